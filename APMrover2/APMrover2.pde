@@ -92,10 +92,12 @@ version 2.1 of the License, or (at your option) any later version.
 #include <AP_RangeFinder.h>	// Range finder library
 #include <Filter.h>			// Filter library
 #include <AP_Buffer.h>      // FIFO buffer library
+#include <AP_Scheduler.h>   // main loop scheduler
 #include <ModeFilter.h>		// Mode Filter from Filter library
 #include <AverageFilter.h>	// Mode Filter from Filter library
 #include <AP_Relay.h>       // APM relay
 #include <AP_Mount.h>		// Camera/Antenna mount
+#include <AP_Mission.h>		// mission command storage
 #include <GCS_MAVLink.h>    // MAVLink GCS definitions
 #include <AP_Airspeed.h>    // needed for AHRS build
 #include <memcheck.h>
@@ -107,6 +109,7 @@ version 2.1 of the License, or (at your option) any later version.
 #include <AP_HAL_AVR_SITL.h>
 #include <AP_HAL_PX4.h>
 #include <AP_HAL_Empty.h>
+#include <AP_HAL_Static.h>
 #include "compat.h"
 
 // Configuration
@@ -517,6 +520,8 @@ static struct 	Location current_loc;
 static struct 	Location next_WP;
 // The location of the active waypoint in Guided mode.
 static struct  	Location guided_WP;
+// The mission commands in EEPROM, with a cache of the ones in use
+static AP_Mission mission(WP_START_BYTE, MAX_WAYPOINTS + 1);
 
 // The location structure information from the Nav command being processed
 static struct 	Location next_nav_command;	
@@ -533,6 +538,8 @@ static float G_Dt						= 0.02;
 ////////////////////////////////////////////////////////////////////////////////
 // Performance monitoring
 ////////////////////////////////////////////////////////////////////////////////
+// Runs all the regular tasks apart from the fast_loop()
+static AP_Scheduler scheduler;
 // Timer used to accrue data and trigger recording of the performanc monitoring log message
 static int32_t 	perf_mon_timer;
 // The maximum main loop execution time recorded in the current performance monitoring interval
@@ -549,6 +556,8 @@ static int16_t pmTest1 = 0;
 ////////////////////////////////////////////////////////////////////////////////
 // Time in miliseconds of start of main control loop.  Milliseconds
 static uint32_t 	fast_loopTimer;
+// Time in microseconds of start of main control loop
+static uint32_t 	fast_loopTimer_us;
 // Time Stamp when fast loop was complete.  Milliseconds
 static uint32_t 	fast_loopTimeStamp;
 // Number of milliseconds used in last main loop cycle
@@ -556,19 +565,15 @@ static uint8_t 		delta_ms_fast_loop;
 // Counter of main loop executions.  Used for performance monitoring and failsafe processing
 static uint16_t			mainLoop_count;
 
-// Time in miliseconds of start of medium control loop.  Milliseconds
+// Time in miliseconds of the last battery reading.  Milliseconds
 static uint32_t 	medium_loopTimer;
-// Counters for branching from main control loop to slower loops
+// Counter for branching from main control loop to slower loops
 static uint8_t 			medium_loopCounter;	
-// Number of milliseconds used in last medium loop cycle
+// Number of milliseconds between the last two battery readings
 static uint8_t			delta_ms_medium_loop;
 
-// Counters for branching from medium control loop to slower loops
-static uint8_t 			slow_loopCounter;
-// Counter to trigger execution of very low rate processes
-static uint8_t 			superslow_loopCounter;
-// Counter to trigger execution of 1 Hz processes
-static uint8_t				counter_one_herz;
+// Counter for branching from medium control loop to slower loops
+static uint8_t			slow_loopCounter;
 
 // % MCU cycles used
 static float 			load;
@@ -577,6 +582,32 @@ static float 			load;
 // Top-level logic
 ////////////////////////////////////////////////////////////////////////////////
 
+/*
+  scheduler table - all regular tasks apart from the fast_loop() and
+  medium_loop() should be listed here, along with how often they should
+  be called (in 20ms units) and the maximum time they are expected to
+  take (in microseconds). They are run in the time left over after the
+  fast loop, so GPS, navigation and failsafes are not in here
+ */
+static const AP_Scheduler::Task scheduler_tasks[] PROGMEM = {
+#if MOUNT == ENABLED
+	{ update_mount,           1,    500 },
+#endif
+	{ update_compass,         5,   1200 },
+	{ update_logging,         5,   1500 },
+	{ update_battery,         5,   1000 },
+	{ read_trim_switch,       5,   1000 },
+	{ read_control_switch,   15,   1000 },
+	{ update_aux,            15,   1000 },
+	{ update_events,         15,   1500 },
+#if USB_MUX_PIN > 0
+	{ check_usb_mux,         15,    300 },
+#endif
+	{ one_second_loop,       50,   1500 },
+	{ compass_save,        3000,   2500 },
+	{ perf_update,         1000,   1500 }
+};
+
 void setup() {
 	memcheck_init();
     cliSerial = hal.console;
@@ -604,6 +635,10 @@ void setup() {
 #endif
 
 	init_ardupilot();
+
+	// initialise the main loop scheduler, with the 10Hz tasks spread
+	// over the ticks
+	scheduler.init(&scheduler_tasks[0], sizeof(scheduler_tasks)/sizeof(scheduler_tasks[0]), true);
 }
 
 void loop()
@@ -615,6 +650,7 @@ void loop()
 		load                = (float)(fast_loopTimeStamp - fast_loopTimer)/delta_ms_fast_loop;
 		G_Dt                = (float)delta_ms_fast_loop / 1000.f;
 		fast_loopTimer      = millis();
+		fast_loopTimer_us   = micros();
 
 		mainLoop_count++;
 
@@ -626,33 +662,30 @@ void loop()
 		// -----------------------
 		medium_loop();
 
-		counter_one_herz++;
-		if(counter_one_herz == 50){
-			one_second_loop();
-			counter_one_herz = 0;
-		}
-
-		if (millis() - perf_mon_timer > 20000) {
-			if (mainLoop_count != 0) {
-  #if LITE == DISABLED
-				if (g.log_bitmask & MASK_LOG_PM)
-					#if HIL_MODE != HIL_MODE_ATTITUDE
-					Log_Write_Performance();
-					#endif
- #endif
-				resetPerfData();
-			}
-		}
+		// tell the scheduler one tick has passed
+		scheduler.tick();
 
 		fast_loopTimeStamp = millis();
-    } else if (millis() - fast_loopTimeStamp < 19) {
-        // less than 19ms has passed. We have at least one millisecond
-        // of free time. The most useful thing to do with that time is
-        // to accumulate some sensor readings, specifically the
-        // compass, which is often very noisy but is not interrupt
-        // driven, so it can't accumulate readings by itself
-        if (g.compass_enabled) {
-            compass.accumulate();
+    } else {
+        // run the scheduled tasks in the time left before the next
+        // fast loop is due
+        uint16_t time_to_next_loop;
+        uint32_t dt = micros() - fast_loopTimer_us;
+        if (dt > 20000) {
+            time_to_next_loop = 0;
+        } else {
+            time_to_next_loop = 20000 - dt;
+        }
+        scheduler.run(time_to_next_loop);
+
+        if (millis() - fast_loopTimeStamp < 19) {
+            // less than 19ms has passed. We have at least one
+            // millisecond of free time. The most useful thing to do
+            // with that time is to accumulate some sensor readings,
+            // specifically the compass, which is often very noisy but
+            // is not interrupt driven, so it can't accumulate readings
+            // by itself
+            compass_accumulate();
         }
     }
 }
@@ -738,167 +771,157 @@ static void fast_loop()
     gcs_data_stream_send();
 }
 
+#if MOUNT == ENABLED
+/*
+  the 10Hz work that navigation and the failsafes depend on. It is run
+  straight after the fast loop, one step per tick, so it does not wait
+  for the scheduler to find spare time
+ */
 static void medium_loop()
 {
-#if MOUNT == ENABLED
-	camera_mount.update_mount_position();
-#endif
-
-	// This is the start of the medium (10 Hz) loop pieces
-	// -----------------------------------------
 	switch(medium_loopCounter) {
-
-		// This case deals with the GPS
-		//-------------------------------
 		case 0:
-			medium_loopCounter++;
-            update_GPS();
-            calc_gndspeed_undershoot();
-            
-//#if LITE == DISABLED
-			#if HIL_MODE != HIL_MODE_ATTITUDE
-            if (g.compass_enabled && compass.read()) {
-                ahrs.set_compass(&compass);
-                // Calculate heading
-                compass.null_offsets();
-            } else {
-                ahrs.set_compass(NULL);
-            }
-			#endif
-//#endif
-/*{
-cliSerial->print(ahrs.roll_sensor, DEC);	cliSerial->printf_P(PSTR("\t"));
-cliSerial->print(ahrs.pitch_sensor, DEC);	cliSerial->printf_P(PSTR("\t"));
-cliSerial->print(ahrs.yaw_sensor, DEC);	cliSerial->printf_P(PSTR("\t"));
-Vector3f tempaccel = ins.get_accel();
-cliSerial->print(tempaccel.x, DEC);	cliSerial->printf_P(PSTR("\t"));
-cliSerial->print(tempaccel.y, DEC);	cliSerial->printf_P(PSTR("\t"));
-cliSerial->println(tempaccel.z, DEC);
-}*/
-
+			update_GPS();
 			break;
 
-		// This case performs some navigation computations
-		//------------------------------------------------
 		case 1:
-			medium_loopCounter++;
-            navigate();
+			// calculate the rover's desired bearing
+			navigate();
 			break;
 
-		// command processing
-		//------------------------------
 		case 2:
-			medium_loopCounter++;
-
 			// perform next command
-			// --------------------
 			update_commands();
 			break;
 
-		// This case deals with sending high rate telemetry
-		//-------------------------------------------------
 		case 3:
-			medium_loopCounter++;
-#if LITE == DISABLED
-			#if HIL_MODE != HIL_MODE_ATTITUDE
-				if ((g.log_bitmask & MASK_LOG_ATTITUDE_MED) && !(g.log_bitmask & MASK_LOG_ATTITUDE_FAST))
-					Log_Write_Attitude((int)ahrs.roll_sensor, (int)ahrs.pitch_sensor, (uint16_t)ahrs.yaw_sensor);
-
-				if (g.log_bitmask & MASK_LOG_CTUN)
-					Log_Write_Control_Tuning();
-			#endif
-
-			if (g.log_bitmask & MASK_LOG_NTUN)
-				Log_Write_Nav_Tuning();
-
-			if (g.log_bitmask & MASK_LOG_GPS)
-				Log_Write_GPS(g_gps->time, current_loc.lat, current_loc.lng, g_gps->altitude, current_loc.alt, (long) g_gps->ground_speed, g_gps->ground_course, g_gps->fix, g_gps->num_sats);
-#endif
 			break;
 
-		// This case controls the slow loop
-		//---------------------------------
 		case 4:
-			medium_loopCounter = 0;
-			delta_ms_medium_loop	= millis() - medium_loopTimer;
-			medium_loopTimer      	= millis();
-
-			if (g.battery_monitoring != 0){
-				read_battery();
+			// the 3.3Hz failsafe check
+			slow_loopCounter++;
+			if (slow_loopCounter == 3) {
+				check_long_failsafe();
+				slow_loopCounter = 0;
 			}
-
-			read_trim_switch();
-
-			slow_loop();
 			break;
 	}
+
+	medium_loopCounter++;
+	if (medium_loopCounter == 5) {
+		medium_loopCounter = 0;
+	}
 }
 
-static void slow_loop()
+static void update_mount(void)
+{
+	camera_mount.update_mount_position();
+}
+#endif
+
+static void update_compass(void)
+{
+#if HIL_MODE != HIL_MODE_ATTITUDE
+    if (g.compass_enabled && compass.read()) {
+        ahrs.set_compass(&compass);
+        // Calculate heading
+        compass.null_offsets();
+    } else {
+        ahrs.set_compass(NULL);
+    }
+#endif
+}
+
+/*
+  if the compass is enabled then try to accumulate a reading
+ */
+static void compass_accumulate(void)
+{
+    if (g.compass_enabled) {
+        compass.accumulate();
+    }
+}
+
+static void compass_save(void)
 {
-	// This is the slow (3 1/3 Hz) loop pieces
-	//----------------------------------------
-	switch (slow_loopCounter){
-		case 0:
-			slow_loopCounter++;
-			check_long_failsafe();
-			superslow_loopCounter++;
-			if(superslow_loopCounter >=200) {				//	200 = Execute every minute
 #if LITE == DISABLED
-				#if HIL_MODE != HIL_MODE_ATTITUDE
-					if(g.compass_enabled) {
-						compass.save_offsets();
-					}
-				#endif
+	#if HIL_MODE != HIL_MODE_ATTITUDE
+		if(g.compass_enabled) {
+			compass.save_offsets();
+		}
+	#endif
 #endif
-				superslow_loopCounter = 0;
-			}
-			break;
+}
 
-		case 1:
-			slow_loopCounter++;
+static void update_logging(void)
+{
+#if LITE == DISABLED
+	#if HIL_MODE != HIL_MODE_ATTITUDE
+		if ((g.log_bitmask & MASK_LOG_ATTITUDE_MED) && !(g.log_bitmask & MASK_LOG_ATTITUDE_FAST))
+			Log_Write_Attitude((int)ahrs.roll_sensor, (int)ahrs.pitch_sensor, (uint16_t)ahrs.yaw_sensor);
 
-			// Read 3-position switch on radio
-			// -------------------------------
-			read_control_switch();
+		if (g.log_bitmask & MASK_LOG_CTUN)
+			Log_Write_Control_Tuning();
+	#endif
 
-			update_aux_servo_function(&g.rc_5, &g.rc_6, &g.rc_7, &g.rc_8);
+	if (g.log_bitmask & MASK_LOG_NTUN)
+		Log_Write_Nav_Tuning();
 
-#if MOUNT == ENABLED
-			camera_mount.update_mount_type();
+	if (g.log_bitmask & MASK_LOG_GPS)
+		Log_Write_GPS(g_gps->time, current_loc.lat, current_loc.lng, g_gps->altitude, current_loc.alt, (long) g_gps->ground_speed, g_gps->ground_course, g_gps->fix, g_gps->num_sats);
 #endif
-			break;
+}
 
-		case 2:
-			slow_loopCounter = 0;
-                        
-			update_events();
+static void update_battery(void)
+{
+	delta_ms_medium_loop	= millis() - medium_loopTimer;
+	medium_loopTimer      	= millis();
 
-            mavlink_system.sysid = g.sysid_this_mav;		// This is just an ugly hack to keep mavlink_system.sysid sync'd with our parameter
+	if (g.battery_monitoring != 0){
+		read_battery();
+	}
+}
 
-#if USB_MUX_PIN > 0
-            check_usb_mux();
+static void update_aux(void)
+{
+	update_aux_servo_function(&g.rc_5, &g.rc_6, &g.rc_7, &g.rc_8);
+
+#if MOUNT == ENABLED
+	camera_mount.update_mount_type();
 #endif
 
 #if TRACE == ENABLED
-         //     cliSerial->printf_P(PSTR("NAV->gnd_crs=%3.0f, nav_brg=%3.0f, tgt_brg=%3.0f, brg_err=%3.0f, nav_rll=%3.1f rsvo=%3.1f\n"), 
-         //           ahrs.yaw_sensor*0.01, (float)nav_bearing/100, (float)target_bearing/100, (float)bearing_error/100, (float)nav_roll/100, (float)g.channel_roll.servo_out/100);           
-             // cliSerial->printf_P(PSTR("WPL->g.command_total=%d, g.command_index=%d, nav_command_index=%d\n"), 
-                //    g.command_total, g.command_index, nav_command_index);      
-    	   cliSerial->printf_P(PSTR("NAV->gnd_crs=%3.0f,  sonar_dist = %d    obstacle = %d\n"), ahrs.yaw_sensor*0.01, (int)sonar_dist, obstacle);                
-#endif                          
-			break;
-	}
+	cliSerial->printf_P(PSTR("NAV->gnd_crs=%3.0f,  sonar_dist = %d    obstacle = %d\n"), ahrs.yaw_sensor*0.01, (int)sonar_dist, obstacle);
+#endif
 }
 
 static void one_second_loop()
 {
+	// write out any waypoints still waiting in the mission batch
+	mission.flush();
+
 #if LITE == DISABLED
 	if (g.log_bitmask & MASK_LOG_CUR)
 		Log_Write_Current();
 #endif
 	// send a heartbeat
 	gcs_send_message(MSG_HEARTBEAT);
+
+	mavlink_system.sysid = g.sysid_this_mav;		// This is just an ugly hack to keep mavlink_system.sysid sync'd with our parameter
+}
+
+static void perf_update(void)
+{
+	if (mainLoop_count != 0) {
+  #if LITE == DISABLED
+		if (g.log_bitmask & MASK_LOG_PM)
+			#if HIL_MODE != HIL_MODE_ATTITUDE
+			Log_Write_Performance();
+			#endif
+ #endif
+		resetPerfData();
+	}
+	scheduler.reset_stats();
 }
 
 static void update_GPS(void)
@@ -933,6 +956,8 @@ static void update_GPS(void)
 		}
         ground_speed   = g_gps->ground_speed;
 	}
+
+	calc_gndspeed_undershoot();
 }
 
 static void update_current_flight_mode(void)
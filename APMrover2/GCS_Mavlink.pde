@@ -1495,6 +1495,8 @@ void GCS_MAVLINK::handleMessage(mavlink_message_t* msg)
 				waypoint_request_i++;
 
                 if (waypoint_request_i > waypoint_request_last) {
+					mission.flush();
+
 					mavlink_msg_mission_ack_send(
 						chan,
 						msg->sysid,
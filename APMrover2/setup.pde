@@ -586,6 +586,7 @@ static void zero_eeprom(void)
 	for (uint16_t i = 0; i < EEPROM_MAX_ADDR; i++) {
 		hal.storage->write_byte(i, b);
 	}
+	mission.clear_cache();
 	cliSerial->printf_P(PSTR("done\n"));
 }
 
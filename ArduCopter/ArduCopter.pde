@@ -67,9 +67,11 @@
 #include <AP_HAL.h>
 #include <AP_HAL_AVR.h>
 #include <AP_HAL_AVR_SITL.h>
+#include <AP_HAL_Linux.h>
 #include <AP_HAL_SMACCM.h>
 #include <AP_HAL_PX4.h>
 #include <AP_HAL_Empty.h>
+#include <AP_HAL_Static.h>
 
 // Application dependencies
 #include <GCS_MAVLink.h>        // MAVLink GCS definitions
@@ -91,6 +93,8 @@
 #include <AP_OpticalFlow.h>     // Optical Flow library
 #include <Filter.h>             // Filter library
 #include <AP_Buffer.h>          // APM FIFO Buffer
+#include <AP_Scheduler.h>       // main loop scheduler
+#include <AP_PerfMon.h>         // main loop profiler
 #include <AP_LeadFilter.h>      // GPS Lead filter
 #include <AP_Relay.h>           // APM relay
 #include <AP_Camera.h>          // Photo or video camera
@@ -99,6 +103,10 @@
 #include <AP_InertialNav.h>     // ArduPilot Mega inertial navigation library
 #include <AP_Declination.h>     // ArduPilot Mega Declination Helper Library
 #include <AP_Limits.h>
+#include <AP_Fence.h>           // geofence zones, used by AP_Limits
+#include <AP_FastBoot.h>        // warm start from saved calibration
+#include <AP_Mission.h>         // mission command storage
+#include <AP_Terrain.h>         // terrain height database
 #include <memcheck.h>
 #include <SITL.h>
 
@@ -151,7 +159,7 @@ static void update_events(void);
 DataFlash_APM2 DataFlash;
 #elif CONFIG_HAL_BOARD == HAL_BOARD_APM1
 DataFlash_APM1 DataFlash;
-#elif CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#elif CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 DataFlash_SITL DataFlash;
 #else
 DataFlash_Empty DataFlash;
@@ -198,7 +206,7 @@ AP_InertialSensor_Stub ins;
 AP_InertialSensor_PX4 ins;
  #endif
 
- #if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+ #if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
  // When building for SITL we use the HIL barometer and compass drivers
 AP_Baro_BMP085_HIL barometer;
 AP_Compass_HIL compass;
@@ -232,9 +240,21 @@ AP_OpticalFlow_ADNS3080 optflow;
 AP_OpticalFlow optflow;
  #endif
 
+// second GPS, blended with the first
+ #if GPS2 == ENABLED
+static GPS      *g_gps1;
+static GPS      *g_gps2;
+AP_GPS_Auto     g_gps2_driver(&g_gps2);
+AP_GPS_Blend    g_gps_blend(&g_gps1, &g_gps2);
+ #endif
+
 // real GPS selection
  #if   GPS_PROTOCOL == GPS_PROTOCOL_AUTO
+  #if GPS2 == ENABLED
+AP_GPS_Auto     g_gps_driver(&g_gps1);
+  #else
 AP_GPS_Auto     g_gps_driver(&g_gps);
+  #endif
 
  #elif GPS_PROTOCOL == GPS_PROTOCOL_NMEA
 AP_GPS_NMEA     g_gps_driver();
@@ -704,6 +724,9 @@ static struct   Location current_loc;
 static struct   Location next_WP;
 // Prev WP is used to get the optimum path from one WP to the next
 static struct   Location prev_WP;
+// The mission commands in EEPROM, with a cache of the ones in use
+static AP_Mission mission(WP_START_BYTE, MAX_WAYPOINTS + 1);
+
 // Holds the current loaded command from the EEPROM for navigation
 static struct   Location command_nav_queue;
 // Holds the current loaded command from the EEPROM for conditional scripts
@@ -720,6 +743,9 @@ static struct   Location guided_WP;
 static int32_t original_wp_bearing;
 // The amount of angle correction applied to wp_bearing to bring the copter back on its optimum path
 static int16_t crosstrack_error;
+// The leg from prev_WP to next_WP, for distance, bearing and crosstrack
+// to next_WP without redoing the trigonometry each update
+static NavLeg nav_leg;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -817,6 +843,8 @@ AP_InertialNav inertial_nav(&ahrs, &ins, &barometer, &g_gps);
 ////////////////////////////////////////////////////////////////////////////////
 // Performance monitoring
 ////////////////////////////////////////////////////////////////////////////////
+// Runs all the regular tasks apart from the fast_loop()
+static AP_Scheduler scheduler;
 // Used to manage the rate of performance logging messages
 static int16_t perf_mon_counter;
 // The number of GPS fixes we have had
@@ -894,6 +922,20 @@ AP_Limit_Geofence       geofence_limit(FENCE_START_BYTE, FENCE_WP_SIZE, MAX_FENC
 AP_Limit_Altitude       altitude_limit(&current_loc);
 #endif
 
+////////////////////////////////////////////////////////////////////////////////
+// Fast boot from the last validated calibration
+////////////////////////////////////////////////////////////////////////////////
+#if FAST_BOOT == ENABLED
+AP_FastBoot fast_boot(ins, barometer, ahrs, FAST_BOOT_START_BYTE);
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Terrain heights
+////////////////////////////////////////////////////////////////////////////////
+#if TERRAIN == ENABLED
+AP_Terrain terrain;
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 // function definitions to keep compiler from complaining about undeclared functions
 ////////////////////////////////////////////////////////////////////////////////
@@ -906,6 +948,35 @@ void get_throttle_althold(int32_t target_alt, int16_t min_climb_rate, int16_t ma
 // setup the var_info table
 AP_Param param_loader(var_info, WP_START_BYTE);
 
+/*
+  scheduler table - all regular tasks apart from the fast_loop()
+  should be listed here, along with how often they should be called
+  (in 10ms units) and the maximum time they are expected to take (in
+  microseconds)
+ */
+static const AP_Scheduler::Task scheduler_tasks[] PROGMEM = {
+    { update_GPS,            2,     900 },
+    { update_navigation,     2,     500 },
+    { medium_loop,           2,     700 },
+    { update_altitude_est,   2,     900 },
+    { fifty_hz_loop,         2,     800 },
+    { run_nav_updates,       2,     500 },
+    { slow_loop,            10,     500 },
+    { gcs_check_input,	     2,     700 },
+    { gcs_send_heartbeat,  100,     700 },
+    { gcs_data_stream_send,  2,    1100 },
+    { gcs_send_deferred,     2,     700 },
+    { compass_accumulate,    2,     600 },
+    { super_slow_loop,     100,    1100 },
+#if FAST_BOOT == ENABLED
+    { fast_boot_update,     10,     300 },
+#endif
+#if TERRAIN == ENABLED
+    { terrain_update,      100,    3000 },
+#endif
+    { perf_update,        1000,     500 }
+};
+
 void setup() {
     cliSerial = hal.console;
 
@@ -933,6 +1004,17 @@ void setup() {
 
     memcheck_init();
     init_ardupilot();
+
+    // initialise the main loop scheduler
+    scheduler.init(&scheduler_tasks[0], sizeof(scheduler_tasks)/sizeof(scheduler_tasks[0]));
+#if SCHEDULER_HISTOGRAMS == ENABLED
+    scheduler.enable_histograms();
+#endif
+
+#if PERFMON == ENABLED && (CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+    // record the first calls of each zone for chrome://tracing
+    AP_PerfMon::trace_start("perfmon_trace.json", PERFMON_TRACE_EVENTS);
+#endif
 }
 
 /*
@@ -950,13 +1032,54 @@ static void compass_accumulate(void)
 
 static void perf_update(void)
 {
-    if (g.log_bitmask & MASK_LOG_PM)
+    if (g.log_bitmask & MASK_LOG_PM) {
         Log_Write_Performance();
+        Log_Write_Loop_Histograms();
+        Log_Write_Memory();
+    }
+#if PERFMON == ENABLED
+    if (g.log_bitmask & MASK_LOG_PM)
+        Log_Write_PerfMon();
+#endif
 #if SCHEDULER_DEBUG
     cliSerial->printf_P(PSTR("PERF: %u/%u %lu\n"), 
                         (unsigned)perf_info_get_num_long_running(),
                         (unsigned)perf_info_get_num_loops(),
                         (unsigned long)perf_info_get_max_time());
+    for (uint8_t i=0; i<scheduler.num_tasks(); i++) {
+        const AP_Scheduler::TaskStats &stats = scheduler.task_stats(i);
+        cliSerial->printf_P(PSTR("TASK %u: %u calls mean %u max %u/%u overruns %u skipped %u late %u\n"),
+                            (unsigned)i,
+                            (unsigned)stats.num_calls,
+                            (unsigned)scheduler.task_mean_time_micros(i),
+                            (unsigned)stats.max_time_micros,
+                            (unsigned)scheduler.task_max_time_allowed(i),
+                            (unsigned)stats.num_overruns,
+                            (unsigned)stats.num_skipped,
+                            (unsigned)stats.max_late_ticks);
+    }
+    AP_HAL::Scheduler::TimerStats timer_stats;
+    hal.scheduler->get_timer_stats(timer_stats);
+    cliSerial->printf_P(PSTR("TIMER: %lu ticks missed %u overran %u worst %u\n"),
+                        (unsigned long)timer_stats.num_ticks,
+                        (unsigned)timer_stats.missed_ticks,
+                        (unsigned)timer_stats.overrun_ticks,
+                        (unsigned)timer_stats.worst_tick_us);
+    AP_HAL::Scheduler::TimerProcStats proc_stats;
+    for (uint8_t i=0; hal.scheduler->get_timer_proc_stats(i, proc_stats); i++) {
+        cliSerial->printf_P(PSTR("TIMER %u: %u calls min %u mean %u max %u worst tick %u\n"),
+                            (unsigned)i,
+                            (unsigned)proc_stats.num_calls,
+                            (unsigned)proc_stats.min_time_us,
+                            (unsigned)proc_stats.mean_time_us,
+                            (unsigned)proc_stats.max_time_us,
+                            (unsigned)proc_stats.worst_tick_time_us);
+    }
+#endif
+    scheduler.reset_stats();
+    hal.scheduler->clear_timer_stats();
+#if PERFMON == ENABLED
+    AP_PerfMon::clear();
 #endif
     perf_info_reset();
     gps_fix_count = 0;
@@ -974,99 +1097,6 @@ static int16_t main_loop_time_available(void)
     return 10000 - dt;
 }
 
-typedef void (*event_fn_t)(void);
-
-struct timer_event_table {
-    event_fn_t func;
-    uint16_t time_interval_10ms;
-    uint16_t min_time_usec;
-};
-
-#define NUM_TIMER_EVENTS 14
-
-/*
-  scheduler table - all regular events apart from the fast_loop()
-  should be listed here, along with how often they should be called
-  (in 10ms units) and the maximum time they are expected to take
- */
-static const struct timer_event_table PROGMEM timer_events[NUM_TIMER_EVENTS] = {
-    { update_GPS,         2,     900 },
-    { update_navigation,     2,     500 },
-    { medium_loop,           2,     700 },
-    { update_altitude_est,   2,     900 },
-    { fifty_hz_loop,         2,     800 },
-    { run_nav_updates,       2,     500 },
-    { slow_loop,            10,     500 },
-    { gcs_check_input,	     2,     700 },
-    { gcs_send_heartbeat,  100,     700 },
-    { gcs_data_stream_send,  2,    1100 },
-    { gcs_send_deferred,     2,     700 },
-    { compass_accumulate,    2,     600 },
-    { super_slow_loop,     100,    1100 },
-    { perf_update,        1000,     500 }
-};
-static uint16_t timer_counters[NUM_TIMER_EVENTS];
-
-static uint16_t tick_counter;
-static uint32_t event_time_started;
-static uint16_t event_time_allowed;
-
-/*
-  return number of micros until the current event reaches its deadline
- */
-static uint16_t event_time_available(void)
-{
-    uint32_t dt = micros() - event_time_started;
-    if (dt > event_time_allowed) {
-        return 0;
-    }
-    return event_time_allowed - dt;
-}
-
-/*
-  run as many scheduler events as we can
- */
-static void run_events(uint16_t time_available_usec)
-{
-    for (uint8_t i=0; i<NUM_TIMER_EVENTS; i++) {
-        // Make sure to use 16-bit arithmetic here for this comparison
-        // to handle the rollover case.  Due to C integer promotion
-        // rules, we have to force the type of the difference here to
-        // "uint16_t" or the compiler will do a 32-bit comparison on a
-        // 32-bit platform.
-        uint16_t dt = tick_counter - timer_counters[i];
-        if (dt >= pgm_read_word(&timer_events[i].time_interval_10ms)) {
-            // this event is due to run. Do we have enough time to run it?
-            event_time_allowed = pgm_read_word(&timer_events[i].min_time_usec);
-            if (event_time_allowed <= time_available_usec) {
-                // run it
-                event_time_started = micros();
-                event_fn_t func = (event_fn_t)pgm_read_pointer(&timer_events[i].func);
-                func();
-                
-                // record the tick counter when we ran. This drives
-                // when we next run the event
-                timer_counters[i] = tick_counter;
-                
-                // work out how long the event actually took
-                uint32_t time_taken = micros() - event_time_started;
-                
-                if (time_taken > event_time_allowed) {
-                    // the event overran!
-#if SCHEDULER_DEBUG
-                    cliSerial->printf_P(PSTR("overrun in event %u (%u/%u)\n"), 
-                                        (unsigned)i, 
-                                        (unsigned)time_taken,
-                                        (unsigned)event_time_allowed);
-#endif
-                    return;
-                }
-                time_available_usec -= time_taken;
-            }
-        }
-    }
-}
-
 void loop()
 {
     uint32_t timer = micros();
@@ -1091,8 +1121,10 @@ void loop()
         // Execute the fast loop
         // ---------------------
         fast_loop();
+        perf_info_check_fast_loop_time(micros() - timer);
 
-        tick_counter++;
+        // tell the scheduler one tick has passed
+        scheduler.tick();
     } else {
         uint16_t time_to_next_loop;
         uint16_t dt = timer - fast_loopTimer;
@@ -1101,7 +1133,8 @@ void loop()
         } else {
             time_to_next_loop = 10000 - dt;
         }
-        run_events(time_to_next_loop);
+        PERFMON_ZONE("scheduler")
+        scheduler.run(time_to_next_loop);
     }
 }
 
@@ -1109,6 +1142,8 @@ void loop()
 // Main loop - 100hz
 static void fast_loop()
 {
+    PERFMON_ZONE("fast_loop")
+
     // run low level rate controllers that only require IMU data
     run_rate_controllers();
 
@@ -1406,6 +1441,9 @@ static void slow_loop()
 // 1Hz loop
 static void super_slow_loop()
 {
+    // write out any waypoints still waiting in the mission batch
+    mission.flush();
+
     Log_Write_Data(DATA_AP_STATE, ap.value);
 
     if (g.log_bitmask & MASK_LOG_CUR && motors.armed())
@@ -1572,6 +1610,8 @@ bool set_yaw_mode(uint8_t new_yaw_mode)
 // 100hz update rate
 void update_yaw_mode(void)
 {
+    PERFMON_ZONE("yaw_mode")
+
     switch(yaw_mode) {
 
     case YAW_HOLD:
@@ -1679,6 +1719,8 @@ bool set_roll_pitch_mode(uint8_t new_roll_pitch_mode)
 // 100hz update rate
 void update_roll_pitch_mode(void)
 {
+    PERFMON_ZONE("rp_mode")
+
     if (ap.do_flip) {
         if(abs(g.rc_1.control_in) < 4000) {
             roll_flip();
@@ -2061,6 +2103,8 @@ void update_throttle_mode(void)
 
 static void read_AHRS(void)
 {
+    PERFMON_ZONE("ahrs")
+
     // Perform IMU calculations and get attitude info
     //-----------------------------------------------
 #if HIL_MODE != HIL_MODE_DISABLED
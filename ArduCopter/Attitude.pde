@@ -263,6 +263,8 @@ update_rate_contoller_targets()
 void
 run_rate_controllers()
 {
+    PERFMON_ZONE("rate_ctrl")
+
 #if FRAME_CONFIG == HELI_FRAME          // helicopters only use rate controllers for yaw and only when not using an external gyro
     if(!motors.ext_gyro_enabled) {
 		g.rc_1.servo_out = get_heli_rate_roll(roll_rate_target_bf);
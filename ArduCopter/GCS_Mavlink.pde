@@ -288,7 +288,7 @@ static void NOINLINE send_ahrs(mavlink_channel_t chan)
         ahrs.get_error_yaw());
 }
 
-#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 // report simulator state
 static void NOINLINE send_simstate(mavlink_channel_t chan)
 {
@@ -304,6 +304,52 @@ static void NOINLINE send_hwstatus(mavlink_channel_t chan)
         hal.i2c->lockup_count());
 }
 
+#if PERFMON == ENABLED
+// send the timing of the next AP_PerfMon zone in turn. x is the number
+// of calls, y the time in the zone less its children and z the longest
+// call, all since the statistics were last cleared time_usec ago
+static void NOINLINE send_perfmon(mavlink_channel_t chan)
+{
+    static uint8_t next_zone[2];
+    uint8_t &zone = next_zone[(uint8_t)chan];
+
+    if (AP_PerfMon::num_zones() == 0) {
+        return;
+    }
+    if (zone >= AP_PerfMon::num_zones()) {
+        zone = 0;
+    }
+    const AP_PerfMon::ZoneStats &stats = AP_PerfMon::zone_stats(zone);
+    char name[AP_PERFMON_NAME_LENGTH+1];
+    AP_PerfMon::zone_name(zone, name);
+    mavlink_msg_debug_vect_send(
+        chan,
+        name,
+        AP_PerfMon::elapsed_us(),
+        stats.num_calls,
+        stats.self_time_us,
+        stats.max_time_us);
+    zone++;
+}
+#endif
+
+// send the next loop timing histogram in turn as a DATA64 packet of
+// type DATAMSG_TYPE_HISTOGRAM, packed by perf_info_pack_histogram()
+static void NOINLINE send_loop_histogram(mavlink_channel_t chan)
+{
+    static uint8_t next_id[2];
+    uint8_t &id = next_id[(uint8_t)chan];
+    uint8_t buf[64];
+
+    uint8_t len = perf_info_pack_histogram(id, buf, sizeof(buf));
+    if (len == 0) {
+        id = 0;
+        len = perf_info_pack_histogram(id, buf, sizeof(buf));
+    }
+    mavlink_msg_data64_send(chan, DATAMSG_TYPE_HISTOGRAM, len, buf);
+    id++;
+}
+
 static void NOINLINE send_gps_raw(mavlink_channel_t chan)
 {
     uint8_t fix = g_gps->status();
@@ -544,7 +590,7 @@ static bool mavlink_try_send_message(mavlink_channel_t chan, enum ap_message id,
     // if we don't have at least 1ms remaining before the main loop
     // wants to fire then don't send a mavlink message. We want to
     // prioritise the main flight control loop over communications
-    if (event_time_available() < 500) {
+    if (scheduler.time_available_usec() < 500) {
         gcs_out_of_time = true;
         return false;
     }
@@ -663,7 +709,7 @@ static bool mavlink_try_send_message(mavlink_channel_t chan, enum ap_message id,
         break;
 
     case MSG_SIMSTATE:
-#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
         CHECK_PAYLOAD_SIZE(SIMSTATE);
         send_simstate(chan);
 #endif
@@ -674,6 +720,18 @@ static bool mavlink_try_send_message(mavlink_channel_t chan, enum ap_message id,
         send_hwstatus(chan);
         break;
 
+    case MSG_PERFMON:
+#if PERFMON == ENABLED
+        CHECK_PAYLOAD_SIZE(DEBUG_VECT);
+        send_perfmon(chan);
+#endif
+        break;
+
+    case MSG_LOOP_HISTOGRAM:
+        CHECK_PAYLOAD_SIZE(DATA64);
+        send_loop_histogram(chan);
+        break;
+
     case MSG_RETRY_DEFERRED:
         break; // just here to prevent a warning
     }
@@ -1045,6 +1103,8 @@ GCS_MAVLINK::data_stream_send(void)
     if (stream_trigger(STREAM_EXTRA3)) {
         send_message(MSG_AHRS);
         send_message(MSG_HWSTATUS);
+        send_message(MSG_PERFMON);
+        send_message(MSG_LOOP_HISTOGRAM);
     }
 }
 
@@ -1324,7 +1384,9 @@ void GCS_MAVLINK::handleMessage(mavlink_message_t* msg)
         // set frame of waypoint
         uint8_t frame;
 
-        if (tell_command.options & MASK_OPTIONS_RELATIVE_ALT) {
+        if (tell_command.options & WP_OPTION_TERRAIN) {
+            frame = MAV_FRAME_GLOBAL_TERRAIN_ALT;                      // reference frame
+        } else if (tell_command.options & MASK_OPTIONS_RELATIVE_ALT) {
             frame = MAV_FRAME_GLOBAL_RELATIVE_ALT;                     // reference frame
         } else {
             frame = MAV_FRAME_GLOBAL;                     // reference frame
@@ -1616,6 +1678,11 @@ void GCS_MAVLINK::handleMessage(mavlink_message_t* msg)
         tell_command.lng = 1.0e7 * packet.y;                 // in as DD converted to * t7
         tell_command.alt = packet.z * 1.0e2;
         tell_command.options = 1;                 // store altitude relative to home alt!! Always!!
+#if TERRAIN == ENABLED
+        if (packet.frame == MAV_FRAME_GLOBAL_TERRAIN_ALT) {
+            tell_command.options |= WP_OPTION_TERRAIN;
+        }
+#endif
 
         switch (tell_command.id) {                                                      // Switch to map APM command fields into MAVLink command fields
         case MAV_CMD_NAV_LOITER_TURNS:
@@ -1677,6 +1744,14 @@ void GCS_MAVLINK::handleMessage(mavlink_message_t* msg)
             break;
         }
 
+#if TERRAIN == ENABLED
+        // guided waypoints and altitude changes are used straight away,
+        // so they are made relative to home here
+        if (packet.current == 2 || packet.current == 3) {
+            terrain_adjust_alt(tell_command);
+        }
+#endif
+
         if(packet.current == 2) {                                               //current = 2 is a flag to tell us this is a "guided mode" waypoint and not for the mission
             guided_WP = tell_command;
 
@@ -1732,6 +1807,8 @@ void GCS_MAVLINK::handleMessage(mavlink_message_t* msg)
             if (waypoint_request_i == (uint16_t)g.command_total) {
                 uint8_t type = 0;                         // ok (0), error(1)
 
+                mission.flush();
+
                 mavlink_msg_mission_ack_send(
                     chan,
                     msg->sysid,
@@ -2068,6 +2145,17 @@ void GCS_MAVLINK::handleMessage(mavlink_message_t* msg)
 
 #endif // AP_LIMITS ENABLED
 
+#if TERRAIN == ENABLED
+    case MAVLINK_MSG_ID_DATA96: {
+        mavlink_data96_t packet;
+        mavlink_msg_data96_decode(msg, &packet);
+        if (packet.type == TERRAIN_DATA_TILE) {
+            terrain.handle_tile_data(packet.data, min(packet.len, sizeof(packet.data)));
+        }
+        break;
+    }
+#endif
+
     }     // end switch
 } // end handle mavlink
 
@@ -2208,6 +2296,31 @@ static void gcs_check_input(void)
     }
 }
 
+#if TERRAIN == ENABLED
+/*
+ *  ask the ground station for a terrain tile. Nothing is queued, the
+ *  request is repeated by terrain_update() until the tile arrives
+ */
+static void gcs_send_terrain_request(uint16_t lat_index, uint16_t lng_index)
+{
+    uint8_t data[16];
+    memset(data, 0, sizeof(data));
+    data[0] = lat_index & 0xFF;
+    data[1] = lat_index >> 8;
+    data[2] = lng_index & 0xFF;
+    data[3] = lng_index >> 8;
+    if (comm_get_txspace(MAVLINK_COMM_0) >=
+        MAVLINK_NUM_NON_PAYLOAD_BYTES + MAVLINK_MSG_ID_DATA16_LEN) {
+        mavlink_msg_data16_send(MAVLINK_COMM_0, TERRAIN_DATA_REQUEST, 4, data);
+    }
+    if (gcs3.initialised &&
+        comm_get_txspace(MAVLINK_COMM_1) >=
+        MAVLINK_NUM_NON_PAYLOAD_BYTES + MAVLINK_MSG_ID_DATA16_LEN) {
+        mavlink_msg_data16_send(MAVLINK_COMM_1, TERRAIN_DATA_REQUEST, 4, data);
+    }
+}
+#endif
+
 static void gcs_send_text_P(gcs_severity severity, const prog_char_t *str)
 {
     gcs0.send_text_P(severity, str);
@@ -682,6 +682,142 @@ static void Log_Write_Performance()
     DataFlash.WriteByte(END_BYTE);
 }
 
+// Write a packet for each loop timing histogram, as packed by
+// perf_info_pack_histogram(). Total length : 56 bytes for the time
+// between loops, 52 for the fast loop time and 20 for each task
+static void Log_Write_Loop_Histograms()
+{
+    uint8_t buf[64];
+    uint8_t len;
+    for (uint8_t id=0; (len = perf_info_pack_histogram(id, buf, sizeof(buf))) != 0; id++) {
+        DataFlash.WriteByte(HEAD_BYTE1);
+        DataFlash.WriteByte(HEAD_BYTE2);
+        DataFlash.WriteByte(LOG_LOOP_HISTOGRAM_MSG);
+        for (uint8_t i=0; i<len; i++) {
+            DataFlash.WriteByte(buf[i]);
+        }
+        DataFlash.WriteByte(END_BYTE);
+    }
+}
+
+// Read a loop timing histogram packet, printing the lower bound of each
+// bucket and its count
+static void Log_Read_Loop_Histogram()
+{
+    uint8_t id          = DataFlash.ReadByte();
+    uint8_t num_buckets = DataFlash.ReadByte();
+    uint8_t min_bits    = DataFlash.ReadByte();
+    uint8_t sub_bits    = DataFlash.ReadByte();
+
+    cliSerial->printf_P(PSTR("LHST, %u"), (unsigned)id);
+    for (uint8_t i=0; i<num_buckets; i++) {
+        uint16_t count = DataFlash.ReadByte();
+        count |= (uint16_t)DataFlash.ReadByte() << 8;
+        cliSerial->printf_P(PSTR(", %lu:%u"),
+                            (unsigned long)log_histogram_lower_bound(i, min_bits, sub_bits),
+                            (unsigned)count);
+    }
+    if (id == 0) {
+        uint16_t max_jitter = DataFlash.ReadByte();
+        max_jitter |= (uint16_t)DataFlash.ReadByte() << 8;
+        uint16_t mean_jitter = DataFlash.ReadByte();
+        mean_jitter |= (uint16_t)DataFlash.ReadByte() << 8;
+        cliSerial->printf_P(PSTR(", %u, %u"), (unsigned)max_jitter, (unsigned)mean_jitter);
+    }
+    cliSerial->println();
+}
+
+// Write a memory packet, to follow how much memory is free over a
+// flight. Total length : 11 bytes
+static void Log_Write_Memory()
+{
+    AP_HAL::Scheduler::TimerStats stats;
+    hal.scheduler->get_timer_stats(stats);
+#if CONFIG_HAL_BOARD == HAL_BOARD_APM1 || CONFIG_HAL_BOARD == HAL_BOARD_APM2
+    extern unsigned __brkval;
+    uint16_t heap_end = __brkval;
+#else
+    uint16_t heap_end = 0;
+#endif
+
+    DataFlash.WriteByte(HEAD_BYTE1);
+    DataFlash.WriteByte(HEAD_BYTE2);
+    DataFlash.WriteByte(LOG_MEMORY_MSG);
+    DataFlash.WriteInt(memcheck_available_memory());        //1  - free memory
+    DataFlash.WriteInt(heap_end);                           //2  - end of the heap
+    DataFlash.WriteInt(stats.main_stack_bytes);             //3  - stack used by the main loop
+    DataFlash.WriteInt(stats.timer_stack_bytes);            //4  - stack used by the timer
+    DataFlash.WriteByte(END_BYTE);
+}
+
+// Read a memory packet
+static void Log_Read_Memory()
+{
+    uint16_t free_memory    = DataFlash.ReadInt();
+    uint16_t heap_end       = DataFlash.ReadInt();
+    uint16_t main_stack     = DataFlash.ReadInt();
+    uint16_t timer_stack    = DataFlash.ReadInt();
+
+    //                             1   2   3   4
+    cliSerial->printf_P(PSTR("MEM, %u, %u, %u, %u\n"),
+                    (unsigned)free_memory,
+                    (unsigned)heap_end,
+                    (unsigned)main_stack,
+                    (unsigned)timer_stack);
+}
+
+#if PERFMON == ENABLED
+// Write an AP_PerfMon packet for each zone. Total length : 30 bytes each
+static void Log_Write_PerfMon()
+{
+    for (uint8_t i=0; i<AP_PerfMon::num_zones(); i++) {
+        const AP_PerfMon::ZoneStats &stats = AP_PerfMon::zone_stats(i);
+        char name[AP_PERFMON_NAME_LENGTH+1];
+        AP_PerfMon::zone_name(i, name);
+
+        DataFlash.WriteByte(HEAD_BYTE1);
+        DataFlash.WriteByte(HEAD_BYTE2);
+        DataFlash.WriteByte(LOG_PERFMON_MSG);
+        DataFlash.WriteByte(i);                                 //1  - zone
+        DataFlash.WriteByte(stats.parent);                      //2  - parent zone
+        for (uint8_t c=0; c<AP_PERFMON_NAME_LENGTH; c++) {
+            DataFlash.WriteByte(name[c]);                       //3  - name, zero padded
+        }
+        DataFlash.WriteLong(stats.num_calls);                   //4  - number of calls
+        DataFlash.WriteLong(stats.total_time_us);               //5  - time including children
+        DataFlash.WriteLong(stats.self_time_us);                //6  - time less children
+        DataFlash.WriteInt(stats.max_time_us);                  //7  - longest call
+        DataFlash.WriteByte(END_BYTE);
+    }
+}
+#endif
+
+// Read an AP_PerfMon packet
+static void Log_Read_PerfMon()
+{
+    uint8_t zone    = DataFlash.ReadByte();
+    uint8_t parent  = DataFlash.ReadByte();
+    char name[11];
+    for (uint8_t c=0; c<10; c++) {
+        name[c] = DataFlash.ReadByte();
+    }
+    name[10] = 0;
+    uint32_t calls  = DataFlash.ReadLong();
+    uint32_t total  = DataFlash.ReadLong();
+    uint32_t self   = DataFlash.ReadLong();
+    uint16_t max    = DataFlash.ReadInt();
+
+    //                           1   2   3   4    5    6    7
+    cliSerial->printf_P(PSTR("PMON, %u, %u, %s, %lu, %lu, %lu, %u\n"),
+                    (unsigned)zone,
+                    (unsigned)parent,
+                    name,
+                    (unsigned long)calls,
+                    (unsigned long)total,
+                    (unsigned long)self,
+                    (unsigned)max);
+}
+
 // Read a performance packet
 static void Log_Read_Performance()
 {
@@ -1280,6 +1416,18 @@ static int16_t Log_Read_Process(int16_t start_page, int16_t end_page)
 
                     case LOG_ERROR_MSG:
                         Log_Read_Error();
+                        break;
+
+                    case LOG_PERFMON_MSG:
+                        Log_Read_PerfMon();
+                        break;
+
+                    case LOG_LOOP_HISTOGRAM_MSG:
+                        Log_Read_Loop_Histogram();
+                        break;
+
+                    case LOG_MEMORY_MSG:
+                        Log_Read_Memory();
                         break;
 				}
 				break;
@@ -1344,6 +1492,12 @@ static void Log_Write_Motors() {
 }
 static void Log_Write_Performance() {
 }
+static void Log_Write_PerfMon() {
+}
+static void Log_Write_Loop_Histograms() {
+}
+static void Log_Write_Memory() {
+}
 static void Log_Write_PID(int8_t pid_id, int32_t error, int32_t p, int32_t i, int32_t d, int32_t output, float gain) {
 }
 static void Log_Write_DMP() {
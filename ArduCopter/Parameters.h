@@ -77,7 +77,10 @@ public:
         k_param_throttle_accel_enabled,
         k_param_yaw_override_behaviour,
         k_param_acro_trainer_enabled,
-        k_param_pilot_velocity_z_max,   // 28
+        k_param_pilot_velocity_z_max,
+        k_param_fast_boot,              // 29
+        k_param_terrain,
+        k_param_gps_rate,
 
         // 65: AP_Limits Library
         k_param_limits = 65,
@@ -265,6 +268,7 @@ public:
 
     AP_Int8         compass_enabled;
     AP_Int8         optflow_enabled;
+    AP_Int8         gps_rate;                   // navigation rate to ask the gps for, in Hz
     AP_Float        low_voltage;
     AP_Int8         super_simple;
     AP_Int16        rtl_alt_final;
@@ -129,6 +129,13 @@ const AP_Param::Info var_info[] PROGMEM = {
     // @User: Standard
     GSCALAR(optflow_enabled,        "FLOW_ENABLE",  DISABLED),
 
+    // @Param: GPS_RATE
+    // @DisplayName: GPS navigation rate
+    // @Description: The rate the GPS is asked to calculate positions at. Only uBlox and MTK 1.9 GPSs can be set to 10Hz, others stay at their own rate. Takes effect after a reboot
+    // @Values: 5:5Hz,10:10Hz
+    // @User: Advanced
+    GSCALAR(gps_rate,               "GPS_RATE",     GPS_RATE),
+
     // @Param: LOW_VOLT
     // @DisplayName: Low Voltage
     // @Description: Set this to the voltage you want to represent low voltage
@@ -998,12 +1005,24 @@ const AP_Param::Info var_info[] PROGMEM = {
     GOBJECT(camera_mount2,           "MNT2_",       AP_Mount),
 #endif
 
-#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
     GOBJECT(sitl, "SIM_", SITL),
 #endif
 
     GOBJECT(barometer, "GND_", AP_Baro),
 
+#if FAST_BOOT == ENABLED
+    // @Group: FBOOT_
+    // @Path: ../libraries/AP_FastBoot/AP_FastBoot.cpp
+    GOBJECT(fast_boot, "FBOOT_", AP_FastBoot),
+#endif
+
+#if TERRAIN == ENABLED
+    // @Group: TERRAIN_
+    // @Path: ../libraries/AP_Terrain/AP_Terrain.cpp
+    GOBJECT(terrain, "TERRAIN_", AP_Terrain),
+#endif
+
 #if AP_LIMITS == ENABLED
     //@Group: LIM_
     //@Path: ../libraries/AP_Limits/AP_Limits.cpp,../libraries/AP_Limits/AP_Limit_GPSLock.cpp,../libraries/AP_Limits/AP_Limit_Geofence.cpp,../libraries/AP_Limits/AP_Limit_Altitude.cpp,../libraries/AP_Limits/AP_Limit_Module.cpp
@@ -31,25 +31,11 @@ static struct Location get_cmd_with_index(int i)
 
     }else{
         // we can load a command, we don't process it yet
-        // read WP position
-        uint16_t mem = (WP_START_BYTE) + (i * WP_SIZE);
-
-        temp.id = hal.storage->read_byte(mem);
-
-        mem++;
-        temp.options = hal.storage->read_byte(mem);
-
-        mem++;
-        temp.p1 = hal.storage->read_byte(mem);
-
-        mem++;
-        temp.alt = hal.storage->read_dword(mem);           // alt is stored in CM! Alt is stored relative!
-
-        mem += 4;
-        temp.lat = hal.storage->read_dword(mem);         // lat is stored in decimal * 10,000,000
-
-        mem += 4;
-        temp.lng = hal.storage->read_dword(mem);         // lon is stored in decimal * 10,000,000
+        // alt is stored relative in cm, lat and lon in decimal * 10,000,000
+        if (!mission.read_cmd(i, temp)) {
+            temp.id = CMD_BLANK;
+            return temp;
+        }
     }
 
     // Add on home altitude if we are a nav command (or other command with altitude) and stored alt is relative
@@ -81,24 +67,8 @@ static void set_cmd_with_index(struct Location temp, int i)
         temp.id = MAV_CMD_NAV_WAYPOINT;
     }
 
-    uint16_t mem = WP_START_BYTE + (i * WP_SIZE);
-
-    hal.storage->write_byte(mem, temp.id);
-
-    mem++;
-    hal.storage->write_byte(mem, temp.options);
-
-    mem++;
-    hal.storage->write_byte(mem, temp.p1);
-
-    mem++;
-    hal.storage->write_dword(mem, temp.alt);     // Alt is stored in CM!
-
-    mem += 4;
-    hal.storage->write_dword(mem, temp.lat);     // Lat is stored in decimal degrees * 10^7
-
-    mem += 4;
-    hal.storage->write_dword(mem, temp.lng);     // Long is stored in decimal degrees * 10^7
+    // Alt is stored in CM, Lat and Long in decimal degrees * 10^7
+    mission.write_cmd(i, temp);
 
     // Make sure our WP_total
     if(g.command_total < (i+1))
@@ -160,8 +130,9 @@ static void set_next_WP(struct Location *wp)
 
     // this is handy for the groundstation
     // -----------------------------------
-    wp_distance             = get_distance_cm(&current_loc, &next_WP);
-    wp_bearing              = get_bearing_cd(&prev_WP, &next_WP);
+    nav_leg.set(prev_WP, next_WP);
+    wp_distance             = nav_leg.distance(current_loc) * 100;
+    wp_bearing              = nav_leg.bearing_cd();
 
     // calc the location error:
     calc_location_error(&next_WP);
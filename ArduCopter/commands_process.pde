@@ -161,6 +161,10 @@ static void execute_nav_command(void)
     // clear navigation prameters
     reset_nav_params();
 
+#if TERRAIN == ENABLED
+    terrain_adjust_alt(command_nav_queue);
+#endif
+
     // Act on the new command
     process_nav_command();
 
@@ -65,7 +65,7 @@
   #  define CONFIG_BARO          AP_BARO_MS5611
   #  define CONFIG_MS5611_SERIAL AP_BARO_MS5611_SPI
  # endif
-#elif CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#elif CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
  # define CONFIG_IMU_TYPE   CONFIG_IMU_SITL
  # define CONFIG_PUSHBUTTON DISABLED
  # define CONFIG_RELAY      DISABLED
@@ -187,7 +187,7 @@
  # define USB_MUX_PIN      23
  # define BATTERY_VOLT_PIN      1      // Battery voltage on A1
  # define BATTERY_CURR_PIN      2      // Battery current on A2
-#elif CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#elif CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
  # define A_LED_PIN        27
  # define B_LED_PIN        26
  # define C_LED_PIN        25
@@ -246,7 +246,7 @@
  #define COPTER_LED_6 AN9       // Motor LED
  #define COPTER_LED_7 AN10      // Motor LED
  #define COPTER_LED_8 AN11      // Motor LED
-#elif CONFIG_HAL_BOARD == HAL_BOARD_APM1 || CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_PX4 || CONFIG_HAL_BOARD == HAL_BOARD_SMACCM
+#elif CONFIG_HAL_BOARD == HAL_BOARD_APM1 || CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_PX4 || CONFIG_HAL_BOARD == HAL_BOARD_SMACCM
  #define COPTER_LED_1 AN8       // Motor or Aux LED
  #define COPTER_LED_2 AN9       // Motor LED
  #define COPTER_LED_3 AN10      // Motor or GPS LED
@@ -332,6 +332,9 @@
  # undef GPS_PROTOCOL
  # define GPS_PROTOCOL GPS_PROTOCOL_NONE
 
+ #undef GPS2
+ #define GPS2 DISABLED
+
  #undef CONFIG_SONAR
  #define CONFIG_SONAR DISABLED
 #endif
@@ -344,6 +347,17 @@
  # define GPS_PROTOCOL           GPS_PROTOCOL_AUTO
 #endif
 
+// the navigation rate to ask the GPS for, 5 or 10Hz
+#ifndef GPS_RATE
+ # define GPS_RATE               5
+#endif
+
+// a second GPS on uartC, blended with the first. uartC is then no
+// longer used for telemetry
+#ifndef GPS2
+ # define GPS2                   DISABLED
+#endif
+
 
 #ifndef MAV_SYSTEM_ID
  # define MAV_SYSTEM_ID          1
@@ -1212,4 +1226,61 @@
  # define INERTIAL_NAV_Z ENABLED
 #endif
 
+// time the main loop code with AP_PerfMon. The results are logged with
+// the performance messages and sent over MAVLink as DEBUG_VECT messages.
+// On SITL the first PERFMON_TRACE_EVENTS calls are also written to
+// perfmon_trace.json
+#ifndef PERFMON
+ # define PERFMON DISABLED
+#endif
+#ifndef PERFMON_TRACE_EVENTS
+ # define PERFMON_TRACE_EVENTS 100000   // calls written to the SITL trace file
+#endif
+#if PERFMON == ENABLED
+ # define PERFMON_ZONE(name) AP_PERFMON_REGISTER_NAME(name)
+#else
+ # define PERFMON_ZONE(name)
+#endif
+
+// keep a histogram of the time each scheduler task takes, logged and
+// sent with the loop time histograms. This needs 16 bytes of memory per
+// task, so it is off on the APM boards
+#ifndef SCHEDULER_HISTOGRAMS
+ # if CONFIG_HAL_BOARD == HAL_BOARD_APM1 || CONFIG_HAL_BOARD == HAL_BOARD_APM2
+  # define SCHEDULER_HISTOGRAMS DISABLED
+ # else
+  # define SCHEDULER_HISTOGRAMS ENABLED
+ # endif
+#endif
+
+// restore the last validated gyro offsets, ground pressure and attitude
+// at boot instead of calibrating, see AP_FastBoot. The FBOOT_ENABLE
+// parameter turns it on, by default only in SITL
+#ifndef FAST_BOOT
+ # if CONFIG_HAL_BOARD == HAL_BOARD_APM1 || CONFIG_HAL_BOARD == HAL_BOARD_APM2
+  # define FAST_BOOT DISABLED
+ # else
+  # define FAST_BOOT ENABLED
+ # endif
+#endif
+
+// the fast boot record is kept below the fence points, and takes the
+// space from the waypoints
+#if FAST_BOOT == ENABLED
+ # define FAST_BOOT_STORAGE_SIZE AP_FASTBOOT_STORAGE_SIZE
+#else
+ # define FAST_BOOT_STORAGE_SIZE 0
+#endif
+
+// terrain heights for waypoints above the terrain and the AP_Limits
+// terrain clearance, see AP_Terrain. The tiles are kept in files, so
+// only on the boards with a filesystem
+#ifndef TERRAIN
+ # if CONFIG_HAL_BOARD == HAL_BOARD_APM1 || CONFIG_HAL_BOARD == HAL_BOARD_APM2
+  # define TERRAIN DISABLED
+ # else
+  # define TERRAIN ENABLED
+ # endif
+#endif
+
 #endif // __ARDUCOPTER_CONFIG_H__
@@ -216,10 +216,15 @@
 #define WP_OPTION_YAW                           4
 #define WP_OPTION_ALT_REQUIRED                  8
 #define WP_OPTION_RELATIVE                      16
-//#define WP_OPTION_					32
+#define WP_OPTION_TERRAIN                       32
 //#define WP_OPTION_					64
 #define WP_OPTION_NEXT_CMD                      128
 
+// MAVLink frame of mission items with the altitude above the terrain at
+// the waypoint, stored with WP_OPTION_TERRAIN. This MAVLink version has
+// no such frame, so it is given the next free number
+#define MAV_FRAME_GLOBAL_TERRAIN_ALT            10
+
 // RTL state
 #define RTL_STATE_INITIAL_CLIMB     0
 #define RTL_STATE_RETURNING_HOME    1
@@ -258,6 +263,8 @@ enum ap_message {
     MSG_AHRS,
     MSG_SIMSTATE,
     MSG_HWSTATUS,
+    MSG_PERFMON,
+    MSG_LOOP_HISTOGRAM,
     MSG_RETRY_DEFERRED // this must be last
 };
 
@@ -290,6 +297,9 @@ enum gcs_severity {
 #define LOG_INAV_MSG                    0x11
 #define LOG_CAMERA_MSG                  0x12
 #define LOG_ERROR_MSG                   0x13
+#define LOG_PERFMON_MSG                 0x14
+#define LOG_LOOP_HISTOGRAM_MSG          0x15
+#define LOG_MEMORY_MSG                  0x16
 #define LOG_INDEX_MSG                   0xF0
 #define MAX_NUM_LOGS                    50
 
@@ -405,7 +415,10 @@ enum gcs_severity {
 #define FENCE_WP_SIZE sizeof(Vector2l)
 #define FENCE_START_BYTE (EEPROM_MAX_ADDR-(MAX_FENCEPOINTS*FENCE_WP_SIZE))
 
-#define MAX_WAYPOINTS  ((FENCE_START_BYTE - WP_START_BYTE) / WP_SIZE) - 1 // -
+// the fast boot calibration is stored just below the fence points
+#define FAST_BOOT_START_BYTE (FENCE_START_BYTE-FAST_BOOT_STORAGE_SIZE)
+
+#define MAX_WAYPOINTS  ((FAST_BOOT_START_BYTE - WP_START_BYTE) / WP_SIZE) - 1 // -
                                                                           // 1
                                                                           // to
                                                                           // be
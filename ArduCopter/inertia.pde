@@ -3,6 +3,8 @@
 // read_inertia - read inertia in from accelerometers
 static void read_inertia()
 {
+    PERFMON_ZONE("inertia")
+
 #if INERTIAL_NAV_XY == ENABLED || INERTIAL_NAV_Z == ENABLED
     static uint8_t log_counter_inav = 0;
 
@@ -107,7 +107,7 @@ static void init_arm_motors()
     failsafe_disable();
 
     //cliSerial->printf("\nARM\n");
-#if HIL_MODE != HIL_MODE_DISABLED || CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if HIL_MODE != HIL_MODE_DISABLED || CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
     gcs_send_text_P(SEVERITY_HIGH, PSTR("ARMING MOTORS"));
 #endif
 
@@ -173,7 +173,7 @@ static void init_arm_motors()
 
 static void init_disarm_motors()
 {
-#if HIL_MODE != HIL_MODE_DISABLED || CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if HIL_MODE != HIL_MODE_DISABLED || CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
     gcs_send_text_P(SEVERITY_HIGH, PSTR("DISARMING MOTORS"));
 #endif
 
@@ -213,6 +213,8 @@ static void init_disarm_motors()
 static void
 set_servos_4()
 {
+    PERFMON_ZONE("servos")
+
 #if FRAME_CONFIG == TRI_FRAME
     // To-Do: implement improved stability patch for tri so that we do not need to limit throttle input to motors
     g.rc_3.servo_out = min(g.rc_3.servo_out, 800);
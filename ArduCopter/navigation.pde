@@ -5,15 +5,19 @@ static void update_navigation()
 {
     static uint32_t nav_last_gps_update = 0;    // the system time of the last gps update
     static uint32_t nav_last_gps_time = 0;      // the time according to the gps
+    static uint32_t nav_last_fix_time = 0;      // the system time the last gps fix was taken
     bool pos_updated = false;
     bool log_output = false;
 
     // check for new gps data
     if( g_gps->fix && g_gps->time != nav_last_gps_time ) {
 
-        // used to calculate speed in X and Y, iterms
+        // used to calculate speed in X and Y, iterms. The fix times come
+        // from the gps timestamps, so at 5 or 10hz the speed is not thrown
+        // off by how late in the main loop each fix was read
         // ------------------------------------------
-        dTnav = (float)(millis() - nav_last_gps_update)/ 1000.0;
+        dTnav = (float)(g_gps->last_fix_time - nav_last_fix_time)/ 1000.0;
+        nav_last_fix_time = g_gps->last_fix_time;
         nav_last_gps_update = millis();
 
         // prevent runup from bad GPS
@@ -148,14 +152,20 @@ static void calc_velocity_and_position(){
 //****************************************************************
 static void calc_distance_and_bearing()
 {
+    // next_WP is moved without a new leg being started when loitering
+    // and circling. The leg then keeps its direction
+    if (!nav_leg.ends_at(next_WP)) {
+        nav_leg.set_destination(next_WP);
+    }
+
     // waypoint distance from plane in cm
     // ---------------------------------------
-    wp_distance     = get_distance_cm(&current_loc, &next_WP);
+    wp_distance     = nav_leg.distance(current_loc) * 100;
     home_distance   = get_distance_cm(&current_loc, &home);
 
     // wp_bearing is bearing to next waypoint
     // --------------------------------------------
-    wp_bearing          = get_bearing_cd(&current_loc, &next_WP);
+    wp_bearing          = nav_leg.bearing_cd(current_loc);
     home_bearing        = get_bearing_cd(&current_loc, &home);
 
     // bearing to target (used when yaw_mode = YAW_LOOK_AT_LOCATION)
@@ -652,8 +662,7 @@ static void update_crosstrack(void)
     if (wp_distance >= (g.crosstrack_min_distance * 100) &&
         abs(wrap_180(wp_bearing - original_wp_bearing)) < 4500) {
 
-	    float temp = (wp_bearing - original_wp_bearing) * RADX100;
-    	crosstrack_error = sin(temp) * wp_distance;          // Meters we are off track line
+    	crosstrack_error = nav_leg.crosstrack(current_loc) * 100;          // cm we are off track line
     }else{
         // fade out crosstrack
         crosstrack_error >>= 1;
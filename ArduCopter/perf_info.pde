@@ -2,21 +2,36 @@
 //
 //  high level performance monitoring
 //
-//  we measure the main loop time
+//  we measure the main loop time, keeping histograms of the time
+//  between fast loops and of the time fast_loop() takes, and how far
+//  the time between fast loops is from 10ms
 //
 
 #define PERF_INFO_OVERTIME_THRESHOLD_MICROS 10500
+#define PERF_INFO_LOOP_PERIOD_MICROS 10000
 
 uint16_t perf_info_loop_count;
 uint32_t perf_info_max_time;
 uint16_t perf_info_long_running;
 
+// bucket 0 is below 1024us, then each power of two is split in four, so
+// there are buckets from 8192, 10240 and 12288us
+static LogHistogram<24,10,2> perf_info_period_hist;
+static LogHistogram<24,10,2> perf_info_time_hist;
+
+uint16_t perf_info_max_jitter;
+uint32_t perf_info_total_jitter;
+
 // perf_info_reset - reset all records of loop time to zero
 void perf_info_reset()
 {
     perf_info_loop_count = 0;
     perf_info_max_time = 0;
     perf_info_long_running = 0;
+    perf_info_period_hist.clear();
+    perf_info_time_hist.clear();
+    perf_info_max_jitter = 0;
+    perf_info_total_jitter = 0;
 }
 
 // perf_info_check_loop_time - check latest loop time vs min, max and overtime threshold
@@ -29,6 +44,27 @@ void perf_info_check_loop_time(uint32_t time_in_micros)
     if( time_in_micros > PERF_INFO_OVERTIME_THRESHOLD_MICROS ) {
         perf_info_long_running++;
     }
+    perf_info_period_hist.add(time_in_micros);
+
+    uint32_t jitter;
+    if (time_in_micros > PERF_INFO_LOOP_PERIOD_MICROS) {
+        jitter = time_in_micros - PERF_INFO_LOOP_PERIOD_MICROS;
+    } else {
+        jitter = PERF_INFO_LOOP_PERIOD_MICROS - time_in_micros;
+    }
+    if (jitter > 0xFFFF) {
+        jitter = 0xFFFF;
+    }
+    if (jitter > perf_info_max_jitter) {
+        perf_info_max_jitter = jitter;
+    }
+    perf_info_total_jitter += jitter;
+}
+
+// perf_info_check_fast_loop_time - record the time fast_loop() took
+void perf_info_check_fast_loop_time(uint32_t time_in_micros)
+{
+    perf_info_time_hist.add(time_in_micros);
 }
 
 // perf_info_get_long_running_percentage - get number of long running loops as a percentage of the total number of loops
@@ -47,4 +83,52 @@ uint32_t perf_info_get_max_time()
 uint16_t perf_info_get_num_long_running()
 {
     return perf_info_long_running;
-}
\ No newline at end of file
+}
+
+// perf_info_get_max_jitter - largest difference of the time between
+// loops from 10ms (in microseconds)
+uint16_t perf_info_get_max_jitter()
+{
+    return perf_info_max_jitter;
+}
+
+// perf_info_get_mean_jitter - average difference of the time between
+// loops from 10ms (in microseconds)
+uint16_t perf_info_get_mean_jitter()
+{
+    if (perf_info_loop_count == 0) {
+        return 0;
+    }
+    return perf_info_total_jitter / perf_info_loop_count;
+}
+
+// perf_info_pack_histogram - pack a timing histogram into buf with
+// LogHistogram::pack() for logging or sending. id 0 is the time between
+// loops, followed by the max and mean jitter as 16 bit little endian
+// values. id 1 is the time fast_loop() takes, and ids from 2 are the
+// scheduler tasks if their histograms are enabled. Returns 0 when there
+// is no histogram with that id
+uint8_t perf_info_pack_histogram(uint8_t id, uint8_t *buf, uint8_t buflen)
+{
+    if (id == 0) {
+        uint8_t len = perf_info_period_hist.pack(id, buf, buflen);
+        if (len == 0 || len + 4 > buflen) {
+            return 0;
+        }
+        uint16_t max_jitter = perf_info_get_max_jitter();
+        uint16_t mean_jitter = perf_info_get_mean_jitter();
+        buf[len++] = max_jitter & 0xFF;
+        buf[len++] = max_jitter >> 8;
+        buf[len++] = mean_jitter & 0xFF;
+        buf[len++] = mean_jitter >> 8;
+        return len;
+    }
+    if (id == 1) {
+        return perf_info_time_hist.pack(id, buf, buflen);
+    }
+    uint8_t task = id - 2;
+    if (task >= scheduler.num_tasks() || scheduler.task_histogram(task) == NULL) {
+        return 0;
+    }
+    return scheduler.task_histogram(task)->pack(id, buf, buflen);
+}
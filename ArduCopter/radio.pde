@@ -126,6 +126,8 @@ void output_min()
 #define RADIO_FS_TIMEOUT_MS 2000       // 2 seconds
 static void read_radio()
 {
+    PERFMON_ZONE("radio")
+
     static uint32_t last_update = 0;
     if (hal.rcin->valid() > 0) {
         last_update = millis();
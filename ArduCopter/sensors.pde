@@ -19,6 +19,14 @@ static void init_sonar(void)
 
 static void init_barometer(void)
 {
+#if FAST_BOOT == ENABLED
+    if (fast_boot.active()) {
+        // the ground pressure was restored at boot, and fast_boot
+        // follows it while we are disarmed
+        ahrs.set_barometer(&barometer);
+        return;
+    }
+#endif
     barometer.calibrate();
     ahrs.set_barometer(&barometer);
     gcs_send_text_P(SEVERITY_LOW, PSTR("barometer calibration complete"));
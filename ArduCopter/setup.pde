@@ -993,6 +993,7 @@ static void zero_eeprom(void)
     for (uint16_t i = 0; i < EEPROM_MAX_ADDR; i++) {
         hal.storage->write_byte(i, 0);
     }
+    mission.clear_cache();
 
     cliSerial->printf_P(PSTR("done\n"));
 }
@@ -161,7 +161,7 @@ static void init_ardupilot()
         // baud rate
         hal.uartA->begin(map_baudrate(g.serial3_baud, SERIAL3_BAUD));
     }
-#else
+#elif GPS2 != ENABLED
     // we have a 2nd serial port for telemetry
     hal.uartC->begin(map_baudrate(g.serial3_baud, SERIAL3_BAUD), 128, 256);
     gcs3.init(hal.uartC);
@@ -209,9 +209,23 @@ static void init_ardupilot()
 #endif // HIL_MODE
 
     // Do GPS init
+#if GPS2 == ENABLED
+    // each receiver on its own port, with the blend of the two as the
+    // GPS the rest of the code sees
+    g_gps1 = &g_gps_driver;
+    g_gps1->set_rate(g.gps_rate);
+    g_gps1->init(hal.uartB, GPS::GPS_ENGINE_AIRBORNE_1G);
+    g_gps2 = &g_gps2_driver;
+    g_gps2->set_rate(g.gps_rate);
+    g_gps2->init(hal.uartC, GPS::GPS_ENGINE_AIRBORNE_1G);
+    g_gps = &g_gps_blend;
+    g_gps->init(NULL, GPS::GPS_ENGINE_AIRBORNE_1G);
+#else
     g_gps = &g_gps_driver;
     // GPS Initialization
+    g_gps->set_rate(g.gps_rate);
     g_gps->init(hal.uartB, GPS::GPS_ENGINE_AIRBORNE_1G);
+#endif
 
     if(g.compass_enabled)
         init_compass();
@@ -245,12 +259,20 @@ static void init_ardupilot()
 #else
     const prog_char_t *msg = PSTR("\nPress ENTER 3 times to start interactive setup\n");
     cliSerial->println_P(msg);
-#if USB_MUX_PIN == 0
+#if USB_MUX_PIN == 0 && GPS2 != ENABLED
     hal.uartC->println_P(msg);
 #endif
 #endif // CLI_ENABLED
 
 #if HIL_MODE != HIL_MODE_ATTITUDE
+ #if FAST_BOOT == ENABLED
+    // restore the last validated calibration, so init_barometer() and
+    // startup_ground() can skip theirs
+    if (fast_boot.restore()) {
+        gcs_send_text_P(SEVERITY_LOW, PSTR("fast boot: calibration restored"));
+    }
+ #endif
+
     // read Baro pressure at ground
     //-----------------------------
     init_barometer();
@@ -305,6 +327,9 @@ static void init_ap_limits() {
     limits.modules_add(&gpslock_limit);
     limits.modules_add(&geofence_limit);
     limits.modules_add(&altitude_limit);
+ #if TERRAIN == ENABLED
+    altitude_limit.set_terrain(&terrain);
+ #endif
 
 
     if (limits.debug())  {
@@ -329,7 +354,14 @@ static void startup_ground(void)
 
     // Warm up and read Gyro offsets
     // -----------------------------
-    ins.init(AP_InertialSensor::COLD_START,
+    AP_InertialSensor::Start_style style = AP_InertialSensor::COLD_START;
+#if FAST_BOOT == ENABLED
+    // the gyro offsets were restored, and are refined while disarmed
+    if (fast_boot.active()) {
+        style = AP_InertialSensor::WARM_START;
+    }
+#endif
+    ins.init(style,
              ins_sample_rate,
              flash_leds);
  #if CLI_ENABLED == ENABLED
@@ -357,6 +389,15 @@ static void startup_ground(void)
     reset_I_all();
 }
 
+#if FAST_BOOT == ENABLED
+// fast_boot_update - refine the calibration and save it once validated.
+// Called at 10Hz
+static void fast_boot_update()
+{
+    fast_boot.update(!motors.armed());
+}
+#endif
+
 // set_mode - change flight mode and perform any necessary initialisation
 static void set_mode(uint8_t mode)
 {
@@ -0,0 +1,60 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+#if TERRAIN == ENABLED
+
+// terrain_update - read the terrain tiles around the vehicle and the
+// next waypoint and ask the ground station for the ones we do not have.
+// Called at 1Hz. This is the only place the tiles are read from storage
+static void terrain_update()
+{
+    if (ap.home_is_set) {
+        terrain.set_home(home);
+    }
+
+    // look up the next waypoint above the terrain, so that its tile is
+    // read before terrain_adjust_alt() needs it
+    if (g.command_total > 1) {
+        int16_t index = find_next_nav_index(command_nav_index + 1);
+        if (index != -1) {
+            struct Location next_cmd = get_cmd_with_index(index);
+            float terrain_alt;
+            if ((next_cmd.options & WP_OPTION_TERRAIN) &&
+                (next_cmd.lat != 0 || next_cmd.lng != 0)) {
+                terrain.height_amsl(next_cmd, terrain_alt);
+            }
+        }
+    }
+    if (g_gps != NULL && g_gps->status() == GPS::GPS_OK) {
+        terrain.update(current_loc);
+    }
+
+    uint16_t lat_index, lng_index;
+    if (terrain.missing_tile(lat_index, lng_index)) {
+        gcs_send_terrain_request(lat_index, lng_index);
+    }
+}
+
+// terrain_adjust_alt - make the altitude of a command with
+// WP_OPTION_TERRAIN, which is above the terrain at the waypoint,
+// relative to home like the other commands. Only the cached tiles are
+// used, as this is on the navigation path. Without terrain data there
+// the altitude is used as it is, relative to home
+static void terrain_adjust_alt(struct Location &cmd)
+{
+    if (!(cmd.options & WP_OPTION_TERRAIN)) {
+        return;
+    }
+    cmd.options &= ~WP_OPTION_TERRAIN;
+
+    // a command without a position is flown where the vehicle is
+    const struct Location &loc = (cmd.lat == 0 && cmd.lng == 0) ? current_loc : cmd;
+
+    float terrain_alt;
+    if (terrain.height_relative_home(loc, terrain_alt)) {
+        cmd.alt += terrain_alt * 100;
+    } else {
+        gcs_send_text_P(SEVERITY_HIGH, PSTR("No terrain data, alt above home"));
+    }
+}
+
+#endif // TERRAIN == ENABLED
@@ -39,6 +39,7 @@
 #include <AP_RangeFinder.h>     // Range finder library
 #include <Filter.h>                     // Filter library
 #include <AP_Buffer.h>      // APM FIFO Buffer
+#include <AP_Scheduler.h>   // main loop scheduler
 #include <AP_Relay.h>       // APM relay
 #include <AP_Camera.h>          // Photo or video camera
 #include <AP_Airspeed.h>
@@ -49,6 +50,8 @@
 #include <GCS_MAVLink.h>    // MAVLink GCS definitions
 #include <AP_Mount.h>           // Camera/Antenna mount
 #include <AP_Declination.h> // ArduPilot Mega Declination Helper Library
+#include <AP_Mission.h>     // mission command storage
+#include <AP_Fence.h>       // geofence zones
 #include <DataFlash.h>
 #include <SITL.h>
 
@@ -72,6 +75,7 @@
 #include <AP_HAL_AVR_SITL.h>
 #include <AP_HAL_PX4.h>
 #include <AP_HAL_Empty.h>
+#include <AP_HAL_Static.h>
 
 AP_HAL::BetterStream* cliSerial;
 
@@ -370,6 +374,10 @@ static int32_t target_bearing_cd;
 // deg * 100 : 0 to 360
 static int32_t crosstrack_bearing_cd;
 
+// The leg from prev_WP to next_WP, for distance, bearing and crosstrack
+// to next_WP without redoing the trigonometry each update
+static NavLeg nav_leg;
+
 // Direction held during phases of takeoff and landing
 // deg * 100 dir of plane,  A value of -1 indicates the course has not been set/is not in use
 static int32_t hold_course                   = -1;              // deg * 100 dir of plane
@@ -565,6 +573,8 @@ static struct   Location prev_WP;
 static struct   Location current_loc;
 // The location of the current/active waypoint.  Used for altitude ramp, track following and loiter calculations.
 static struct   Location next_WP;
+// The mission commands in EEPROM, with a cache of the ones in use
+static AP_Mission mission(WP_START_BYTE, MAX_WAYPOINTS + 1);
 // The location of the active waypoint in Guided mode.
 static struct   Location guided_WP;
 // The location structure information from the Nav command being processed
@@ -590,6 +600,8 @@ static float G_Dt                                               = 0.02;
 ////////////////////////////////////////////////////////////////////////////////
 // Performance monitoring
 ////////////////////////////////////////////////////////////////////////////////
+// Runs all the regular tasks apart from the fast_loop()
+static AP_Scheduler scheduler;
 // Timer used to accrue data and trigger recording of the performanc monitoring log message
 static int32_t perf_mon_timer;
 // The maximum main loop execution time recorded in the current performance monitoring interval
@@ -607,6 +619,9 @@ static int16_t pmTest1 = 0;
 // Time in miliseconds of start of main control loop.  Milliseconds
 static uint32_t fast_loopTimer_ms;
 
+// Time in microseconds of start of main control loop
+static uint32_t fast_loopTimer_us;
+
 // Time Stamp when fast loop was complete.  Milliseconds
 static uint32_t fast_loopTimeStamp_ms;
 
@@ -616,20 +631,16 @@ static uint8_t delta_ms_fast_loop;
 // Counter of main loop executions.  Used for performance monitoring and failsafe processing
 static uint16_t mainLoop_count;
 
-// Time in miliseconds of start of medium control loop.  Milliseconds
+// Time in miliseconds of the last battery reading.  Milliseconds
 static uint32_t medium_loopTimer_ms;
 
-// Counters for branching from main control loop to slower loops
+// Counter for branching from main control loop to slower loops
 static uint8_t medium_loopCounter;
-// Number of milliseconds used in last medium loop cycle
+// Number of milliseconds between the last two battery readings
 static uint8_t delta_ms_medium_loop;
 
-// Counters for branching from medium control loop to slower loops
+// Counter for branching from medium control loop to slower loops
 static uint8_t slow_loopCounter;
-// Counter to trigger execution of very low rate processes
-static uint8_t superslow_loopCounter;
-// Counter to trigger execution of 1 Hz processes
-static uint8_t counter_one_herz;
 
 // % MCU cycles used
 static float load;
@@ -660,6 +671,28 @@ AP_Mount camera_mount2(&current_loc, g_gps, &ahrs, 1);
 // setup the var_info table
 AP_Param param_loader(var_info, WP_START_BYTE);
 
+/*
+  scheduler table - all regular tasks apart from the fast_loop() and
+  medium_loop() should be listed here, along with how often they should
+  be called (in 20ms units) and the maximum time they are expected to
+  take (in microseconds). They are run in the time left over after the
+  fast loop, so GPS, navigation and failsafes are not in here
+ */
+static const AP_Scheduler::Task scheduler_tasks[] PROGMEM = {
+    { update_mount,           1,    500 },
+    { update_compass,         5,   1200 },
+    { update_airspeed,        5,   1200 },
+    { read_receiver_rssi,     5,   1000 },
+    { update_logging,         5,   1500 },
+    { update_battery,         5,   1000 },
+    { update_aux,            15,   1000 },
+    { update_events,         15,   1500 },
+    { check_usb_mux,         15,    300 },
+    { one_second_loop,       50,   1500 },
+    { compass_save,        3000,   2500 },
+    { perf_update,         1000,   1500 }
+};
+
 void setup() {
     cliSerial = hal.console;
 
@@ -682,6 +715,10 @@ void setup() {
     airspeed.init(pitot_analog_source);
     memcheck_init();
     init_ardupilot();
+
+    // initialise the main loop scheduler, with the 10Hz tasks spread
+    // over the ticks
+    scheduler.init(&scheduler_tasks[0], sizeof(scheduler_tasks)/sizeof(scheduler_tasks[0]), true);
 }
 
 void loop()
@@ -693,6 +730,7 @@ void loop()
         load                = (float)(fast_loopTimeStamp_ms - fast_loopTimer_ms)/delta_ms_fast_loop;
         G_Dt                = (float)delta_ms_fast_loop / 1000.f;
         fast_loopTimer_ms   = millis();
+        fast_loopTimer_us   = micros();
 
         mainLoop_count++;
 
@@ -704,29 +742,30 @@ void loop()
         // -----------------------
         medium_loop();
 
-        counter_one_herz++;
-        if(counter_one_herz == 50) {
-            one_second_loop();
-            counter_one_herz = 0;
-        }
-
-        if (millis() - perf_mon_timer > 20000) {
-            if (mainLoop_count != 0) {
-                if (g.log_bitmask & MASK_LOG_PM)
-                    Log_Write_Performance();
-                    resetPerfData();
-            }
-        }
+        // tell the scheduler one tick has passed
+        scheduler.tick();
 
         fast_loopTimeStamp_ms = millis();
-    } else if (millis() - fast_loopTimeStamp_ms < 19) {
-        // less than 19ms has passed. We have at least one millisecond
-        // of free time. The most useful thing to do with that time is
-        // to accumulate some sensor readings, specifically the
-        // compass, which is often very noisy but is not interrupt
-        // driven, so it can't accumulate readings by itself
-        if (g.compass_enabled) {
-            compass.accumulate();
+    } else {
+        // run the scheduled tasks in the time left before the next
+        // fast loop is due
+        uint16_t time_to_next_loop;
+        uint32_t dt = micros() - fast_loopTimer_us;
+        if (dt > 20000) {
+            time_to_next_loop = 0;
+        } else {
+            time_to_next_loop = 20000 - dt;
+        }
+        scheduler.run(time_to_next_loop);
+
+        if (millis() - fast_loopTimeStamp_ms < 19) {
+            // less than 19ms has passed. We have at least one
+            // millisecond of free time. The most useful thing to do
+            // with that time is to accumulate some sensor readings,
+            // specifically the compass, which is often very noisy but
+            // is not interrupt driven, so it can't accumulate readings
+            // by itself
+            compass_accumulate();
         }
     }
 }
@@ -791,185 +830,183 @@ static void fast_loop()
     gcs_data_stream_send();
 }
 
+/*
+  the 10Hz work that navigation and the failsafes depend on. It is run
+  straight after the fast loop, one step per tick, so it does not wait
+  for the scheduler to find spare time
+ */
 static void medium_loop()
 {
-#if MOUNT == ENABLED
-    camera_mount.update_mount_position();
-#endif
-
-#if MOUNT2 == ENABLED
-    camera_mount2.update_mount_position();
-#endif
-
-#if CAMERA == ENABLED
-    camera.trigger_pic_cleanup();
-#endif
-
-    // This is the start of the medium (10 Hz) loop pieces
-    // -----------------------------------------
     switch(medium_loopCounter) {
-
-    // This case deals with the GPS
-    //-------------------------------
     case 0:
-        medium_loopCounter++;
         update_GPS();
-        calc_gndspeed_undershoot();
-
-#if HIL_MODE != HIL_MODE_ATTITUDE
-        if (g.compass_enabled && compass.read()) {
-            ahrs.set_compass(&compass);
-            compass.null_offsets();
-        } else {
-            ahrs.set_compass(NULL);
-        }
-#endif
-
         break;
 
-    // This case performs some navigation computations
-    //------------------------------------------------
     case 1:
-        medium_loopCounter++;
-
         // Read 6-position switch on radio
-        // -------------------------------
         read_control_switch();
 
         // calculate the plane's desired bearing
-        // -------------------------------------
         navigate();
-
         break;
 
-    // command processing
-    //------------------------------
     case 2:
-        medium_loopCounter++;
-
-        // Read Airspeed
-        // -------------
-#if HIL_MODE != HIL_MODE_ATTITUDE
-        if (airspeed.enabled()) {
-            read_airspeed();
-        }
-#endif
-
-        read_receiver_rssi();
-
-        // Read altitude from sensors
-        // ------------------
+        // Read altitude from sensors and perform next command
         update_alt();
-
-        // altitude smoothing
-        // ------------------
-        if (control_mode != FLY_BY_WIRE_B)
-            calc_altitude_error();
-
-        // perform next command
-        // --------------------
         update_commands();
         break;
 
-    // This case deals with sending high rate telemetry
-    //-------------------------------------------------
     case 3:
-        medium_loopCounter++;
-
-        if ((g.log_bitmask & MASK_LOG_ATTITUDE_MED) && !(g.log_bitmask & MASK_LOG_ATTITUDE_FAST))
-            Log_Write_Attitude(ahrs.roll_sensor, ahrs.pitch_sensor, ahrs.yaw_sensor);
-
-        if (g.log_bitmask & MASK_LOG_CTUN)
-            Log_Write_Control_Tuning();
-
-        if (g.log_bitmask & MASK_LOG_NTUN)
-            Log_Write_Nav_Tuning();
-
-        if (g.log_bitmask & MASK_LOG_GPS)
-            Log_Write_GPS(g_gps->time, current_loc.lat, current_loc.lng, g_gps->altitude, current_loc.alt, (long) g_gps->ground_speed, g_gps->ground_course, g_gps->fix, g_gps->num_sats);
+#if OBC_FAILSAFE == ENABLED
+        obc_fs_check();
+#endif
         break;
 
-    // This case controls the slow loop
-    //---------------------------------
     case 4:
+        // the 3.3Hz failsafe check
+        slow_loopCounter++;
+        if (slow_loopCounter == 3) {
+            check_long_failsafe();
+            slow_loopCounter = 0;
+        }
+        break;
+    }
+
+    medium_loopCounter++;
+    if (medium_loopCounter == 5) {
         medium_loopCounter = 0;
-        delta_ms_medium_loop    = millis() - medium_loopTimer_ms;
-        medium_loopTimer_ms     = millis();
+    }
+}
 
-        if (g.battery_monitoring != 0) {
-            read_battery();
-        }
+static void update_mount(void)
+{
+#if MOUNT == ENABLED
+    camera_mount.update_mount_position();
+#endif
 
-        slow_loop();
+#if MOUNT2 == ENABLED
+    camera_mount2.update_mount_position();
+#endif
 
-#if OBC_FAILSAFE == ENABLED
-        // perform OBC failsafe checks
-        obc.check(OBC_MODE(control_mode),
-                  last_heartbeat_ms,
-                  g_gps ? g_gps->last_fix_time : 0);
+#if CAMERA == ENABLED
+    camera.trigger_pic_cleanup();
 #endif
+}
 
-        break;
+static void update_compass(void)
+{
+#if HIL_MODE != HIL_MODE_ATTITUDE
+    if (g.compass_enabled && compass.read()) {
+        ahrs.set_compass(&compass);
+        compass.null_offsets();
+    } else {
+        ahrs.set_compass(NULL);
     }
+#endif
 }
 
-static void slow_loop()
+/*
+  if the compass is enabled then try to accumulate a reading
+ */
+static void compass_accumulate(void)
+{
+    if (g.compass_enabled) {
+        compass.accumulate();
+    }
+}
+
+static void compass_save(void)
 {
-    // This is the slow (3 1/3 Hz) loop pieces
-    //----------------------------------------
-    switch (slow_loopCounter) {
-    case 0:
-        slow_loopCounter++;
-        check_long_failsafe();
-        superslow_loopCounter++;
-        if(superslow_loopCounter >=200) {                                               //	200 = Execute every minute
 #if HIL_MODE != HIL_MODE_ATTITUDE
-            if(g.compass_enabled) {
-                compass.save_offsets();
-            }
+    if (g.compass_enabled) {
+        compass.save_offsets();
+    }
 #endif
+}
 
-            superslow_loopCounter = 0;
-        }
-        break;
+static void update_airspeed(void)
+{
+#if HIL_MODE != HIL_MODE_ATTITUDE
+    if (airspeed.enabled()) {
+        read_airspeed();
+    }
+#endif
+}
 
-    case 1:
-        slow_loopCounter++;
+static void update_logging(void)
+{
+    if ((g.log_bitmask & MASK_LOG_ATTITUDE_MED) && !(g.log_bitmask & MASK_LOG_ATTITUDE_FAST))
+        Log_Write_Attitude(ahrs.roll_sensor, ahrs.pitch_sensor, ahrs.yaw_sensor);
+
+    if (g.log_bitmask & MASK_LOG_CTUN)
+        Log_Write_Control_Tuning();
 
+    if (g.log_bitmask & MASK_LOG_NTUN)
+        Log_Write_Nav_Tuning();
+
+    if (g.log_bitmask & MASK_LOG_GPS)
+        Log_Write_GPS(g_gps->time, current_loc.lat, current_loc.lng, g_gps->altitude, current_loc.alt, (long) g_gps->ground_speed, g_gps->ground_course, g_gps->fix, g_gps->num_sats);
+}
+
+static void update_battery(void)
+{
+    delta_ms_medium_loop    = millis() - medium_loopTimer_ms;
+    medium_loopTimer_ms     = millis();
+
+    if (g.battery_monitoring != 0) {
+        read_battery();
+    }
+}
+
+#if OBC_FAILSAFE == ENABLED
+static void obc_fs_check(void)
+{
+    // perform OBC failsafe checks
+    obc.check(OBC_MODE(control_mode),
+              last_heartbeat_ms,
+              g_gps ? g_gps->last_fix_time : 0);
+}
+#endif
+
+static void update_aux(void)
+{
 #if CONFIG_HAL_BOARD == HAL_BOARD_APM2
-        update_aux_servo_function(&g.rc_5, &g.rc_6, &g.rc_7, &g.rc_8, &g.rc_9, &g.rc_10, &g.rc_11);
+    update_aux_servo_function(&g.rc_5, &g.rc_6, &g.rc_7, &g.rc_8, &g.rc_9, &g.rc_10, &g.rc_11);
 #else
-        update_aux_servo_function(&g.rc_5, &g.rc_6, &g.rc_7, &g.rc_8);
+    update_aux_servo_function(&g.rc_5, &g.rc_6, &g.rc_7, &g.rc_8);
 #endif
-        enable_aux_servos();
+    enable_aux_servos();
 
 #if MOUNT == ENABLED
-        camera_mount.update_mount_type();
+    camera_mount.update_mount_type();
 #endif
 #if MOUNT2 == ENABLED
-        camera_mount2.update_mount_type();
+    camera_mount2.update_mount_type();
 #endif
-        break;
-
-    case 2:
-        slow_loopCounter = 0;
-        update_events();
-
-        mavlink_system.sysid = g.sysid_this_mav;                // This is just an ugly hack to keep mavlink_system.sysid sync'd with our parameter
-
-        check_usb_mux();
-
-        break;
-    }
 }
 
 static void one_second_loop()
 {
+    // write out any waypoints still waiting in the mission batch
+    mission.flush();
+
     if (g.log_bitmask & MASK_LOG_CUR)
         Log_Write_Current();
 
     // send a heartbeat
     gcs_send_message(MSG_HEARTBEAT);
+
+    mavlink_system.sysid = g.sysid_this_mav;                // This is just an ugly hack to keep mavlink_system.sysid sync'd with our parameter
+}
+
+static void perf_update(void)
+{
+    if (mainLoop_count != 0) {
+        if (g.log_bitmask & MASK_LOG_PM)
+            Log_Write_Performance();
+        resetPerfData();
+    }
+    scheduler.reset_stats();
 }
 
 static void update_GPS(void)
@@ -1021,6 +1058,8 @@ static void update_GPS(void)
         // see if we've breached the geo-fence
         geofence_check(false);
     }
+
+    calc_gndspeed_undershoot();
 }
 
 static void update_current_flight_mode(void)
@@ -1271,6 +1310,11 @@ static void update_alt()
 
     geofence_check(true);
 
+    // altitude smoothing
+    // ------------------
+    if (control_mode != FLY_BY_WIRE_B)
+        calc_altitude_error();
+
     // Calculate new climb rate
     //if(medium_loopCounter == 0 && slow_loopCounter == 0)
     //	add_altitude_data(millis() / 100, g_gps->altitude / 10);
@@ -45,32 +45,12 @@ static void reload_commands_airstart()
 static struct Location get_cmd_with_index_raw(int16_t i)
 {
     struct Location temp;
-    uint16_t mem;
 
     // Find out proper location in memory by using the start_byte position + the index
     // --------------------------------------------------------------------------------
-    if (i > g.command_total) {
+    if (i > g.command_total || !mission.read_cmd(i, temp)) {
         memset(&temp, 0, sizeof(temp));
         temp.id = CMD_BLANK;
-    }else{
-        // read WP position
-        mem = (WP_START_BYTE) + (i * WP_SIZE);
-        temp.id = hal.storage->read_byte(mem);
-
-        mem++;
-        temp.options = hal.storage->read_byte(mem);
-
-        mem++;
-        temp.p1 = hal.storage->read_byte(mem);
-
-        mem++;
-        temp.alt = hal.storage->read_dword(mem);
-
-        mem += 4;
-        temp.lat = hal.storage->read_dword(mem);
-
-        mem += 4;
-        temp.lng = hal.storage->read_dword(mem);
     }
 
     return temp;
@@ -100,7 +80,6 @@ static struct Location get_cmd_with_index(int16_t i)
 static void set_cmd_with_index(struct Location temp, int16_t i)
 {
     i = constrain_int16(i, 0, g.command_total.get());
-    uint16_t mem = WP_START_BYTE + (i * WP_SIZE);
 
     // Set altitude options bitmask
     // XXX What is this trying to do?
@@ -110,22 +89,7 @@ static void set_cmd_with_index(struct Location temp, int16_t i)
         temp.options = 0;
     }
 
-    hal.storage->write_byte(mem, temp.id);
-
-    mem++;
-    hal.storage->write_byte(mem, temp.options);
-
-    mem++;
-    hal.storage->write_byte(mem, temp.p1);
-
-    mem++;
-    hal.storage->write_dword(mem, temp.alt);
-
-    mem += 4;
-    hal.storage->write_dword(mem, temp.lat);
-
-    mem += 4;
-    hal.storage->write_dword(mem, temp.lng);
+    mission.write_cmd(i, temp);
 }
 
 static void decrement_cmd_index()
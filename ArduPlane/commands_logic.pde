@@ -373,7 +373,7 @@ static bool verify_nav_wp()
     }
 
     // have we flown past the waypoint?
-    if (location_passed_point(current_loc, prev_WP, next_WP)) {
+    if (nav_leg.passed(current_loc)) {
         gcs_send_text_fmt(PSTR("Passed Waypoint #%i dist %um"),
                           (unsigned)nav_command_index,
                           (unsigned)get_distance(&current_loc, &next_WP));
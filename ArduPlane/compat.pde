@@ -12,12 +12,12 @@ void mavlink_delay(uint32_t ms)
 
 uint32_t millis()
 {
-    return hal.scheduler->millis();
+    return hal_static::millis();
 }
 
 uint32_t micros()
 {
-    return hal.scheduler->micros();
+    return hal_static::micros();
 }
 
 void pinMode(uint8_t pin, uint8_t output)
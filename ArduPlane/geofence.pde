@@ -25,6 +25,8 @@ static struct geofence_state {
     uint8_t old_switch_position;
     /* point 0 is the return point */
     Vector2l boundary[MAX_FENCEPOINTS];
+    /* the zones, indexed from boundary[1] onwards */
+    AP_Fence fence;
 } *geofence_state;
 
 
@@ -99,11 +101,12 @@ static void geofence_load(void)
     }
     geofence_state->num_points = i;
 
-    if (!Polygon_complete(&geofence_state->boundary[1], geofence_state->num_points-1)) {
+    geofence_state->fence.clear();
+    if (!geofence_state->fence.add_polygon(&geofence_state->boundary[1], geofence_state->num_points-1, false)) {
         // first point and last point must be the same
         goto failed;
     }
-    if (Polygon_outside(geofence_state->boundary[0], &geofence_state->boundary[1], geofence_state->num_points-1)) {
+    if (!geofence_state->fence.inside(geofence_state->boundary[0])) {
         // return point needs to be inside the fence
         goto failed;
     }
@@ -217,7 +220,7 @@ static void geofence_check(bool altitude_check_only)
         Vector2l location;
         location.x = loc.lat;
         location.y = loc.lng;
-        outside = Polygon_outside(location, &geofence_state->boundary[1], geofence_state->num_points-1);
+        outside = !geofence_state->fence.inside(location);
         if (outside) {
             breach_type = FENCE_BREACH_BOUNDARY;
         }
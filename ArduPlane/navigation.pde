@@ -15,9 +15,15 @@ static void navigate()
         return;
     }
 
+    // next_WP can be moved without a new leg being started, for
+    // example by RTL or a loiter. The leg then keeps its direction
+    if (!nav_leg.ends_at(next_WP)) {
+        nav_leg.set_destination(next_WP);
+    }
+
     // waypoint distance from plane
     // ----------------------------
-    wp_distance = get_distance(&current_loc, &next_WP);
+    wp_distance = nav_leg.distance(current_loc);
 
     if (wp_distance < 0) {
         gcs_send_text_P(SEVERITY_HIGH,PSTR("WP error - distance < 0"));
@@ -26,7 +32,7 @@ static void navigate()
 
     // target_bearing is where we should be heading
     // --------------------------------------------
-    target_bearing_cd       = get_bearing_cd(&current_loc, &next_WP);
+    target_bearing_cd       = nav_leg.bearing_cd(current_loc);
 
     // nav_bearing will includes xtrac correction
     // ------------------------------------------
@@ -194,7 +200,7 @@ static void update_crosstrack(void)
     if (wp_totalDistance >= g.crosstrack_min_distance && 
         abs(wrap_180_cd(target_bearing_cd - crosstrack_bearing_cd)) < 4500) {
         // Meters we are off track line
-        crosstrack_error = sin(radians((target_bearing_cd - crosstrack_bearing_cd) * 0.01)) * wp_distance;               
+        crosstrack_error = nav_leg.crosstrack(current_loc);
         nav_bearing_cd += constrain_int32(crosstrack_error * g.crosstrack_gain, -g.crosstrack_entry_angle.get(), g.crosstrack_entry_angle.get());
         nav_bearing_cd = wrap_360_cd(nav_bearing_cd);
     }
@@ -203,6 +209,7 @@ static void update_crosstrack(void)
 
 static void reset_crosstrack()
 {
-    crosstrack_bearing_cd   = get_bearing_cd(&prev_WP, &next_WP);       // Used for track following
+    nav_leg.set(prev_WP, next_WP);
+    crosstrack_bearing_cd   = nav_leg.bearing_cd();       // Used for track following
 }
 
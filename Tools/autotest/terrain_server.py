@@ -0,0 +1,83 @@
+#!/usr/bin/env python
+'''
+stand in for a terrain tile server. Answers the terrain tile requests
+of a vehicle running AP_Terrain with tiles of made up hills, see
+libraries/AP_Terrain/AP_Terrain.h for the tile format
+
+  terrain_server.py --master udp:127.0.0.1:14551
+'''
+
+import struct, time
+from math import sin, cos, radians
+from optparse import OptionParser
+
+parser = OptionParser("terrain_server.py [options]")
+parser.add_option("--master", default="udp:127.0.0.1:14551", help="MAVLink connection to the vehicle")
+parser.add_option("--base", type='float', default=584.0, help="height of the plain in meters")
+parser.add_option("--hills", type='float', default=100.0, help="height of the hills in meters")
+(opts, args) = parser.parse_args()
+
+from pymavlink import mavutil
+
+# these must match AP_Terrain.h
+GRID_SIZE = 16
+GRID_SPACING = 9000
+TILE_SPAN = (GRID_SIZE-1) * GRID_SPACING
+CHUNK_HEADER = 8
+DATA_REQUEST = 0x54
+DATA_TILE = 0x55
+
+def height(lat, lng):
+    '''made up terrain height in meters at a latitude and longitude in degrees'''
+    return opts.base + opts.hills * sin(radians(lat * 200)) * cos(radians(lng * 250))
+
+def make_tile(lat_index, lng_index):
+    '''the grid heights of a tile, rows running north'''
+    tile = []
+    for i in range(GRID_SIZE):
+        lat = (lat_index * TILE_SPAN + i * GRID_SPACING - 900000000) * 1.0e-7
+        row = []
+        for j in range(GRID_SIZE):
+            lng = (lng_index * TILE_SPAN + j * GRID_SPACING - 1800000000) * 1.0e-7
+            row.append(int(round(height(lat, lng))))
+        tile.append(row)
+    return tile
+
+def encode(tile):
+    '''compress a tile as AP_Terrain::encode() does'''
+    buf = struct.pack('<h', tile[0][0])
+    for i in range(GRID_SIZE):
+        for j in range(GRID_SIZE):
+            if i == 0 and j == 0:
+                continue
+            if j == 0:
+                prev = tile[i-1][0]
+            else:
+                prev = tile[i][j-1]
+            diff = tile[i][j] - prev
+            if diff >= -127 and diff <= 127:
+                buf += struct.pack('<b', diff)
+            else:
+                buf += struct.pack('<Bh', 0x80, tile[i][j])
+    return buf
+
+def send_tile(mav, lat_index, lng_index):
+    data = encode(make_tile(lat_index, lng_index))
+    for offset in range(0, len(data), 96 - CHUNK_HEADER):
+        chunk = data[offset:offset + 96 - CHUNK_HEADER]
+        payload = struct.pack('<HHHH', lat_index, lng_index, offset, len(data)) + chunk
+        n = len(payload)
+        payload += b'\0' * (96 - n)
+        mav.mav.data96_send(DATA_TILE, n, [ord(payload[k:k+1]) for k in range(96)])
+        time.sleep(0.02)
+    print("Sent tile %u,%u, %u bytes" % (lat_index, lng_index, len(data)))
+
+mav = mavutil.mavlink_connection(opts.master)
+print("Waiting for terrain requests on %s" % opts.master)
+while True:
+    m = mav.recv_match(type='DATA16', blocking=True)
+    if m is None or m.type != DATA_REQUEST or m.len < 4:
+        continue
+    request = bytes(bytearray(m.data[:4]))
+    (lat_index, lng_index) = struct.unpack('<HH', request)
+    send_tile(mav, lat_index, lng_index)
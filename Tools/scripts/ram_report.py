@@ -0,0 +1,118 @@
+#!/usr/bin/env python
+'''
+report the static RAM (.data, .bss and .noinit) used by each library,
+from the linker map of a build. Use as
+
+   ram_report.py /tmp/ArduCopter.build/ArduCopter.map [NUM_SECTIONS]
+
+which also lists the NUM_SECTIONS largest variables, 20 by default
+'''
+
+import re, sys, os, operator
+
+# an input section with its address, size and object on one line, or
+# a long section name on a line by itself with the rest on the next
+section_line = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+name_line = re.compile(r"^ (\S+)$")
+address_line = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+output_line = re.compile(r"^(\.\S+)")
+
+ram_sections = ['.data', '.bss', '.noinit']
+
+class section(object):
+    def __init__(self, name, kind, size, obj):
+        self.name = name
+        self.kind = kind
+        self.size = size
+        self.obj = obj
+        self.library = library_of(obj)
+
+def library_of(obj):
+    '''the library an object file belongs to'''
+    m = re.search(r"/libraries/([^/]+)/", obj)
+    if m:
+        return m.group(1)
+    m = re.search(r"([^/]+)\.a\(", obj)
+    if m:
+        return m.group(1)
+    return os.path.splitext(os.path.basename(obj))[0]
+
+def process_map(filename):
+    '''process a linker map, returning the RAM input sections'''
+    sections = []
+    in_memory_map = False
+    kind = None
+    name = None
+    h = open(filename, mode='r')
+    for line in h:
+        line = line.rstrip()
+        if line.startswith("Linker script and memory map"):
+            in_memory_map = True
+            continue
+        if not in_memory_map:
+            continue
+        m = output_line.match(line)
+        if m:
+            kind = m.group(1) if m.group(1) in ram_sections else None
+            name = None
+            continue
+        if kind is None:
+            continue
+        m = section_line.match(line)
+        if m:
+            name = m.group(1)
+            size = int(m.group(3), 16)
+            obj = m.group(4)
+        else:
+            m = name_line.match(line)
+            if m:
+                name = m.group(1)
+                continue
+            m = address_line.match(line)
+            if m is None or name is None:
+                continue
+            size = int(m.group(2), 16)
+            obj = m.group(3)
+        if size > 0 and not obj.startswith('load address'):
+            sections.append(section(name, kind, size, obj))
+        name = None
+    h.close()
+    return sections
+
+if len(sys.argv) < 2:
+    print("Usage: ram_report.py MAPFILE [NUM_SECTIONS]")
+    sys.exit(1)
+
+num_sections = 20
+if len(sys.argv) > 2:
+    num_sections = int(sys.argv[2])
+
+sections = process_map(sys.argv[1])
+
+libraries = {}
+for s in sections:
+    if not s.library in libraries:
+        libraries[s.library] = { '.data' : 0, '.bss' : 0, '.noinit' : 0 }
+    libraries[s.library][s.kind] += s.size
+
+totals = { '.data' : 0, '.bss' : 0, '.noinit' : 0 }
+print("%-24s %7s %7s %7s %7s" % ("Library", "data", "bss", "noinit", "total"))
+for lib in sorted(libraries.keys(),
+                  key=lambda l: sum(libraries[l].values()),
+                  reverse=True):
+    sizes = libraries[lib]
+    print("%-24s %7u %7u %7u %7u" % (lib, sizes['.data'], sizes['.bss'],
+                                     sizes['.noinit'], sum(sizes.values())))
+    for k in totals.keys():
+        totals[k] += sizes[k]
+print("%-24s %7u %7u %7u %7u" % ("TOTAL", totals['.data'], totals['.bss'],
+                                 totals['.noinit'], sum(totals.values())))
+
+if num_sections > 0:
+    print("")
+    print("%7s   %-24s %s" % ("Size", "Library", "Section"))
+    sorted_sections = sorted(sections,
+                             key=operator.attrgetter('size'),
+                             reverse=True)
+    for s in sorted_sections[:num_sections]:
+        print("%7u   %-24s %s" % (s.size, s.library, s.name))
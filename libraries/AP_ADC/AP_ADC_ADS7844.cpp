@@ -166,7 +166,9 @@ void AP_ADC_ADS7844::Init()
 
     _ch6_last_sample_time_micros = hal.scheduler->micros();
 
-    hal.scheduler->register_timer_process( AP_ADC_ADS7844::read );
+    // sample every tick, ahead of the slower sensors
+    hal.scheduler->register_timer_process( AP_ADC_ADS7844::read, 1,
+                                           AP_HAL::Scheduler::TIMER_PRIORITY_HIGH );
     hal.scheduler->resume_timer_procs();
 
 }
@@ -94,6 +94,14 @@ void AP_Baro::calibrate()
     _ground_temperature.set_and_save(ground_temperature / 10.0f);
 }
 
+// set the ground values directly, the temperature in the units of
+// get_ground_temperature()
+void AP_Baro::set_ground(float pressure, float temperature)
+{
+    _ground_pressure.set(pressure);
+    _ground_temperature.set(temperature);
+}
+
 // return current altitude estimate relative to time that calibrate()
 // was called. Returns altitude in meters
 // note that this relies on read() being called regularly to get new data
@@ -29,6 +29,10 @@ public:
     // the callback is a delay() like routine
     void        calibrate();
 
+    // set the ground pressure and temperature without calibrating, for
+    // a calibration restored from storage. They are not saved
+    void        set_ground(float pressure, float temperature);
+
     // get current altitude in meters relative to altitude at the time
     // of the last calibrate() call
     float        get_altitude(void);
@@ -21,6 +21,8 @@ uint8_t AP_Baro_BMP085_HIL::read()
 {
     uint8_t result = 0;
 
+    // the sums are added to from the timer when run in SITL
+    hal.scheduler->suspend_timer_procs();
     if (_count != 0) {
         result = 1;
         Press = ((float)_pressure_sum) / _count;
@@ -30,6 +32,7 @@ uint8_t AP_Baro_BMP085_HIL::read()
         _pressure_sum = 0;
         _temperature_sum = 0;
     }
+    hal.scheduler->resume_timer_procs();
 
     return result;
 }
@@ -54,7 +54,6 @@ uint32_t volatile AP_Baro_MS5611::_s_D2;
 uint8_t volatile AP_Baro_MS5611::_d1_count;
 uint8_t volatile AP_Baro_MS5611::_d2_count;
 uint8_t AP_Baro_MS5611::_state;
-uint32_t AP_Baro_MS5611::_timer;
 bool volatile AP_Baro_MS5611::_updated;
 
 AP_Baro_MS5611_Serial* AP_Baro_MS5611::_serial = NULL;
@@ -238,7 +237,6 @@ bool AP_Baro_MS5611::init()
 
     //Send a command to read Temp first
     _serial->write(CMD_CONVERT_D2_OSR4096);
-    _timer = hal.scheduler->micros();
     _state = 0;
     Temp=0;
     Press=0;
@@ -248,7 +246,9 @@ bool AP_Baro_MS5611::init()
     _d1_count = 0;
     _d2_count = 0;
 
-    hal.scheduler->register_timer_process( AP_Baro_MS5611::_update );
+    // a conversion at OSR4096 takes 9.04ms, so read the result at 100Hz
+    hal.scheduler->register_timer_process( AP_Baro_MS5611::_update, 10,
+                                           AP_HAL::Scheduler::TIMER_PRIORITY_LOW );
     _serial->sem_give();
 
     // wait for at least one value to be read
@@ -271,17 +271,10 @@ bool AP_Baro_MS5611::init()
 // Read the sensor. This is a state machine
 // We read one time Temperature (state=1) and then 4 times Pressure (states 2-5)
 // temperature does not change so quickly...
-void AP_Baro_MS5611::_update(uint32_t tnow)
+// This is called at 100Hz by the timer
+void AP_Baro_MS5611::_update(uint32_t)
 {
-    // Throttle read rate to 100hz maximum.
-    // note we use 9500us here not 10000us
-    // the read rate will end up at exactly 100hz because the Periodic Timer fires at 1khz
-    if (tnow - _timer < 9500) {
-        return;
-    }
-
     _serial->sem_take_nonblocking();
-    _timer = tnow;
 
     if (_state == 0) {
         _s_D2 += _serial->read_adc();// On state 0 we read temp
@@ -97,7 +97,6 @@ private:
     static volatile uint8_t         _d2_count;
     static volatile uint32_t        _s_D1, _s_D2;
     static uint8_t                  _state;
-    static uint32_t                 _timer;
     static AP_Baro_MS5611_Serial   *_serial;
     /* Gates access to asynchronous state: */
     static bool                     _sync_access;
@@ -2,6 +2,10 @@
 
 /// @file	AP_Buffer.h
 /// @brief	fifo buffer template class
+///
+/// None of the methods are virtual so calls can be inlined and the buffer
+/// carries no vtable. When SIZE is a power of two the index wraps with a
+/// mask, otherwise with a single compare.
 
 #ifndef __AP_BUFFER_H__
 #define __AP_BUFFER_H__
@@ -17,24 +21,32 @@ public:
     AP_Buffer();
 
     // clear - removes all points from the curve
-    virtual void clear();
+    void clear();
 
     // add - adds an item to the buffer.  returns TRUE if successfully added
-    virtual bool add( T item );
+    bool add( T item );
 
     // get - returns the next value in the buffer
-    virtual T get();
+    T get();
 
     // peek - check what the next value in the buffer is but don't pull it off
-    virtual T peek(uint8_t position = 0);
+    T peek(uint8_t position = 0) const;
 
     // num_values - returns number of values in the buffer
-    virtual uint8_t num_items() { return _num_items; }
+    uint8_t num_items() const { return _num_items; }
 
     // print_buffer - display the contents of the buffer on the serial port
     //virtual void print_buffer();
 
 protected:
+    // _wrap - wrap an index that is less than 2*SIZE back into the buffer
+    static uint8_t _wrap(uint8_t index) {
+        if ((SIZE & (SIZE-1)) == 0) {
+            return index & (SIZE-1);
+        }
+        return index >= SIZE ? index - SIZE : index;
+    }
+
     uint8_t     _num_items;             // number of items in the buffer
     uint8_t     _head;                  // first item in the buffer (will be returned with the next get call)
     T           _buff[SIZE];            // x values of each point on the curve
@@ -74,10 +86,7 @@ template <class T, uint8_t SIZE>
 bool AP_Buffer<T,SIZE>::add( T item )
 {
     // determine position of new item
-    uint8_t tail = _head + _num_items;
-    if( tail >= SIZE ) {
-        tail -= SIZE;
-    }
+    uint8_t tail = _wrap(_head + _num_items);
 
     // add item to buffer
     _buff[tail] = item;
@@ -87,10 +96,7 @@ bool AP_Buffer<T,SIZE>::add( T item )
         _num_items++;
     }else{
         // no room for new items so drop oldest item
-        _head++;
-        if( _head >= SIZE ) {
-            _head = 0;
-        }
+        _head = _wrap(_head + 1);
     }
 
     // indicate success
@@ -112,9 +118,7 @@ T AP_Buffer<T,SIZE>::get()
     result = _buff[_head];
 
     // increment to next point
-    _head++;
-    if( _head >= SIZE )
-        _head = 0;
+    _head = _wrap(_head + 1);
 
     // reduce number of items
     _num_items--;
@@ -125,21 +129,17 @@ T AP_Buffer<T,SIZE>::get()
 
 // peek - check what the next value in the buffer is but don't pull it off
 template <class T, uint8_t SIZE>
-T AP_Buffer<T,SIZE>::peek(uint8_t position)
+T AP_Buffer<T,SIZE>::peek(uint8_t position) const
 {
-    uint8_t j = _head+position;
-
     // return zero if position is out of range
     if( position >= _num_items ) {
         return 0;
     }
 
-    // wrap around if necessary
-    if( j >= SIZE )
-        j -= SIZE;
-
     // return desired value
-    return _buff[j];
+    return _buff[_wrap(_head+position)];
 }
 
+#include "AP_DelayLine.h"
+
 #endif  // __AP_BUFFER_H__
@@ -0,0 +1,129 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+/// @file	AP_DelayLine.h
+/// @brief	time stamped history buffer template class
+///
+/// Keeps the most recent SIZE sets of CHANNELS values along with the time
+/// they were taken, and interpolates between them so an estimator can
+/// find what its state was at the moment a delayed measurement (gps,
+/// barometer etc) was actually taken.
+
+#ifndef __AP_DELAY_LINE_H__
+#define __AP_DELAY_LINE_H__
+
+#include <stdint.h>
+
+/// @class      AP_DelayLine
+template <class T, uint8_t CHANNELS, uint8_t SIZE>
+class AP_DelayLine {
+public:
+
+    // Constructor
+    AP_DelayLine() {
+        clear();
+    }
+
+    // clear - removes all entries from the buffer
+    void clear() {
+        _num_items = 0;
+        _head = 0;
+    }
+
+    // add - adds a set of values taken at time_ms, dropping the oldest
+    // entry if the buffer is full
+    void add(uint32_t time_ms, const T values[CHANNELS]);
+
+    // get - interpolate the values at time_ms.  Requests outside of the
+    // stored history are clamped to the oldest or newest entry.
+    // returns false if the buffer is empty
+    bool get(uint32_t time_ms, T values[CHANNELS]) const;
+
+    // num_items - returns number of entries in the buffer
+    uint8_t num_items() const { return _num_items; }
+
+    // newest_time_ms - returns the time of the most recent entry
+    uint32_t newest_time_ms() const {
+        if (_num_items == 0) {
+            return 0;
+        }
+        return _time_ms[_index(_num_items-1)];
+    }
+
+private:
+    // _index - position in the arrays of the i'th oldest entry
+    uint8_t _index(uint8_t i) const {
+        uint8_t j = _head + i;
+        if (j >= SIZE) {
+            j -= SIZE;
+        }
+        return j;
+    }
+
+    uint8_t     _num_items;             // number of entries in the buffer
+    uint8_t     _head;                  // position of the oldest entry
+    uint32_t    _time_ms[SIZE];         // time each entry was taken
+    T           _values[CHANNELS][SIZE];  // values of each entry, one array per channel
+};
+
+// add - adds a set of values taken at time_ms
+template <class T, uint8_t CHANNELS, uint8_t SIZE>
+void AP_DelayLine<T,CHANNELS,SIZE>::add(uint32_t time_ms, const T values[CHANNELS])
+{
+    uint8_t tail;
+
+    if (_num_items < SIZE) {
+        tail = _index(_num_items);
+        _num_items++;
+    }else{
+        // no room for new entries so overwrite the oldest
+        tail = _head;
+        _head = _index(1);
+    }
+
+    _time_ms[tail] = time_ms;
+    for (uint8_t c=0; c<CHANNELS; c++) {
+        _values[c][tail] = values[c];
+    }
+}
+
+// get - interpolate the values at time_ms
+template <class T, uint8_t CHANNELS, uint8_t SIZE>
+bool AP_DelayLine<T,CHANNELS,SIZE>::get(uint32_t time_ms, T values[CHANNELS]) const
+{
+    if (_num_items == 0) {
+        return false;
+    }
+
+    // search back from the newest entry for the first one taken at or
+    // before the requested time. Time differences are taken as signed
+    // so that millis() wrapping is handled
+    uint8_t i = _num_items-1;
+    uint8_t newer = _index(i);
+    if ((int32_t)(time_ms - _time_ms[newer]) >= 0) {
+        // newer than anything we have
+        for (uint8_t c=0; c<CHANNELS; c++) {
+            values[c] = _values[c][newer];
+        }
+        return true;
+    }
+    while (i > 0) {
+        uint8_t older = _index(--i);
+        int32_t since_older = (int32_t)(time_ms - _time_ms[older]);
+        if (since_older >= 0) {
+            float alpha = (float)since_older / (float)(_time_ms[newer] - _time_ms[older]);
+            for (uint8_t c=0; c<CHANNELS; c++) {
+                values[c] = _values[c][older] + (_values[c][newer] - _values[c][older]) * alpha;
+            }
+            return true;
+        }
+        newer = older;
+    }
+
+    // older than anything we have
+    for (uint8_t c=0; c<CHANNELS; c++) {
+        values[c] = _values[c][newer];
+    }
+    return true;
+}
+
+#endif  // __AP_DELAY_LINE_H__
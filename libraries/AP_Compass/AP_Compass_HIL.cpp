@@ -18,7 +18,13 @@ extern const AP_HAL::HAL& hal;
 
 bool AP_Compass_HIL::read()
 {
-    // values set by setHIL function
+    // values set by setHIL function, which is called from the timer
+    // when run in SITL
+    hal.scheduler->suspend_timer_procs();
+    mag_x = _hil_mag.x;
+    mag_y = _hil_mag.y;
+    mag_z = _hil_mag.z;
+    hal.scheduler->resume_timer_procs();
     last_update = hal.scheduler->micros();      // record time of update
     return true;
 }
@@ -27,10 +33,7 @@ bool AP_Compass_HIL::read()
 //
 void AP_Compass_HIL::setHIL(float _mag_x, float _mag_y, float _mag_z)
 {
-    Vector3f ofs = _offset.get();
-    mag_x = _mag_x + ofs.x;
-    mag_y = _mag_y + ofs.y;
-    mag_z = _mag_z + ofs.z;
+    _hil_mag = Vector3f(_mag_x, _mag_y, _mag_z) + _offset.get();
     healthy = true;
 }
 
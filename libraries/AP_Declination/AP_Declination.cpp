@@ -107,8 +107,16 @@ static const row_value declination_values[] PROGMEM = \
 
 #define PGM_UINT8(p) pgm_read_byte_far(p)
 
+struct AP_Declination::Tile AP_Declination::_tile;
+
 float
 AP_Declination::get_declination(float lat, float lon)
+{
+    return get_declination(lat, lon, _tile);
+}
+
+float
+AP_Declination::get_declination(float lat, float lon, struct Tile &tile)
 {
     int16_t decSW, decSE, decNW, decNE, lonmin, latmin;
     uint8_t latmin_index,lonmin_index;
@@ -121,13 +129,26 @@ AP_Declination::get_declination(float lat, float lon)
     latmin = floor(lat/5)*5;
     lonmin = floor(lon/5)*5;
 
+    // 90 degrees and 180 degrees are the top and right edges of the
+    // last cells
+    if (latmin == 90) latmin = 85;
+    if (lonmin == 180) lonmin = 175;
+
     latmin_index= (90+latmin)/5;
     lonmin_index= (180+lonmin)/5;
 
-    decSW = get_lookup_value(latmin_index, lonmin_index);
-    decSE = get_lookup_value(latmin_index, lonmin_index+1);
-    decNE = get_lookup_value(latmin_index+1, lonmin_index+1);
-    decNW = get_lookup_value(latmin_index+1, lonmin_index);
+    if (!tile.valid ||
+        latmin_index < tile.lat_index || latmin_index > tile.lat_index + 2 ||
+        lonmin_index < tile.lon_index || lonmin_index > tile.lon_index + 2) {
+        load_tile(tile, latmin_index, lonmin_index);
+    }
+    uint8_t i = latmin_index - tile.lat_index;
+    uint8_t j = lonmin_index - tile.lon_index;
+
+    decSW = tile.value[i][j];
+    decSE = tile.value[i][j+1];
+    decNE = tile.value[i+1][j+1];
+    decNW = tile.value[i+1][j];
 
     /* approximate declination within the grid using bilinear interpolation */
     decmin = (lon - lonmin) / 5 * (decSE - decSW) + decSW;
@@ -135,12 +156,35 @@ AP_Declination::get_declination(float lat, float lon)
     return (lat - latmin) / 5 * (decmax - decmin) + decmin;
 }
 
-int16_t
-AP_Declination::get_lookup_value(uint8_t x, uint8_t y)
+void
+AP_Declination::get_declinations(const float *lat, const float *lon,
+                                 float *declination, uint16_t count)
 {
-    // return value
-    int16_t val = 0;
+    // a tile of its own, so a batch does not disturb the vehicle's
+    struct Tile tile;
+    tile.valid = false;
+    for (uint16_t i=0; i<count; i++) {
+        declination[i] = get_declination(lat[i], lon[i], tile);
+    }
+}
 
+// load_tile - decode the 4x4 values around grid cell x,y. The cell is
+// kept in the middle of the tile, except at the edges of the table
+void
+AP_Declination::load_tile(struct Tile &tile, uint8_t x, uint8_t y)
+{
+    tile.lat_index = constrain_int16(x - 1, 0, 36 - 3);
+    tile.lon_index = constrain_int16(y - 1, 0, 72 - 3);
+    for (uint8_t i = 0; i < 4; i++) {
+        get_lookup_row(tile.lat_index + i, tile.lon_index, 4, tile.value[i]);
+    }
+    tile.valid = true;
+}
+
+// get_lookup_row - decode n values of row x from index y
+void
+AP_Declination::get_lookup_row(uint8_t x, uint8_t y, uint8_t n, int16_t *val)
+{
     // These are exception indicies
     if(x <= 6 || x >= 34)
     {
@@ -148,17 +192,18 @@ AP_Declination::get_lookup_value(uint8_t x, uint8_t y)
         // to match the 10 indicies in the exceptions lookup table
         if(x >= 34) x -= 27;
 
-        // Read the unsigned value from the array
-        val = PGM_UINT8(&exceptions[x][y]);
-
-        // Read the 8 bit compressed sign values
-        uint8_t sign = PGM_UINT8(&exception_signs[x][y/8]);
+        for (uint8_t k = 0; k < n; k++, y++) {
+            // Read the unsigned value from the array
+            val[k] = PGM_UINT8(&exceptions[x][y]);
 
-        // Check the sign bit for this index
-        if(sign & (0x80 >> y%8))
-            val = -val;
+            // Read the 8 bit compressed sign values
+            uint8_t sign = PGM_UINT8(&exception_signs[x][y/8]);
 
-        return val;
+            // Check the sign bit for this index
+            if(sign & (0x80 >> y%8))
+                val[k] = -val[k];
+        }
+        return;
     }
 
     // Because the values were removed from the start of the
@@ -167,22 +212,20 @@ AP_Declination::get_lookup_value(uint8_t x, uint8_t y)
     // EX: User enters 7 -> 7 is the first row in this array so it needs to be zero
     if(x >= 7) x -= 7;
 
-    // If we are looking for the first value we can just use the
-    // row start value from declination_keys
-    if(y == 0) return PGM_UINT8(&declination_keys[0][x]);
-
     // Init vars
     row_value stval;
     int16_t offset = 0;
 
     // These will never exceed the second dimension length of 73
     uint8_t current_virtual_index = 0, r;
+    uint8_t last = y + n - 1;
 
     // This could be the length of the array or less (1075 or less)
     uint16_t start_index = 0, i;
 
     // Init value to row start
-    val = PGM_UINT8(&declination_keys[0][x]);
+    int16_t value = PGM_UINT8(&declination_keys[0][x]);
+    if (y == 0) val[0] = value;
 
     // Find the first element in the 1D array
     // that corresponds with the target row
@@ -190,8 +233,9 @@ AP_Declination::get_lookup_value(uint8_t x, uint8_t y)
         start_index += PGM_UINT8(&declination_keys[1][i]);
     }
 
-    // Traverse the row until we find our value
-    for(i = start_index; i < (start_index + PGM_UINT8(&declination_keys[1][x])) && current_virtual_index <= y; i++) {
+    // Traverse the row until we have the last value wanted. The value
+    // at index k, for k > 0, is the row start plus the first k+1 offsets
+    for(i = start_index; i < (start_index + PGM_UINT8(&declination_keys[1][x])) && current_virtual_index <= last; i++) {
 
         // Pull out the row_value struct
         memcpy_P((void*) &stval, (const prog_char *)&declination_values[i], sizeof(struct row_value));
@@ -202,10 +246,19 @@ AP_Declination::get_lookup_value(uint8_t x, uint8_t y)
 
         // Add offset for each repeat
         // This will at least run once for zero repeat
-        for(r = 0; r <= stval.repeats && current_virtual_index <= y; r++) {
-            val += offset;
+        for(r = 0; r <= stval.repeats && current_virtual_index <= last; r++) {
+            value += offset;
+            if (current_virtual_index >= y && current_virtual_index > 0) {
+                val[current_virtual_index - y] = value;
+            }
             current_virtual_index++;
         }
     }
-    return val;
+
+    // the values past the end of a row are its last value
+    for (; current_virtual_index <= last; current_virtual_index++) {
+        if (current_virtual_index >= y && current_virtual_index > 0) {
+            val[current_virtual_index - y] = value;
+        }
+    }
 }
@@ -12,12 +12,41 @@
  *	scottfromscott@gmail.com
  *
  */
+
+/*
+ *	The table has a value every 5 degrees, and a query interpolates
+ *	between the four around it. Decoding those from the compressed
+ *	tables is much slower than the interpolation, so the values of a
+ *	tile of 3x3 grid cells around the last query are kept decoded. A
+ *	query in the same tile is only the interpolation, and one outside
+ *	it decodes the tile around the new cell, a row at a time.
+ */
 class AP_Declination
 {
 public:
+    struct Tile {
+        bool    valid;
+        uint8_t lat_index;          // grid index of value[0][0]
+        uint8_t lon_index;
+        int16_t value[4][4];        // [lat][lon] in degrees
+    };
+
     static float            get_declination(float lat, float lon);
+
+    // get_declination - as above, with a tile kept by the caller. For
+    // callers that are far apart, or that run in another thread
+    static float            get_declination(float lat, float lon, struct Tile &tile);
+
+    // get_declinations - declination for count positions, best given in
+    // an order where neighbours are close together
+    static void             get_declinations(const float *lat, const float *lon,
+                                             float *declination, uint16_t count);
+
 private:
-    static int16_t          get_lookup_value(uint8_t x, uint8_t y);
+    static void             load_tile(struct Tile &tile, uint8_t x, uint8_t y);
+    static void             get_lookup_row(uint8_t x, uint8_t y, uint8_t n, int16_t *val);
+
+    static struct Tile      _tile;
 };
 
 #endif // AP_Declination_h
@@ -10,6 +10,8 @@
 #include <Filter.h>
 
 #include <AP_HAL_AVR.h>
+#include <AP_HAL_AVR_SITL.h>
+#include <AP_HAL_Empty.h>
 
 const AP_HAL::HAL& hal = AP_HAL_BOARD_DRIVER;
 
@@ -113,6 +115,43 @@ void setup(void)
     hal.console->printf("Total Fail: %i\n", fail);
     hal.console->printf("Average time per call: %.1f usec\n",
                   total_time/(float)(pass+fail));
+
+    // time a vehicle flying north east at about 100m/s, queried at
+    // 10Hz, first decoding the table for every query, then with the
+    // tile kept between queries
+    uint32_t t1 = hal.scheduler->micros();
+    for (uint16_t i = 0; i < 1000; i++) {
+        AP_Declination::Tile tile;
+        tile.valid = false;
+        declination = AP_Declination::get_declination(-35 + i*0.0001f, 149 + i*0.0001f, tile);
+    }
+    uint32_t decode_time = hal.scheduler->micros() - t1;
+    t1 = hal.scheduler->micros();
+    for (uint16_t i = 0; i < 1000; i++) {
+        declination = AP_Declination::get_declination(-35 + i*0.0001f, 149 + i*0.0001f);
+    }
+    uint32_t cached_time = hal.scheduler->micros() - t1;
+    hal.console->printf("Decoded: %.2f usec, cached: %.2f usec per call\n",
+                  decode_time/1000.0f, cached_time/1000.0f);
+
+    // the batch call must agree with single calls
+    float lat[73], lon[73], dec[73];
+    for (uint8_t i = 0; i < 73; i++) {
+        lat[i] = 40 - i * 0.7f;
+        lon[i] = -180 + i * 4.9f;
+    }
+    t1 = hal.scheduler->micros();
+    AP_Declination::get_declinations(lat, lon, dec, 73);
+    uint32_t batch_time = hal.scheduler->micros() - t1;
+    fail = 0;
+    for (uint8_t i = 0; i < 73; i++) {
+        if (dec[i] != AP_Declination::get_declination(lat[i], lon[i])) {
+            hal.console->printf("BATCH FAIL: %f, %f\n", lat[i], lon[i]);
+            fail++;
+        }
+    }
+    hal.console->printf("Batch of 73: %lu usec, %u fail\n",
+                  (unsigned long)batch_time, (unsigned)fail);
 }
 
 void loop(void)
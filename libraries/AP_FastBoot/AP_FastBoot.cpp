@@ -0,0 +1,228 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ *       AP_FastBoot.cpp - warm start from the last validated sensor state
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <AP_HAL.h>
+#include "AP_FastBoot.h"
+
+extern const AP_HAL::HAL& hal;
+
+#define FASTBOOT_MAGIC   0x4642
+#define FASTBOOT_VERSION 1
+
+// the simulators start from the same state every time, so there is
+// nothing to lose by restoring it
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+ # define FASTBOOT_ENABLE_DEFAULT 1
+#else
+ # define FASTBOOT_ENABLE_DEFAULT 0
+#endif
+
+const AP_Param::GroupInfo AP_FastBoot::var_info[] PROGMEM = {
+    // @Param: ENABLE
+    // @DisplayName: Enable fast boot
+    // @Description: Setting this to Enabled(1) restores the last validated gyro offsets, ground pressure and attitude at boot instead of calibrating them, and refines them while the vehicle is disarmed
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("ENABLE",   0, AP_FastBoot, _enable,        FASTBOOT_ENABLE_DEFAULT),
+
+    // @Param: MAX_AGE
+    // @DisplayName: Fast boot maximum age
+    // @Description: The number of boots the saved state can be used for before a full calibration is needed. The state is saved again each time the vehicle is seen still while disarmed
+    // @Range: 1 255
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("MAX_AGE",  1, AP_FastBoot, _max_age,       10),
+
+    // @Param: TEMP_MAX
+    // @DisplayName: Fast boot temperature limit
+    // @Description: The largest difference between the barometer temperature at boot and the saved ground temperature for which the saved state is used
+    // @Units: Degrees C
+    // @Range: 0 50
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("TEMP_MAX", 2, AP_FastBoot, _max_temp_diff, 10),
+
+    AP_GROUPEND
+};
+
+AP_FastBoot::AP_FastBoot(AP_InertialSensor &ins, AP_Baro &baro, AP_AHRS &ahrs,
+                         uint16_t storage_offset) :
+    _ins(ins),
+    _baro(baro),
+    _ahrs(ahrs),
+    _storage_offset(storage_offset),
+    _active(false),
+    _validated(false),
+    _gyro_count(0),
+    _have_last_window(false),
+    _pressure(0)
+{
+    AP_Param::setup_object_defaults(this, var_info);
+}
+
+// CRC-16-CCITT
+uint16_t AP_FastBoot::_crc16(const uint8_t *buf, uint8_t len)
+{
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc ^= (uint16_t)(*buf++) << 8;
+        for (uint8_t i=0; i<8; i++) {
+            if (crc & 0x8000) {
+                crc = (crc << 1) ^ 0x1021;
+            } else {
+                crc <<= 1;
+            }
+        }
+    }
+    return crc;
+}
+
+// _read_baro - get a first reading from the barometer, for the
+// temperature check. Unlike AP_Baro::calibrate() a barometer that does
+// not answer is not fatal here, the caller falls back to the cold start
+bool AP_FastBoot::_read_baro()
+{
+    uint32_t tstart = hal.scheduler->millis();
+    do {
+        _baro.read();
+        if (_baro.healthy && _baro.get_pressure() != 0) {
+            return true;
+        }
+        hal.scheduler->delay(10);
+    } while (hal.scheduler->millis() - tstart < 200);
+    return false;
+}
+
+bool AP_FastBoot::restore()
+{
+    struct Record rec;
+
+    // the record must fit in the space set aside for it
+    typedef char record_size_check[sizeof(rec) <= AP_FASTBOOT_STORAGE_SIZE ? 1 : -1] __attribute__((unused));
+
+    _active = false;
+    if (!_enable) {
+        return false;
+    }
+
+    hal.storage->read_block(&rec, _storage_offset, sizeof(rec));
+    if (rec.magic != FASTBOOT_MAGIC ||
+        rec.version != FASTBOOT_VERSION ||
+        rec.crc != _crc16((const uint8_t *)&rec.data, sizeof(rec.data))) {
+        return false;
+    }
+    if (rec.age >= (uint8_t)_max_age) {
+        return false;
+    }
+
+    // count this boot against the record. The age is outside the CRC so
+    // only the one byte is written
+    uint16_t age_offset = (uint8_t *)&rec.age - (uint8_t *)&rec;
+    hal.storage->write_byte(_storage_offset + age_offset, rec.age + 1);
+
+    if (!_read_baro()) {
+        return false;
+    }
+    float temperature = _baro.get_temperature() / 10.0f;
+    if (fabs(temperature - rec.data.ground_temperature) > _max_temp_diff) {
+        return false;
+    }
+
+    _ins.set_gyro_offsets(rec.data.gyro_offset);
+    _baro.set_ground(rec.data.ground_pressure, rec.data.ground_temperature);
+    _pressure = rec.data.ground_pressure;
+
+    // start the attitude where it was left. The AHRS converges on the
+    // real attitude from there
+    _ahrs.roll  = rec.data.roll;
+    _ahrs.pitch = rec.data.pitch;
+    _ahrs.yaw   = rec.data.yaw;
+    _ahrs.reset(true);
+
+    _active = true;
+    return true;
+}
+
+void AP_FastBoot::update(bool on_ground)
+{
+    if (!_enable) {
+        return;
+    }
+    if (!on_ground) {
+        // start again when we next land
+        _gyro_sum.zero();
+        _gyro_count = 0;
+        _have_last_window = false;
+        return;
+    }
+
+    // with the barometer calibration skipped the ground pressure is
+    // followed while on the ground, with a time constant of about a
+    // second
+    if (_active && _baro.healthy) {
+        _pressure = 0.9f * _pressure + 0.1f * _baro.get_pressure();
+        _baro.set_ground(_pressure, _baro.get_temperature() / 10.0f);
+    }
+
+    // the gyros read the remaining offset error while the vehicle is
+    // still
+    _gyro_sum += _ins.get_gyro();
+    if (++_gyro_count < FASTBOOT_WINDOW_SAMPLES) {
+        return;
+    }
+    Vector3f gyro_mean = _gyro_sum / _gyro_count;
+    _gyro_sum.zero();
+    _gyro_count = 0;
+
+    if (!_have_last_window) {
+        _last_gyro_mean = gyro_mean;
+        _have_last_window = true;
+        return;
+    }
+
+    // the same test as the cold start calibration, two windows within
+    // 0.04 degrees/s of each other. Otherwise the vehicle is moving
+    if ((gyro_mean - _last_gyro_mean).length() >= ToRad(0.04)) {
+        _last_gyro_mean = gyro_mean;
+        return;
+    }
+
+    _ins.set_gyro_offsets(_ins.get_gyro_offsets() +
+                          (gyro_mean + _last_gyro_mean) * 0.5f);
+    _have_last_window = false;
+
+    if (!_validated) {
+        _validated = true;
+        save();
+    }
+}
+
+void AP_FastBoot::save()
+{
+    struct Record rec;
+
+    rec.magic   = FASTBOOT_MAGIC;
+    rec.version = FASTBOOT_VERSION;
+    rec.age     = 0;
+    rec.data.gyro_offset        = _ins.get_gyro_offsets();
+    rec.data.ground_pressure    = _baro.get_ground_pressure();
+    rec.data.ground_temperature = _baro.get_ground_temperature();
+    rec.data.roll               = _ahrs.roll;
+    rec.data.pitch              = _ahrs.pitch;
+    rec.data.yaw                = _ahrs.yaw;
+    rec.crc = _crc16((const uint8_t *)&rec.data, sizeof(rec.data));
+
+    hal.storage->write_block(_storage_offset, &rec, sizeof(rec));
+}
+
+void AP_FastBoot::invalidate()
+{
+    hal.storage->write_word(_storage_offset, 0);
+}
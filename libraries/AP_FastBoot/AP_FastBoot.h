@@ -0,0 +1,121 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ *       AP_FastBoot.h - warm start from the last validated sensor state
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ */
+
+#ifndef __AP_FASTBOOT_H__
+#define __AP_FASTBOOT_H__
+
+#include <AP_Common.h>
+#include <AP_Param.h>
+#include <AP_Math.h>
+#include <AP_InertialSensor.h>
+#include <AP_Baro.h>
+#include <AP_AHRS.h>
+
+/*
+  A cold start averages the gyros for two seconds or more and settles
+  the barometer for another one and a half, with the vehicle kept
+  still. AP_FastBoot keeps the gyro offsets, barometer ground pressure
+  and temperature and the attitude from the last time they were seen to
+  be good in a small block of storage, protected by a CRC. On the next
+  boot restore() puts them back, so the vehicle can skip the blocking
+  calibrations and instead refine them with update() while it sits
+  disarmed.
+
+  The saved state is not used if it is more than FBOOT_MAX_AGE boots
+  old, or if the barometer temperature has moved more than
+  FBOOT_TEMP_MAX from the saved ground temperature, as the gyro offsets
+  drift with temperature.
+
+  update() averages the gyros over windows of FASTBOOT_WINDOW_SAMPLES
+  calls. When two windows in a row agree the vehicle is taken to be
+  still, the mean of the two is taken off the gyro offsets and, on the
+  first such pair of each boot, the state is saved for the next one.
+ */
+
+// the bytes of storage the saved state needs
+#define AP_FASTBOOT_STORAGE_SIZE 48
+
+// calls of update() averaged in each gyro window
+#define FASTBOOT_WINDOW_SAMPLES 50
+
+class AP_FastBoot
+{
+public:
+    AP_FastBoot(AP_InertialSensor &ins, AP_Baro &baro, AP_AHRS &ahrs,
+                uint16_t storage_offset);
+
+    // restore - load the saved state and, if it passes the checks, set
+    // the gyro offsets, the barometer ground values and the attitude
+    // from it. Call after the barometer init() and before the gyro and
+    // barometer calibrations, which can be skipped if this returns true
+    bool restore();
+
+    // update - refine the gyro offsets and barometer ground pressure.
+    // Call at 10Hz, with on_ground true while the vehicle is disarmed
+    // on the ground
+    void update(bool on_ground);
+
+    // save - write the current state to storage as validated
+    void save();
+
+    // invalidate - stop the saved state being used on the next boot
+    void invalidate();
+
+    // active - true if the calibrations were restored on this boot
+    bool active() const { return _active; }
+
+    // validated - true once the vehicle has been seen still on this boot
+    bool validated() const { return _validated; }
+
+    static const struct AP_Param::GroupInfo var_info[];
+
+private:
+    struct Data {
+        Vector3f gyro_offset;
+        float    ground_pressure;
+        float    ground_temperature;
+        float    roll;
+        float    pitch;
+        float    yaw;
+    };
+    struct Record {
+        uint16_t magic;
+        uint16_t crc;           // of data
+        uint8_t  version;
+        uint8_t  age;           // boots since the record was saved
+        struct Data data;
+    };
+
+    static uint16_t _crc16(const uint8_t *buf, uint8_t len);
+    bool            _read_baro();
+
+    AP_InertialSensor   &_ins;
+    AP_Baro             &_baro;
+    AP_AHRS             &_ahrs;
+    const uint16_t      _storage_offset;
+
+    AP_Int8             _enable;
+    AP_Int8             _max_age;
+    AP_Float            _max_temp_diff;
+
+    bool                _active;
+    bool                _validated;
+
+    // the gyro window being summed, and the mean of the last one
+    Vector3f            _gyro_sum;
+    Vector3f            _last_gyro_mean;
+    uint8_t             _gyro_count;
+    bool                _have_last_window;
+
+    // low passed pressure, for tracking the ground pressure
+    float               _pressure;
+};
+
+#endif // __AP_FASTBOOT_H__
@@ -0,0 +1,301 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ *       AP_Fence.cpp - geofence made of inclusion and exclusion zones
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <string.h>
+#include "AP_Fence.h"
+
+// meters per unit of latitude
+#define FENCE_LAT_SCALE 0.01113195f
+
+AP_Fence::AP_Fence()
+{
+    clear();
+}
+
+void AP_Fence::clear()
+{
+    _num_zones  = 0;
+    _bands_used = 0;
+    _index_used = 0;
+    _lng_scale  = FENCE_LAT_SCALE;
+}
+
+// the fence is small enough for one longitude scale to do for all of it
+void AP_Fence::_set_scale(int32_t lat)
+{
+    _lng_scale = cos((fabs((float)lat)/1.0e7) * 0.0174532925) * FENCE_LAT_SCALE;
+}
+
+bool AP_Fence::add_polygon(const Vector2l *points, uint8_t n, bool exclusion)
+{
+    if (_num_zones >= AP_FENCE_MAX_ZONES || !Polygon_complete(points, n)) {
+        return false;
+    }
+    struct Zone &z = _zones[_num_zones];
+    z.type      = ZONE_POLYGON;
+    z.exclusion = exclusion;
+    z.points    = points;
+    z.num_edges = n - 1;
+    z.radius    = 0;
+
+    z.min = z.max = points[0];
+    for (uint8_t i=1; i<n; i++) {
+        if (points[i].x < z.min.x) z.min.x = points[i].x;
+        if (points[i].x > z.max.x) z.max.x = points[i].x;
+        if (points[i].y < z.min.y) z.min.y = points[i].y;
+        if (points[i].y > z.max.y) z.max.y = points[i].y;
+    }
+    if (_num_zones == 0) {
+        _set_scale(z.min.x/2 + z.max.x/2);
+    }
+
+    // start with a band per edge, and halve that until the index fits.
+    // A zone with no bands left for it is checked edge by edge
+    uint8_t num_bands = z.num_edges;
+    int16_t bands_free = (int16_t)(sizeof(_band_start)/sizeof(_band_start[0])) - _bands_used - 1;
+    if (bands_free <= 0) {
+        num_bands = 0;
+    } else if (num_bands > bands_free) {
+        num_bands = bands_free;
+    }
+    while (num_bands > 0 && !_build_index(z, num_bands)) {
+        num_bands /= 2;
+    }
+    z.num_bands = num_bands;
+
+    _num_zones++;
+    return true;
+}
+
+bool AP_Fence::add_circle(const Vector2l &center, float radius, bool exclusion)
+{
+    if (_num_zones >= AP_FENCE_MAX_ZONES) {
+        return false;
+    }
+    if (_num_zones == 0) {
+        _set_scale(center.x);
+    }
+    struct Zone &z = _zones[_num_zones];
+    z.type      = ZONE_CIRCLE;
+    z.exclusion = exclusion;
+    z.points    = NULL;
+    z.num_edges = 0;
+    z.num_bands = 0;
+    z.radius    = radius;
+
+    // the center is kept in the bounding box, as its middle
+    int32_t dlat = radius / FENCE_LAT_SCALE + 1;
+    int32_t dlng = radius / _lng_scale + 1;
+    z.min = Vector2l(center.x - dlat, center.y - dlng);
+    z.max = Vector2l(center.x + dlat, center.y + dlng);
+
+    _num_zones++;
+    return true;
+}
+
+// _build_index - sort the edges of z into num_bands bands. Returns false
+// if they do not fit in what is left of the index
+bool AP_Fence::_build_index(struct Zone &z, uint8_t num_bands)
+{
+    int32_t span = z.max.y - z.min.y;
+    if (span < 0) {
+        // too wide to index
+        return false;
+    }
+    z.num_bands  = num_bands;
+    z.first_band = _bands_used;
+    z.band_width = span / num_bands + 1;
+
+    // count the edges in each band into the start of the next one
+    uint16_t *start = &_band_start[_bands_used];
+    memset(start, 0, (num_bands + 1) * sizeof(start[0]));
+    for (uint8_t e=0; e<z.num_edges; e++) {
+        const Vector2l &v1 = z.points[e];
+        const Vector2l &v2 = z.points[e+1];
+        uint8_t b1 = _band(z, min(v1.y, v2.y));
+        uint8_t b2 = _band(z, max(v1.y, v2.y));
+        for (uint8_t b=b1; b<=b2; b++) {
+            start[b+1]++;
+        }
+    }
+    start[0] = _index_used;
+    for (uint8_t b=0; b<num_bands; b++) {
+        start[b+1] += start[b];
+    }
+    if (start[num_bands] > AP_FENCE_INDEX_SIZE) {
+        return false;
+    }
+
+    // fill in the bands, which moves each start on to the end of its
+    // band, then put the starts back
+    for (uint8_t e=0; e<z.num_edges; e++) {
+        const Vector2l &v1 = z.points[e];
+        const Vector2l &v2 = z.points[e+1];
+        uint8_t b1 = _band(z, min(v1.y, v2.y));
+        uint8_t b2 = _band(z, max(v1.y, v2.y));
+        for (uint8_t b=b1; b<=b2; b++) {
+            _index[start[b]++] = e;
+        }
+    }
+    for (uint8_t b=num_bands; b>0; b--) {
+        start[b] = start[b-1];
+    }
+    start[0] = _index_used;
+
+    _index_used = start[num_bands];
+    _bands_used += num_bands + 1;
+    return true;
+}
+
+uint8_t AP_Fence::_band(const struct Zone &z, int32_t y) const
+{
+    if (y <= z.min.y) {
+        return 0;
+    }
+    int32_t b = (y - z.min.y) / z.band_width;
+    if (b >= z.num_bands) {
+        return z.num_bands - 1;
+    }
+    return b;
+}
+
+bool AP_Fence::_inside_zone(const struct Zone &z, const Vector2l &point) const
+{
+    if (point.x < z.min.x || point.x > z.max.x ||
+        point.y < z.min.y || point.y > z.max.y) {
+        return false;
+    }
+
+    if (z.type == ZONE_CIRCLE) {
+        float dx = (point.x - z.min.x - (z.max.x - z.min.x)/2) * FENCE_LAT_SCALE;
+        float dy = (point.y - z.min.y - (z.max.y - z.min.y)/2) * _lng_scale;
+        return dx*dx + dy*dy < z.radius*z.radius;
+    }
+
+    // the same edge tests as Polygon_outside(), on the edges of the
+    // band the point is in
+    bool inside = false;
+    if (z.num_bands == 0) {
+        for (uint8_t e=0; e<z.num_edges; e++) {
+            if (Polygon_edge_crossed(point, z.points[e+1], z.points[e])) {
+                inside = !inside;
+            }
+        }
+        return inside;
+    }
+    uint8_t b = z.first_band + _band(z, point.y);
+    for (uint16_t k=_band_start[b]; k<_band_start[b+1]; k++) {
+        uint8_t e = _index[k];
+        if (Polygon_edge_crossed(point, z.points[e+1], z.points[e])) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+bool AP_Fence::inside(const Vector2l &point) const
+{
+    bool have_inclusion = false;
+    bool included = false;
+    for (uint8_t i=0; i<_num_zones; i++) {
+        const struct Zone &z = _zones[i];
+        if (z.exclusion) {
+            if (_inside_zone(z, point)) {
+                return false;
+            }
+        } else {
+            have_inclusion = true;
+            if (!included && _inside_zone(z, point)) {
+                included = true;
+            }
+        }
+    }
+    return included || !have_inclusion;
+}
+
+// _edge_distance - meters from point to edge e of z
+float AP_Fence::_edge_distance(const struct Zone &z, uint8_t e, const Vector2l &point) const
+{
+    Vector2f a((z.points[e].x - point.x) * FENCE_LAT_SCALE,
+               (z.points[e].y - point.y) * _lng_scale);
+    Vector2f b((z.points[e+1].x - point.x) * FENCE_LAT_SCALE,
+               (z.points[e+1].y - point.y) * _lng_scale);
+    Vector2f d = b - a;
+    float len2 = d * d;
+    if (len2 > 0) {
+        float t = -(a * d) / len2;
+        a += d * constrain(t, 0, 1);
+    }
+    return a.length();
+}
+
+// _zone_distance - meters from point to the edge of z, or best if that
+// is closer
+float AP_Fence::_zone_distance(const struct Zone &z, const Vector2l &point, float best) const
+{
+    if (z.type == ZONE_CIRCLE) {
+        float dx = (point.x - z.min.x - (z.max.x - z.min.x)/2) * FENCE_LAT_SCALE;
+        float dy = (point.y - z.min.y - (z.max.y - z.min.y)/2) * _lng_scale;
+        float d = fabs(pythagorous2(dx, dy) - z.radius);
+        return d < best ? d : best;
+    }
+
+    // nothing to do if the bounding box is further than best
+    float bx = 0, by = 0;
+    if (point.x < z.min.x) bx = (z.min.x - point.x) * FENCE_LAT_SCALE;
+    if (point.x > z.max.x) bx = (point.x - z.max.x) * FENCE_LAT_SCALE;
+    if (point.y < z.min.y) by = (z.min.y - point.y) * _lng_scale;
+    if (point.y > z.max.y) by = (point.y - z.max.y) * _lng_scale;
+    if (bx*bx + by*by >= best*best) {
+        return best;
+    }
+
+    if (z.num_bands == 0) {
+        for (uint8_t e=0; e<z.num_edges; e++) {
+            float d = _edge_distance(z, e, point);
+            if (d < best) best = d;
+        }
+        return best;
+    }
+
+    // work out from the band of the point. Once k bands have been done
+    // on each side, the edges left are at least k band widths away
+    float band_width = z.band_width * _lng_scale;
+    int16_t b = _band(z, point.y);
+    for (int16_t k=0; k<z.num_bands; k++) {
+        if (k > 0 && best <= (k-1) * band_width) {
+            break;
+        }
+        int16_t bands[2] = { (int16_t)(b - k), (int16_t)(b + k) };
+        for (uint8_t s=0; s<(k>0?2:1); s++) {
+            if (bands[s] < 0 || bands[s] >= z.num_bands) {
+                continue;
+            }
+            uint8_t fb = z.first_band + bands[s];
+            for (uint16_t i=_band_start[fb]; i<_band_start[fb+1]; i++) {
+                float d = _edge_distance(z, _index[i], point);
+                if (d < best) best = d;
+            }
+        }
+    }
+    return best;
+}
+
+float AP_Fence::distance_to_boundary(const Vector2l &point) const
+{
+    if (_num_zones == 0) {
+        return -1;
+    }
+    float best = 1.0e9f;
+    for (uint8_t i=0; i<_num_zones; i++) {
+        best = _zone_distance(_zones[i], point, best);
+    }
+    return best;
+}
@@ -0,0 +1,122 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ *       AP_Fence.h - geofence made of inclusion and exclusion zones
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ */
+
+#ifndef __AP_FENCE_H__
+#define __AP_FENCE_H__
+
+#include <AP_Common.h>
+#include <AP_Math.h>
+
+/*
+  A fence is a set of zones, each a polygon or a circle, and each one
+  either an inclusion zone the vehicle must stay in or an exclusion
+  zone it must stay out of. A point is inside the fence if it is inside
+  at least one inclusion zone, or there are none, and outside all of
+  the exclusion zones.
+
+  Polygons are given as for Polygon_outside(), with the last point the
+  same as the first, and are not copied. The points must stay where
+  they are until the fence is cleared.
+
+  When a polygon is added its bounding box is found and its edges are
+  sorted into bands of equal width across its longitude range. A point
+  outside the bounding box is done with a compare, and one inside only
+  tests the edges in its band, so the cost of a check depends on how
+  many edges cross one band, not on the number of points. The bands
+  also let distance_to_boundary() look at the nearest edges first and
+  stop once the rest are further away than the closest found.
+
+  If there is no room left in the band index a polygon is added
+  without one and its edges are all tested, as Polygon_outside() does.
+ */
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_APM1 || CONFIG_HAL_BOARD == HAL_BOARD_APM2
+ # define AP_FENCE_MAX_ZONES       2
+ # define AP_FENCE_MAX_BANDS       8
+ # define AP_FENCE_INDEX_SIZE      40
+#else
+ # define AP_FENCE_MAX_ZONES       8
+ # define AP_FENCE_MAX_BANDS       128
+ # define AP_FENCE_INDEX_SIZE      512
+#endif
+
+class AP_Fence
+{
+public:
+    AP_Fence();
+
+    // clear - remove all the zones
+    void clear();
+
+    // add_polygon - add a polygon of n points, the last the same as the
+    // first. Returns false if the polygon is not complete or there is
+    // no room for another zone
+    bool add_polygon(const Vector2l *points, uint8_t n, bool exclusion);
+
+    // add_circle - add a circle of radius meters. Returns false if there
+    // is no room for another zone
+    bool add_circle(const Vector2l &center, float radius, bool exclusion);
+
+    // inside - true if point is inside the fence
+    bool inside(const Vector2l &point) const;
+
+    // distance_to_boundary - meters from point to the edge of the
+    // nearest zone, or -1 if there are no zones
+    float distance_to_boundary(const Vector2l &point) const;
+
+    uint8_t num_zones() const { return _num_zones; }
+
+    // bands - the number of bands polygon zone i was indexed with, 0 if
+    // it has no index
+    uint8_t bands(uint8_t i) const { return _zones[i].num_bands; }
+
+private:
+    enum ZoneType {
+        ZONE_POLYGON = 0,
+        ZONE_CIRCLE  = 1
+    };
+
+    struct Zone {
+        uint8_t         type:1;
+        uint8_t         exclusion:1;
+        uint8_t         num_edges;
+        uint8_t         num_bands;
+        uint8_t         first_band;     // in _band_start
+        const Vector2l  *points;        // or the circle center in points[0]
+        Vector2l        min;            // bounding box
+        Vector2l        max;
+        int32_t         band_width;     // longitude units
+        float           radius;         // meters, circles only
+    };
+
+    bool        _inside_zone(const struct Zone &z, const Vector2l &point) const;
+    float       _zone_distance(const struct Zone &z, const Vector2l &point, float best) const;
+    float       _edge_distance(const struct Zone &z, uint8_t edge, const Vector2l &point) const;
+    bool        _build_index(struct Zone &z, uint8_t num_bands);
+    void        _set_scale(int32_t lat);
+
+    // the band a longitude falls in, clamped to the band range
+    uint8_t     _band(const struct Zone &z, int32_t y) const;
+
+    struct Zone _zones[AP_FENCE_MAX_ZONES];
+    uint8_t     _num_zones;
+
+    // the edges of band b of a zone are _index[_band_start[first_band+b]]
+    // up to _index[_band_start[first_band+b+1]]
+    uint16_t    _band_start[AP_FENCE_MAX_BANDS + AP_FENCE_MAX_ZONES];
+    uint8_t     _bands_used;
+    uint8_t     _index[AP_FENCE_INDEX_SIZE];
+    uint16_t    _index_used;
+
+    // meters per unit of longitude at the first zone
+    float       _lng_scale;
+};
+
+#endif // __AP_FENCE_H__
@@ -0,0 +1,162 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+//
+// Tests for the AP_Fence library, checked against Polygon_outside()
+//
+
+#include <AP_Common.h>
+#include <AP_Progmem.h>
+#include <AP_Param.h>
+#include <AP_Math.h>
+#include <AP_Fence.h>
+#include <AP_HAL.h>
+#include <AP_HAL_AVR.h>
+#include <AP_HAL_AVR_SITL.h>
+#include <AP_HAL_Empty.h>
+
+const AP_HAL::HAL& hal = AP_HAL_BOARD_DRIVER;
+
+/*
+ *  the boundary of the 2010 outback challenge, as in the AP_Math
+ *  polygon test
+ */
+static const Vector2l OBC_boundary[] = {
+    Vector2l(-265695640, 1518373730),
+    Vector2l(-265699560, 1518394050),
+    Vector2l(-265768230, 1518411420),
+    Vector2l(-265773080, 1518403440),
+    Vector2l(-265815110, 1518419500),
+    Vector2l(-265784860, 1518474690),
+    Vector2l(-265994890, 1518528860),
+    Vector2l(-266092110, 1518747420),
+    Vector2l(-266454780, 1518820530),
+    Vector2l(-266435720, 1518303500),
+    Vector2l(-265875990, 1518344050),
+    Vector2l(-265695640, 1518373730)
+};
+
+#define ARRAY_LENGTH(x) (sizeof((x))/sizeof((x)[0]))
+
+// a survey area boundary with many points
+#define SURVEY_POINTS 61
+static Vector2l survey_boundary[SURVEY_POINTS];
+
+static AP_Fence fence;
+
+// check_points - compare fence.inside() with Polygon_outside() over a
+// grid of points around the boundary
+static bool check_points(const Vector2l *V, uint8_t n)
+{
+    bool passed = true;
+    Vector2l min = V[0], max = V[0];
+    for (uint8_t i=1; i<n; i++) {
+        if (V[i].x < min.x) min.x = V[i].x;
+        if (V[i].x > max.x) max.x = V[i].x;
+        if (V[i].y < min.y) min.y = V[i].y;
+        if (V[i].y > max.y) max.y = V[i].y;
+    }
+    int32_t step_x = (max.x - min.x) / 37 + 1;
+    int32_t step_y = (max.y - min.y) / 41 + 1;
+    for (int32_t x = min.x - 3*step_x; x <= max.x + 3*step_x; x += step_x) {
+        for (int32_t y = min.y - 3*step_y; y <= max.y + 3*step_y; y += step_y) {
+            Vector2l P(x, y);
+            if (fence.inside(P) == Polygon_outside(P, V, n)) {
+                hal.console->printf_P(PSTR("FAIL at %ld,%ld\n"), (long)x, (long)y);
+                passed = false;
+            }
+        }
+    }
+    // and every vertex
+    for (uint8_t i=0; i<n; i++) {
+        if (fence.inside(V[i]) == Polygon_outside(V[i], V, n)) {
+            hal.console->printf_P(PSTR("FAIL at vertex %u\n"), (unsigned)i);
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+static void speed_test(const Vector2l *V, uint8_t n)
+{
+    const Vector2l P(V[0].x/2 + V[n/2].x/2, V[0].y/2 + V[n/2].y/2);
+    uint16_t count;
+    uint32_t start_time;
+    volatile bool result;
+
+    start_time = hal.scheduler->micros();
+    for (count=0; count<1000; count++) {
+        result = Polygon_outside(P, V, n);
+    }
+    uint32_t t_polygon = hal.scheduler->micros() - start_time;
+
+    start_time = hal.scheduler->micros();
+    for (count=0; count<1000; count++) {
+        result = fence.inside(P);
+    }
+    uint32_t t_fence = hal.scheduler->micros() - start_time;
+
+    start_time = hal.scheduler->micros();
+    for (count=0; count<1000; count++) {
+        result = fence.distance_to_boundary(P) > 0;
+    }
+    uint32_t t_distance = hal.scheduler->micros() - start_time;
+    (void)result;
+
+    hal.console->printf_P(PSTR("%u points, %u bands: Polygon_outside %luus inside %luus distance %luus per 1000\n"),
+                          (unsigned)n, (unsigned)fence.bands(0),
+                          (unsigned long)t_polygon, (unsigned long)t_fence,
+                          (unsigned long)t_distance);
+}
+
+void setup(void)
+{
+    bool all_passed = true;
+
+    hal.console->println("AP_Fence tests\n");
+
+    fence.clear();
+    if (!fence.add_polygon(OBC_boundary, ARRAY_LENGTH(OBC_boundary), false)) {
+        hal.console->println("add_polygon failed");
+        all_passed = false;
+    }
+    all_passed &= check_points(OBC_boundary, ARRAY_LENGTH(OBC_boundary));
+    speed_test(OBC_boundary, ARRAY_LENGTH(OBC_boundary));
+
+    // an incomplete polygon is refused
+    if (fence.add_polygon(OBC_boundary, ARRAY_LENGTH(OBC_boundary)-1, false)) {
+        hal.console->println("incomplete polygon accepted");
+        all_passed = false;
+    }
+
+    // an exclusion circle of 500m in the middle of the OBC boundary
+    Vector2l center(-266200000, 1518500000);
+    if (!fence.inside(center)) {
+        hal.console->println("center not inside");
+        all_passed = false;
+    }
+    fence.add_circle(center, 500, true);
+    if (fence.inside(center) ||
+        !fence.inside(Vector2l(center.x + 60000, center.y)) ||
+        fabs(fence.distance_to_boundary(center) - 500) > 1) {
+        hal.console->println("exclusion circle FAIL");
+        all_passed = false;
+    }
+
+    // a survey area, roughly round with a wavy edge
+    for (uint8_t i=0; i<SURVEY_POINTS-1; i++) {
+        float angle = radians(i * 360.0f / (SURVEY_POINTS-1));
+        float r = 100000 + ((i & 1) ? 8000 : 0);
+        survey_boundary[i] = Vector2l(-353000000 + r * cos(angle),
+                                      1491000000 + r * sin(angle));
+    }
+    survey_boundary[SURVEY_POINTS-1] = survey_boundary[0];
+    fence.clear();
+    fence.add_polygon(survey_boundary, SURVEY_POINTS, false);
+    all_passed &= check_points(survey_boundary, SURVEY_POINTS);
+    speed_test(survey_boundary, SURVEY_POINTS);
+
+    hal.console->println(all_passed ? "ALL TESTS PASSED" : "TEST FAILED");
+}
+
+void loop(void){}
+
+AP_HAL_MAIN();
@@ -11,6 +11,7 @@
 #include "AP_GPS_MTK19.h"
 #include "AP_GPS_None.h"
 #include "AP_GPS_Auto.h"
+#include "AP_GPS_Blend.h"
 #include "AP_GPS_HIL.h"
 #include "AP_GPS_Shim.h"        // obsoletes AP_GPS_HIL, use in preference
 
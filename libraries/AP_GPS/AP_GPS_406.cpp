@@ -20,6 +20,7 @@ static const char init_str[] = "$PSRF100,0,57600,8,1,0*37";
 // Public Methods ////////////////////////////////////////////////////////////////////
 void AP_GPS_406::init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting)
 {
+    _port = s;
     _change_to_sirf_protocol();         // Changes to SIRF protocol and sets baud rate
     _configure_gps();                           // Function to configure GPS, to output only the desired msg's
 
@@ -5,6 +5,7 @@
 
 #include <AP_HAL.h>
 #include <AP_Common.h>
+#include <string.h>
 
 #include "AP_GPS.h"             // includes AP_GPS_Auto.h
 
@@ -17,7 +18,12 @@ const prog_char AP_GPS_Auto::_sirf_set_binary[]  PROGMEM = SIRF_SET_BINARY;
 
 
 AP_GPS_Auto::AP_GPS_Auto(GPS **gps)  :
-    _gps(gps)
+    _gps(gps),
+    _baud_index(0),
+    _baud_change_ms(0),
+    _baud_bytes(0),
+    _nmea_seen_ms(0),
+    _nmea_last_ms(0)
 {
 }
 
@@ -37,92 +43,117 @@ AP_GPS_Auto::init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting)
 // We detect the real GPS, then update the pointer we have been called through
 // and return.
 //
+// All the protocol recognisers look at every byte, so one pass over the
+// received bytes at each baud rate is enough. The next baud rate is
+// tried after AUTO_BAUD_TIMEOUT_MS, or sooner once AUTO_BAUD_MAX_BYTES
+// have come in without any valid message, which is what a wrong baud
+// rate looks like. Once NMEA has been seen the baud rate is known to be
+// right and is kept for as long as sentences keep coming. A GPS that
+// the config strings have moved to binary at another baud rate stops
+// sending sentences we can read, and the search starts again
+// AUTO_NMEA_WAIT_MS after the last one.
+//
 bool
 AP_GPS_Auto::read(void)
 {
-	static uint32_t last_baud_change_ms;
-	static uint8_t last_baud;
-	GPS *gps;
 	uint32_t now = hal.scheduler->millis();
 
-	if (now - last_baud_change_ms > 1200) {
-		// its been more than 1.2 seconds without detection on this
-		// GPS - switch to another baud rate
-		_port->begin(pgm_read_dword(&baudrates[last_baud]), 256, 16);		
-		last_baud++;
-		last_baud_change_ms = now;
-		if (last_baud == sizeof(baudrates) / sizeof(baudrates[0])) {
-			last_baud = 0;
-		}
-		// write config strings for the types of GPS we support
-		_send_progstr(_port, _mtk_set_binary, sizeof(_mtk_set_binary));
-		_send_progstr(_port, AP_GPS_UBLOX::_ublox_set_binary, AP_GPS_UBLOX::_ublox_set_binary_size);
-		_send_progstr(_port, _sirf_set_binary, sizeof(_sirf_set_binary));
+	if (_baud_change_ms == 0 ||
+		(_nmea_seen_ms == 0 &&
+		 (now - _baud_change_ms > AUTO_BAUD_TIMEOUT_MS ||
+		  _baud_bytes > AUTO_BAUD_MAX_BYTES)) ||
+		(_nmea_seen_ms != 0 &&
+		 now - _nmea_last_ms > AUTO_NMEA_WAIT_MS)) {
+		_next_baud(now);
 	}
 
 	_update_progstr();
 
-	if (NULL != (gps = _detect())) {
-		// configure the detected GPS
-		gps->init(_port, _nav_setting);
-		hal.console->println_P(PSTR("OK"));
-		*_gps = gps;
-		return true;
-    }
-    return false;
+	int16_t available = _port->available();
+	while (available-- > 0) {
+		GPS *gps = _detect(_port->read(), now);
+		if (gps != NULL) {
+			// configure the detected GPS
+			gps->set_rate(_rate_hz);
+			gps->init(_port, _nav_setting);
+			hal.console->println_P(PSTR("OK"));
+			*_gps = gps;
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+AP_GPS_Auto::_next_baud(uint32_t now)
+{
+	_port->begin(pgm_read_dword(&baudrates[_baud_index]), 256, 16);
+	_baud_index++;
+	if (_baud_index == sizeof(baudrates) / sizeof(baudrates[0])) {
+		_baud_index = 0;
+	}
+	_baud_change_ms = now;
+	_baud_bytes = 0;
+	_nmea_seen_ms = 0;
+
+	// bytes from the last baud rate mean nothing at this one
+	memset(&_detect_state, 0, sizeof(_detect_state));
+
+	_send_config();
+}
+
+// write config strings for the types of GPS we support
+void
+AP_GPS_Auto::_send_config(void)
+{
+	_send_progstr(_port, _mtk_set_binary, sizeof(_mtk_set_binary));
+	_send_progstr(_port, AP_GPS_UBLOX::_ublox_set_binary, AP_GPS_UBLOX::_ublox_set_binary_size);
+	_send_progstr(_port, _sirf_set_binary, sizeof(_sirf_set_binary));
 }
 
 //
 // Perform one iteration of the auto-detection process.
 //
 GPS *
-AP_GPS_Auto::_detect(void)
+AP_GPS_Auto::_detect(uint8_t data, uint32_t now)
 {
-	static uint32_t detect_started_ms;
-	GPS *new_gps = NULL;
+	_baud_bytes++;
 
-	if (detect_started_ms == 0 && _port->available() > 0) {
-		detect_started_ms = hal.scheduler->millis();
+	if (AP_GPS_UBLOX::_detect(_detect_state.ublox, data)) {
+		hal.console->print_P(PSTR(" ublox "));
+		return new AP_GPS_UBLOX();
+	}
+	if (AP_GPS_MTK19::_detect(_detect_state.mtk19, data)) {
+		hal.console->print_P(PSTR(" MTK19 "));
+		return new AP_GPS_MTK19();
+	}
+	if (AP_GPS_MTK::_detect(_detect_state.mtk, data)) {
+		hal.console->print_P(PSTR(" MTK "));
+		return new AP_GPS_MTK();
 	}
-
-	while (_port->available() > 0 && new_gps == NULL) {
-		uint8_t data = _port->read();
-		if (AP_GPS_UBLOX::_detect(data)) {
-			hal.console->print_P(PSTR(" ublox "));
-			new_gps = new AP_GPS_UBLOX();
-		} 
-		else if (AP_GPS_MTK19::_detect(data)) {
-			hal.console->print_P(PSTR(" MTK19 "));
-			new_gps = new AP_GPS_MTK19();
-		} 
-		else if (AP_GPS_MTK::_detect(data)) {
-			hal.console->print_P(PSTR(" MTK "));
-			new_gps = new AP_GPS_MTK();
-		}
 #if !defined( __AVR_ATmega1280__ )
-		// save a bit of code space on a 1280
-		else if (AP_GPS_SIRF::_detect(data)) {
-			hal.console->print_P(PSTR(" SIRF "));
-			new_gps = new AP_GPS_SIRF();
-		}
-		else if (hal.scheduler->millis() - detect_started_ms > 5000) {
-			// prevent false detection of NMEA mode in
-			// a MTK or UBLOX which has booted in NMEA mode
-			if (AP_GPS_NMEA::_detect(data)) {
-				hal.console->print_P(PSTR(" NMEA "));
-				new_gps = new AP_GPS_NMEA();
-			}
-		}
-#endif
+	// save a bit of code space on a 1280
+	if (AP_GPS_SIRF::_detect(_detect_state.sirf, data)) {
+		hal.console->print_P(PSTR(" SIRF "));
+		return new AP_GPS_SIRF();
 	}
-
-	if (new_gps != NULL) {
-		new_gps->init(_port);
+	if (AP_GPS_NMEA::_detect(_detect_state.nmea, data)) {
+		// a whole valid message, so the bytes before it don't count
+		// against the baud rate
+		_baud_bytes = 0;
+		_nmea_last_ms = now;
+		if (_nmea_seen_ms == 0) {
+			// the baud rate is right, and the GPS is up to hear the
+			// config strings. Send them again and give a uBlox or MTK
+			// in NMEA mode time to switch to binary, to prevent false
+			// detection of NMEA
+			_nmea_seen_ms = now;
+			_send_config();
+		} else if (now - _nmea_seen_ms > AUTO_NMEA_WAIT_MS) {
+			hal.console->print_P(PSTR(" NMEA "));
+			return new AP_GPS_NMEA();
+		}
 	}
-
-	return new_gps;
+#endif
+	return NULL;
 }
-
-
-
-
@@ -8,6 +8,24 @@
 
 #include <AP_HAL.h>
 #include "GPS.h"
+#include "AP_GPS_UBLOX.h"
+#include "AP_GPS_MTK.h"
+#include "AP_GPS_MTK19.h"
+#include "AP_GPS_SIRF.h"
+#include "AP_GPS_NMEA.h"
+
+// time to listen at each baud rate before trying the next
+#define AUTO_BAUD_TIMEOUT_MS    1200
+
+// bytes received at one baud rate without a valid message of any
+// protocol before trying the next. Every protocol sends a complete
+// message well within this, so more bytes means the baud rate is wrong
+#define AUTO_BAUD_MAX_BYTES     400
+
+// time to wait after NMEA is first seen for a uBlox or MTK, which boots
+// in NMEA, to switch to binary on the config strings. Also how long the
+// baud rate is kept after the last NMEA sentence
+#define AUTO_NMEA_WAIT_MS       2000
 
 class AP_GPS_Auto : public GPS
 {
@@ -36,9 +54,40 @@ private:
     ///
     GPS **     _gps;
 
-    /// low-level auto-detect routine
+    /// switch to the next baud rate and start detection again
+    ///
+    void                            _next_baud(uint32_t now);
+
+    /// send the config strings that switch each protocol to binary
+    ///
+    void                            _send_config(void);
+
+    /// run every protocol recogniser over one byte, returning the new
+    /// driver if one of them matches
+    ///
+    GPS *                           _detect(uint8_t data, uint32_t now);
+
+    /// the recognisers, all fed the same bytes
+    ///
+    struct {
+        AP_GPS_UBLOX::detect_state  ublox;
+        AP_GPS_MTK19::detect_state  mtk19;
+        AP_GPS_MTK::detect_state    mtk;
+        AP_GPS_SIRF::detect_state   sirf;
+        AP_GPS_NMEA::detect_state   nmea;
+    } _detect_state;
+
+    uint8_t                         _baud_index;
+    uint32_t                        _baud_change_ms;
+    uint16_t                        _baud_bytes;
+
+    /// when NMEA was first seen at this baud rate, or zero
+    ///
+    uint32_t                        _nmea_seen_ms;
+
+    /// when the last NMEA sentence was seen
     ///
-    GPS *                           _detect(void);
+    uint32_t                        _nmea_last_ms;
 
     static const prog_char          _mtk_set_binary[];
     static const prog_char          _sirf_set_binary[];
@@ -0,0 +1,179 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: t -*-
+
+/// @file	AP_GPS_Blend.cpp
+/// @brief	Pseudo-GPS driver blending the solutions of two receivers.
+
+#include <AP_HAL.h>
+#include <AP_Common.h>
+#include <AP_Math.h>
+
+#include "AP_GPS_Blend.h"
+
+extern const AP_HAL::HAL& hal;
+
+// metres in a latitude step of 1e-7 degrees
+#define LATLON_TO_M 0.01113195f
+
+AP_GPS_Blend::AP_GPS_Blend(GPS **gps1, GPS **gps2) :
+    _primary(0),
+    _fade_start_ms(0)
+{
+    _gps[0] = gps1;
+    _gps[1] = gps2;
+    _last_weight[0] = _last_weight[1] = 0;
+}
+
+void
+AP_GPS_Blend::init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting)
+{
+    _port = s;
+    _nav_setting = nav_setting;
+    _primary = 0;
+    _last_weight[0] = _last_weight[1] = 0;
+    _fade.zero();
+    _have_raw_velocity = true;
+    idleTimeout = 1200;
+}
+
+bool
+AP_GPS_Blend::read(void)
+{
+    uint32_t now = hal.scheduler->millis();
+    GPS *gps[2];
+    float weight[2];
+    float total_weight = 0;
+    bool new_fix = false;
+
+    for (uint8_t i=0; i<2; i++) {
+        gps[i] = *_gps[i];
+        gps[i]->update();
+        if (gps[i]->new_data) {
+            gps[i]->new_data = false;
+            new_fix = true;
+        }
+
+        weight[i] = 0;
+        if (gps[i]->status() == GPS::GPS_OK &&
+            now - gps[i]->last_fix_time < BLEND_TIMEOUT_MS) {
+            float rx_hdop = gps[i]->hdop > 0 ? gps[i]->hdop : BLEND_HDOP_DEFAULT;
+            weight[i] = 1.0f / (rx_hdop * rx_hdop);
+            total_weight += weight[i];
+        }
+    }
+
+    if (!new_fix) {
+        return false;
+    }
+    if (total_weight == 0) {
+        _primary = 0;
+        _last_weight[0] = _last_weight[1] = 0;
+        _fade.zero();
+        fix = false;
+        return true;
+    }
+
+    uint8_t p = weight[1] > weight[0] ? 1 : 0;
+    GPS *ref = gps[p];
+    _primary = p + 1;
+
+    // blend the fixes as offsets in metres north, east and up from the
+    // primary fix, each moved on by its velocity to now, which is the
+    // time the blended fix is given
+    float lng_scale = cos(ToRad(ref->latitude * 1.0e-7f));
+    float share[2];
+    Vector3f pos[2];
+    Vector3f blend;
+    float vel_north = 0, vel_east = 0, vel_down = 0;
+    for (uint8_t i=0; i<2; i++) {
+        share[i] = weight[i] / total_weight;
+        if (weight[i] == 0) {
+            continue;
+        }
+        float dt = (now - gps[i]->last_fix_time) * 1.0e-3f;
+        pos[i].x = (gps[i]->latitude - ref->latitude) * LATLON_TO_M +
+                   gps[i]->velocity_north() * dt;
+        pos[i].y = (gps[i]->longitude - ref->longitude) * LATLON_TO_M * lng_scale +
+                   gps[i]->velocity_east() * dt;
+        pos[i].z = gps[i]->altitude * 0.01f - gps[i]->velocity_down() * dt;
+        blend     += pos[i] * share[i];
+        vel_north += share[i] * gps[i]->velocity_north();
+        vel_east  += share[i] * gps[i]->velocity_east();
+        vel_down  += share[i] * gps[i]->velocity_down();
+    }
+
+    // the part of the last switch still to be faded out
+    Vector3f fade;
+    uint32_t fade_ms = now - _fade_start_ms;
+    if (fade_ms < BLEND_FADE_MS) {
+        fade = _fade * (1.0f - fade_ms / (float)BLEND_FADE_MS);
+    }
+
+    // on a switch, work out where the blend would be with the old
+    // weights, from the receivers still in it less their offsets from
+    // it, and fade the difference out rather than stepping to the new
+    // position
+    bool switched = false;
+    for (uint8_t i=0; i<2; i++) {
+        if (fabs(share[i] - _last_weight[i]) > BLEND_SWITCH_WEIGHT) {
+            switched = true;
+        }
+    }
+    if (switched) {
+        Vector3f old_blend;
+        float old_total = 0;
+        for (uint8_t i=0; i<2; i++) {
+            if (weight[i] != 0 && _last_weight[i] != 0) {
+                old_blend += (pos[i] - _rx_offset[i]) * _last_weight[i];
+                old_total += _last_weight[i];
+            }
+        }
+        if (old_total > 0) {
+            fade += old_blend / old_total - blend;
+            _fade = fade;
+            _fade_start_ms = now;
+        }
+    }
+
+    for (uint8_t i=0; i<2; i++) {
+        if (weight[i] != 0) {
+            _rx_offset[i] = pos[i] - blend;
+        }
+        _last_weight[i] = share[i];
+    }
+
+    blend += fade;
+
+    // the offsets are added as whole steps of 1e-7 degrees, as adding
+    // them to the position as a float, as location_offset() does, would
+    // round it to a metre or so
+    latitude        = ref->latitude + (int32_t)(blend.x / LATLON_TO_M);
+    longitude       = ref->longitude + (int32_t)(blend.y / (LATLON_TO_M * lng_scale));
+    altitude        = blend.z * 100;
+    _vel_north      = vel_north * 100;
+    _vel_east       = vel_east * 100;
+    _vel_down       = vel_down * 100;
+    ground_speed    = pythagorous2(vel_north, vel_east) * 100;
+    ground_course   = ToDeg(atan2(vel_east, vel_north)) * 100;
+    if (ground_course < 0) {
+        ground_course += 36000;
+    }
+    speed_3d        = pythagorous3(vel_north, vel_east, vel_down) * 100;
+
+    // HDOPs combine as standard deviations do
+    hdop            = 1.0f / sqrt(total_weight);
+
+    // the receivers' clocks can't be mixed, so time and the rest are
+    // those of the primary
+    time            = ref->time;
+    date            = ref->date;
+    num_sats        = ref->num_sats;
+    _epoch          = ref->epoch();
+    fix             = true;
+    return true;
+}
+
+float
+AP_GPS_Blend::get_lag()
+{
+    return (*_gps[_primary == 2 ? 1 : 0])->get_lag();
+}
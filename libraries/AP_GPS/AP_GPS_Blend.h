@@ -0,0 +1,90 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: t -*-
+//
+// Pseudo-GPS driver blending the solutions of two receivers
+//
+
+#ifndef __AP_GPS_BLEND_H__
+#define __AP_GPS_BLEND_H__
+
+#include <AP_HAL.h>
+#include <AP_Math.h>
+#include "GPS.h"
+
+// a receiver with no fix for this long is left out of the blend. Long
+// enough for a fix or two to be late at 5Hz, short enough that the
+// vehicle moves on to the other receiver well within its own idle
+// timeout
+#define BLEND_TIMEOUT_MS        500
+
+// HDOP, in cm, to weight a receiver that doesn't report one by
+#define BLEND_HDOP_DEFAULT      200
+
+// a change in a receiver's share of the weight bigger than this, such as
+// a receiver dropping out or coming back, is taken as a switch. The step
+// it would make in the position is taken out and faded back in over
+// BLEND_FADE_MS
+#define BLEND_SWITCH_WEIGHT     0.1f
+#define BLEND_FADE_MS           1000
+
+class AP_GPS_Blend : public GPS
+{
+public:
+    /// Constructor
+    ///
+    /// @param	gps1	Pointer to the GPS * of the first receiver. This may
+    ///					be changed under us, eg by AP_GPS_Auto.
+    /// @param	gps2	Pointer to the GPS * of the second receiver.
+    ///
+    AP_GPS_Blend(GPS **gps1, GPS **gps2);
+
+    /// Start blending afresh.
+    ///
+    /// The receivers are set up on their own ports by the caller, so
+    /// the port is not used.
+    ///
+    virtual void        init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting = GPS_ENGINE_NONE);
+
+    /// Update both receivers, and blend their latest fixes whenever
+    /// either has a new one.
+    ///
+    /// Each receiver with a fix from the last BLEND_TIMEOUT_MS is
+    /// weighted by the inverse square of its HDOP. Its position is
+    /// moved on by its velocity to the present, so that fixes taken at
+    /// different times can be averaged. A receiver that loses its fix
+    /// drops out at its next message, and one that stops sending drops
+    /// out after BLEND_TIMEOUT_MS, leaving the solution to the other.
+    ///
+    /// Each receiver's offset from the blended position is tracked, so
+    /// that when one drops out, comes back or its weight jumps the
+    /// position does not step by its offset. The step is faded in over
+    /// BLEND_FADE_MS instead.
+    ///
+    virtual bool        read(void);
+
+    /// the lag of the receiver with the most weight
+    ///
+    virtual float       get_lag();
+
+    /// The receiver with the most weight in the last solution, 1 or 2,
+    /// or 0 when neither has a fix.
+    ///
+    uint8_t             primary(void) {
+        return _primary;
+    }
+
+private:
+    GPS **              _gps[2];
+    uint8_t             _primary;
+
+    // each receiver's share of the weight in the last solution, and its
+    // offset from the blended position then, north, east and up in metres
+    float               _last_weight[2];
+    Vector3f            _rx_offset[2];
+
+    // what is still to be faded out of the position since the last
+    // switch, north, east and up in metres, as it was at _fade_start_ms
+    Vector3f            _fade;
+    uint32_t            _fade_start_ms;
+};
+
+#endif // __AP_GPS_BLEND_H__
@@ -22,7 +22,14 @@ class AP_GPS_MTK : public GPS {
 public:
     virtual void        init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting = GPS_ENGINE_NONE);
     virtual bool        read(void);
-    static bool _detect(uint8_t );
+    // the state of _detect(), see AP_GPS_UBLOX::detect_state
+    struct detect_state {
+        uint8_t  payload_counter;
+        uint8_t  step;
+        uint8_t  ck_a;
+        uint8_t  ck_b;
+    };
+    static bool _detect(struct detect_state &state, uint8_t data);
 
 private:
     #pragma pack(push,1)
@@ -61,7 +68,7 @@ private:
     // Receive buffer
     union {
         diyd_mtk_msg msg;
-        uint8_t bytes[];
+        uint8_t bytes[sizeof(diyd_mtk_msg)];
     } _buffer;
 
     // Buffer parse & GPS state update
@@ -26,13 +26,18 @@ AP_GPS_MTK19::init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting)
 {
 	_port = s;
     _port->flush();
+    _framer.init(_frame_buf, sizeof(_frame_buf), PREAMBLE2, 1, _frame_check);
 
     // initialize serial port for binary protocol use
     // XXX should assume binary, let GPS_AUTO handle dynamic config?
     _port->print(MTK_SET_BINARY);
 
-    // set 5Hz update rate
-    _port->print(MTK_OUTPUT_5HZ);
+    // set 10Hz update rate if asked for, otherwise 5Hz
+    if (_rate_hz == 10) {
+        _port->print(MTK_OUTPUT_10HZ);
+    } else {
+        _port->print(MTK_OUTPUT_5HZ);
+    }
 
     // set SBAS on
     _port->print(SBAS_ON);
@@ -45,6 +50,7 @@ AP_GPS_MTK19::init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting)
 
     // set initial epoch code
     _epoch = TIME_OF_DAY;
+    _have_time_ms = true;
     _time_offset = 0;
     _offset_calculated = false;
     idleTimeout = 1200;
@@ -52,111 +58,44 @@ AP_GPS_MTK19::init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting)
 
 // Process bytes available from the stream
 //
-// The stream is assumed to contain only our custom message.  If it
-// contains other messages, and those messages contain the preamble bytes,
-// it is possible for this code to become de-synchronised.  Without
-// buffering the entire message and re-processing it from the top,
-// this is unavoidable.
-//
-// The lack of a standard header length field makes it impossible to skip
-// unrecognised messages.
+// The framer only hands us whole messages with a good checksum, see
+// GPS_Framer.h. The lack of a standard header length field makes it
+// impossible to skip unrecognised messages.
 //
 bool
 AP_GPS_MTK19::read(void)
 {
-    uint8_t data;
-    int16_t numc;
+    const uint8_t *frame;
+    uint16_t length;
     bool parsed = false;
 
-    numc = _port->available();
-    for (int16_t i = 0; i < numc; i++) {        // Process bytes received
-
-        // read the next byte
-        data = _port->read();
-
-restart:
-        switch(_step) {
-
-        // Message preamble, class, ID detection
-        //
-        // If we fail to match any of the expected bytes, we
-        // reset the state machine and re-consider the failed
-        // byte as the first byte of the preamble.  This
-        // improves our chances of recovering from a mismatch
-        // and makes it less likely that we will be fooled by
-        // the preamble appearing as data in some other message.
-        //
-        case 0:
-            if (data == PREAMBLE1_V16) {
-                _mtk_revision     = MTK_GPS_REVISION_V16;
-                _step++;
-            } else if (data == PREAMBLE1_V19) {
-                _mtk_revision     = MTK_GPS_REVISION_V19;
-                _step++;
-            }    
-            break;
-        case 1:
-            if (data == PREAMBLE2) {
-                _step++;
-            } else {
-				_step = 0;
-				goto restart;
-			}
-			break;
-        case 2:
-            if (sizeof(_buffer) == data) {
-                _step++;
-                _ck_b = _ck_a       = data;                    // reset the checksum accumulators
-                _payload_counter    = 0;
+    while (_framer.fill(_port)) {
+        while ((frame = _framer.next(length)) != NULL) {
+            if (frame[0] == PREAMBLE1_V16) {
+                _mtk_revision = MTK_GPS_REVISION_V16;
             } else {
-                _step               = 0;                       // reset and wait for a message of the right class
-                goto restart;
-            }
-            break;
-
-        // Receive message data
-        //
-        case 3:
-            _buffer.bytes[_payload_counter++] = data;
-            _ck_b += (_ck_a += data);
-            if (_payload_counter == sizeof(_buffer)) {
-                _step++;
-			}
-            break;
-
-        // Checksum and message processing
-        //
-        case 4:
-            _step++;
-            if (_ck_a != data) {
-                _step               = 0;
-				goto restart;
-            }
-            break;
-        case 5:
-            _step                   = 0;
-            if (_ck_b != data) {
-				goto restart;
+                _mtk_revision = MTK_GPS_REVISION_V19;
             }
+            const struct diyd_mtk_msg &msg = *(const struct diyd_mtk_msg *)&frame[3];
 
-            fix                     = ((_buffer.msg.fix_type == FIX_3D) ||
-                                       (_buffer.msg.fix_type == FIX_3D_SBAS));                   
+            fix                     = ((msg.fix_type == FIX_3D) ||
+                                       (msg.fix_type == FIX_3D_SBAS));                   
             if (_mtk_revision == MTK_GPS_REVISION_V16) {
-                latitude            = _buffer.msg.latitude  * 10;  // V16, V17,V18 doc says *10e7 but device says otherwise
-                longitude           = _buffer.msg.longitude * 10;  // V16, V17,V18 doc says *10e7 but device says otherwise
+                latitude            = msg.latitude  * 10;  // V16, V17,V18 doc says *10e7 but device says otherwise
+                longitude           = msg.longitude * 10;  // V16, V17,V18 doc says *10e7 but device says otherwise
             } else {
-				latitude            = _buffer.msg.latitude;
-				longitude           = _buffer.msg.longitude;
+				latitude            = msg.latitude;
+				longitude           = msg.longitude;
 			}
-            altitude                = _buffer.msg.altitude;
-            ground_speed            = _buffer.msg.ground_speed;
-            ground_course           = _buffer.msg.ground_course;
-            num_sats                = _buffer.msg.satellites;
-            hdop                    = _buffer.msg.hdop;
-            date                    = _buffer.msg.utc_date;
+            altitude                = msg.altitude;
+            ground_speed            = msg.ground_speed;
+            ground_course           = msg.ground_course;
+            num_sats                = msg.satellites;
+            hdop                    = msg.hdop;
+            date                    = msg.utc_date;
 
             // time from gps is UTC, but convert here to msToD
-            int32_t time_utc        = _buffer.msg.utc_time;
+            int32_t time_utc        = msg.utc_time;
             int32_t temp            = (time_utc/10000000);
             time_utc               -= temp*10000000;
             time                    = temp * 3600000;
@@ -178,57 +117,88 @@ restart:
     return parsed;
 }
 
+/*
+  check for a message at the start of buf: a revision preamble, the
+  second preamble, the payload length, which must be that of our one
+  message, the payload and a two byte Fletcher checksum over the length
+  and payload
+ */
+GPS_Framer::Frame_Status
+AP_GPS_MTK19::_frame_check(const uint8_t *buf, uint16_t len, uint16_t &length)
+{
+    if (buf[0] != PREAMBLE1_V16 && buf[0] != PREAMBLE1_V19) {
+        return GPS_Framer::FRAME_BAD;
+    }
+    if (len < 3) {
+        return GPS_Framer::FRAME_PARTIAL;
+    }
+    if (buf[2] != sizeof(struct diyd_mtk_msg)) {
+        return GPS_Framer::FRAME_BAD;
+    }
+    if (len < sizeof(struct diyd_mtk_msg) + 5) {
+        return GPS_Framer::FRAME_PARTIAL;
+    }
+
+    uint8_t ck_a = 0, ck_b = 0;
+    const uint8_t *p = &buf[2];
+    const uint8_t *end = &buf[3 + sizeof(struct diyd_mtk_msg)];
+    while (p != end) {
+        ck_b += (ck_a += *p++);
+    }
+    if (p[0] != ck_a || p[1] != ck_b) {
+        return GPS_Framer::FRAME_BAD;
+    }
+    length = sizeof(struct diyd_mtk_msg) + 5;
+    return GPS_Framer::FRAME_OK;
+}
+
 
 /*
   detect a MTK16 or MTK19 GPS
  */
 bool
-AP_GPS_MTK19::_detect(uint8_t data)
+AP_GPS_MTK19::_detect(struct detect_state &state, uint8_t data)
 {
-    static uint8_t payload_counter;
-    static uint8_t step;
-    static uint8_t ck_a, ck_b;
-
 restart:
-	switch (step) {
+	switch (state.step) {
         case 0:
-            ck_b = ck_a = payload_counter = 0;
+            state.ck_b = state.ck_a = state.payload_counter = 0;
             if (data == PREAMBLE1_V16 || data == PREAMBLE1_V19) {
-                step++;
+                state.step++;
             }    
             break;
         case 1:
             if (PREAMBLE2 == data) {
-                step++;
+                state.step++;
             } else {
-				step = 0;
+				state.step = 0;
 				goto restart;
 			}
 			break;
         case 2:
             if (data == sizeof(struct diyd_mtk_msg)) {
-                step++;
-                ck_b = ck_a         = data;
+                state.step++;
+                state.ck_b = state.ck_a         = data;
             } else {
-                step                = 0;
+                state.step                = 0;
 				goto restart;
             }
             break;
         case 3:
-            ck_b += (ck_a += data);
-            if (++payload_counter == sizeof(struct diyd_mtk_msg))
-                step++;
+            state.ck_b += (state.ck_a += data);
+            if (++state.payload_counter == sizeof(struct diyd_mtk_msg))
+                state.step++;
             break;
         case 4:
-            step++;
-            if (ck_a != data) {
-                step 				= 0;
+            state.step++;
+            if (state.ck_a != data) {
+                state.step 				= 0;
 				goto restart;
             }
             break;
         case 5:
-            step                    = 0;
-            if (ck_b != data) {
+            state.step                    = 0;
+            if (state.ck_b != data) {
 				goto restart;
 			}
 			return true;
@@ -15,6 +15,7 @@
 
 #include "GPS.h"
 #include "AP_GPS_MTK_Common.h"
+#include "GPS_Framer.h"
 
 #define MTK_GPS_REVISION_V16  16
 #define MTK_GPS_REVISION_V19  19
@@ -25,7 +26,14 @@ public:
     AP_GPS_MTK19();
     virtual void        init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting = GPS_ENGINE_NONE);
     virtual bool        read(void);
-    static bool 		_detect(uint8_t );
+    // the state of _detect(), see AP_GPS_UBLOX::detect_state
+    struct detect_state {
+        uint8_t  payload_counter;
+        uint8_t  step;
+        uint8_t  ck_a;
+        uint8_t  ck_b;
+    };
+    static bool _detect(struct detect_state &state, uint8_t data);
 
 private:
 	#pragma pack(push,1)
@@ -56,24 +64,17 @@ private:
         PREAMBLE2     = 0xdd,
     };
 
-    // Packet checksum accumulators
-    uint8_t         _ck_a;
-    uint8_t         _ck_b;
-
-    // State machine state
-    uint8_t         _step;
-    uint8_t         _payload_counter;
 	uint8_t			_mtk_revision;
 
     // Time from UNIX Epoch offset
     long            _time_offset;
     bool            _offset_calculated;
 
-    // Receive buffer
-    union {
-        diyd_mtk_msg msg;
-        uint8_t bytes[];
-    } _buffer;
+    // Receive buffer, big enough for a message and the start of the next
+    uint8_t         _frame_buf[64];
+    GPS_Framer      _framer;
+
+    static GPS_Framer::Frame_Status _frame_check(const uint8_t *buf, uint16_t len, uint16_t &length);
 };
 
 #endif  // AP_GPS_MTK19_H
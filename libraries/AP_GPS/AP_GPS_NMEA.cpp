@@ -31,6 +31,7 @@
 #include <ctype.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "AP_GPS_NMEA.h"
 
@@ -94,6 +95,7 @@ const char AP_GPS_NMEA::_gpvtg_string[] PROGMEM = "GPVTG";
 void AP_GPS_NMEA::init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting)
 {
 	_port = s;
+    _framer.init(_frame_buf, sizeof(_frame_buf), '$', 0, _frame_check);
 
     // send the SiRF init strings
     _port->print_P((const prog_char_t *)_SiRF_init_string);
@@ -109,53 +111,80 @@ void AP_GPS_NMEA::init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_settin
 
 bool AP_GPS_NMEA::read(void)
 {
-    int16_t numc;
+    const uint8_t *frame;
+    uint16_t length;
     bool parsed = false;
 
-    numc = _port->available();
-    while (numc--) {
-        if (_decode(_port->read())) {
-            parsed = true;
+    while (_framer.fill(_port)) {
+        while ((frame = _framer.next(length)) != NULL) {
+            if (_decode((const char *)frame, length)) {
+                parsed = true;
+            }
         }
     }
     return parsed;
 }
 
-bool AP_GPS_NMEA::_decode(char c)
+bool AP_GPS_NMEA::_decode(const char *sentence, uint16_t length)
 {
-    bool valid_sentence = false;
-
-    switch (c) {
-    case ',': // term terminators
-        _parity ^= c;
-    case '\r':
-    case '\n':
-    case '*':
-        if (_term_offset < sizeof(_term)) {
-            _term[_term_offset] = 0;
-            valid_sentence = _term_complete();
+    // the terms are between the '$' and the '*'
+    const char *p = sentence + 1;
+    const char *end = sentence + length - 3;
+
+    _sentence_type = _GPS_SENTENCE_OTHER;
+    _gps_data_good = false;
+
+    for (_term_number = 0; ; _term_number++) {
+        const char *q = (const char *)memchr(p, ',', end - p);
+        if (q == NULL) {
+            q = end;
+        }
+        uint8_t len = sizeof(_term) - 1;
+        if (q - p < len) {
+            len = q - p;
         }
-        ++_term_number;
-        _term_offset = 0;
-        _is_checksum_term = c == '*';
-        return valid_sentence;
-
-    case '$': // sentence begin
-        _term_number = _term_offset = 0;
-        _parity = 0;
-        _sentence_type = _GPS_SENTENCE_OTHER;
-        _is_checksum_term = false;
-        _gps_data_good = false;
-        return valid_sentence;
+        memcpy(_term, p, len);
+        _term[len] = 0;
+        _term_complete();
+        if (q == end) {
+            break;
+        }
+        p = q + 1;
     }
 
-    // ordinary characters
-    if (_term_offset < sizeof(_term) - 1)
-        _term[_term_offset++] = c;
-    if (!_is_checksum_term)
-        _parity ^= c;
+    return _sentence_complete();
+}
 
-    return valid_sentence;
+/*
+  check for a NMEA sentence at the start of buf: a '$', the sentence,
+  a '*' and two hex digits of the XOR of the bytes between the '$' and
+  the '*'. A '$' or line end before the '*' means the sentence was cut
+  short
+ */
+GPS_Framer::Frame_Status
+AP_GPS_NMEA::_frame_check(const uint8_t *buf, uint16_t len, uint16_t &length)
+{
+    uint8_t parity = 0;
+    uint16_t i;
+
+    for (i = 1; i < len; i++) {
+        uint8_t c = buf[i];
+        if (c == '*') {
+            break;
+        }
+        if (c == '$' || c == '\r' || c == '\n') {
+            return GPS_Framer::FRAME_BAD;
+        }
+        parity ^= c;
+    }
+    if (i + 3 > len) {
+        return GPS_Framer::FRAME_PARTIAL;
+    }
+    if (16 * _from_hex(buf[i+1]) + _from_hex(buf[i+2]) != parity) {
+        return GPS_Framer::FRAME_BAD;
+    }
+    length = i + 3;
+    return GPS_Framer::FRAME_OK;
 }
 
 //
@@ -228,56 +257,52 @@ uint32_t AP_GPS_NMEA::_parse_degrees()
     return ret;
 }
 
-// Processes a just-completed term
-// Returns true if new sentence has just passed checksum test and is validated
-bool AP_GPS_NMEA::_term_complete()
+// Processes a sentence once all its terms have been processed
+// Returns true as the sentence has passed its checksum test
+bool AP_GPS_NMEA::_sentence_complete()
 {
-    // handle the last term in a message
-    if (_is_checksum_term) {
-        uint8_t checksum = 16 * _from_hex(_term[0]) + _from_hex(_term[1]);
-        if (checksum == _parity) {
-            if (_gps_data_good) {
-                switch (_sentence_type) {
-                case _GPS_SENTENCE_GPRMC:
-                    time                        = _new_time;
-                    date                        = _new_date;
-                    latitude            = _new_latitude * 10;   // degrees*10e5 -> 10e7
-                    longitude           = _new_longitude * 10;  // degrees*10e5 -> 10e7
-                    ground_speed        = _new_speed;
-                    ground_course       = _new_course;
-                    fix                         = true;
-                    break;
-                case _GPS_SENTENCE_GPGGA:
-                    altitude            = _new_altitude;
-                    time                        = _new_time;
-                    latitude            = _new_latitude * 10;   // degrees*10e5 -> 10e7
-                    longitude           = _new_longitude * 10;  // degrees*10e5 -> 10e7
-                    num_sats            = _new_satellite_count;
-                    hdop                        = _new_hdop;
-                    fix                         = true;
-                    break;
-                case _GPS_SENTENCE_GPVTG:
-                    ground_speed        = _new_speed;
-                    ground_course       = _new_course;
-                    // VTG has no fix indicator, can't change fix status
-                    break;
-                }
-            } else {
-                switch (_sentence_type) {
-                case _GPS_SENTENCE_GPRMC:
-                case _GPS_SENTENCE_GPGGA:
-                    // Only these sentences give us information about
-                    // fix status.
-                    fix = false;
-                }
-            }
-            // we got a good message
-            return true;
+    if (_gps_data_good) {
+        switch (_sentence_type) {
+        case _GPS_SENTENCE_GPRMC:
+            time                        = _new_time;
+            date                        = _new_date;
+            latitude            = _new_latitude * 10;   // degrees*10e5 -> 10e7
+            longitude           = _new_longitude * 10;  // degrees*10e5 -> 10e7
+            ground_speed        = _new_speed;
+            ground_course       = _new_course;
+            fix                         = true;
+            break;
+        case _GPS_SENTENCE_GPGGA:
+            altitude            = _new_altitude;
+            time                        = _new_time;
+            latitude            = _new_latitude * 10;   // degrees*10e5 -> 10e7
+            longitude           = _new_longitude * 10;  // degrees*10e5 -> 10e7
+            num_sats            = _new_satellite_count;
+            hdop                        = _new_hdop;
+            fix                         = true;
+            break;
+        case _GPS_SENTENCE_GPVTG:
+            ground_speed        = _new_speed;
+            ground_course       = _new_course;
+            // VTG has no fix indicator, can't change fix status
+            break;
+        }
+    } else {
+        switch (_sentence_type) {
+        case _GPS_SENTENCE_GPRMC:
+        case _GPS_SENTENCE_GPGGA:
+            // Only these sentences give us information about
+            // fix status.
+            fix = false;
         }
-        // we got a bad message, ignore it
-        return false;
     }
+    // we got a good message
+    return true;
+}
 
+// Processes a just-completed term
+void AP_GPS_NMEA::_term_complete()
+{
     // the first term determines the sentence type
     if (_term_number == 0) {
         if (!strcmp_P(_term, _gprmc_string)) {
@@ -292,7 +317,7 @@ bool AP_GPS_NMEA::_term_complete()
         } else {
             _sentence_type = _GPS_SENTENCE_OTHER;
         }
-        return false;
+        return;
     }
 
     // 32 = RMC, 64 = GGA, 96 = VTG
@@ -362,8 +387,6 @@ bool AP_GPS_NMEA::_term_complete()
             break;
         }
     }
-
-    return false;
 }
 
 #define hexdigit(x) ((x)>9?'A'+(x):'0'+(x))
@@ -373,37 +396,34 @@ bool AP_GPS_NMEA::_term_complete()
   matches a NMEA string
  */
 bool
-AP_GPS_NMEA::_detect(uint8_t data)
+AP_GPS_NMEA::_detect(struct detect_state &state, uint8_t data)
 {
-	static uint8_t step;
-	static uint8_t ck;
-
-	switch (step) {
+	switch (state.step) {
 	case 0:
-		ck = 0;
+		state.ck = 0;
 		if ('$' == data) {
-			step++;
+			state.step++;
 		}
 		break;
 	case 1:
 		if ('*' == data) {
-			step++;
+			state.step++;
 		} else {
-			ck ^= data;
+			state.ck ^= data;
 		}
 		break;
 	case 2:
-		if (hexdigit(ck>>4) == data) {
-			step++;
+		if (hexdigit(state.ck>>4) == data) {
+			state.step++;
 		} else {
-			step = 0;
+			state.step = 0;
 		}
 		break;
 	case 3:
-		if (hexdigit(ck&0xF) == data) {
+		if (hexdigit(state.ck&0xF) == data) {
 			return true;
 		}
-		step = 0;
+		state.step = 0;
 		break;
     }
     return false;
@@ -44,6 +44,7 @@
 
 #include <AP_HAL.h>
 #include "GPS.h"
+#include "GPS_Framer.h"
 #include <AP_Progmem.h>
 
 
@@ -63,7 +64,12 @@ public:
     ///
     virtual bool        read();
 
-	static bool _detect(uint8_t data);
+	// the state of _detect(), see AP_GPS_UBLOX::detect_state
+	struct detect_state {
+		uint8_t  step;
+		uint8_t  ck;
+	};
+	static bool _detect(struct detect_state &state, uint8_t data);
 
 private:
     /// Coding for the GPS sentences that the parser handles
@@ -74,20 +80,26 @@ private:
         _GPS_SENTENCE_OTHER = 0
     };
 
-    /// Update the decode state machine with a new character
+    /// Parse a sentence
     ///
-    /// @param	c		The next character in the NMEA input stream
-    /// @returns		True if processing the character has resulted in
-    ///					an update to the GPS state
+    /// @param	sentence	The sentence, from the '$' to the checksum,
+    ///						which has been checked
+    /// @param	length		The length of the sentence
+    /// @returns		True if the sentence has resulted in an update to
+    ///					the GPS state
     ///
-    bool                        _decode(char c);
+    bool                        _decode(const char *sentence, uint16_t length);
+
+    /// Check for a sentence at the start of a buffer, see GPS_Framer
+    ///
+    static GPS_Framer::Frame_Status _frame_check(const uint8_t *buf, uint16_t len, uint16_t &length);
 
     /// Return the numeric value of an ascii hex character
     ///
     /// @param	a		The character to be converted
     /// @returns		The value of the character as a hex digit
     ///
-    int16_t                     _from_hex(char a);
+    static int16_t              _from_hex(char a);
 
     /// Parses the current term as a NMEA-style decimal number with
     /// up to two decimal digits.
@@ -111,23 +123,23 @@ private:
     /// complete.
     ///
     /// Each GPS message is broken up into terms separated by commas.
-    /// Each term is then processed by this function as it is received.
+    /// Each term is then processed by this function in turn.
     ///
-    /// @returns		True if completing the term has resulted in
-    ///					an update to the GPS state.
-    bool                        _term_complete();
+    void                        _term_complete();
+
+    /// Processes a sentence when all of its terms have been processed.
+    ///
+    /// @returns		True as the sentence has resulted in an update
+    ///					to the GPS state.
+    bool                        _sentence_complete();
 
-    uint8_t _parity;                                                    ///< NMEA message checksum accumulator
-    bool _is_checksum_term;                                     ///< current term is the checksum
     char _term[15];                                                     ///< buffer for the current term within the current sentence
     uint8_t _sentence_type;                                     ///< the sentence type currently being processed
     uint8_t _term_number;                                       ///< term index within the current sentence
-    uint8_t _term_offset;                                       ///< character offset with the term being received
     bool _gps_data_good;                                        ///< set when the sentence indicates data is good
 
     // The result of parsing terms within a message is stored temporarily until
-    // the message is completely processed and the checksum validated.
-    // This avoids the need to buffer the entire message.
+    // the message is completely processed.
     int32_t _new_time;                                                  ///< time parsed from a term
     int32_t _new_date;                                                  ///< date parsed from a term
     int32_t _new_latitude;                                      ///< latitude parsed from a term
@@ -154,6 +166,11 @@ private:
     static const prog_char _gpgga_string[];
     static const prog_char _gpvtg_string[];
     //@}
+
+    /// Receive buffer, big enough for the longest sentence and the
+    /// start of the next
+    uint8_t _frame_buf[128];
+    GPS_Framer _framer;
 };
 
 #endif // __AP_GPS_NMEA_H__
@@ -29,6 +29,7 @@ AP_GPS_SIRF::init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting)
 {
 	_port = s;
     _port->flush();
+    _framer.init(_frame_buf, sizeof(_frame_buf), PREAMBLE1, 0, _frame_check);
 
     // For modules that default to something other than SiRF binary,
     // the module-specific subclass should take care of switching to binary mode
@@ -41,123 +42,21 @@ AP_GPS_SIRF::init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting)
 
 // Process bytes available from the stream
 //
-// The stream is assumed to contain only messages we recognise.  If it
-// contains other messages, and those messages contain the preamble
-// bytes, it is possible for this code to fail to synchronise to the
-// stream immediately.  Without buffering the entire message and
-// re-processing it from the top, this is unavoidable. The parser
-// attempts to avoid this when possible.
+// Messages are checked whole, postamble included, by the framer before
+// they are parsed. A message that fails is skipped by a byte and the
+// search for a preamble starts again from there.
 //
 bool
 AP_GPS_SIRF::read(void)
 {
-    uint8_t data;
-    int16_t numc;
+    const uint8_t *frame;
+    uint16_t length;
     bool parsed = false;
 
-    numc = _port->available();
-    while(numc--) {
-
-        // read the next byte
-        data = _port->read();
-
-        switch(_step) {
-
-        // Message preamble detection
-        //
-        // If we fail to match any of the expected bytes, we reset
-        // the state machine and re-consider the failed byte as
-        // the first byte of the preamble.  This improves our
-        // chances of recovering from a mismatch and makes it less
-        // likely that we will be fooled by the preamble appearing
-        // as data in some other message.
-        //
-        case 1:
-            if (PREAMBLE2 == data) {
-                _step++;
-                break;
-            }
-            _step = 0;
-        // FALLTHROUGH
-        case 0:
-            if(PREAMBLE1 == data)
-                _step++;
-            break;
-
-        // Message length
-        //
-        // We always collect the length so that we can avoid being
-        // fooled by preamble bytes in messages.
-        //
-        case 2:
-            _step++;
-            _payload_length = (uint16_t)data << 8;
-            break;
-        case 3:
-            _step++;
-            _payload_length |= data;
-            _payload_counter = 0;
-            _checksum = 0;
-            break;
-
-        // Message header processing
-        //
-        // We sniff the message ID to determine whether we are going
-        // to gather the message bytes or just discard them.
-        //
-        case 4:
-            _step++;
-            _accumulate(data);
-            _payload_length--;
-            _gather = false;
-            switch(data) {
-            case MSG_GEONAV:
-                if (_payload_length == sizeof(sirf_geonav)) {
-                    _gather = true;
-                    _msg_id = data;
-                }
-                break;
-            }
-            break;
-
-        // Receive message data
-        //
-        // Note that we are effectively guaranteed by the protocol
-        // that the checksum and postamble cannot be mistaken for
-        // the preamble, so if we are discarding bytes in this
-        // message when the payload is done we return directly
-        // to the preamble detector rather than bothering with
-        // the checksum logic.
-        //
-        case 5:
-            if (_gather) {                                              // gather data if requested
-                _accumulate(data);
-                _buffer.bytes[_payload_counter] = data;
-                if (++_payload_counter == _payload_length)
-                    _step++;
-            } else {
-                if (++_payload_counter == _payload_length)
-                    _step = 0;
-            }
-            break;
-
-        // Checksum and message processing
-        //
-        case 6:
-            _step++;
-            if ((_checksum >> 8) != data) {
-                _error("GPS_SIRF: checksum error\n");
-                _step = 0;
-            }
-            break;
-        case 7:
-            _step = 0;
-            if ((_checksum & 0xff) != data) {
-                _error("GPS_SIRF: checksum error\n");
-                break;
-            }
-            if (_gather) {
-                parsed = _parse_gps();                                   // Parse the new GPS packet
+    while (_framer.fill(_port)) {
+        while ((frame = _framer.next(length)) != NULL) {
+            if (_parse_gps(&frame[4], length - 8)) {
+                parsed = true;
             }
         }
     }
@@ -165,81 +64,112 @@ AP_GPS_SIRF::read(void)
 }
 
 bool
-AP_GPS_SIRF::_parse_gps(void)
+AP_GPS_SIRF::_parse_gps(const uint8_t *payload, uint16_t payload_length)
 {
-    switch(_msg_id) {
-    case MSG_GEONAV:
-        time                    = _swapl(&_buffer.nav.time);
-        //fix				= (0 == _buffer.nav.fix_invalid) && (FIX_3D == (_buffer.nav.fix_type & FIX_MASK));
-        fix                             = (0 == _buffer.nav.fix_invalid);
-        latitude                = _swapl(&_buffer.nav.latitude);
-        longitude               = _swapl(&_buffer.nav.longitude);
-        altitude                = _swapl(&_buffer.nav.altitude_msl);
-        ground_speed    = _swapi(&_buffer.nav.ground_speed);
-        // at low speeds, ground course wanders wildly; suppress changes if we are not moving
-        if (ground_speed > 50)
-            ground_course       = _swapi(&_buffer.nav.ground_course);
-        num_sats                = _buffer.nav.satellites;
-
-        return true;
+    // the message is parsed in place, so check it is all there
+    if (payload[0] != MSG_GEONAV || payload_length != sizeof(sirf_geonav) + 1) {
+        return false;
     }
-    return false;
+    const sirf_geonav &nav = *(const sirf_geonav *)&payload[1];
+
+    time                    = _swapl(&nav.time);
+    //fix				= (0 == nav.fix_invalid) && (FIX_3D == (nav.fix_type & FIX_MASK));
+    fix                             = (0 == nav.fix_invalid);
+    latitude                = _swapl(&nav.latitude);
+    longitude               = _swapl(&nav.longitude);
+    altitude                = _swapl(&nav.altitude_msl);
+    ground_speed    = _swapi(&nav.ground_speed);
+    // at low speeds, ground course wanders wildly; suppress changes if we are not moving
+    if (ground_speed > 50)
+        ground_course       = _swapi(&nav.ground_course);
+    num_sats                = nav.satellites;
+
+    return true;
 }
 
-void
-AP_GPS_SIRF::_accumulate(uint8_t val)
+/*
+  check for a SiRF message at the start of buf: the preambles, a 15 bit
+  big endian payload length, the payload, a 15 bit sum of the payload
+  bytes and the postambles
+ */
+GPS_Framer::Frame_Status
+AP_GPS_SIRF::_frame_check(const uint8_t *buf, uint16_t len, uint16_t &length)
 {
-    _checksum = (_checksum + val) & 0x7fff;
-}
-
+    if (len < 2) {
+        return GPS_Framer::FRAME_PARTIAL;
+    }
+    if (buf[1] != PREAMBLE2) {
+        return GPS_Framer::FRAME_BAD;
+    }
+    if (len < 4) {
+        return GPS_Framer::FRAME_PARTIAL;
+    }
+    uint16_t payload_length = (uint16_t)buf[2]<<8 | buf[3];
+    if (payload_length == 0 || payload_length > 0x7fff) {
+        return GPS_Framer::FRAME_BAD;
+    }
+    if (len < payload_length + 8) {
+        return GPS_Framer::FRAME_PARTIAL;
+    }
 
+    uint16_t checksum = 0;
+    const uint8_t *p = &buf[4];
+    const uint8_t *end = &buf[4 + payload_length];
+    while (p != end) {
+        checksum += *p++;
+    }
+    checksum &= 0x7fff;
+    if (p[0] != (checksum >> 8) || p[1] != (checksum & 0xff) ||
+        p[2] != POSTAMBLE1 || p[3] != POSTAMBLE2) {
+        return GPS_Framer::FRAME_BAD;
+    }
+    length = payload_length + 8;
+    return GPS_Framer::FRAME_OK;
+}
 
 /*
   detect a SIRF GPS
  */
 bool
-AP_GPS_SIRF::_detect(uint8_t data)
+AP_GPS_SIRF::_detect(struct detect_state &state, uint8_t data)
 {
-	static uint16_t checksum;
-	static uint8_t step, payload_length, payload_counter;
-
-	switch (step) {
+	switch (state.step) {
 	case 1:
 		if (PREAMBLE2 == data) {
-			step++;
+			state.step++;
 			break;
 		}
-		step = 0;
+		state.step = 0;
 	case 0:
-		payload_length = payload_counter = checksum = 0;
+		state.payload_length = state.payload_counter = state.checksum = 0;
 		if (PREAMBLE1 == data)
-			step++;
+			state.step++;
 		break;
 	case 2:
-		step++;
+		state.step++;
 		if (data != 0) {
 			// only look for short messages
-			step = 0;
+			state.step = 0;
 		}
 		break;
 	case 3:
-		step++;
-		payload_length = data;
+		state.step++;
+		state.payload_length = data;
 		break;
 	case 4:
-		checksum = (checksum + data) & 0x7fff;
-		if (++payload_counter == payload_length)
-			step++;
+		state.checksum = (state.checksum + data) & 0x7fff;
+		if (++state.payload_counter == state.payload_length)
+			state.step++;
 		break;
 	case 5:
-		step++;
-		if ((checksum >> 8) != data) {
-			step = 0;
+		state.step++;
+		if ((state.checksum >> 8) != data) {
+			state.step = 0;
 		}
 		break;
 	case 6:
-		step = 0;
-		if ((checksum & 0xff) == data) {
+		state.step = 0;
+		if ((state.checksum & 0xff) == data) {
 			return true;
 		}
     }
@@ -13,6 +13,7 @@
 
 #include <AP_HAL.h>
 #include "GPS.h"
+#include "GPS_Framer.h"
 
 #define SIRF_SET_BINARY "$PSRF100,0,38400,8,1,0*3C"
 
@@ -20,7 +21,14 @@ class AP_GPS_SIRF : public GPS {
 public:
     virtual void        init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting = GPS_ENGINE_NONE);
     virtual bool        read();
-	static bool         _detect(uint8_t data);
+	// the state of _detect(), see AP_GPS_UBLOX::detect_state
+	struct detect_state {
+		uint16_t checksum;
+		uint8_t  step;
+		uint8_t  payload_length;
+		uint8_t  payload_counter;
+	};
+	static bool _detect(struct detect_state &state, uint8_t data);
 
 private:
     #pragma pack(push,1)
@@ -75,22 +83,13 @@ private:
     };
 
 
-    // State machine state
-    uint8_t         _step;
-    uint16_t        _checksum;
-    bool            _gather;
-    uint16_t        _payload_length;
-    uint16_t        _payload_counter;
-    uint8_t         _msg_id;
+    // Receive buffer, big enough for a geonav message and the start of
+    // the next
+    uint8_t         _frame_buf[128];
+    GPS_Framer      _framer;
 
-    // Message buffer
-    union {
-        sirf_geonav nav;
-        uint8_t bytes[];
-    } _buffer;
-
-    bool        _parse_gps(void);
-    void        _accumulate(uint8_t val);
+    bool        _parse_gps(const uint8_t *payload, uint16_t payload_length);
+    static GPS_Framer::Frame_Status _frame_check(const uint8_t *buf, uint16_t len, uint16_t &length);
 };
 
 #endif // AP_GPS_SIRF_h
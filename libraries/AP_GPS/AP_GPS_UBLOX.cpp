@@ -42,8 +42,10 @@ AP_GPS_UBLOX::init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting)
 	Debug("uBlox nav_setting=%u\n", nav_setting);
 
     _port->flush();
+    _framer.init(_frame_buf, sizeof(_frame_buf), PREAMBLE1, 0, _frame_check);
 
     _epoch = TIME_OF_WEEK;
+    _have_time_ms = true;
     idleTimeout = 1200;
 
     // configure the GPS for the messages we want
@@ -54,118 +56,24 @@ AP_GPS_UBLOX::init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting)
 
 // Process bytes available from the stream
 //
-// The stream is assumed to contain only messages we recognise.  If it
-// contains other messages, and those messages contain the preamble
-// bytes, it is possible for this code to fail to synchronise to the
-// stream immediately.  Without buffering the entire message and
-// re-processing it from the top, this is unavoidable. The parser
-// attempts to avoid this when possible.
+// The bytes are split into messages by the framer, which checks the
+// length and checksum of each whole message before it is parsed, and
+// resynchronises on the next preamble after any message that fails.
+// Messages are parsed in place in the framer's buffer.
 //
 bool
 AP_GPS_UBLOX::read(void)
 {
-    uint8_t data;
-    int16_t numc;
+    const uint8_t *frame;
+    uint16_t length;
     bool parsed = false;
 
-    numc = _port->available();
-    for (int16_t i = 0; i < numc; i++) {        // Process bytes received
-
-        // read the next byte
-        data = _port->read();
-
-	reset:
-        switch(_step) {
-
-        // Message preamble detection
-        //
-        // If we fail to match any of the expected bytes, we reset
-        // the state machine and re-consider the failed byte as
-        // the first byte of the preamble.  This improves our
-        // chances of recovering from a mismatch and makes it less
-        // likely that we will be fooled by the preamble appearing
-        // as data in some other message.
-        //
-        case 1:
-            if (PREAMBLE2 == data) {
-                _step++;
-                break;
-            }
-            _step = 0;
-            Debug("reset %u", __LINE__);
-        // FALLTHROUGH
-        case 0:
-            if(PREAMBLE1 == data)
-                _step++;
-            break;
-
-        // Message header processing
-        //
-        // We sniff the class and message ID to decide whether we
-        // are going to gather the message bytes or just discard
-        // them.
-        //
-        // We always collect the length so that we can avoid being
-        // fooled by preamble bytes in messages.
-        //
-        case 2:
-            _step++;
-            _class = data;
-            _ck_b = _ck_a = data;                               // reset the checksum accumulators
-            break;
-        case 3:
-            _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _msg_id = data;
-            break;
-        case 4:
-            _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _payload_length = data;                             // payload length low byte
-            break;
-        case 5:
-            _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-
-            _payload_length += (uint16_t)(data<<8);
-            if (_payload_length > 512) {
-                Debug("large payload %u", (unsigned)_payload_length);
-                // assume very large payloads are line noise
-                _payload_length = 0;
-                _step = 0;
-				goto reset;
-            }
-            _payload_counter = 0;                               // prepare to receive payload
-            break;
-
-        // Receive message data
-        //
-        case 6:
-            _ck_b += (_ck_a += data);                   // checksum byte
-            if (_payload_counter < sizeof(_buffer)) {
-                _buffer.bytes[_payload_counter] = data;
-            }
-            if (++_payload_counter == _payload_length)
-                _step++;
-            break;
-
-        // Checksum and message processing
-        //
-        case 7:
-            _step++;
-            if (_ck_a != data) {
-                Debug("bad cka %x should be %x", data, _ck_a);
-                _step = 0;
-				goto reset;
-            }
-            break;
-        case 8:
-            _step = 0;
-            if (_ck_b != data) {
-                Debug("bad ckb %x should be %x", data, _ck_b);
-                break;                                                  // bad checksum
-            }
-
+    while (_framer.fill(_port)) {
+        while ((frame = _framer.next(length)) != NULL) {
+            _class          = frame[2];
+            _msg_id         = frame[3];
+            _payload_length = length - 8;
+            _buffer         = (const ubx_payload *)&frame[6];
             if (_parse_gps()) {
                 parsed = true;
             }
@@ -174,6 +82,46 @@ AP_GPS_UBLOX::read(void)
     return parsed;
 }
 
+/*
+  check for a UBX message at the start of buf: the preambles, class,
+  id, 16 bit length, the payload and a two byte Fletcher checksum over
+  all but the preambles
+ */
+GPS_Framer::Frame_Status
+AP_GPS_UBLOX::_frame_check(const uint8_t *buf, uint16_t len, uint16_t &length)
+{
+    if (len < 2) {
+        return GPS_Framer::FRAME_PARTIAL;
+    }
+    if (buf[1] != PREAMBLE2) {
+        return GPS_Framer::FRAME_BAD;
+    }
+    if (len < 6) {
+        return GPS_Framer::FRAME_PARTIAL;
+    }
+    uint16_t payload_length = buf[4] | (uint16_t)buf[5]<<8;
+    if (payload_length > 512) {
+        // assume very large payloads are line noise
+        return GPS_Framer::FRAME_BAD;
+    }
+    if (len < payload_length + 8) {
+        return GPS_Framer::FRAME_PARTIAL;
+    }
+
+    uint8_t ck_a = 0, ck_b = 0;
+    const uint8_t *p = &buf[2];
+    const uint8_t *end = &buf[6 + payload_length];
+    while (p != end) {
+        ck_b += (ck_a += *p++);
+    }
+    if (p[0] != ck_a || p[1] != ck_b) {
+        Debug("bad checksum %x %x should be %x %x", p[0], p[1], ck_a, ck_b);
+        return GPS_Framer::FRAME_BAD;
+    }
+    length = payload_length + 8;
+    return GPS_Framer::FRAME_OK;
+}
+
 // Private Methods /////////////////////////////////////////////////////////////
 
 bool
@@ -184,18 +132,20 @@ AP_GPS_UBLOX::_parse_gps(void)
         return false;
     }
 
-    if (_class == CLASS_CFG && _msg_id == MSG_CFG_NAV_SETTINGS) {
-		Debug("Got engine settings %u\n", (unsigned)_buffer.nav_settings.dynModel);
+    if (_class == CLASS_CFG && _msg_id == MSG_CFG_NAV_SETTINGS &&
+        _payload_length >= sizeof(_buffer->nav_settings)) {
+		Debug("Got engine settings %u\n", (unsigned)_buffer->nav_settings.dynModel);
         if (_nav_setting != GPS_ENGINE_NONE &&
-            _buffer.nav_settings.dynModel != _nav_setting) {
+            _buffer->nav_settings.dynModel != _nav_setting) {
             // we've received the current nav settings, change the engine
             // settings and send them back
             Debug("Changing engine setting from %u to %u\n",
-                  (unsigned)_buffer.nav_settings.dynModel, (unsigned)_nav_setting);
-            _buffer.nav_settings.dynModel = _nav_setting;
+                  (unsigned)_buffer->nav_settings.dynModel, (unsigned)_nav_setting);
+            struct ubx_cfg_nav_settings nav_settings = _buffer->nav_settings;
+            nav_settings.dynModel = _nav_setting;
             _send_message(CLASS_CFG, MSG_CFG_NAV_SETTINGS,
-                          &_buffer.nav_settings,
-                          sizeof(_buffer.nav_settings));
+                          &nav_settings,
+                          sizeof(nav_settings));
         }
         return false;
     }
@@ -213,45 +163,58 @@ AP_GPS_UBLOX::_parse_gps(void)
         return false;
     }
 
+    // the messages are parsed in place, so check they are all there
     switch (_msg_id) {
     case MSG_POSLLH:
+        if (_payload_length < sizeof(_buffer->posllh)) {
+            return false;
+        }
         Debug("MSG_POSLLH next_fix=%u", next_fix);
-        time            = _buffer.posllh.time;
-        longitude       = _buffer.posllh.longitude;
-        latitude        = _buffer.posllh.latitude;
-        altitude        = _buffer.posllh.altitude_msl / 10;
+        time            = _buffer->posllh.time;
+        longitude       = _buffer->posllh.longitude;
+        latitude        = _buffer->posllh.latitude;
+        altitude        = _buffer->posllh.altitude_msl / 10;
         fix                     = next_fix;
         _new_position = true;
         break;
     case MSG_STATUS:
+        if (_payload_length < sizeof(_buffer->status)) {
+            return false;
+        }
         Debug("MSG_STATUS fix_status=%u fix_type=%u",
-              _buffer.status.fix_status,
-              _buffer.status.fix_type);
-        next_fix        = (_buffer.status.fix_status & NAV_STATUS_FIX_VALID) && (_buffer.status.fix_type == FIX_3D);
+              _buffer->status.fix_status,
+              _buffer->status.fix_type);
+        next_fix        = (_buffer->status.fix_status & NAV_STATUS_FIX_VALID) && (_buffer->status.fix_type == FIX_3D);
         if (!next_fix) {
             fix = false;
         }
         break;
     case MSG_SOL:
+        if (_payload_length < sizeof(_buffer->solution)) {
+            return false;
+        }
         Debug("MSG_SOL fix_status=%u fix_type=%u",
-              _buffer.solution.fix_status,
-              _buffer.solution.fix_type);
-        next_fix        = (_buffer.solution.fix_status & NAV_STATUS_FIX_VALID) && (_buffer.solution.fix_type == FIX_3D);
+              _buffer->solution.fix_status,
+              _buffer->solution.fix_type);
+        next_fix        = (_buffer->solution.fix_status & NAV_STATUS_FIX_VALID) && (_buffer->solution.fix_type == FIX_3D);
         if (!next_fix) {
             fix = false;
         }
-        num_sats        = _buffer.solution.satellites;
-        hdop            = _buffer.solution.position_DOP;
+        num_sats        = _buffer->solution.satellites;
+        hdop            = _buffer->solution.position_DOP;
         break;
     case MSG_VELNED:
+        if (_payload_length < sizeof(_buffer->velned)) {
+            return false;
+        }
         Debug("MSG_VELNED");
-        speed_3d        = _buffer.velned.speed_3d;                              // cm/s
-        ground_speed = _buffer.velned.speed_2d;                         // cm/s
-        ground_course = _buffer.velned.heading_2d / 1000;       // Heading 2D deg * 100000 rescaled to deg * 100
+        speed_3d        = _buffer->velned.speed_3d;                              // cm/s
+        ground_speed = _buffer->velned.speed_2d;                         // cm/s
+        ground_course = _buffer->velned.heading_2d / 1000;       // Heading 2D deg * 100000 rescaled to deg * 100
         _have_raw_velocity = true;
-        _vel_north  = _buffer.velned.ned_north;
-        _vel_east   = _buffer.velned.ned_east;
-        _vel_down   = _buffer.velned.ned_down;
+        _vel_north  = _buffer->velned.ned_north;
+        _vel_east   = _buffer->velned.ned_east;
+        _vel_down   = _buffer->velned.ned_down;
         _new_speed = true;
         break;
     default:
@@ -353,8 +316,8 @@ AP_GPS_UBLOX::_configure_gps(void)
     }
     _port->begin(38400U);
 
-    // ask for navigation solutions every 200ms
-    msg.measure_rate_ms = 200;
+    // ask for navigation solutions every 100ms at 10Hz, otherwise every 200ms
+    msg.measure_rate_ms = _rate_hz == 10 ? 100 : 200;
     msg.nav_rate        = 1;
     msg.timeref         = 0;     // UTC time
     _send_message(CLASS_CFG, MSG_CFG_RATE, &msg, sizeof(msg));
@@ -376,57 +339,53 @@ AP_GPS_UBLOX::_configure_gps(void)
   matches a UBlox
  */
 bool
-AP_GPS_UBLOX::_detect(uint8_t data)
+AP_GPS_UBLOX::_detect(struct detect_state &state, uint8_t data)
 {
-	static uint8_t payload_length, payload_counter;
-	static uint8_t step;
-	static uint8_t ck_a, ck_b;
-
 reset:
-	switch (step) {
+	switch (state.step) {
         case 1:
             if (PREAMBLE2 == data) {
-                step++;
+                state.step++;
                 break;
             }
-            step = 0;
+            state.step = 0;
         case 0:
             if (PREAMBLE1 == data)
-                step++;
+                state.step++;
             break;
         case 2:
-            step++;
-            ck_b = ck_a = data;
+            state.step++;
+            state.ck_b = state.ck_a = data;
             break;
         case 3:
-            step++;
-            ck_b += (ck_a += data);
+            state.step++;
+            state.ck_b += (state.ck_a += data);
             break;
         case 4:
-            step++;
-            ck_b += (ck_a += data);
-            payload_length = data;
+            state.step++;
+            state.ck_b += (state.ck_a += data);
+            state.payload_length = data;
             break;
         case 5:
-            step++;
-            ck_b += (ck_a += data);
-            payload_counter = 0;
+            state.step++;
+            state.ck_b += (state.ck_a += data);
+            state.payload_counter = 0;
             break;
         case 6:
-            ck_b += (ck_a += data);
-            if (++payload_counter == payload_length)
-                step++;
+            state.ck_b += (state.ck_a += data);
+            if (++state.payload_counter == state.payload_length)
+                state.step++;
             break;
         case 7:
-            step++;
-            if (ck_a != data) {
-                step = 0;
+            state.step++;
+            if (state.ck_a != data) {
+                state.step = 0;
 				goto reset;
             }
             break;
         case 8:
-            step = 0;
-			if (ck_b == data) {
+            state.step = 0;
+			if (state.ck_b == data) {
 				// a valid UBlox packet
 				return true;
 			} else {
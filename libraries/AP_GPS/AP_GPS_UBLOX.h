@@ -13,6 +13,7 @@
 
 #include <AP_HAL.h>
 #include "GPS.h"
+#include "GPS_Framer.h"
 
 /*
  *  try to put a UBlox into binary mode. This is in two parts. First we
@@ -30,7 +31,16 @@ public:
     // Methods
     virtual void                    init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting = GPS_ENGINE_NONE);
     virtual bool                    read();
-    static bool _detect(uint8_t );
+    // the state of _detect(), one per stream being detected. Zero
+    // it to start detection again
+    struct detect_state {
+        uint8_t  payload_length;
+        uint8_t  payload_counter;
+        uint8_t  step;
+        uint8_t  ck_a;
+        uint8_t  ck_b;
+    };
+    static bool _detect(struct detect_state &state, uint8_t data);
 
     static const prog_char          _ublox_set_binary[];
     static const uint8_t            _ublox_set_binary_size;
@@ -124,15 +134,14 @@ private:
         uint32_t speed_accuracy;
         uint32_t heading_accuracy;
     };
-    // Receive buffer
-    union {
+    // Message payloads
+    union ubx_payload {
         ubx_nav_posllh posllh;
         ubx_nav_status status;
         ubx_nav_solution solution;
         ubx_nav_velned velned;
         ubx_cfg_nav_settings nav_settings;
-        uint8_t bytes[];
-    } _buffer;
+    };
 	#pragma pack(pop)
 
     enum ubs_protocol_bytes {
@@ -164,15 +173,14 @@ private:
         NAV_STATUS_FIX_VALID = 1
     };
 
-    // Packet checksum accumulators
-    uint8_t         _ck_a;
-    uint8_t         _ck_b;
+    // Receive buffer, big enough for two of the messages we parse
+    uint8_t         _frame_buf[128];
+    GPS_Framer      _framer;
 
-    // State machine state
-    uint8_t         _step;
+    // the message being parsed, in _frame_buf
+    const ubx_payload *_buffer;
     uint8_t         _msg_id;
     uint16_t        _payload_length;
-    uint16_t        _payload_counter;
 
 	// 8 bit count of fix messages processed, used for periodic
 	// processing
@@ -190,6 +198,7 @@ private:
 
     // Buffer parse & GPS state update
     bool        _parse_gps();
+    static GPS_Framer::Frame_Status _frame_check(const uint8_t *buf, uint16_t len, uint16_t &length);
 
     // used to update fix between status and position packets
     bool        next_fix;
@@ -49,7 +49,7 @@ GPS::update(void)
         _idleTimer = tnow;
 
         if (_status == GPS_OK) {
-            last_fix_time = _idleTimer;
+            _update_fix_time(tnow);
             _last_ground_speed_cm = ground_speed;
 
             if (_have_raw_velocity) {
@@ -75,6 +75,38 @@ GPS::update(void)
     }
 }
 
+// the largest amount a fix can be read later than the earliest fix
+// before we decide the receiver clock has wrapped or jumped
+#define GPS_TIME_OFFSET_MAX_DELAY_MS 500
+
+// The system time of a fix is its receiver timestamp plus the offset
+// between the two clocks. Every fix is read some time after it is made,
+// by the transfer over the serial port and by how often we are called,
+// so the smallest difference seen between the system time and the
+// timestamp is taken as the offset. It is raised by a millisecond a
+// second while fixes arrive later than it, to follow a system clock
+// that runs faster than the receiver's
+void
+GPS::_update_fix_time(uint32_t tnow)
+{
+    if (!_have_time_ms) {
+        last_fix_time = tnow;
+        return;
+    }
+
+    uint32_t offset = tnow - time;
+    int32_t delay = (int32_t)(offset - _fix_time_offset);
+    if (!_have_fix_time_offset || delay < 0 || delay > GPS_TIME_OFFSET_MAX_DELAY_MS) {
+        _fix_time_offset = offset;
+        _fix_time_offset_ms = tnow;
+        _have_fix_time_offset = true;
+    } else if (delay > 0 && tnow - _fix_time_offset_ms > 1000) {
+        _fix_time_offset++;
+        _fix_time_offset_ms = tnow;
+    }
+    last_fix_time = time + _fix_time_offset;
+}
+
 void
 GPS::setHIL(uint32_t _time, float _latitude, float _longitude, float _altitude,
             float _ground_speed, float _ground_course, float _speed_3d, uint8_t _num_sats)
@@ -88,6 +88,15 @@ public:
     ///
     virtual void        init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting engine_setting = GPS_ENGINE_NONE) = 0;
 
+    /// Set the navigation solution rate to ask the receiver for, in Hz.
+    ///
+    /// Must be called before ::init. 5 and 10 are supported, and only
+    /// the uBlox and MTK19 drivers can change the rate of the receiver.
+    ///
+    void                set_rate(uint8_t rate_hz) {
+        _rate_hz = rate_hz;
+    }
+
     // Properties
     uint32_t time;                      ///< GPS time (milliseconds from epoch)
     uint32_t date;                      ///< GPS date (FORMAT TBD)
@@ -144,7 +153,10 @@ public:
     // the expected lag (in seconds) in the position and velocity readings from the gps
     virtual float get_lag() { return 1.0; }
 
-    // the time we got our last fix in system milliseconds
+    // the time of our last fix in system milliseconds. For receivers
+    // that timestamp their fixes in milliseconds this is found from the
+    // timestamp, so it does not carry the jitter of when the message
+    // happened to be read
     uint32_t last_fix_time;
 
 	// return true if the GPS supports raw velocity values
@@ -205,6 +217,12 @@ protected:
     // does this GPS support raw velocity numbers?
     bool _have_raw_velocity;
 
+    // is time a count of milliseconds from the receiver's own clock?
+    bool _have_time_ms;
+
+    // navigation solution rate to ask the receiver for, in Hz
+    uint8_t _rate_hz;
+
 private:
 
 
@@ -215,6 +233,15 @@ private:
     /// Our current status
     GPS_Status _status;
 
+    /// work out last_fix_time from the receiver timestamp
+    void _update_fix_time(uint32_t tnow);
+
+    // the smallest difference seen between the system time a fix was
+    // read and its receiver timestamp, and when it was last raised
+    uint32_t _fix_time_offset;
+    uint32_t _fix_time_offset_ms;
+    bool _have_fix_time_offset;
+
     // previous ground speed in cm/s
     uint32_t _last_ground_speed_cm;
 
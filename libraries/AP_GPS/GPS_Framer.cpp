@@ -0,0 +1,80 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: t -*-
+
+/// @file	GPS_Framer.cpp
+/// @brief	Framed message layer shared by the GPS protocol drivers.
+
+#include <AP_HAL.h>
+#include <string.h>
+#include "GPS_Framer.h"
+
+void
+GPS_Framer::init(uint8_t *buf, uint16_t size, uint8_t preamble,
+                 uint8_t preamble_offset, check_fn check)
+{
+    _buf = buf;
+    _size = size;
+    _start = 0;
+    _len = 0;
+    _preamble = preamble;
+    _preamble_offset = preamble_offset;
+    _check = check;
+    _skipped = 0;
+}
+
+bool
+GPS_Framer::fill(AP_HAL::UARTDriver *port)
+{
+    // move the bytes not yet parsed to the front to make room
+    if (_start != 0) {
+        _len -= _start;
+        memmove(_buf, &_buf[_start], _len);
+        _start = 0;
+    }
+
+    if (_len == _size) {
+        return false;
+    }
+    uint16_t numc = port->read(&_buf[_len], _size - _len);
+    _len += numc;
+    return numc != 0;
+}
+
+const uint8_t *
+GPS_Framer::next(uint16_t &length)
+{
+    while (_len - _start > _preamble_offset) {
+        const uint8_t *p = (const uint8_t *)memchr(&_buf[_start + _preamble_offset],
+                                                   _preamble,
+                                                   _len - _start - _preamble_offset);
+        if (p == NULL) {
+            // keep the bytes that could be in front of a preamble byte
+            // still to come
+            _skipped += _len - _start - _preamble_offset;
+            _start = _len - _preamble_offset;
+            return NULL;
+        }
+        uint16_t frame_start = (p - _buf) - _preamble_offset;
+        _skipped += frame_start - _start;
+        _start = frame_start;
+
+        switch (_check(&_buf[_start], _len - _start, length)) {
+        case FRAME_OK:
+            _start += length;
+            return &_buf[_start - length];
+
+        case FRAME_PARTIAL:
+            if (_start != 0 || _len != _size) {
+                // wait for the rest of it
+                return NULL;
+            }
+            // a frame too long for the buffer can't be checked, so it
+            // is no use to us
+            // FALLTHROUGH
+        case FRAME_BAD:
+            _start++;
+            _skipped++;
+            break;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,95 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: t -*-
+
+/// @file	GPS_Framer.h
+/// @brief	Framed message layer shared by the GPS protocol drivers.
+
+#ifndef __GPS_FRAMER_H__
+#define __GPS_FRAMER_H__
+
+#include <AP_HAL.h>
+#include <inttypes.h>
+
+/// @class	GPS_Framer
+/// @brief	Splits the bytes from a GPS into the frames of one protocol.
+///
+/// The bytes waiting on the port are moved into a buffer owned by the
+/// driver. The buffer is searched for the protocol's preamble byte with
+/// memchr, and each place it is found is handed to the protocol's check
+/// function, which validates the whole frame at once. Good frames are
+/// returned in place, so a driver decodes its messages straight from
+/// the buffer.
+///
+/// A frame that fails its check is skipped by one byte only, and the
+/// search starts again from there. A message whose start was taken for
+/// the payload of a corrupt frame is still found, which a byte at a time
+/// state machine cannot do without keeping the bytes it has passed.
+///
+/// The framer has no constructor so that the drivers holding one can
+/// still be zeroed by new; drivers call ::init from their own ::init.
+///
+class GPS_Framer
+{
+public:
+    /// Result of checking the bytes at a possible frame start
+    ///
+    enum Frame_Status {
+        FRAME_PARTIAL = 0,      ///< could be a good frame, but not all of it is here
+        FRAME_BAD = 1,          ///< not a good frame
+        FRAME_OK = 2            ///< a good frame
+    };
+
+    /// Protocol frame check.
+    ///
+    /// @param	buf		bytes from a preamble byte on
+    /// @param	len		number of bytes in buf
+    /// @param	length	set to the length of the whole frame for FRAME_OK
+    ///
+    typedef Frame_Status (*check_fn)(const uint8_t *buf, uint16_t len, uint16_t &length);
+
+    /// Set up the framer and empty it.
+    ///
+    /// @param	buf				buffer to hold the bytes not yet parsed. It
+    ///							must hold the largest frame to be decoded
+    /// @param	size			size of buf
+    /// @param	preamble		the byte searched for
+    /// @param	preamble_offset	where the searched for byte is in a frame,
+    ///							for protocols with more than one first byte
+    /// @param	check			the protocol's frame check
+    ///
+    void                init(uint8_t *buf, uint16_t size, uint8_t preamble,
+                             uint8_t preamble_offset, check_fn check);
+
+    /// Move as many bytes as fit from the port into the buffer.
+    ///
+    /// @returns		true if any bytes were moved, so ::next may have
+    ///					more frames to give
+    ///
+    bool                fill(AP_HAL::UARTDriver *port);
+
+    /// Find the next good frame.
+    ///
+    /// @param	length	set to the length of the frame
+    /// @returns		the frame, valid until the next call to ::fill, or
+    ///					NULL when the buffer holds no more complete frames
+    ///
+    const uint8_t *     next(uint16_t &length);
+
+    /// Count of bytes skipped while looking for frames, for debugging
+    /// and testing resynchronisation.
+    ///
+    uint32_t            skipped(void) {
+        return _skipped;
+    }
+
+private:
+    uint8_t *           _buf;
+    uint16_t            _size;
+    uint16_t            _start;         ///< first byte not yet parsed
+    uint16_t            _len;           ///< bytes in the buffer
+    uint8_t             _preamble;
+    uint8_t             _preamble_offset;
+    check_fn            _check;
+    uint32_t            _skipped;
+};
+
+#endif // __GPS_FRAMER_H__
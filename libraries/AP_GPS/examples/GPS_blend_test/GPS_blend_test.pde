@@ -0,0 +1,220 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: t -*-
+/*
+ *       Dropout test of the GPS blending.
+ *
+ *       Two simulated receivers, each with its own position error, are
+ *       blended by AP_GPS_Blend while the vehicle flies north. Part way
+ *       through the first receiver stops sending, and later it comes
+ *       back. Around each switch it prints the blended position's error,
+ *       and then how long the blend took to fail over, the largest step
+ *       in the position between two solutions, and how long the position
+ *       took to settle on the new blend.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <AP_Common.h>
+#include <AP_Progmem.h>
+#include <AP_Param.h>
+#include <AP_HAL.h>
+#include <AP_HAL_AVR.h>
+#include <AP_HAL_AVR_SITL.h>
+#include <AP_HAL_Empty.h>
+#include <AP_HAL_PX4.h>
+#include <AP_GPS.h>
+#include <AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL_BOARD_DRIVER;
+
+// each receiver sends a fix every 200ms, half way between the other's,
+// and is read every 20ms
+#define LOOP_MS         20
+#define FIX_LOOPS       10
+
+// the first receiver stops sending at DROPOUT_MS and comes back at
+// RETURN_MS
+#define DROPOUT_MS      3000
+#define RETURN_MS       6000
+#define END_MS          9000
+
+// how long after a switch to print the error for
+#define TRACE_MS        1400
+
+// the position is settled once it is this close to the new blend, in m
+#define SETTLED_M       0.1f
+
+// the vehicle flies north at this speed, in m/s
+#define SPEED           10.0f
+
+// metres in a latitude step of 1e-7 degrees
+#define LATLON_TO_M     0.01113195f
+
+#define START_LAT       -353630000L
+#define START_LNG       1491652300L
+
+/*
+  a receiver with an error of its own in its position, sending fixes
+  when told to
+ */
+class SimGPS : public GPS {
+public:
+    SimGPS(float err_north, float err_east) :
+        _err_north(err_north),
+        _err_east(err_east),
+        _pending(false)
+    {}
+
+    void init(AP_HAL::UARTDriver *s, enum GPS_Engine_Setting nav_setting = GPS_ENGINE_NONE) {
+        _have_raw_velocity = true;
+        idleTimeout = 1200;
+    }
+
+    // send a fix, the vehicle being north metres from the start
+    void send(float north, float lng_scale) {
+        latitude    = START_LAT + (int32_t)((north + _err_north) / LATLON_TO_M);
+        longitude   = START_LNG + (int32_t)(_err_east / (LATLON_TO_M * lng_scale));
+        altitude    = 58400;
+        hdop        = 150;
+        num_sats    = 9;
+        _vel_north  = SPEED * 100;
+        _vel_east   = 0;
+        _vel_down   = 0;
+        fix         = true;
+        _pending    = true;
+    }
+
+    float err_north(void) { return _err_north; }
+    float err_east(void)  { return _err_east; }
+
+protected:
+    bool read(void) {
+        bool ret = _pending;
+        _pending = false;
+        return ret;
+    }
+
+private:
+    float _err_north;
+    float _err_east;
+    bool _pending;
+};
+
+static SimGPS rx1(2.0f, 1.0f);
+static SimGPS rx2(-1.5f, -2.0f);
+static GPS *gps1 = &rx1;
+static GPS *gps2 = &rx2;
+static AP_GPS_Blend blend(&gps1, &gps2);
+
+/*
+  a switch is timed from the last fix of the first receiver before it
+  drops out, or from its first fix when it comes back
+ */
+struct switch_result {
+    bool switched;
+    uint32_t switch_ms;         // time from the switch to the blend failing over
+    float max_step;             // largest step in the error, in m
+    uint32_t settled_ms;        // time from the switch to settling
+};
+
+static void print_result(const char *name, const struct switch_result &r)
+{
+    hal.console->printf_P(PSTR("%s: failover after %lums, largest step %.2fm, "
+                               "settled after %lums\n"),
+                          name, (unsigned long)r.switch_ms, r.max_step,
+                          (unsigned long)r.settled_ms);
+}
+
+void setup()
+{
+    hal.console->println_P(PSTR("GPS blend dropout test"));
+
+    blend.init(NULL);
+    rx1.init(NULL);
+    rx2.init(NULL);
+
+    struct switch_result result[2];
+    memset(result, 0, sizeof(result));
+
+    float lng_scale = cos(ToRad(START_LAT * 1.0e-7f));
+    float last_err_north = 0, last_err_east = 0;
+    bool have_last = false;
+    uint32_t switch_ms[2] = { 0, 0 };
+    uint32_t start_ms = hal.scheduler->millis();
+
+    for (uint32_t n=0; ; n++) {
+        uint32_t t_ms = hal.scheduler->millis() - start_ms;
+        if (t_ms >= END_MS) {
+            break;
+        }
+        float north = SPEED * t_ms * 0.001f;
+
+        if (n % FIX_LOOPS == 0 && (t_ms < DROPOUT_MS || t_ms >= RETURN_MS)) {
+            rx1.send(north, lng_scale);
+            if (t_ms < DROPOUT_MS) {
+                switch_ms[0] = t_ms;
+            } else if (switch_ms[1] == 0) {
+                switch_ms[1] = t_ms;
+            }
+        }
+        if (n % FIX_LOOPS == FIX_LOOPS/2) {
+            rx2.send(north, lng_scale);
+        }
+
+        blend.update();
+        if (blend.new_data) {
+            blend.new_data = false;
+
+            // the error of the blended position, and what it should
+            // settle to: the other receiver's error while the first is
+            // out, otherwise the average of the two
+            float err_north = (blend.latitude - START_LAT) * LATLON_TO_M - north;
+            float err_east  = (blend.longitude - START_LNG) * LATLON_TO_M * lng_scale;
+            bool out = t_ms >= DROPOUT_MS && t_ms < RETURN_MS;
+            float want_north = out ? rx2.err_north() : (rx1.err_north() + rx2.err_north()) / 2;
+            float want_east  = out ? rx2.err_east()  : (rx1.err_east() + rx2.err_east()) / 2;
+
+            uint8_t e = t_ms < RETURN_MS ? 0 : 1;
+            uint32_t since_ms = t_ms - switch_ms[e];
+            if (t_ms >= DROPOUT_MS) {
+                struct switch_result &r = result[e];
+                uint8_t primary = e == 0 ? 2 : 1;
+                if (!r.switched && blend.primary() == primary) {
+                    r.switched = true;
+                    r.switch_ms = since_ms;
+                }
+                if (have_last) {
+                    float step = pythagorous2(err_north - last_err_north, err_east - last_err_east);
+                    if (step > r.max_step) {
+                        r.max_step = step;
+                    }
+                }
+                if (!r.switched ||
+                    pythagorous2(err_north - want_north, err_east - want_east) > SETTLED_M) {
+                    r.settled_ms = since_ms;
+                }
+                if (since_ms < TRACE_MS) {
+                    hal.console->printf_P(PSTR("%5lums rx%u error N %.2fm E %.2fm\n"),
+                                          (unsigned long)t_ms, blend.primary(),
+                                          err_north, err_east);
+                }
+            }
+            last_err_north = err_north;
+            last_err_east  = err_east;
+            have_last = true;
+        }
+
+        hal.scheduler->delay(LOOP_MS);
+    }
+
+    print_result("dropout", result[0]);
+    print_result("return", result[1]);
+    hal.console->println_P(PSTR("done"));
+}
+
+void loop()
+{
+    hal.scheduler->delay(1000);
+}
+
+AP_HAL_MAIN();
@@ -0,0 +1,732 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: t -*-
+/*
+ *       Replay and fuzz test of the GPS drivers.
+ *
+ *       Each driver is fed a capture of its protocol through a UART that
+ *       hands over the bytes as fast as a 38400 baud port fills, first as
+ *       sent and then with bytes flipped, dropped and line noise put in.
+ *       Every fix in a capture is at its own latitude, so the fixes a
+ *       driver reports can be matched to the ones sent. For each driver
+ *       it prints the fixes decoded, how long after the end of a fix it
+ *       was reported, the good fixes lost getting back in step after
+ *       corrupt data, any false fixes, and how fast the parser runs.
+ *       Last, the captures are given to AP_GPS_Auto to see how many bytes
+ *       it takes to recognise each protocol.
+ *
+ *       The captures are made up here. On SITL a recorded capture can be
+ *       replayed instead by setting GPS_REPLAY to the protocol and the
+ *       file, eg GPS_REPLAY=ublox:flight.ubx
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <AP_Common.h>
+#include <AP_Progmem.h>
+#include <AP_Param.h>
+#include <AP_HAL.h>
+#include <AP_HAL_AVR.h>
+#include <AP_HAL_AVR_SITL.h>
+#include <AP_HAL_Empty.h>
+#include <AP_HAL_PX4.h>
+#include <AP_GPS.h>
+#include <AP_GPS_MTK16.h>
+#include <AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL_BOARD_DRIVER;
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_APM1 || CONFIG_HAL_BOARD == HAL_BOARD_APM2
+ # define CAPTURE_SIZE   1536
+ # define MAX_FIXES      12
+#else
+ # define CAPTURE_SIZE   32000
+ # define MAX_FIXES      250
+#endif
+
+// the most bytes the messages of one fix take
+#define MAX_FIX_BYTES   256
+
+// the GPS sends a fix every 200ms at 38400 baud, and is read every 20ms
+#define FIX_MS          200
+#define BYTES_PER_SEC   (38400 / 10)
+#define LOOP_MS         20
+
+// fix k is at latitude FIX_LAT_BASE + k * FIX_LAT_STEP, far enough apart
+// for the rounding of the NMEA minutes
+#define FIX_LAT_BASE    -353630000L
+#define FIX_LAT_STEP    1000
+#define FIX_LNG         1491652300L
+
+/*
+  A UART giving the driver the bytes of a capture as they come in. What
+  the driver sends is thrown away.
+ */
+class ReplayUART : public AP_HAL::UARTDriver {
+public:
+    void start(const uint8_t *data, uint16_t len) {
+        _data = data;
+        _len = len;
+        _pos = 0;
+        _arrived = 0;
+    }
+
+    // let the capture up to offset n come in
+    void arrive(uint16_t n) {
+        _arrived = n < _len ? n : _len;
+    }
+
+    uint16_t arrived(void) { return _arrived; }
+    bool done(void) { return _pos == _len; }
+
+    void begin(uint32_t b) {}
+    void begin(uint32_t b, uint16_t rxS, uint16_t txS) {}
+    void end() {}
+    void flush() {}
+    bool is_initialized() { return true; }
+    void set_blocking_writes(bool blocking) {}
+    bool tx_pending() { return false; }
+
+    void print_P(const prog_char_t *pstr) {}
+    void println_P(const prog_char_t *pstr) {}
+    void printf(const char *pstr, ...) {}
+    void _printf_P(const prog_char *pstr, ...) {}
+    void vprintf(const char *pstr, va_list ap) {}
+    void vprintf_P(const prog_char *pstr, va_list ap) {}
+
+    int16_t available() { return _arrived - _pos; }
+    int16_t txspace() { return 256; }
+    int16_t read() { return _pos == _arrived ? -1 : _data[_pos++]; }
+    int16_t peek() { return _pos == _arrived ? -1 : _data[_pos]; }
+    uint16_t read(uint8_t *buf, uint16_t n) {
+        if (n > _arrived - _pos) {
+            n = _arrived - _pos;
+        }
+        memcpy(buf, &_data[_pos], n);
+        _pos += n;
+        return n;
+    }
+    size_t write(uint8_t c) { return 1; }
+
+private:
+    const uint8_t *_data;
+    uint16_t _len;
+    uint16_t _pos;
+    uint16_t _arrived;
+};
+
+struct fix_record {
+    uint16_t start;         // capture offset of the first byte
+    uint16_t end;           // capture offset past the message the fix is reported on
+    bool damaged;           // some of the fix was corrupted
+    bool reported;
+};
+
+struct protocol {
+    const char *name;
+    GPS *gps;
+    // put the messages of fix k in buf, returning their length
+    uint16_t (*make_fix)(uint8_t *buf, uint16_t k, uint16_t &fix_end);
+};
+
+struct replay_result {
+    uint16_t decoded;           // good fixes reported
+    uint16_t lost;              // good fixes not reported
+    uint16_t damaged;
+    uint16_t damaged_decoded;   // corrupted fixes reported anyway
+    uint16_t false_fixes;       // reports that match no fix sent
+    uint32_t latency_ms;        // sum of the times from the end of a fix to its report
+    uint16_t latency_max;
+    uint16_t detect_bytes;      // bytes in when AP_GPS_Auto picked a driver
+};
+
+static ReplayUART uart;
+static uint8_t capture[CAPTURE_SIZE];
+static uint16_t capture_len;
+static struct fix_record fixes[MAX_FIXES];
+static uint16_t num_fixes;
+
+static AP_GPS_UBLOX gps_ublox;
+static AP_GPS_MTK19 gps_mtk19;
+static AP_GPS_MTK16 gps_mtk16;
+static AP_GPS_MTK gps_mtk;
+static AP_GPS_SIRF gps_sirf;
+static AP_GPS_NMEA gps_nmea;
+
+// set by AP_GPS_Auto to the driver it picks
+static GPS *gps_detected;
+
+static int32_t fix_latitude(uint16_t k)
+{
+    return FIX_LAT_BASE + (int32_t)k * FIX_LAT_STEP;
+}
+
+// the fix a reported latitude belongs to, or -1
+static int16_t fix_index(int32_t lat)
+{
+    if (lat < FIX_LAT_BASE - FIX_LAT_STEP/10) {
+        return -1;
+    }
+    int32_t k = (lat - FIX_LAT_BASE + FIX_LAT_STEP/2) / FIX_LAT_STEP;
+    int32_t err = lat - fix_latitude(k);
+    if (k >= num_fixes || err > FIX_LAT_STEP/10 || err < -FIX_LAT_STEP/10) {
+        return -1;
+    }
+    return k;
+}
+
+// time of day of fix k in ms, 200ms apart as at 5Hz
+static uint32_t fix_time_ms(uint16_t k)
+{
+    return 43200000UL + 200UL * k;
+}
+
+// time of day of fix k as hhmmssmmm, for the MTK protocols
+static uint32_t fix_time_hms(uint16_t k)
+{
+    uint32_t t = fix_time_ms(k);
+    return (t / 3600000UL) * 10000000UL + (t / 60000UL % 60) * 100000UL + t % 60000UL;
+}
+
+static void put_le(uint8_t *p, uint32_t v, uint8_t n)
+{
+    while (n--) {
+        *p++ = v;
+        v >>= 8;
+    }
+}
+
+static void put_be(uint8_t *p, uint32_t v, uint8_t n)
+{
+    while (n--) {
+        p[n] = v;
+        v >>= 8;
+    }
+}
+
+// two byte Fletcher checksum of the uBlox and MTK protocols
+static void put_fletcher(uint8_t *p, const uint8_t *start)
+{
+    uint8_t ck_a = 0, ck_b = 0;
+    while (start != p) {
+        ck_b += (ck_a += *start++);
+    }
+    p[0] = ck_a;
+    p[1] = ck_b;
+}
+
+static uint16_t ubx_msg(uint8_t *buf, uint8_t msg_id, const uint8_t *payload, uint16_t len)
+{
+    buf[0] = 0xb5;
+    buf[1] = 0x62;
+    buf[2] = 0x01;          // CLASS_NAV
+    buf[3] = msg_id;
+    put_le(&buf[4], len, 2);
+    memcpy(&buf[6], payload, len);
+    put_fletcher(&buf[6 + len], &buf[2]);
+    return len + 8;
+}
+
+// NAV-STATUS, NAV-POSLLH, NAV-SOL and NAV-VELNED, as a uBlox sends them
+static uint16_t ublox_fix(uint8_t *buf, uint16_t k, uint16_t &fix_end)
+{
+    uint32_t tow = 345600000UL + 200UL * k;
+    uint8_t p[52];
+    uint16_t n = 0;
+
+    memset(p, 0, sizeof(p));
+    put_le(&p[0], tow, 4);
+    p[4] = 3;               // 3D fix
+    p[5] = 1;               // fix valid
+    n += ubx_msg(&buf[n], 0x03, p, 16);
+
+    put_le(&p[4], FIX_LNG, 4);
+    put_le(&p[8], fix_latitude(k), 4);
+    put_le(&p[12], 603600, 4);
+    put_le(&p[16], 584000, 4);
+    put_le(&p[20], 1500, 4);
+    put_le(&p[24], 2500, 4);
+    n += ubx_msg(&buf[n], 0x02, p, 28);
+
+    memset(p, 0, sizeof(p));
+    put_le(&p[0], tow, 4);
+    p[10] = 3;
+    p[11] = 1;
+    put_le(&p[44], 150, 2);
+    p[47] = 9;
+    n += ubx_msg(&buf[n], 0x06, p, 52);
+
+    memset(p, 0, sizeof(p));
+    put_le(&p[0], tow, 4);
+    put_le(&p[4], 500, 4);
+    put_le(&p[8], 200, 4);
+    put_le(&p[12], -10, 4);
+    put_le(&p[16], 539, 4);
+    put_le(&p[20], 538, 4);
+    put_le(&p[24], 2180000, 4);
+    n += ubx_msg(&buf[n], 0x12, p, 36);
+
+    fix_end = n;
+    return n;
+}
+
+// the custom binary message of the MTK 1.6 to 1.9 firmware
+static uint16_t diyd_fix(uint8_t *buf, uint16_t k, uint8_t preamble1, uint8_t lat_lng_scale)
+{
+    uint8_t *p = &buf[3];
+    buf[0] = preamble1;
+    buf[1] = 0xdd;
+    buf[2] = 32;
+    memset(p, 0, 32);
+    put_le(&p[0], fix_latitude(k) / lat_lng_scale, 4);
+    put_le(&p[4], FIX_LNG / lat_lng_scale, 4);
+    put_le(&p[8], 58400, 4);
+    put_le(&p[12], 538, 4);
+    put_le(&p[16], 2180, 4);
+    p[20] = 9;
+    p[21] = 3;
+    put_le(&p[22], 181014, 4);
+    put_le(&p[26], fix_time_hms(k), 4);
+    put_le(&p[30], 150, 2);
+    put_fletcher(&p[32], &buf[2]);
+    return 37;
+}
+
+static uint16_t mtk19_fix(uint8_t *buf, uint16_t k, uint16_t &fix_end)
+{
+    return fix_end = diyd_fix(buf, k, 0xd1, 1);
+}
+
+static uint16_t mtk16_fix(uint8_t *buf, uint16_t k, uint16_t &fix_end)
+{
+    return fix_end = diyd_fix(buf, k, 0xd0, 10);
+}
+
+// the big endian custom message of the MTK 1.4 firmware
+static uint16_t mtk_fix(uint8_t *buf, uint16_t k, uint16_t &fix_end)
+{
+    uint8_t *p = &buf[4];
+    buf[0] = 0xb5;
+    buf[1] = 0x62;
+    buf[2] = 0x01;
+    buf[3] = 0x05;
+    put_be(&p[0], fix_latitude(k) / 10, 4);
+    put_be(&p[4], FIX_LNG / 10, 4);
+    put_be(&p[8], 58400, 4);
+    put_be(&p[12], 538, 4);
+    put_be(&p[16], 2180 * 10000UL, 4);
+    p[20] = 9;
+    p[21] = 3;
+    put_be(&p[22], fix_time_hms(k), 4);
+    put_fletcher(&p[26], &buf[2]);
+    return fix_end = 32;
+}
+
+// SiRF geodetic navigation data, message 41
+static uint16_t sirf_fix(uint8_t *buf, uint16_t k, uint16_t &fix_end)
+{
+    const uint16_t len = 91;
+    uint8_t *p = &buf[4];
+    buf[0] = 0xa0;
+    buf[1] = 0xa2;
+    put_be(&buf[2], len, 2);
+    memset(p, 0, len);
+    p[0] = 41;
+    put_be(&p[1+6], 345600000UL + 200UL * k, 4);
+    put_be(&p[1+22], fix_latitude(k), 4);
+    put_be(&p[1+26], FIX_LNG, 4);
+    put_be(&p[1+34], 58400, 4);
+    put_be(&p[1+39], 538, 2);
+    put_be(&p[1+41], 2180, 2);
+    p[1+87] = 9;
+    p[1+88] = 4;
+
+    uint16_t checksum = 0;
+    for (uint16_t i=0; i<len; i++) {
+        checksum += p[i];
+    }
+    put_be(&p[len], checksum & 0x7fff, 2);
+    p[len+2] = 0xb0;
+    p[len+3] = 0xb3;
+    return fix_end = len + 8;
+}
+
+static uint16_t nmea_sentence(uint8_t *buf, const char *body)
+{
+    uint8_t parity = 0;
+    for (const char *p = body; *p; p++) {
+        parity ^= *p;
+    }
+    return sprintf((char *)buf, "$%s*%02X\r\n", body, parity);
+}
+
+// ddmm.mmmmm, or dddmm.mmmmm for a longitude
+static void nmea_degrees(char *s, int32_t v, bool longitude)
+{
+    uint32_t a = labs(v);
+    uint32_t min = (a % 10000000UL) * 3 / 5;
+    sprintf(s, longitude ? "%03lu%02lu.%05lu" : "%02lu%02lu.%05lu",
+            (unsigned long)(a / 10000000UL),
+            (unsigned long)(min / 100000UL),
+            (unsigned long)(min % 100000UL));
+}
+
+// GGA, RMC and VTG. The fix is reported on the GGA
+static uint16_t nmea_fix(uint8_t *buf, uint16_t k, uint16_t &fix_end)
+{
+    char time[12], lat[12], lng[12], body[100];
+    uint32_t t = fix_time_ms(k);
+    char ns = fix_latitude(k) < 0 ? 'S' : 'N';
+    uint16_t n;
+
+    sprintf(time, "%02lu%02lu%02lu.%02lu",
+            (unsigned long)(t / 3600000UL), (unsigned long)(t / 60000UL % 60),
+            (unsigned long)(t / 1000UL % 60), (unsigned long)(t / 10UL % 100));
+    nmea_degrees(lat, fix_latitude(k), false);
+    nmea_degrees(lng, FIX_LNG, true);
+
+    sprintf(body, "GPGGA,%s,%s,%c,%s,E,1,09,0.9,584.0,M,19.6,M,,", time, lat, ns, lng);
+    n = nmea_sentence(buf, body);
+    fix_end = n;
+    sprintf(body, "GPRMC,%s,A,%s,%c,%s,E,010.5,021.8,181014,,,A", time, lat, ns, lng);
+    n += nmea_sentence(&buf[n], body);
+    n += nmea_sentence(&buf[n], "GPVTG,021.8,T,,M,010.5,N,019.4,K,A");
+    return n;
+}
+
+static const struct protocol protocols[] = {
+    { "ublox",  &gps_ublox, ublox_fix },
+    { "mtk19",  &gps_mtk19, mtk19_fix },
+    { "mtk16",  &gps_mtk16, mtk16_fix },
+    { "mtk",    &gps_mtk,   mtk_fix },
+    { "sirf",   &gps_sirf,  sirf_fix },
+    { "nmea",   &gps_nmea,  nmea_fix },
+};
+
+// xorshift, so that every run corrupts the same bytes
+static uint32_t fuzz_state;
+
+static uint32_t fuzz_random(void)
+{
+    fuzz_state ^= fuzz_state << 13;
+    fuzz_state ^= fuzz_state >> 17;
+    fuzz_state ^= fuzz_state << 5;
+    return fuzz_state;
+}
+
+static void capture_byte(uint8_t c)
+{
+    if (capture_len < CAPTURE_SIZE - 64) {
+        capture[capture_len++] = c;
+    }
+}
+
+/*
+  make a capture of as many fixes as fit. With corrupt_per_1000 set, that
+  many of every thousand bytes sent are flipped, dropped, or have line
+  noise or the start of a message cut short put in front of them
+ */
+static void make_capture(const struct protocol &p, uint16_t corrupt_per_1000)
+{
+    uint8_t msg[MAX_FIX_BYTES];
+
+    fuzz_state = 2463534242UL;
+    capture_len = 0;
+    num_fixes = 0;
+    while (num_fixes < MAX_FIXES && capture_len + 2*MAX_FIX_BYTES + 64 < CAPTURE_SIZE) {
+        struct fix_record &f = fixes[num_fixes];
+        uint16_t fix_end;
+        uint16_t n = p.make_fix(msg, num_fixes, fix_end);
+        num_fixes++;
+
+        f.start = capture_len;
+        f.damaged = false;
+        f.reported = false;
+        for (uint16_t i=0; i<n; i++) {
+            if (i == fix_end) {
+                f.end = capture_len;
+            }
+            if (corrupt_per_1000 == 0 || fuzz_random() % 1000 >= corrupt_per_1000) {
+                capture_byte(msg[i]);
+                continue;
+            }
+            if (i < fix_end) {
+                f.damaged = true;
+            }
+            uint32_t r = fuzz_random();
+            uint8_t count = 1 + (r >> 8) % 32;
+            switch (r % 4) {
+            case 0:
+                capture_byte(msg[i] ^ (1 + (r >> 16) % 255));
+                break;
+            case 1:
+                // dropped
+                break;
+            case 2:
+                // noise, a quarter of it the first byte of the message
+                while (count--) {
+                    r = fuzz_random();
+                    capture_byte((r & 0x300) ? r : msg[0]);
+                }
+                capture_byte(msg[i]);
+                break;
+            case 3:
+                for (uint8_t j=0; j<count && j<n; j++) {
+                    capture_byte(msg[j]);
+                }
+                capture_byte(msg[i]);
+                break;
+            }
+        }
+        if (fix_end == n) {
+            f.end = capture_len;
+        }
+    }
+
+    // some idle bytes, so no driver is left part way through a message
+    // for the next capture
+    memset(&capture[capture_len], 0, 64);
+    capture_len += 64;
+}
+
+// time the GPS starts to send fix k. The fixes are FIX_MS apart, each
+// a few ms later against the loop than the last so that the latencies
+// aren't all the same
+static uint32_t fix_start_ms(uint16_t k)
+{
+    return (k+1) * (uint32_t)FIX_MS + (k * 7) % LOOP_MS;
+}
+
+// time by which the message fix k is reported on is in
+static uint32_t fix_end_ms(uint16_t k)
+{
+    return fix_start_ms(k) + (fixes[k].end - fixes[k].start) * 1000UL / BYTES_PER_SEC;
+}
+
+// capture offset of the bytes in by time t_ms
+static uint16_t capture_arrived(uint32_t t_ms)
+{
+    if (t_ms < fix_start_ms(0)) {
+        return 0;
+    }
+    uint32_t k = t_ms / FIX_MS - 1;
+    if (k >= num_fixes) {
+        return capture_len;
+    }
+    if (t_ms < fix_start_ms(k)) {
+        k--;
+    }
+    uint16_t next = k+1 < num_fixes ? fixes[k+1].start : capture_len;
+    uint32_t n = fixes[k].start + (t_ms - fix_start_ms(k)) * BYTES_PER_SEC / 1000;
+    return n < next ? n : next;
+}
+
+/*
+  replay the capture to *gps in 20ms loops, as a vehicle would read it,
+  matching the fixes reported to the ones sent. gps is a pointer to a
+  pointer for AP_GPS_Auto, which changes it once it knows the protocol,
+  and which needs the loops to take real time until then.
+ */
+static void replay(GPS **gps, struct replay_result &r, bool real_time)
+{
+    GPS *first = *gps;
+    int32_t last_lat = 0;
+
+    memset(&r, 0, sizeof(r));
+    uart.start(capture, capture_len);
+    (*gps)->init(&uart);
+    (*gps)->latitude = 0;
+    (*gps)->new_data = false;
+
+    for (uint32_t t_ms = LOOP_MS; !uart.done(); t_ms += LOOP_MS) {
+        uart.arrive(capture_arrived(t_ms));
+        (*gps)->update();
+        if (*gps == first && real_time) {
+            hal.scheduler->delay(LOOP_MS);
+        } else if (*gps != first && r.detect_bytes == 0) {
+            r.detect_bytes = uart.arrived();
+        }
+        if (!(*gps)->new_data) {
+            continue;
+        }
+        (*gps)->new_data = false;
+
+        // some messages don't move the fix on, so only count changes
+        if ((*gps)->latitude == last_lat) {
+            continue;
+        }
+        last_lat = (*gps)->latitude;
+        int16_t k = fix_index(last_lat);
+        if (k < 0) {
+            r.false_fixes++;
+            continue;
+        }
+        struct fix_record &f = fixes[k];
+        if (!f.reported && !f.damaged && t_ms > fix_end_ms(k)) {
+            uint16_t late = t_ms - fix_end_ms(k);
+            r.latency_ms += late;
+            if (late > r.latency_max) {
+                r.latency_max = late;
+            }
+        }
+        f.reported = true;
+    }
+
+    for (uint16_t k=0; k<num_fixes; k++) {
+        if (fixes[k].damaged) {
+            r.damaged++;
+            if (fixes[k].reported) {
+                r.damaged_decoded++;
+            }
+        } else if (fixes[k].reported) {
+            r.decoded++;
+        } else {
+            r.lost++;
+        }
+    }
+}
+
+// microseconds to parse the capture, with the port always full
+static uint32_t parse_time(GPS *gps)
+{
+    uint32_t total = 0;
+
+    gps->init(&uart);
+    for (uint8_t pass=0; pass<10; pass++) {
+        uart.start(capture, capture_len);
+        for (uint16_t n = 512; !uart.done(); n += 512) {
+            uart.arrive(n);
+            uint32_t t0 = hal.scheduler->micros();
+            gps->update();
+            total += hal.scheduler->micros() - t0;
+        }
+    }
+    return total / 10;
+}
+
+static void test_protocol(const struct protocol &p)
+{
+    GPS *gps = p.gps;
+    struct replay_result r;
+
+    make_capture(p, 0);
+    replay(&gps, r, false);
+    uint32_t us = parse_time(gps);
+    hal.console->printf_P(PSTR("%s clean: %u/%u fixes, latency avg %.1fms max %ums, "
+                               "parse %.0fkB/s %.1fus/fix\n"),
+                          p.name, r.decoded, num_fixes,
+                          r.decoded ? (float)r.latency_ms / r.decoded : 0.0f,
+                          r.latency_max,
+                          capture_len * 1000.0f / (us ? us : 1),
+                          (float)us / num_fixes);
+
+    static const uint16_t levels[] = { 1, 10 };
+    for (uint8_t i=0; i<sizeof(levels)/sizeof(levels[0]); i++) {
+        make_capture(p, levels[i]);
+        replay(&gps, r, false);
+        hal.console->printf_P(PSTR("%s %.1f%% corrupt: %u/%u good fixes, %u lost, "
+                                   "%u/%u corrupted fixes, %u false\n"),
+                              p.name, levels[i] * 0.1f,
+                              r.decoded, r.decoded + r.lost, r.lost,
+                              r.damaged_decoded, r.damaged, r.false_fixes);
+    }
+}
+
+// bytes AP_GPS_Auto takes to recognise the protocol, and the fixes the
+// driver it picks decodes from the rest
+static void test_detect(const struct protocol &p)
+{
+    AP_GPS_Auto autodetect(&gps_detected);
+    struct replay_result r;
+
+    gps_detected = &autodetect;
+    make_capture(p, 0);
+    hal.console->printf_P(PSTR("%s detect:"), p.name);
+    replay(&gps_detected, r, true);
+    if (gps_detected == &autodetect) {
+        hal.console->println_P(PSTR(" not detected"));
+        return;
+    }
+    hal.console->printf_P(PSTR("%s detect: %u bytes, %u/%u fixes decoded\n"),
+                          p.name, r.detect_bytes, r.decoded, num_fixes);
+}
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+// replay a recorded capture, named by GPS_REPLAY=protocol:file
+static bool replay_file(void)
+{
+    const char *env = getenv("GPS_REPLAY");
+    if (env == NULL) {
+        return false;
+    }
+    const char *file = strchr(env, ':');
+    const struct protocol *p = NULL;
+    for (uint8_t i=0; file && i<sizeof(protocols)/sizeof(protocols[0]); i++) {
+        if (strncmp(env, protocols[i].name, file - env) == 0 &&
+            protocols[i].name[file - env] == 0) {
+            p = &protocols[i];
+        }
+    }
+    if (p == NULL) {
+        hal.console->println_P(PSTR("GPS_REPLAY should be protocol:file"));
+        return true;
+    }
+    FILE *f = fopen(file+1, "rb");
+    if (f == NULL) {
+        hal.console->printf_P(PSTR("can't open %s\n"), file+1);
+        return true;
+    }
+    capture_len = fread(capture, 1, sizeof(capture), f);
+    fclose(f);
+
+    GPS *gps = p->gps;
+    uint16_t reports = 0, with_fix = 0;
+    uart.start(capture, capture_len);
+    gps->init(&uart);
+    for (uint32_t t_ms = LOOP_MS; !uart.done(); t_ms += LOOP_MS) {
+        uart.arrive(t_ms * BYTES_PER_SEC / 1000);
+        gps->update();
+        if (gps->new_data) {
+            gps->new_data = false;
+            reports++;
+            if (gps->fix) {
+                with_fix++;
+            }
+        }
+    }
+    uint32_t us = parse_time(gps);
+    hal.console->printf_P(PSTR("%s: %u bytes, %u reports, %u with a fix, "
+                               "parse %.0fkB/s\n"),
+                          file+1, capture_len, reports, with_fix,
+                          capture_len * 1000.0f / (us ? us : 1));
+    hal.console->printf_P(PSTR("last: Lat %ld Lon %ld Alt %ld time %lu\n"),
+                          (long)gps->latitude, (long)gps->longitude,
+                          (long)gps->altitude, (unsigned long)gps->time);
+    return true;
+}
+#endif
+
+void setup()
+{
+    hal.console->println_P(PSTR("GPS replay and fuzz test"));
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+    if (replay_file()) {
+        return;
+    }
+#endif
+
+    for (uint8_t i=0; i<sizeof(protocols)/sizeof(protocols[0]); i++) {
+        test_protocol(protocols[i]);
+    }
+    for (uint8_t i=0; i<sizeof(protocols)/sizeof(protocols[0]); i++) {
+        test_detect(protocols[i]);
+    }
+    hal.console->println_P(PSTR("done"));
+}
+
+void loop()
+{
+    hal.scheduler->delay(1000);
+}
+
+AP_HAL_MAIN();
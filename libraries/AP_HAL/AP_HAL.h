@@ -25,6 +25,7 @@
 #include "utility/Print.h"
 #include "utility/Stream.h"
 #include "utility/BetterStream.h"
+#include "utility/TimerProcTable.h"
 
 /* HAL Class definition */
 #include "HAL.h"
@@ -14,6 +14,7 @@
 #define HAL_BOARD_APM2     2
 #define HAL_BOARD_AVR_SITL 3
 #define HAL_BOARD_SMACCM   4
+#define HAL_BOARD_LINUX    5
 #define HAL_BOARD_EMPTY    99
 
 /*
@@ -32,6 +33,8 @@
 #define AP_HAL_BOARD_DRIVER AP_HAL_PX4
 #elif CONFIG_HAL_BOARD == HAL_BOARD_SMACCM
 #define AP_HAL_BOARD_DRIVER AP_HAL_SMACCM
+#elif CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define AP_HAL_BOARD_DRIVER AP_HAL_Linux
 #elif CONFIG_HAL_BOARD == HAL_BOARD_EMPTY
 #define AP_HAL_BOARD_DRIVER AP_HAL_Empty
 #else
@@ -2,6 +2,8 @@
 #ifndef __AP_HAL_NAMESPACE_H__
 #define __AP_HAL_NAMESPACE_H__
 
+#include <stdint.h>
+
 namespace AP_HAL {
 
     /* Toplevel pure virtual class Hal.*/
@@ -31,6 +33,7 @@ namespace AP_HAL {
     class Print;
     class Stream;
     class BetterStream;
+    template <uint8_t MAX_PROCS> class TimerProcTable;
 
     /* Typdefs for function pointers (Procedure, Timed Procedure) */
     typedef void(*Proc)(void);
@@ -0,0 +1,137 @@
+
+#ifndef __AP_HAL_STATIC_H__
+#define __AP_HAL_STATIC_H__
+
+#include "AP_HAL.h"
+
+/*
+  Static binding of the HAL drivers used in hot paths.
+
+  Every call through hal.scheduler, hal.uartA, hal.rcout or hal.storage
+  is a virtual call, which costs a load of the vtable and an indirect
+  call each time. The hal_static:: functions below do the same work,
+  but with HAL_STATIC_BINDING set to 1 they cast the driver to the
+  concrete class of the board being built and call it with a qualified
+  name. That is a direct call, and drivers that define the method in
+  their header (the scheduler's micros() and millis() on AVR, SITL and
+  Linux) are inlined.
+
+  With HAL_STATIC_BINDING at 0, the default, they are plain virtual
+  calls, so a board can be built either way for comparison, for
+  example with "make sitl" and "make sitl-static".
+
+  The cast is only correct while the HAL object of the board uses the
+  driver classes listed here for uartA-uartC, rcout, storage and
+  scheduler.
+ */
+
+#ifndef HAL_STATIC_BINDING
+#define HAL_STATIC_BINDING 0
+#endif
+
+#if HAL_STATIC_BINDING
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_APM1 || CONFIG_HAL_BOARD == HAL_BOARD_APM2
+#include "../AP_HAL_AVR/AP_HAL_AVR.h"
+#include "../AP_HAL_AVR/AP_HAL_AVR_private.h"
+namespace AP_HAL { namespace Board {
+    typedef AP_HAL_AVR::AVRScheduler     Scheduler;
+    typedef AP_HAL_AVR::AVRUARTDriver    UARTDriver;
+    typedef AP_HAL_AVR::AVREEPROMStorage Storage;
+#if CONFIG_HAL_BOARD == HAL_BOARD_APM1
+    typedef AP_HAL_AVR::APM1RCOutput     RCOutput;
+#else
+    typedef AP_HAL_AVR::APM2RCOutput     RCOutput;
+#endif
+}}
+#elif CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include "../AP_HAL_AVR_SITL/AP_HAL_AVR_SITL.h"
+#include "../AP_HAL_AVR_SITL/AP_HAL_AVR_SITL_Private.h"
+#include "../AP_HAL_AVR_SITL/RCOutput.h"
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include "../AP_HAL_Linux/AP_HAL_Linux.h"
+#include "../AP_HAL_Linux/AP_HAL_Linux_Private.h"
+#endif
+namespace AP_HAL { namespace Board {
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    typedef Linux::LinuxScheduler        Scheduler;
+#else
+    typedef AVR_SITL::SITLScheduler      Scheduler;
+#endif
+    typedef AVR_SITL::SITLUARTDriver     UARTDriver;
+    typedef AVR_SITL::SITLEEPROMStorage  Storage;
+    typedef AVR_SITL::SITLRCOutput       RCOutput;
+}}
+#elif CONFIG_HAL_BOARD == HAL_BOARD_PX4
+#include "../AP_HAL_PX4/AP_HAL_PX4.h"
+#include "../AP_HAL_PX4/Scheduler.h"
+#include "../AP_HAL_PX4/UARTDriver.h"
+#include "../AP_HAL_PX4/Storage.h"
+#include "../AP_HAL_PX4/RCOutput.h"
+namespace AP_HAL { namespace Board {
+    typedef PX4::PX4Scheduler            Scheduler;
+    typedef PX4::PX4UARTDriver           UARTDriver;
+    typedef PX4::PX4EEPROMStorage        Storage;
+    typedef PX4::PX4RCOutput             RCOutput;
+}}
+#elif CONFIG_HAL_BOARD == HAL_BOARD_SMACCM
+#include "../AP_HAL_SMACCM/AP_HAL_SMACCM.h"
+#include "../AP_HAL_SMACCM/AP_HAL_SMACCM_Private.h"
+namespace AP_HAL { namespace Board {
+    typedef SMACCM::SMACCMScheduler      Scheduler;
+    typedef SMACCM::SMACCMUARTDriver     UARTDriver;
+    typedef SMACCM::SMACCMStorage        Storage;
+    typedef SMACCM::SMACCMRCOutput       RCOutput;
+}}
+#elif CONFIG_HAL_BOARD == HAL_BOARD_EMPTY
+#include "../AP_HAL_Empty/AP_HAL_Empty.h"
+#include "../AP_HAL_Empty/AP_HAL_Empty_Private.h"
+namespace AP_HAL { namespace Board {
+    typedef Empty::EmptyScheduler        Scheduler;
+    typedef Empty::EmptyUARTDriver       UARTDriver;
+    typedef Empty::EmptyStorage          Storage;
+    typedef Empty::EmptyRCOutput         RCOutput;
+}}
+#else
+#error "HAL_STATIC_BINDING is not supported on this board"
+#endif
+
+// a qualified, and so non-virtual, call of a method of the concrete
+// driver class
+#define HAL_STATIC_CALL(driver, type, method) \
+    (static_cast<AP_HAL::Board::type *>(driver)->AP_HAL::Board::type::method)
+
+#else // HAL_STATIC_BINDING
+
+#define HAL_STATIC_CALL(driver, type, method) ((driver)->method)
+
+#endif // HAL_STATIC_BINDING
+
+extern const AP_HAL::HAL& hal;
+
+namespace hal_static {
+    static inline uint32_t micros() {
+        return HAL_STATIC_CALL(hal.scheduler, Scheduler, micros)();
+    }
+    static inline uint32_t millis() {
+        return HAL_STATIC_CALL(hal.scheduler, Scheduler, millis)();
+    }
+    static inline void delay_microseconds(uint16_t us) {
+        HAL_STATIC_CALL(hal.scheduler, Scheduler, delay_microseconds)(us);
+    }
+
+    // uart is one of hal.uartA, hal.uartB or hal.uartC
+    static inline size_t uart_write(AP_HAL::UARTDriver *uart, uint8_t c) {
+        return HAL_STATIC_CALL(uart, UARTDriver, write)(c);
+    }
+
+    static inline void rcout_write(uint8_t ch, uint16_t period_us) {
+        HAL_STATIC_CALL(hal.rcout, RCOutput, write)(ch, period_us);
+    }
+
+    static inline uint8_t storage_read_byte(uint16_t loc) {
+        return HAL_STATIC_CALL(hal.storage, Storage, read_byte)(loc);
+    }
+}
+
+#endif // __AP_HAL_STATIC_H__
@@ -9,6 +9,46 @@
 
 class AP_HAL::Scheduler {
 public:
+    /* Priorities of timer processes. The processes due on a tick are
+     * called highest priority first, so sensors that need to be sampled
+     * at a steady time should be registered as high priority. */
+    enum TimerPriority {
+        TIMER_PRIORITY_LOW    = 0,
+        TIMER_PRIORITY_NORMAL = 1,
+        TIMER_PRIORITY_HIGH   = 2
+    };
+
+    /* Timing of one timer process since the statistics were cleared. */
+    struct TimerProcStats {
+        AP_HAL::TimedProc proc;
+        uint8_t  freq_div;
+        uint8_t  priority;
+        uint16_t num_calls;
+        uint16_t min_time_us;
+        uint16_t mean_time_us;
+        uint16_t max_time_us;
+        uint16_t worst_tick_time_us;    /* time taken in the worst tick */
+    };
+
+    /* Timing of the timer ticks since the statistics were cleared. The
+     * worst tick is the one where the processes took longest in total,
+     * and the time each process took in it is in its TimerProcStats. */
+    struct TimerStats {
+        uint8_t  num_procs;
+        uint32_t num_ticks;
+        uint16_t missed_ticks;          /* ticks when the processes were
+                                         * suspended or locked out */
+        uint16_t overrun_ticks;         /* ticks that came while the last
+                                         * one was still running */
+        uint16_t worst_tick_us;
+        uint32_t worst_tick_start_us;   /* micros() when it started */
+
+        /* stack high water marks in bytes since boot, which are not
+         * cleared. Zero on boards that do not measure them */
+        uint16_t main_stack_bytes;      /* used outside the timer */
+        uint16_t timer_stack_bytes;     /* used by the timer processes */
+    };
+
     Scheduler() {}
     virtual void     init(void* implspecific) = 0;
     virtual void     delay(uint16_t ms) = 0;
@@ -18,13 +58,26 @@ public:
     virtual void     register_delay_callback(AP_HAL::Proc,
                         uint16_t min_time_ms) = 0;
 
-    virtual void     register_timer_process(AP_HAL::TimedProc) = 0;
+    /* register_timer_process: call proc on every freq_div'th tick of the
+     * 1kHz timer, so a freq_div of 10 runs it at 100Hz. */
+    virtual void     register_timer_process(AP_HAL::TimedProc proc,
+                        uint8_t freq_div = 1,
+                        uint8_t priority = TIMER_PRIORITY_NORMAL) = 0;
     virtual void     suspend_timer_procs() = 0;
     virtual void     resume_timer_procs() = 0;
     
     virtual void     register_timer_failsafe(AP_HAL::TimedProc,
                         uint32_t period_us) = 0;
 
+    /* statistics of the timer processes, for finding out which driver
+     * is using the time of the timer. get_timer_proc_stats() returns
+     * false if there is no i'th process. The processes are numbered in
+     * the order they are called. */
+    virtual void     get_timer_stats(TimerStats &stats) = 0;
+    virtual bool     get_timer_proc_stats(uint8_t i,
+                        TimerProcStats &stats) = 0;
+    virtual void     clear_timer_stats() = 0;
+
     virtual void     panic(const prog_char_t *errormsg) = 0;
     virtual void     reboot() = 0;
 };
@@ -38,6 +38,22 @@ public:
     virtual bool is_initialized() = 0;
     virtual void set_blocking_writes(bool blocking) = 0;
     virtual bool tx_pending() = 0;
+
+    /* read up to n bytes into buf, returning the number read. This
+     * default reads them a byte at a time; drivers override it to copy
+     * them out of their receive buffer in one go */
+    using AP_HAL::BetterStream::read;
+    virtual uint16_t read(uint8_t *buf, uint16_t n) {
+        uint16_t count = 0;
+        while (count < n) {
+            int16_t c = read();
+            if (c == -1) {
+                break;
+            }
+            buf[count++] = c;
+        }
+        return count;
+    }
 };
 
 #endif // __AP_HAL_UART_DRIVER_H__
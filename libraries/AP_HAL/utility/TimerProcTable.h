@@ -0,0 +1,208 @@
+#ifndef __AP_HAL_UTILITY_TIMER_PROC_TABLE_H__
+#define __AP_HAL_UTILITY_TIMER_PROC_TABLE_H__
+
+#include <stdint.h>
+#include "../AP_HAL_Namespace.h"
+#include "../Scheduler.h"
+
+/* The table of timer processes shared by the HAL schedulers.
+ *
+ * Each process has a rate divider and a priority. On every tick of the
+ * 1kHz timer only the processes that are due are called, highest
+ * priority first. The table keeps the shortest, mean and longest time
+ * each process has taken, and the time each took in the tick where the
+ * processes took longest in total. The owning scheduler tells the table
+ * about ticks that were missed or overran so they are counted with the
+ * rest.
+ *
+ * The table does no locking of its own. The owning scheduler must stop
+ * run() being entered (by disabling interrupts or taking its atomic
+ * lock) around add(), as add() moves entries to keep them in priority
+ * order, and around reading or clearing the statistics. */
+
+template <uint8_t MAX_PROCS>
+class AP_HAL::TimerProcTable {
+public:
+    TimerProcTable() : _num_procs(0) { clear_stats(); }
+
+    /* add a process to be called every freq_div ticks. Registering a
+     * process a second time leaves it as it is. Returns false if the
+     * table is full. */
+    bool add(AP_HAL::TimedProc proc, uint8_t freq_div, uint8_t priority) {
+        for (uint8_t i = 0; i < _num_procs; i++) {
+            if (_procs[i].proc == proc) {
+                return true;
+            }
+        }
+        if (_num_procs >= MAX_PROCS) {
+            return false;
+        }
+        if (freq_div == 0) {
+            freq_div = 1;
+        }
+
+        /* insert after any processes of the same or higher priority */
+        uint8_t i = _num_procs;
+        while (i > 0 && _procs[i-1].priority < priority) {
+            _procs[i] = _procs[i-1];
+            _worst_tick_proc_us[i] = _worst_tick_proc_us[i-1];
+            i--;
+        }
+        _procs[i].proc = proc;
+        _procs[i].freq_div = freq_div;
+        _procs[i].priority = priority;
+        _clear_entry(i);
+        /* the first call is a whole period after registration, which
+         * gives drivers that start a conversion in their init time for
+         * it to complete. Drivers registered at different times also
+         * end up on different ticks */
+        _procs[i].countdown = freq_div;
+        _num_procs++;
+        return true;
+    }
+
+    /* one tick of the timer has passed, call the processes that are
+     * due. micros is used to time each one */
+    void run(uint32_t tnow, uint32_t (*micros)(void)) {
+        uint32_t tstart = tnow;
+        bool called = false;
+        _num_ticks++;
+        for (uint8_t i = 0; i < _num_procs; i++) {
+            Entry &e = _procs[i];
+            if (--e.countdown != 0) {
+                continue;
+            }
+            e.countdown = e.freq_div;
+            e.proc(tnow);
+            called = true;
+
+            uint32_t tend = micros();
+            uint32_t time_taken = tend - tstart;
+            if (time_taken > 0xFFFF) {
+                time_taken = 0xFFFF;
+            }
+            e.last_time_us = time_taken;
+            if (time_taken < e.min_time_us) {
+                e.min_time_us = time_taken;
+            }
+            if (time_taken > e.max_time_us) {
+                e.max_time_us = time_taken;
+            }
+            /* the counts stop when they are full, which keeps the
+             * mean correct if the stats are not cleared often */
+            if (e.num_calls < 0xFFFF) {
+                e.num_calls++;
+                e.total_time_us += time_taken;
+            }
+            tstart = tend;
+        }
+
+        /* keep what each process took in the worst tick. A process was
+         * called on this tick if its countdown was just reset */
+        uint32_t tick_time = tstart - tnow;
+        if (called && tick_time > _worst_tick_us) {
+            _worst_tick_us = tick_time > 0xFFFF ? 0xFFFF : tick_time;
+            _worst_tick_start_us = tnow;
+            for (uint8_t i = 0; i < _num_procs; i++) {
+                const Entry &e = _procs[i];
+                _worst_tick_proc_us[i] =
+                    e.countdown == e.freq_div ? e.last_time_us : 0;
+            }
+        }
+    }
+
+    /* a tick went by while the processes were suspended */
+    void note_missed_tick() {
+        if (_missed_ticks < 0xFFFF) {
+            _missed_ticks++;
+        }
+    }
+
+    /* a tick came while the processes of the last one were still
+     * running */
+    void note_overrun_tick() {
+        if (_overrun_ticks < 0xFFFF) {
+            _overrun_ticks++;
+        }
+    }
+
+    uint8_t  num_procs() const { return _num_procs; }
+
+    /* the longest time in microseconds the i'th process has taken to
+     * run, in priority order */
+    uint16_t max_time_us(uint8_t i) const { return _procs[i].max_time_us; }
+
+    void get_stats(AP_HAL::Scheduler::TimerStats &stats) const {
+        stats.num_procs = _num_procs;
+        stats.num_ticks = _num_ticks;
+        stats.missed_ticks = _missed_ticks;
+        stats.overrun_ticks = _overrun_ticks;
+        stats.worst_tick_us = _worst_tick_us;
+        stats.worst_tick_start_us = _worst_tick_start_us;
+        stats.main_stack_bytes = 0;
+        stats.timer_stack_bytes = 0;
+    }
+
+    bool get_proc_stats(uint8_t i,
+                        AP_HAL::Scheduler::TimerProcStats &stats) const {
+        if (i >= _num_procs) {
+            return false;
+        }
+        const Entry &e = _procs[i];
+        stats.proc = e.proc;
+        stats.freq_div = e.freq_div;
+        stats.priority = e.priority;
+        stats.num_calls = e.num_calls;
+        stats.min_time_us = e.num_calls ? e.min_time_us : 0;
+        stats.mean_time_us = e.num_calls ? e.total_time_us / e.num_calls : 0;
+        stats.max_time_us = e.max_time_us;
+        stats.worst_tick_time_us = _worst_tick_proc_us[i];
+        return true;
+    }
+
+    void clear_stats() {
+        for (uint8_t i = 0; i < _num_procs; i++) {
+            _clear_entry(i);
+        }
+        _num_ticks = 0;
+        _missed_ticks = 0;
+        _overrun_ticks = 0;
+        _worst_tick_us = 0;
+        _worst_tick_start_us = 0;
+    }
+
+private:
+    struct Entry {
+        AP_HAL::TimedProc proc;
+        uint32_t total_time_us;
+        uint16_t num_calls;
+        uint16_t min_time_us;
+        uint16_t max_time_us;
+        uint16_t last_time_us;
+        uint8_t  freq_div;
+        uint8_t  countdown;         /* ticks until the process is next due */
+        uint8_t  priority;
+    };
+
+    void _clear_entry(uint8_t i) {
+        Entry &e = _procs[i];
+        e.total_time_us = 0;
+        e.num_calls = 0;
+        e.min_time_us = 0xFFFF;
+        e.max_time_us = 0;
+        e.last_time_us = 0;
+        _worst_tick_proc_us[i] = 0;
+    }
+
+    Entry    _procs[MAX_PROCS];
+    uint16_t _worst_tick_proc_us[MAX_PROCS];
+    uint8_t  _num_procs;
+
+    uint32_t _num_ticks;
+    uint16_t _missed_ticks;
+    uint16_t _overrun_ticks;
+    uint16_t _worst_tick_us;
+    uint32_t _worst_tick_start_us;
+};
+
+#endif // __AP_HAL_UTILITY_TIMER_PROC_TABLE_H__
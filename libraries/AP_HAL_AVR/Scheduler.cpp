@@ -6,6 +6,7 @@
 #include <avr/io.h>
 #include <avr/wdt.h>
 #include <avr/interrupt.h>
+#include <string.h>
 
 #include "Scheduler.h"
 #include "ISRRegistry.h"
@@ -17,6 +18,22 @@ extern const AP_HAL::HAL& hal;
  * 256-62 gives a 1kHz period. */
 #define RESET_TCNT2_VALUE (256 - 62)
 
+/* The stack used by the timer processes is measured every
+ * STACK_CHECK_TICKS ticks, by painting up to STACK_CHECK_BYTES below the
+ * timer's stack frame before calling them and looking at how much of
+ * the paint is gone afterwards. The paint is not memcheck's sentinel,
+ * and the words that held the sentinel get it back afterwards unless
+ * the timer processes used them, so memcheck sees the stack as if it
+ * had not been painted. */
+#define STACK_CHECK_TICKS 64
+#define STACK_CHECK_BYTES 256
+#define STACK_PAINT 0x54494d52
+#define MEMCHECK_SENTINEL 0x28021967
+
+/* the end of the heap, from avr-libc */
+extern char *__brkval;
+extern char __heap_start;
+
 /* Static AVRScheduler variables: */
 AVRTimer AVRScheduler::_timer;
 
@@ -24,8 +41,15 @@ AP_HAL::TimedProc AVRScheduler::_failsafe = NULL;
 volatile bool AVRScheduler::_timer_suspended = false;
 volatile bool AVRScheduler::_timer_event_missed = false;
 volatile bool AVRScheduler::_in_timer_proc = false;
-AP_HAL::TimedProc AVRScheduler::_timer_proc[AVR_SCHEDULER_MAX_TIMER_PROCS] = {NULL};
-uint8_t AVRScheduler::_num_timer_procs = 0;
+AP_HAL::TimerProcTable<AVR_SCHEDULER_MAX_TIMER_PROCS> AVRScheduler::_timer_procs;
+uint16_t AVRScheduler::_main_stack_bytes;
+uint16_t AVRScheduler::_timer_stack_bytes;
+uint32_t *AVRScheduler::_stack_paint_top;
+uint32_t *AVRScheduler::_stack_paint_bottom;
+uint8_t AVRScheduler::_stack_check_ticks;
+uint8_t AVRScheduler::_stack_sentinel[STACK_CHECK_BYTES/32];
+volatile uint16_t AVRScheduler::_isr_wait_sp;
+uint8_t AVRScheduler::_isr_frame_bytes;
 
 
 AVRScheduler::AVRScheduler() :
@@ -49,14 +73,14 @@ void AVRScheduler::init(void* _isrregistry) {
     TIMSK2 = _BV(TOIE2);            /* Enable overflow interrupt*/
     /* Register _timer_isr_event to trigger on overflow */
     isrregistry->register_signal(ISR_REGISTRY_TIMER2_OVF, _timer_isr_event);   
-}
-
-uint32_t AVRScheduler::micros() {
-    return _timer.micros();
-}
 
-uint32_t AVRScheduler::millis() {
-    return _timer.millis();
+    /* Wait for a tick with nothing on the stack below here, so the
+     * timer interrupt can work out how much stack it takes itself and
+     * leave that out of the main loop's stack. Nothing is left out if
+     * the tick does not come. */
+    _isr_wait_sp = SP;
+    for (uint16_t i = 0; i < 0xFFFF && _isr_wait_sp != 0; i++) ;
+    _isr_wait_sp = 0;
 }
 
 void AVRScheduler::delay_microseconds(uint16_t us) {
@@ -87,24 +111,14 @@ void AVRScheduler::register_delay_callback(AP_HAL::Proc proc,
     _min_delay_cb_ms = min_time_ms;
 }
 
-void AVRScheduler::register_timer_process(AP_HAL::TimedProc proc) {
-    for (int i = 0; i < _num_timer_procs; i++) {
-        if (_timer_proc[i] == proc) {
-            return;
-        }
-    }
-
-    if (_num_timer_procs < AVR_SCHEDULER_MAX_TIMER_PROCS) {
-        /* this write to _timer_proc can be outside the critical section
-         * because that memory won't be used until _num_timer_procs is
-         * incremented. */
-        _timer_proc[_num_timer_procs] = proc;
-        /* _num_timer_procs is used from interrupt, and multiple bytes long. */
-        cli();
-        _num_timer_procs++;
-        sei();
-    }
-
+void AVRScheduler::register_timer_process(AP_HAL::TimedProc proc,
+        uint8_t freq_div, uint8_t priority) {
+    /* the table is used from interrupt, and adding a process may move
+     * the existing entries. */
+    uint8_t sreg = SREG;
+    cli();
+    _timer_procs.add(proc, freq_div, priority);
+    SREG = sreg;
 }
 
 void AVRScheduler::register_timer_failsafe(
@@ -113,6 +127,33 @@ void AVRScheduler::register_timer_failsafe(
     _failsafe = failsafe;
 }
 
+/* the statistics are written from interrupt, so they are copied and
+ * cleared with interrupts disabled */
+void AVRScheduler::get_timer_stats(AP_HAL::Scheduler::TimerStats &stats) {
+    uint8_t sreg = SREG;
+    cli();
+    _timer_procs.get_stats(stats);
+    stats.main_stack_bytes = _main_stack_bytes;
+    stats.timer_stack_bytes = _timer_stack_bytes;
+    SREG = sreg;
+}
+
+bool AVRScheduler::get_timer_proc_stats(uint8_t i,
+        AP_HAL::Scheduler::TimerProcStats &stats) {
+    uint8_t sreg = SREG;
+    cli();
+    bool ret = _timer_procs.get_proc_stats(i, stats);
+    SREG = sreg;
+    return ret;
+}
+
+void AVRScheduler::clear_timer_stats() {
+    uint8_t sreg = SREG;
+    cli();
+    _timer_procs.clear_stats();
+    SREG = sreg;
+}
+
 void AVRScheduler::suspend_timer_procs() {
     _timer_suspended = true;
 }
@@ -152,6 +193,7 @@ void AVRScheduler::_run_timer_procs(bool called_from_isr) {
         // need be.  We assume the failsafe code can't
         // block. If it does then we will recurse and die when
         // we run out of stack
+        _timer_procs.note_overrun_tick();
         if (_failsafe != NULL) {
             _failsafe(tnow);
         }
@@ -160,15 +202,21 @@ void AVRScheduler::_run_timer_procs(bool called_from_isr) {
 
     _in_timer_proc = true;
 
+    if (called_from_isr) {
+        _check_stack_before();
+    }
+
     if (!_timer_suspended) {
-        // now call the timer based drivers
-        for (int i = 0; i < _num_timer_procs; i++) {
-            if (_timer_proc[i] != NULL) {
-                _timer_proc[i](tnow);
-            }
-        }
+        // now call the timer based drivers that are due
+        _timer_procs.run(tnow, AVRTimer::micros);
     } else if (called_from_isr) {
         _timer_event_missed = true;
+        _timer_procs.note_missed_tick();
+    }
+
+    // the paint has to come off even if nothing ran
+    if (_stack_paint_top != NULL) {
+        _check_stack_after();
     }
 
     // and the failsafe, if one is setup
@@ -179,6 +227,72 @@ void AVRScheduler::_run_timer_procs(bool called_from_isr) {
     _in_timer_proc = false;
 }
 
+/* The stack pointer when the timer goes off, less the timer
+ * interrupt's own frame, shows how deep the main loop is. It is only a
+ * sample at each tick; memcheck_available_memory() gives the deepest the
+ * stack has been, with the interrupts. */
+void AVRScheduler::_check_stack_before() {
+    uint16_t sp = SP;
+    if (_isr_wait_sp != 0) {
+        _isr_frame_bytes = _isr_wait_sp - sp;
+        _isr_wait_sp = 0;
+    }
+    uint16_t main_bytes = RAMEND - sp - _isr_frame_bytes;
+    if (main_bytes > _main_stack_bytes) {
+        _main_stack_bytes = main_bytes;
+    }
+
+    _stack_paint_top = NULL;
+    if (++_stack_check_ticks < STACK_CHECK_TICKS) {
+        return;
+    }
+    _stack_check_ticks = 0;
+
+    /* leave a few bytes for the stack of this function */
+    uint32_t *top = (uint32_t *)((sp - 8) & ~3);
+    char *heap_end = __brkval != NULL ? __brkval : &__heap_start;
+    uint32_t *bottom = top - STACK_CHECK_BYTES/4;
+    if ((char *)bottom < heap_end + 32) {
+        bottom = (uint32_t *)(((uintptr_t)heap_end + 32 + 3) & ~3);
+    }
+    if (bottom >= top) {
+        return;
+    }
+
+    memset(_stack_sentinel, 0, sizeof(_stack_sentinel));
+    for (uint8_t i = 0; bottom + i < top; i++) {
+        if (bottom[i] == MEMCHECK_SENTINEL) {
+            _stack_sentinel[i/8] |= 1 << (i%8);
+        }
+        bottom[i] = STACK_PAINT;
+    }
+    _stack_paint_top = top;
+    _stack_paint_bottom = bottom;
+}
+
+/* The lowest word of the paint that has changed is as deep as the timer
+ * processes, and any interrupts taken while they ran, went. The words
+ * still painted that held memcheck's sentinel get it back. */
+void AVRScheduler::_check_stack_after() {
+    uint32_t *bottom = _stack_paint_bottom;
+    uint8_t n = _stack_paint_top - bottom;
+    uint8_t lowest = n;
+    for (uint8_t i = 0; i < n; i++) {
+        if (bottom[i] != STACK_PAINT) {
+            if (lowest == n) {
+                lowest = i;
+            }
+        } else if (_stack_sentinel[i/8] & (1 << (i%8))) {
+            bottom[i] = MEMCHECK_SENTINEL;
+        }
+    }
+    uint16_t used = (n - lowest) * 4;
+    if (used > _timer_stack_bytes) {
+        _timer_stack_bytes = used;
+    }
+    _stack_paint_top = NULL;
+}
+
 void AVRScheduler::panic(const prog_char_t* errormsg) {
     /* Suspend timer processes. We still want the timer event to go off
      * to run the _failsafe code, however. */
@@ -5,7 +5,7 @@
 #include <AP_HAL.h>
 #include "AP_HAL_AVR_Namespace.h"
 
-#define AVR_SCHEDULER_MAX_TIMER_PROCS 4
+#define AVR_SCHEDULER_MAX_TIMER_PROCS 6
 
 /* Class for managing the AVR Timers: */
 class AP_HAL_AVR::AVRTimer {
@@ -28,16 +28,24 @@ public:
      * AP_HAL_AVR::ISRRegistry*. */
     void     init(void *isrregistry);
     void     delay(uint16_t ms);
-    uint32_t millis();
-    uint32_t micros();
+    /* defined here so a statically bound call is inlined, see
+     * AP_HAL_Static.h */
+    uint32_t millis() { return AVRTimer::millis(); }
+    uint32_t micros() { return AVRTimer::micros(); }
     void     delay_microseconds(uint16_t us);
     void     register_delay_callback(AP_HAL::Proc, uint16_t min_time_ms);
 
-    void     register_timer_process(AP_HAL::TimedProc);
+    void     register_timer_process(AP_HAL::TimedProc, uint8_t freq_div,
+                                    uint8_t priority);
     void     suspend_timer_procs();
     void     resume_timer_procs();
 
     void     register_timer_failsafe(AP_HAL::TimedProc, uint32_t period_us);
+
+    void     get_timer_stats(AP_HAL::Scheduler::TimerStats &stats);
+    bool     get_timer_proc_stats(uint8_t i,
+                                  AP_HAL::Scheduler::TimerProcStats &stats);
+    void     clear_timer_stats();
     void     panic(const prog_char_t *errormsg);
     void     reboot();
 
@@ -57,10 +65,21 @@ private:
 
     static AP_HAL::TimedProc _failsafe;
 
+    /* stack measurement, see _check_stack_before() */
+    static void _check_stack_before();
+    static void _check_stack_after();
+    static uint16_t _main_stack_bytes;
+    static uint16_t _timer_stack_bytes;
+    static uint32_t *_stack_paint_top;
+    static uint32_t *_stack_paint_bottom;
+    static uint8_t _stack_check_ticks;
+    static uint8_t _stack_sentinel[];   /* which painted words held memcheck's */
+    static volatile uint16_t _isr_wait_sp;
+    static uint8_t _isr_frame_bytes;    /* stack taken by the timer interrupt */
+
     static volatile bool _timer_suspended;
     static volatile bool _timer_event_missed;
-    static AP_HAL::TimedProc _timer_proc[AVR_SCHEDULER_MAX_TIMER_PROCS];
-    static uint8_t _num_timer_procs;
+    static AP_HAL::TimerProcTable<AVR_SCHEDULER_MAX_TIMER_PROCS> _timer_procs;
 
 };
 #endif // __AP_HAL_AVR_SCHEDULER_H__
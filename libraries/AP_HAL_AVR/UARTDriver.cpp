@@ -13,6 +13,7 @@
 #include <limits.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include <avr/pgmspace.h>
 
@@ -150,6 +151,28 @@ int16_t AVRUARTDriver::read(void) {
 	return (c);
 }
 
+uint16_t AVRUARTDriver::read(uint8_t *buf, uint16_t n) {
+	if (!_open)
+		return 0;
+
+	// copy out up to the head as it is now, in at most two pieces
+	// where the ring wraps
+	uint8_t head = _rxBuffer->head;
+	uint8_t tail = _rxBuffer->tail;
+	uint16_t count = 0;
+	while (count < n && tail != head) {
+		uint16_t len = (tail < head ? head : _rxBuffer->mask + 1) - tail;
+		if (len > n - count)
+			len = n - count;
+		memcpy(&buf[count], &_rxBuffer->bytes[tail], len);
+		count += len;
+		tail = (tail + len) & _rxBuffer->mask;
+	}
+	_rxBuffer->tail = tail;
+
+	return count;
+}
+
 int16_t AVRUARTDriver::peek(void) {
 
 	// if the head and tail are equal, the buffer is empty
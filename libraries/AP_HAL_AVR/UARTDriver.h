@@ -56,6 +56,9 @@ public:
     int16_t read();
     int16_t peek();
 
+    /* Implementations of UARTDriver virtual methods */
+    uint16_t read(uint8_t *buf, uint16_t n);
+
     /* Implementations of Print virtual methods */
     size_t write(uint8_t c);
 
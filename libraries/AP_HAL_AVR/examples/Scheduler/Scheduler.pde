@@ -65,6 +65,30 @@ void setup_pin(int pin_num) {
     hal.gpio->write(pin_num,0);
 }
 
+void print_timer_stats() {
+    AP_HAL::Scheduler::TimerStats stats;
+    hal.scheduler->get_timer_stats(stats);
+    hal.console->printf_P(PSTR("%lu ticks, %u missed, %u overran, "
+                "worst tick %uus at %lu\r\n"),
+            (unsigned long) stats.num_ticks,
+            (unsigned) stats.missed_ticks,
+            (unsigned) stats.overrun_ticks,
+            (unsigned) stats.worst_tick_us,
+            (unsigned long) stats.worst_tick_start_us);
+
+    AP_HAL::Scheduler::TimerProcStats proc;
+    for (uint8_t i = 0; hal.scheduler->get_timer_proc_stats(i, proc); i++) {
+        hal.console->printf_P(PSTR("proc %u: %u calls, min %u mean %u "
+                    "max %u us, %u us in worst tick\r\n"),
+                (unsigned) i,
+                (unsigned) proc.num_calls,
+                (unsigned) proc.min_time_us,
+                (unsigned) proc.mean_time_us,
+                (unsigned) proc.max_time_us,
+                (unsigned) proc.worst_tick_time_us);
+    }
+}
+
 void setup (void) {
     hal.console->printf_P(PSTR("Starting AP_HAL_AVR::Scheduler test\r\n"));
 
@@ -92,14 +116,20 @@ void setup (void) {
     hal.console->printf_P(PSTR("Testing running timer processes.\r\n"));
     hal.console->printf_P(PSTR("Pin %d should toggle at 1khz.\r\n"),
             (int) SCHEDULED_TOGGLE_PIN_1);
-    hal.console->printf_P(PSTR("Pin %d should toggle at 1khz.\r\n"),
-            (int) SCHEDULED_TOGGLE_PIN_2);
+    hal.console->printf_P(PSTR("Pin %d should toggle at 100hz, just before "
+                "pin %d on the same tick.\r\n"),
+            (int) SCHEDULED_TOGGLE_PIN_2, (int) SCHEDULED_TOGGLE_PIN_1);
 
     hal.scheduler->register_timer_process(schedule_toggle_1);
-    hal.scheduler->register_timer_process(schedule_toggle_2);
+    hal.scheduler->register_timer_process(schedule_toggle_2, 10,
+            AP_HAL::Scheduler::TIMER_PRIORITY_HIGH);
 
     hal.scheduler->delay(100);
 
+    hal.console->printf_P(PSTR("Timer statistics, the 100hz process "
+                "should be called 10 times:\r\n"));
+    print_timer_stats();
+
     hal.console->printf_P(PSTR("Test running a pathological timer process.\r\n"
                 "Failsafe should continue even as pathological process "
                 "dominates the processor."));
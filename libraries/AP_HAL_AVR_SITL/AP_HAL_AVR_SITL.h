@@ -4,7 +4,9 @@
 
 #include <AP_HAL.h>
 
+#include "AP_HAL_AVR_SITL_Namespace.h"
 #include "HAL_AVR_SITL_Class.h"
+#include "SITL_State.h"
 #include "AP_HAL_AVR_SITL_Main.h"
 
 #endif // __AP_HAL_AVR_SITL_H__
@@ -3,7 +3,7 @@
 #define __AP_HAL_AVR_SITL_RCINPUT_H__
 
 #include <AP_HAL.h>
-#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 #include <AP_HAL_AVR_SITL.h>
 
 class AVR_SITL::SITLRCInput : public AP_HAL::RCInput {
@@ -2,7 +2,7 @@
 
 #include <AP_HAL.h>
 
-#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 
 #include <AP_HAL_AVR.h>
 #include <AP_HAL_AVR_SITL.h>
@@ -30,12 +30,17 @@ uint16_t SITL_State::_framerate;
 struct sockaddr_in SITL_State::_rcout_addr;
 pid_t SITL_State::_parent_pid;
 uint32_t SITL_State::_update_count;
+struct sitl_fdm SITL_State::_fdm_pkt;
+uint32_t SITL_State::_fdm_count;
+AP_HAL::Semaphore *SITL_State::_fdm_sem;
 bool SITL_State::_motors_on;
 uint16_t SITL_State::airspeed_pin_value;
 
 AP_Baro_BMP085_HIL *SITL_State::_barometer;
 AP_InertialSensor_Stub *SITL_State::_ins;
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
 SITLScheduler *SITL_State::_scheduler;
+#endif
 AP_Compass_HIL *SITL_State::_compass;
 
 int SITL_State::_sitl_fd;
@@ -127,7 +132,9 @@ void SITL_State::_sitl_setup(void)
 	_rcout_addr.sin_port = htons(_rcout_port);
 	inet_pton(AF_INET, "127.0.0.1", &_rcout_addr.sin_addr);
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
 	_setup_timer();
+#endif
 	_setup_fdm();
 	fprintf(stdout, "Starting SITL input\n");
 
@@ -183,14 +190,12 @@ void SITL_State::_setup_fdm(void)
 }
 
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
 /*
   timer called at 1kHz
  */
 void SITL_State::_timer_handler(int signum)
 {
-	static uint32_t last_update_count;
-    static uint32_t last_pwm_input;
-
 	static bool in_timer;
 
 	if (in_timer || _scheduler->interrupts_are_blocked()){
@@ -200,6 +205,36 @@ void SITL_State::_timer_handler(int signum)
     _scheduler->sitl_begin_atomic();
 	in_timer = true;
 
+    update();
+
+	// trigger all APM timers. We do this last as it can re-enable
+	// interrupts, which can lead to recursion
+	_scheduler->timer_event();
+
+    _scheduler->sitl_end_atomic();
+	in_timer = false;
+}
+#endif
+
+
+/*
+  exchange packets with the flight simulator and update the simulated
+  sensors. Called at 1kHz from the timer signal on SITL
+ */
+void SITL_State::update(void)
+{
+	fdm_io();
+	update_sensors();
+}
+
+
+/*
+  exchange packets with the flight simulator
+ */
+void SITL_State::fdm_io(void)
+{
+    static uint32_t last_pwm_input;
+
 #ifndef __CYGWIN__
 	/* make sure we die if our parent dies */
 	if (kill(_parent_pid, 0) != 0) {
@@ -229,19 +264,37 @@ void SITL_State::_timer_handler(int signum)
 
 	// send RC output to flight sim
 	_simulator_output();
+}
+
+
+/*
+  update the simulated sensors from the last packet from the flight
+  simulator
+ */
+void SITL_State::update_sensors(void)
+{
+	static uint32_t last_update_count;
+
+	// this runs on the timer, so rather than wait for fdm_io() to
+	// finish handing over a packet, pick it up on the next call
+	if (_fdm_sem == NULL || _fdm_sem->take_nonblocking()) {
+		if (_fdm_count != _update_count) {
+			if (_sitl != NULL) {
+				_sitl->state = _fdm_pkt;
+			}
+			_update_count = _fdm_count;
+		}
+		if (_fdm_sem != NULL) {
+			_fdm_sem->give();
+		}
+	}
 
 	if (_update_count == 0 && _sitl != NULL) {
 		_update_gps(0, 0, 0, 0, 0, false);
-		_scheduler->timer_event();
-        _scheduler->sitl_end_atomic();
-		in_timer = false;
 		return;
 	}
 
 	if (_update_count == last_update_count) {
-		_scheduler->timer_event();
-        _scheduler->sitl_end_atomic();
-		in_timer = false;
 		return;
 	}
 	last_update_count = _update_count;
@@ -257,13 +310,6 @@ void SITL_State::_timer_handler(int signum)
         _update_barometer(_sitl->state.altitude);
         _update_compass(_sitl->state.rollDeg, _sitl->state.pitchDeg, _sitl->state.heading);
     }
-
-	// trigger all APM timers. We do this last as it can re-enable
-	// interrupts, which can lead to recursion
-	_scheduler->timer_event();
-
-    _scheduler->sitl_end_atomic();
-	in_timer = false;
 }
 
 
@@ -299,10 +345,14 @@ void SITL_State::_fdm_input(void)
 			return;
 		}
 
-        if (_sitl != NULL) {
-            _sitl->state = d.fg_pkt;
-        }
-		_update_count++;
+		if (_fdm_sem != NULL) {
+			_fdm_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER);
+		}
+		_fdm_pkt = d.fg_pkt;
+		_fdm_count++;
+		if (_fdm_sem != NULL) {
+			_fdm_sem->give();
+		}
 
 		count++;
 		if (hal.scheduler->millis() - last_report > 1000) {
@@ -416,6 +466,7 @@ void SITL_State::_simulator_output(void)
 }
 
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
 /*
   setup a timer used to prod the ISRs
  */
@@ -436,6 +487,7 @@ void SITL_State::_setup_timer(void)
 
 	setitimer(ITIMER_REAL, &it, NULL);
 }
+#endif
 
 // generate a random float between -1 and 1
 float SITL_State::_rand_float(void)
@@ -462,7 +514,9 @@ void SITL_State::init(int argc, char * const argv[])
     pwm_input[4] = pwm_input[7] = 1800;
     pwm_input[2] = pwm_input[5] = pwm_input[6] = 1000;
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
     _scheduler = (SITLScheduler *)hal.scheduler;
+#endif
 	_parse_command_line(argc, argv);
 }
 
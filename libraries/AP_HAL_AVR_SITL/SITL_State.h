@@ -4,7 +4,7 @@
 
 #include <AP_HAL.h>
 
-#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 
 #include <AP_HAL_AVR_SITL.h>
 #include "AP_HAL_AVR_SITL_Namespace.h"
@@ -39,6 +39,15 @@ public:
     static uint16_t pwm_input[8];
     static bool pwm_valid;
     static void loop_hook(void);
+    static void update(void);
+
+    // the two halves of update(). On Linux fdm_io() runs on a thread of
+    // its own so the sockets don't hold up the timer, and
+    // update_sensors() runs as a timer process. The packets from the
+    // flight simulator are handed over under the semaphore
+    static void fdm_io(void);
+    static void update_sensors(void);
+    static void set_fdm_semaphore(AP_HAL::Semaphore *sem) { _fdm_sem = sem; }
 
     // simulated airspeed
     static uint16_t airspeed_pin_value;
@@ -48,7 +57,9 @@ private:
     void _usage(void);
     void _sitl_setup(void);
     void _setup_fdm(void);
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
     void _setup_timer(void);
+#endif
     void _setup_adc(void);
 
     // these methods are static as they are called
@@ -72,7 +83,9 @@ private:
 
     // signal handlers
     static void _sig_fpe(int signum);
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
     static void _timer_handler(int signum);
+#endif
 
     // internal state
     static enum vehicle_type _vehicle;
@@ -81,11 +94,19 @@ private:
     static struct sockaddr_in _rcout_addr;
     static pid_t _parent_pid;
     static uint32_t _update_count;
+
+    // the last packet from the flight simulator, waiting for
+    // update_sensors() to pick it up
+    static struct sitl_fdm _fdm_pkt;
+    static uint32_t _fdm_count;
+    static AP_HAL::Semaphore *_fdm_sem;
     static bool _motors_on;
 
     static AP_Baro_BMP085_HIL *_barometer;
     static AP_InertialSensor_Stub *_ins;
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
     static SITLScheduler *_scheduler;
+#endif
     static AP_Compass_HIL *_compass;
 
     static int _sitl_fd;
@@ -94,6 +115,6 @@ private:
     static const uint16_t _simin_port = 5501;
 };
 
-#endif // CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 #endif // __AP_HAL_AVR_SITL_STATE_H__
 
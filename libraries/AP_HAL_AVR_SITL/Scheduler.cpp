@@ -16,8 +16,7 @@ extern const AP_HAL::HAL& hal;
 AP_HAL::TimedProc SITLScheduler::_failsafe = NULL;
 volatile bool SITLScheduler::_timer_suspended = false;
 volatile bool SITLScheduler::_timer_event_missed = false;
-AP_HAL::TimedProc SITLScheduler::_timer_proc[SITL_SCHEDULER_MAX_TIMER_PROCS] = {NULL};
-uint8_t SITLScheduler::_num_timer_procs = 0;
+AP_HAL::TimerProcTable<SITL_SCHEDULER_MAX_TIMER_PROCS> SITLScheduler::_timer_procs;
 bool SITLScheduler::_in_timer_proc = false;
 struct timeval SITLScheduler::_sketch_start_time;
 
@@ -38,11 +37,6 @@ uint32_t SITLScheduler::_micros()
 		       (_sketch_start_time.tv_usec*1.0e-6)));
 }
 
-uint32_t SITLScheduler::micros() 
-{
-    return _micros();
-}
-
 uint32_t SITLScheduler::millis() 
 {
 	struct timeval tp;
@@ -85,19 +79,13 @@ void SITLScheduler::register_delay_callback(AP_HAL::Proc proc,
     _min_delay_cb_ms = min_time_ms;
 }
 
-void SITLScheduler::register_timer_process(AP_HAL::TimedProc proc) 
+void SITLScheduler::register_timer_process(AP_HAL::TimedProc proc,
+                                           uint8_t freq_div, uint8_t priority) 
 {
-    for (uint8_t i = 0; i < _num_timer_procs; i++) {
-        if (_timer_proc[i] == proc) {
-            return;
-        }
-    }
-
-    if (_num_timer_procs < SITL_SCHEDULER_MAX_TIMER_PROCS) {
-        _timer_proc[_num_timer_procs] = proc;
-        _num_timer_procs++;
-    }
-
+    // block the timer signal while the table is changed
+    sitl_begin_atomic();
+    _timer_procs.add(proc, freq_div, priority);
+    sitl_end_atomic();
 }
 
 void SITLScheduler::register_timer_failsafe(AP_HAL::TimedProc failsafe, uint32_t period_us) 
@@ -105,6 +93,30 @@ void SITLScheduler::register_timer_failsafe(AP_HAL::TimedProc failsafe, uint32_t
     _failsafe = failsafe;
 }
 
+// the statistics are written by the timer signal, so block it while
+// they are copied or cleared
+void SITLScheduler::get_timer_stats(AP_HAL::Scheduler::TimerStats &stats)
+{
+    sitl_begin_atomic();
+    _timer_procs.get_stats(stats);
+    sitl_end_atomic();
+}
+
+bool SITLScheduler::get_timer_proc_stats(uint8_t i, AP_HAL::Scheduler::TimerProcStats &stats)
+{
+    sitl_begin_atomic();
+    bool ret = _timer_procs.get_proc_stats(i, stats);
+    sitl_end_atomic();
+    return ret;
+}
+
+void SITLScheduler::clear_timer_stats()
+{
+    sitl_begin_atomic();
+    _timer_procs.clear_stats();
+    sitl_end_atomic();
+}
+
 void SITLScheduler::suspend_timer_procs() {
     _timer_suspended = true;
 }
@@ -143,6 +155,7 @@ void SITLScheduler::_run_timer_procs(bool called_from_isr)
         // need be.  We assume the failsafe code can't
         // block. If it does then we will recurse and die when
         // we run out of stack
+        _timer_procs.note_overrun_tick();
         if (_failsafe != NULL) {
             _failsafe(tnow);
         }
@@ -151,14 +164,11 @@ void SITLScheduler::_run_timer_procs(bool called_from_isr)
     _in_timer_proc = true;
 
     if (!_timer_suspended) {
-        // now call the timer based drivers
-        for (int i = 0; i < _num_timer_procs; i++) {
-            if (_timer_proc[i] != NULL) {
-                _timer_proc[i](tnow);
-            }
-        }
+        // now call the timer based drivers that are due
+        _timer_procs.run(tnow, _micros);
     } else if (called_from_isr) {
         _timer_event_missed = true;
+        _timer_procs.note_missed_tick();
     }
 
     // and the failsafe, if one is setup
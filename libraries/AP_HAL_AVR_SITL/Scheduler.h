@@ -7,7 +7,7 @@
 #include "AP_HAL_AVR_SITL_Namespace.h"
 #include <sys/time.h>
 
-#define SITL_SCHEDULER_MAX_TIMER_PROCS 4
+#define SITL_SCHEDULER_MAX_TIMER_PROCS 8
 
 /* Scheduler implementation: */
 class AVR_SITL::SITLScheduler : public AP_HAL::Scheduler {
@@ -18,15 +18,21 @@ public:
     void     init(void *unused);
     void     delay(uint16_t ms);
     uint32_t millis();
-    uint32_t micros();
+    uint32_t micros() { return _micros(); }
     void     delay_microseconds(uint16_t us);
     void     register_delay_callback(AP_HAL::Proc, uint16_t min_time_ms);
 
-    void     register_timer_process(AP_HAL::TimedProc);
+    void     register_timer_process(AP_HAL::TimedProc, uint8_t freq_div,
+                                    uint8_t priority);
     void     suspend_timer_procs();
     void     resume_timer_procs();
 
     void     register_timer_failsafe(AP_HAL::TimedProc, uint32_t period_us);
+
+    void     get_timer_stats(AP_HAL::Scheduler::TimerStats &stats);
+    bool     get_timer_proc_stats(uint8_t i,
+                                  AP_HAL::Scheduler::TimerProcStats &stats);
+    void     clear_timer_stats();
     void     reboot();
     void     panic(const prog_char_t *errormsg);
 
@@ -50,8 +56,7 @@ private:
 
     static volatile bool _timer_suspended;
     static volatile bool _timer_event_missed;
-    static AP_HAL::TimedProc _timer_proc[SITL_SCHEDULER_MAX_TIMER_PROCS];
-    static uint8_t _num_timer_procs;
+    static AP_HAL::TimerProcTable<SITL_SCHEDULER_MAX_TIMER_PROCS> _timer_procs;
     static bool    _in_timer_proc;
 
 };
@@ -8,7 +8,7 @@
 // your option) any later version.
 //
 #include <AP_HAL.h>
-#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 
 #include <limits.h>
 #include <stdlib.h>
@@ -139,6 +139,25 @@ int16_t SITLUARTDriver::read(void)
     return -1;
 }
 
+uint16_t SITLUARTDriver::read(uint8_t *buf, uint16_t n)
+{
+    // the GPS port reads from a pipe, so the bytes can be read in one
+    // go. The sockets and console go a byte at a time, as read() does
+    if (_portNumber != 1) {
+        return AP_HAL::UARTDriver::read(buf, n);
+    }
+
+    int16_t numc = available();
+    if (numc <= 0) {
+        return 0;
+    }
+    if (n > numc) {
+        n = numc;
+    }
+    ssize_t ret = _sitlState->gps_read(_fd, buf, n);
+    return ret > 0 ? ret : 0;
+}
+
 int16_t SITLUARTDriver::peek(void) 
 {
     return -1;
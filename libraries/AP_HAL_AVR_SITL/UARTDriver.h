@@ -3,7 +3,7 @@
 #ifndef __AP_HAL_AVR_SITL_UART_DRIVER_H__
 #define __AP_HAL_AVR_SITL_UART_DRIVER_H__
 #include <AP_HAL.h>
-#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 
 #include <stdint.h>
 #include <stdarg.h>
@@ -55,6 +55,9 @@ public:
     int16_t read();
     int16_t peek();
 
+    /* Implementations of UARTDriver virtual methods */
+    uint16_t read(uint8_t *buf, uint16_t n);
+
     /* Implementations of Print virtual methods */
     size_t write(uint8_t c);
 
@@ -1,6 +1,6 @@
 
 #include <AP_HAL.h>
-#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 #include <stdio.h>
 #include <stdarg.h>
 
@@ -41,4 +41,4 @@ int SITLUtil::vsnprintf_P(char* str, size_t size, const prog_char_t *format,
     return libc_vsnprintf(str, size, format, ap);
 }
 
-#endif // CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
@@ -7,7 +7,7 @@
  */
 
 #include <AP_HAL.h>
-#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 
 #include <AP_HAL_AVR.h>
 #include <AP_HAL_AVR_SITL.h>
@@ -32,6 +32,10 @@ using namespace AVR_SITL;
 // using an APM1 with 5883L compass
 #define MAG_FIELD_STRENGTH 818
 
+// the compass is simulated from the timer, which can interrupt a
+// lookup by the vehicle, so it keeps its own decoded declination tile
+static AP_Declination::Tile declination_tile;
+
 /*
   given a magnetic heading, and roll, pitch, yaw values,
   calculate consistent magnetometer components
@@ -42,7 +46,8 @@ Vector3f SITL_State::_heading_to_mag(float roll, float pitch, float yaw)
 {
 	Vector3f Bearth, m;
 	Matrix3f R;
-	float declination = AP_Declination::get_declination(_sitl->state.latitude, _sitl->state.longitude);
+	float declination = AP_Declination::get_declination(_sitl->state.latitude, _sitl->state.longitude,
+	                                                    declination_tile);
 
 	// Bearth is the magnetic field in Canberra. We need to adjust
 	// it for inclination and declination
@@ -7,7 +7,7 @@
  */
 
 #include <AP_HAL.h>
-#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 
 #include <AP_HAL_AVR.h>
 #include <AP_HAL_AVR_SITL.h>
@@ -78,7 +78,7 @@ int SITL_State::gps_pipe(void)
 	pipe(fd);
 	gps_state.gps_fd    = fd[1];
 	gps_state.client_fd = fd[0];
-	gps_state.last_update = _scheduler->millis();
+	gps_state.last_update = hal.scheduler->millis();
 	AVR_SITL::SITLUARTDriver::_set_nonblocking(gps_state.gps_fd);
 	AVR_SITL::SITLUARTDriver::_set_nonblocking(fd[0]);
 	return gps_state.client_fd;
@@ -1,4 +1,5 @@
 
+#include <string.h>
 #include "Scheduler.h"
 
 using namespace Empty;
@@ -29,13 +30,28 @@ void EmptyScheduler::register_delay_callback(AP_HAL::Proc k,
             uint16_t min_time_ms)
 {}
 
-void EmptyScheduler::register_timer_process(AP_HAL::TimedProc k)
+void EmptyScheduler::register_timer_process(AP_HAL::TimedProc k,
+            uint8_t freq_div, uint8_t priority)
 {}
 
 void EmptyScheduler::register_timer_failsafe(AP_HAL::TimedProc,
             uint32_t period_us)
 {}
 
+void EmptyScheduler::get_timer_stats(AP_HAL::Scheduler::TimerStats &stats)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool EmptyScheduler::get_timer_proc_stats(uint8_t i,
+            AP_HAL::Scheduler::TimerProcStats &stats)
+{
+    return false;
+}
+
+void EmptyScheduler::clear_timer_stats()
+{}
+
 void EmptyScheduler::suspend_timer_procs()
 {}
 
@@ -14,9 +14,14 @@ public:
     void     delay_microseconds(uint16_t us);
     void     register_delay_callback(AP_HAL::Proc,
                 uint16_t min_time_ms);
-    void     register_timer_process(AP_HAL::TimedProc);
+    void     register_timer_process(AP_HAL::TimedProc, uint8_t freq_div,
+                uint8_t priority);
     void     register_timer_failsafe(AP_HAL::TimedProc,
                 uint32_t period_us);
+    void     get_timer_stats(AP_HAL::Scheduler::TimerStats &stats);
+    bool     get_timer_proc_stats(uint8_t i,
+                AP_HAL::Scheduler::TimerProcStats &stats);
+    void     clear_timer_stats();
     void     suspend_timer_procs();
     void     resume_timer_procs();
 
@@ -0,0 +1,11 @@
+
+#ifndef __AP_HAL_LINUX_H__
+#define __AP_HAL_LINUX_H__
+
+#include <AP_HAL.h>
+
+#include "HAL_Linux_Class.h"
+#include "AP_HAL_Linux_Main.h"
+
+#endif // __AP_HAL_LINUX_H__
+
@@ -0,0 +1,20 @@
+
+#ifndef __AP_HAL_LINUX_MAIN_H__
+#define __AP_HAL_LINUX_MAIN_H__
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define AP_HAL_MAIN() extern "C" {\
+    int main (int argc, char * const argv[]) {	\
+	hal.init(argc, argv); \
+        setup(); \
+        for(;;) { \
+		loop(); \
+		AVR_SITL::SITL_State::loop_hook(); \
+	} \
+        return 0;\
+    }\
+    }
+#endif
+
+#endif // __AP_HAL_LINUX_MAIN_H__
+
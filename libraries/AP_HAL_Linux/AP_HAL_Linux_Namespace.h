@@ -0,0 +1,11 @@
+
+#ifndef __AP_HAL_LINUX_NAMESPACE_H__
+#define __AP_HAL_LINUX_NAMESPACE_H__
+
+namespace Linux {
+    class LinuxScheduler;
+    class LinuxSemaphore;
+}
+
+#endif // __AP_HAL_LINUX_NAMESPACE_H__
+
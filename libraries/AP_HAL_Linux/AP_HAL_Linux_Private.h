@@ -0,0 +1,10 @@
+
+#ifndef __AP_HAL_LINUX_PRIVATE_H__
+#define __AP_HAL_LINUX_PRIVATE_H__
+
+#include "AP_HAL_Linux_Namespace.h"
+#include "Scheduler.h"
+#include "Semaphores.h"
+
+#endif // __AP_HAL_LINUX_PRIVATE_H__
+
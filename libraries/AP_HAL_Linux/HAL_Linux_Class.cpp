@@ -0,0 +1,120 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+#include <AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <AP_HAL_Linux.h>
+#include "AP_HAL_Linux_Namespace.h"
+#include "AP_HAL_Linux_Private.h"
+#include "HAL_Linux_Class.h"
+
+// the SITL drivers and sensor models stand in for hardware
+#include <AP_HAL_AVR_SITL.h>
+#include "../AP_HAL_AVR_SITL/AP_HAL_AVR_SITL_Namespace.h"
+#include "../AP_HAL_AVR_SITL/AnalogIn.h"
+#include "../AP_HAL_AVR_SITL/UARTDriver.h"
+#include "../AP_HAL_AVR_SITL/Storage.h"
+#include "../AP_HAL_AVR_SITL/Console.h"
+#include "../AP_HAL_AVR_SITL/RCInput.h"
+#include "../AP_HAL_AVR_SITL/RCOutput.h"
+#include "../AP_HAL_AVR_SITL/SITL_State.h"
+#include "../AP_HAL_AVR_SITL/Util.h"
+
+#include <AP_HAL_Empty.h>
+#include <AP_HAL_Empty_Private.h>
+
+#include <pthread.h>
+
+using namespace Linux;
+using namespace AVR_SITL;
+
+static LinuxScheduler linuxScheduler;
+static SITLEEPROMStorage sitlEEPROMStorage;
+static SITLConsoleDriver consoleDriver;
+static SITL_State sitlState;
+static SITLRCInput  sitlRCInput(&sitlState);
+static SITLRCOutput sitlRCOutput(&sitlState);
+static SITLAnalogIn sitlAnalogIn(&sitlState);
+
+// use the Empty HAL for hardware we don't emulate
+static Empty::EmptyGPIO emptyGPIO;
+static LinuxSemaphore i2cSemaphore;
+static Empty::EmptyI2CDriver emptyI2C(&i2cSemaphore);
+static Empty::EmptySPIDeviceManager emptySPI;
+
+static SITLUARTDriver sitlUart0Driver(0, &sitlState);
+static SITLUARTDriver sitlUart1Driver(1, &sitlState);
+static SITLUARTDriver sitlUart2Driver(2, &sitlState);
+
+static SITLUtil utilInstance;
+
+// guards the packets handed from the flight simulator thread to the
+// sensor update on the timer thread
+static LinuxSemaphore fdmSemaphore;
+static pthread_t fdm_thread_ctx;
+
+/*
+  exchange packets with the flight simulator at 1kHz. This runs on a
+  thread of its own at normal priority, so a slow socket holds up
+  neither the real time timer thread nor anything waiting on the timer
+  lock
+ */
+static void *sitl_fdm_thread(void *)
+{
+    for (;;) {
+        SITL_State::fdm_io();
+        linuxScheduler.delay_microseconds(1000);
+    }
+    return NULL;
+}
+
+static void sitl_update_sensors(uint32_t)
+{
+    SITL_State::update_sensors();
+}
+
+HAL_Linux::HAL_Linux() :
+    AP_HAL::HAL(
+        &sitlUart0Driver,  /* uartA */
+        &sitlUart1Driver,  /* uartB */
+        &sitlUart2Driver,  /* uartC */
+        &emptyI2C,         /* i2c */
+        &emptySPI,         /* spi */
+        &sitlAnalogIn,     /* analogin */
+        &sitlEEPROMStorage, /* storage */
+        &consoleDriver,    /* console */
+        &emptyGPIO,        /* gpio */
+        &sitlRCInput,      /* rcinput */
+        &sitlRCOutput,     /* rcoutput */
+        &linuxScheduler,   /* scheduler */
+        &utilInstance),    /* util */
+    _sitl_state(&sitlState)
+{}
+
+void HAL_Linux::init(int argc, char * const argv[]) const
+{
+    _sitl_state->init(argc, argv);
+    _sitl_state->set_fdm_semaphore(&fdmSemaphore);
+    scheduler->init(NULL);
+
+    // the sensors are updated from a timer process, in place of the
+    // timer signal SITL uses. Running under the timer lock means the
+    // sensor drivers can hold it off with suspend_timer_procs() while
+    // they take the new readings
+    scheduler->register_timer_process(sitl_update_sensors);
+    if (pthread_create(&fdm_thread_ctx, NULL, sitl_fdm_thread, NULL) != 0) {
+        scheduler->panic(PSTR("PANIC: failed to start SITL thread"));
+    }
+
+    uartA->begin(115200);
+    console->init((void*) uartA);
+
+    rcin->init(NULL);
+    rcout->init(NULL);
+    analogin->init(NULL);
+}
+
+const HAL_Linux AP_HAL_Linux;
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_LINUX
@@ -0,0 +1,27 @@
+
+#ifndef __AP_HAL_LINUX_CLASS_H__
+#define __AP_HAL_LINUX_CLASS_H__
+
+#include <AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <AP_HAL_Linux.h>
+#include "AP_HAL_Linux_Namespace.h"
+#include <AP_HAL_AVR_SITL.h>
+#include "../AP_HAL_AVR_SITL/SITL_State.h"
+
+class HAL_Linux : public AP_HAL::HAL {
+public:
+    HAL_Linux();
+    void init(int argc, char * const argv[]) const;
+
+private:
+    AVR_SITL::SITL_State *_sitl_state;
+};
+
+extern const HAL_Linux AP_HAL_Linux;
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#endif // __AP_HAL_LINUX_CLASS_H__
+
@@ -0,0 +1,309 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+#include <AP_HAL.h>
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include "AP_HAL_Linux.h"
+#include "Scheduler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+using namespace Linux;
+
+extern const AP_HAL::HAL& hal;
+
+struct timespec LinuxScheduler::_sketch_start_time;
+
+LinuxScheduler::LinuxScheduler() :
+    _delay_cb(NULL),
+    _min_delay_cb_ms(0),
+    _failsafe(NULL),
+    _timer_suspended(false),
+    _timer_event_missed(false),
+    _num_io_procs(0)
+{
+    // the lock is recursive so a timer process can call back into the
+    // scheduler, for example to read the statistics
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&_timer_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void LinuxScheduler::init(void *unused)
+{
+    clock_gettime(CLOCK_MONOTONIC, &_sketch_start_time);
+
+    // keep the process in RAM so the timer thread never waits on a
+    // page fault. This needs the same privileges as real time
+    // scheduling, so failure is not fatal
+    mlockall(MCL_CURRENT | MCL_FUTURE);
+
+    if (!_start_thread(&_timer_thread_ctx, _timer_thread, this, LINUX_TIMER_PRIORITY) ||
+        !_start_thread(&_io_thread_ctx, _io_thread, this, LINUX_IO_PRIORITY)) {
+        panic(PSTR("PANIC: failed to start scheduler threads"));
+    }
+}
+
+/*
+  start a thread at the given SCHED_FIFO priority, or with the default
+  scheduling if the process is not allowed real time priorities
+ */
+bool LinuxScheduler::_start_thread(pthread_t *ctx, void *(*start_routine)(void *),
+                                   void *arg, int priority)
+{
+    pthread_attr_t attr;
+    struct sched_param param;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    param.sched_priority = priority;
+    pthread_attr_setschedparam(&attr, &param);
+    int ret = pthread_create(ctx, &attr, start_routine, arg);
+    pthread_attr_destroy(&attr);
+
+    if (ret == EPERM) {
+        fprintf(stderr, "Scheduler: no permission for real time priority, "
+                "timing will be less accurate\n");
+        ret = pthread_create(ctx, NULL, start_routine, arg);
+    }
+    return ret == 0;
+}
+
+void LinuxScheduler::_timespec_add_us(struct timespec &ts, uint32_t usec)
+{
+    ts.tv_sec  += usec / 1000000UL;
+    ts.tv_nsec += (usec % 1000000UL) * 1000UL;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+}
+
+bool LinuxScheduler::_timespec_before(const struct timespec &a,
+                                      const struct timespec &b)
+{
+    return a.tv_sec < b.tv_sec ||
+        (a.tv_sec == b.tv_sec && a.tv_nsec < b.tv_nsec);
+}
+
+uint32_t LinuxScheduler::_micros()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((ts.tv_sec - _sketch_start_time.tv_sec) * 1000000ULL +
+                      (ts.tv_nsec - _sketch_start_time.tv_nsec) / 1000L);
+}
+
+uint32_t LinuxScheduler::millis()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((ts.tv_sec - _sketch_start_time.tv_sec) * 1000ULL +
+                      (ts.tv_nsec - _sketch_start_time.tv_nsec) / 1000000L);
+}
+
+void LinuxScheduler::delay_microseconds(uint16_t usec)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    _timespec_add_us(ts, usec);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) ;
+}
+
+void LinuxScheduler::delay(uint16_t ms)
+{
+    uint32_t start = micros();
+
+    while ((micros() - start)/1000 < ms) {
+        delay_microseconds(1000);
+        if (_min_delay_cb_ms <= ms) {
+            if (_delay_cb) {
+                _delay_cb();
+            }
+        }
+    }
+}
+
+void LinuxScheduler::register_delay_callback(AP_HAL::Proc proc,
+                                             uint16_t min_time_ms)
+{
+    _delay_cb = proc;
+    _min_delay_cb_ms = min_time_ms;
+}
+
+void LinuxScheduler::register_timer_process(AP_HAL::TimedProc proc,
+                                            uint8_t freq_div, uint8_t priority)
+{
+    // hold off the timer thread while the table is changed
+    begin_atomic();
+    _timer_procs.add(proc, freq_div, priority);
+    end_atomic();
+}
+
+bool LinuxScheduler::register_io_process(AP_HAL::Proc proc)
+{
+    begin_atomic();
+    for (uint8_t i = 0; i < _num_io_procs; i++) {
+        if (_io_procs[i] == proc) {
+            end_atomic();
+            return true;
+        }
+    }
+    bool ret = false;
+    if (_num_io_procs < LINUX_SCHEDULER_MAX_IO_PROCS) {
+        // the IO thread reads the count without the lock, so the
+        // entry is filled in before the count is raised
+        _io_procs[_num_io_procs] = proc;
+        _num_io_procs++;
+        ret = true;
+    }
+    end_atomic();
+    return ret;
+}
+
+void LinuxScheduler::register_timer_failsafe(AP_HAL::TimedProc failsafe, uint32_t period_us)
+{
+    _failsafe = failsafe;
+}
+
+// the statistics are written by the timer thread, so hold it off while
+// they are copied or cleared
+void LinuxScheduler::get_timer_stats(AP_HAL::Scheduler::TimerStats &stats)
+{
+    begin_atomic();
+    _timer_procs.get_stats(stats);
+    end_atomic();
+}
+
+bool LinuxScheduler::get_timer_proc_stats(uint8_t i, AP_HAL::Scheduler::TimerProcStats &stats)
+{
+    begin_atomic();
+    bool ret = _timer_procs.get_proc_stats(i, stats);
+    end_atomic();
+    return ret;
+}
+
+void LinuxScheduler::clear_timer_stats()
+{
+    begin_atomic();
+    _timer_procs.clear_stats();
+    end_atomic();
+}
+
+// taking the lock waits for a tick that is running to finish, so no
+// timer process is running when this returns
+void LinuxScheduler::suspend_timer_procs()
+{
+    begin_atomic();
+    _timer_suspended = true;
+    end_atomic();
+}
+
+void LinuxScheduler::resume_timer_procs()
+{
+    begin_atomic();
+    _timer_suspended = false;
+    bool missed = _timer_event_missed;
+    _timer_event_missed = false;
+    end_atomic();
+    if (missed) {
+        _run_timer_procs(false);
+    }
+}
+
+void LinuxScheduler::reboot()
+{
+    hal.uartA->println_P(PSTR("REBOOT NOT IMPLEMENTED\r\n"));
+}
+
+void LinuxScheduler::_run_timer_procs(bool called_from_thread)
+{
+    begin_atomic();
+    uint32_t tnow = _micros();
+
+    if (!_timer_suspended) {
+        // now call the timer based drivers that are due
+        _timer_procs.run(tnow, _micros);
+    } else if (called_from_thread) {
+        _timer_event_missed = true;
+        _timer_procs.note_missed_tick();
+    }
+
+    // and the failsafe, if one is setup
+    if (_failsafe != NULL) {
+        _failsafe(tnow);
+    }
+    end_atomic();
+}
+
+/*
+  the 1kHz timer thread. Sleeping to an absolute time keeps the ticks
+  from drifting. A tick that runs past the start of the next one is
+  counted as an overrun, and the ticks start again from the current
+  time rather than running back to back to catch up
+ */
+void *LinuxScheduler::_timer_thread(void *arg)
+{
+    LinuxScheduler *sched = (LinuxScheduler *)arg;
+    struct timespec next, now;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (;;) {
+        _timespec_add_us(next, 1000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) ;
+
+        sched->_run_timer_procs(true);
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        struct timespec late = next;
+        _timespec_add_us(late, 1000);
+        if (_timespec_before(late, now)) {
+            sched->begin_atomic();
+            sched->_timer_procs.note_overrun_tick();
+            sched->end_atomic();
+            next = now;
+        }
+    }
+    return NULL;
+}
+
+/*
+  the 1kHz IO thread
+ */
+void *LinuxScheduler::_io_thread(void *arg)
+{
+    LinuxScheduler *sched = (LinuxScheduler *)arg;
+    struct timespec next, now;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (;;) {
+        _timespec_add_us(next, 1000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) ;
+
+        uint8_t num_io_procs = sched->_num_io_procs;
+        for (uint8_t i = 0; i < num_io_procs; i++) {
+            sched->_io_procs[i]();
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (_timespec_before(next, now)) {
+            next = now;
+        }
+    }
+    return NULL;
+}
+
+void LinuxScheduler::panic(const prog_char_t *errormsg)
+{
+    hal.console->println_P(errormsg);
+    exit(1);
+}
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_LINUX
@@ -0,0 +1,94 @@
+
+#ifndef __AP_HAL_LINUX_SCHEDULER_H__
+#define __AP_HAL_LINUX_SCHEDULER_H__
+
+#include <AP_HAL.h>
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include "AP_HAL_Linux_Namespace.h"
+#include <pthread.h>
+#include <time.h>
+
+#define LINUX_SCHEDULER_MAX_TIMER_PROCS 8
+#define LINUX_SCHEDULER_MAX_IO_PROCS    4
+
+// SCHED_FIFO priorities of the threads, used when the process is
+// allowed real time scheduling. The timer thread pre-empts the IO
+// thread, which pre-empts the main thread
+#define LINUX_TIMER_PRIORITY 15
+#define LINUX_IO_PRIORITY    14
+
+/* Scheduler implementation:
+ *
+ * The timer processes are called at 1kHz from a timer thread, and IO
+ * processes, such as the exchange of packets with a flight simulator,
+ * at 1kHz from a separate IO thread so a slow socket cannot delay the
+ * timer. Each tick of the timer thread holds the timer lock, which the
+ * main thread takes to change the process table or read the
+ * statistics, and suspend_timer_procs() waits for a running tick to
+ * finish. IO processes are not run under the lock and must do their
+ * own locking against the main thread. */
+class Linux::LinuxScheduler : public AP_HAL::Scheduler {
+public:
+    LinuxScheduler();
+    /* AP_HAL::Scheduler methods */
+
+    void     init(void *unused);
+    void     delay(uint16_t ms);
+    uint32_t millis();
+    uint32_t micros() { return _micros(); }
+    void     delay_microseconds(uint16_t us);
+    void     register_delay_callback(AP_HAL::Proc, uint16_t min_time_ms);
+
+    void     register_timer_process(AP_HAL::TimedProc, uint8_t freq_div,
+                                    uint8_t priority);
+    void     suspend_timer_procs();
+    void     resume_timer_procs();
+
+    void     register_timer_failsafe(AP_HAL::TimedProc, uint32_t period_us);
+
+    void     get_timer_stats(AP_HAL::Scheduler::TimerStats &stats);
+    bool     get_timer_proc_stats(uint8_t i,
+                                  AP_HAL::Scheduler::TimerProcStats &stats);
+    void     clear_timer_stats();
+    void     reboot();
+    void     panic(const prog_char_t *errormsg);
+
+    /* Linux specific: add a process to be called at 1kHz on the IO
+     * thread. Returns false if there are too many */
+    bool     register_io_process(AP_HAL::Proc);
+
+    void     begin_atomic() { pthread_mutex_lock(&_timer_mutex); }
+    void     end_atomic()   { pthread_mutex_unlock(&_timer_mutex); }
+
+private:
+    AP_HAL::Proc _delay_cb;
+    uint16_t _min_delay_cb_ms;
+    static struct timespec _sketch_start_time;
+    AP_HAL::TimedProc _failsafe;
+
+    pthread_mutex_t _timer_mutex;
+    pthread_t _timer_thread_ctx;
+    pthread_t _io_thread_ctx;
+
+    bool _timer_suspended;
+    bool _timer_event_missed;
+    AP_HAL::TimerProcTable<LINUX_SCHEDULER_MAX_TIMER_PROCS> _timer_procs;
+
+    AP_HAL::Proc _io_procs[LINUX_SCHEDULER_MAX_IO_PROCS];
+    volatile uint8_t _num_io_procs;
+
+    static uint32_t _micros();
+    static void _timespec_add_us(struct timespec &ts, uint32_t usec);
+    static bool _timespec_before(const struct timespec &a,
+                                 const struct timespec &b);
+    static bool _start_thread(pthread_t *ctx, void *(*start_routine)(void *),
+                              void *arg, int priority);
+
+    static void *_timer_thread(void *arg);
+    static void *_io_thread(void *arg);
+    void _run_timer_procs(bool called_from_thread);
+};
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#endif // __AP_HAL_LINUX_SCHEDULER_H__
+
@@ -0,0 +1,51 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+#include <AP_HAL.h>
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include "Semaphores.h"
+#include <errno.h>
+#include <time.h>
+
+using namespace Linux;
+
+LinuxSemaphore::LinuxSemaphore()
+{
+    // an error checking mutex makes give() fail if the semaphore is not
+    // held by the caller, rather than being undefined
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK);
+    pthread_mutex_init(&_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+bool LinuxSemaphore::give()
+{
+    return pthread_mutex_unlock(&_lock) == 0;
+}
+
+bool LinuxSemaphore::take(uint32_t timeout_ms)
+{
+    if (timeout_ms == HAL_SEMAPHORE_BLOCK_FOREVER) {
+        return pthread_mutex_lock(&_lock) == 0;
+    }
+
+    // pthread_mutex_timedlock() takes an absolute CLOCK_REALTIME time
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec  += timeout_ms / 1000;
+    ts.tv_nsec += (timeout_ms % 1000) * 1000000UL;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return pthread_mutex_timedlock(&_lock, &ts) == 0;
+}
+
+bool LinuxSemaphore::take_nonblocking()
+{
+    return pthread_mutex_trylock(&_lock) == 0;
+}
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_LINUX
@@ -0,0 +1,22 @@
+
+#ifndef __AP_HAL_LINUX_SEMAPHORES_H__
+#define __AP_HAL_LINUX_SEMAPHORES_H__
+
+#include <AP_HAL.h>
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include "AP_HAL_Linux_Namespace.h"
+#include <pthread.h>
+
+class Linux::LinuxSemaphore : public AP_HAL::Semaphore {
+public:
+    LinuxSemaphore();
+    bool give();
+    bool take(uint32_t timeout_ms);
+    bool take_nonblocking();
+private:
+    pthread_mutex_t _lock;
+};
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#endif // __AP_HAL_LINUX_SEMAPHORES_H__
+
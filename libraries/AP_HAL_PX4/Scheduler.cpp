@@ -24,8 +24,7 @@ uint64_t PX4Scheduler::_sketch_start_time;
 
 AP_HAL::TimedProc PX4Scheduler::_failsafe = NULL;
 volatile bool PX4Scheduler::_timer_suspended = false;
-AP_HAL::TimedProc PX4Scheduler::_timer_proc[PX4_SCHEDULER_MAX_TIMER_PROCS] = {NULL};
-uint8_t PX4Scheduler::_num_timer_procs = 0;
+AP_HAL::TimerProcTable<PX4_SCHEDULER_MAX_TIMER_PROCS> PX4Scheduler::_timer_procs;
 bool PX4Scheduler::_in_timer_proc = false;
 uint8_t PX4Scheduler::_nested_atomic_ctr;
 bool PX4Scheduler::_timer_pending;
@@ -87,19 +86,13 @@ void PX4Scheduler::register_delay_callback(AP_HAL::Proc proc,
     _min_delay_cb_ms = min_time_ms;
 }
 
-void PX4Scheduler::register_timer_process(AP_HAL::TimedProc proc) 
+void PX4Scheduler::register_timer_process(AP_HAL::TimedProc proc,
+                                          uint8_t freq_div, uint8_t priority) 
 {
-    for (uint8_t i = 0; i < _num_timer_procs; i++) {
-        if (_timer_proc[i] == proc) {
-            return;
-        }
-    }
-
-    if (_num_timer_procs < PX4_SCHEDULER_MAX_TIMER_PROCS) {
-        _timer_proc[_num_timer_procs] = proc;
-        _num_timer_procs++;
-    }
-
+    // hold off the timer while the table is changed
+    begin_atomic();
+    _timer_procs.add(proc, freq_div, priority);
+    end_atomic();
 }
 
 void PX4Scheduler::register_timer_failsafe(AP_HAL::TimedProc failsafe, uint32_t period_us) 
@@ -108,6 +101,30 @@ void PX4Scheduler::register_timer_failsafe(AP_HAL::TimedProc failsafe, uint32_t
 //    _failsafe = failsafe;
 }
 
+// the statistics are written by the timer, so hold it off while they
+// are copied or cleared
+void PX4Scheduler::get_timer_stats(AP_HAL::Scheduler::TimerStats &stats)
+{
+    begin_atomic();
+    _timer_procs.get_stats(stats);
+    end_atomic();
+}
+
+bool PX4Scheduler::get_timer_proc_stats(uint8_t i, AP_HAL::Scheduler::TimerProcStats &stats)
+{
+    begin_atomic();
+    bool ret = _timer_procs.get_proc_stats(i, stats);
+    end_atomic();
+    return ret;
+}
+
+void PX4Scheduler::clear_timer_stats()
+{
+    begin_atomic();
+    _timer_procs.clear_stats();
+    end_atomic();
+}
+
 void PX4Scheduler::suspend_timer_procs() {
     _timer_suspended = true;
 }
@@ -141,6 +158,10 @@ void PX4Scheduler::reboot()
 void PX4Scheduler::_timer_event(void *arg)
 {
     if (_nested_atomic_ctr != 0) {
+        // only one pending tick is run when the atomic section ends
+        if (_timer_pending) {
+            _timer_procs.note_missed_tick();
+        }
         _timer_pending = true;
         return;
     }
@@ -157,6 +178,7 @@ void PX4Scheduler::_timer_event(void *arg)
         // need be.  We assume the failsafe code can't
         // block. If it does then we will recurse and die when
         // we run out of stack
+        _timer_procs.note_overrun_tick();
         if (_failsafe != NULL) {
             _failsafe(tnow);
         }
@@ -165,12 +187,10 @@ void PX4Scheduler::_timer_event(void *arg)
     _in_timer_proc = true;
 
     if (!_timer_suspended) {
-        // now call the timer based drivers
-        for (int i = 0; i < _num_timer_procs; i++) {
-            if (_timer_proc[i] != NULL) {
-                _timer_proc[i](tnow);
-            }
-        }
+        // now call the timer based drivers that are due
+        _timer_procs.run(tnow, _micros);
+    } else {
+        _timer_procs.note_missed_tick();
     }
 
     // and the failsafe, if one is setup
@@ -9,7 +9,7 @@
 #include <signal.h>
 #include <drivers/drv_hrt.h>
 
-#define PX4_SCHEDULER_MAX_TIMER_PROCS 4
+#define PX4_SCHEDULER_MAX_TIMER_PROCS 8
 
 /* Scheduler implementation: */
 class PX4::PX4Scheduler : public AP_HAL::Scheduler {
@@ -23,8 +23,13 @@ public:
     uint32_t micros();
     void     delay_microseconds(uint16_t us);
     void     register_delay_callback(AP_HAL::Proc, uint16_t min_time_ms);
-    void     register_timer_process(AP_HAL::TimedProc);
+    void     register_timer_process(AP_HAL::TimedProc, uint8_t freq_div,
+                                    uint8_t priority);
     void     register_timer_failsafe(AP_HAL::TimedProc, uint32_t period_us);
+    void     get_timer_stats(AP_HAL::Scheduler::TimerStats &stats);
+    bool     get_timer_proc_stats(uint8_t i,
+                                  AP_HAL::Scheduler::TimerProcStats &stats);
+    void     clear_timer_stats();
     void     suspend_timer_procs();
     void     resume_timer_procs();
     void     begin_atomic();
@@ -43,8 +48,7 @@ private:
     static uint64_t _sketch_start_time;
 
     static volatile bool _timer_suspended;
-    static AP_HAL::TimedProc _timer_proc[PX4_SCHEDULER_MAX_TIMER_PROCS];
-    static uint8_t _num_timer_procs;
+    static AP_HAL::TimerProcTable<PX4_SCHEDULER_MAX_TIMER_PROCS> _timer_procs;
     static bool    _in_timer_proc;
 
     // callable from interrupt handler
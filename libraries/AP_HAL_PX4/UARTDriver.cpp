@@ -128,6 +128,18 @@ int16_t PX4UARTDriver::read() {
 	return -1;
 }
 
+uint16_t PX4UARTDriver::read(uint8_t *buf, uint16_t n) {
+	int16_t numc = available();
+	if (numc <= 0) {
+		return 0;
+	}
+	if (n > numc) {
+		n = numc;
+	}
+	ssize_t ret = ::read(_fd, buf, n);
+	return ret > 0 ? ret : 0;
+}
+
 int16_t PX4UARTDriver::peek() { 
 	return -1;
 }
@@ -31,6 +31,9 @@ public:
     int16_t read();
     int16_t peek();
 
+    /* PX4 implementations of UARTDriver virtual methods */
+    uint16_t read(uint8_t *buf, uint16_t n);
+
     /* PX4 implementations of Print virtual methods */
     size_t write(uint8_t c);
 
@@ -48,6 +48,12 @@ extern const AP_HAL::HAL& hal;
  */
 static xSemaphoreHandle g_atomic;
 
+/** Time since init in microseconds, for timing the timer procedures. */
+static uint32_t timer_micros(void)
+{
+  return (uint32_t)timer_get_ticks();
+}
+
 /** High-priority thread managing timer procedures. */
 static void scheduler_task(void *arg)
 {
@@ -133,7 +139,7 @@ static void delay_cb_task(void *arg)
 
 SMACCMScheduler::SMACCMScheduler()
   : m_delay_cb(NULL), m_task(NULL), m_delay_cb_task(NULL),
-    m_failsafe_cb(NULL), m_num_procs(0)
+    m_failsafe_cb(NULL)
 {
 }
 
@@ -192,19 +198,14 @@ void SMACCMScheduler::register_delay_callback(AP_HAL::Proc k, uint16_t)
   m_delay_cb = k;
 }
 
-void SMACCMScheduler::register_timer_process(AP_HAL::TimedProc k)
+void SMACCMScheduler::register_timer_process(AP_HAL::TimedProc k,
+                                             uint8_t freq_div,
+                                             uint8_t priority)
 {
-  for (int i = 0; i < m_num_procs; ++i) {
-    if (m_procs[i] == k)
-      return;
-  }
-
-  if (m_num_procs < SMACCM_SCHEDULER_MAX_TIMER_PROCS) {
-    portENTER_CRITICAL();
-    m_procs[m_num_procs] = k;
-    ++m_num_procs;
-    portEXIT_CRITICAL();
-  }
+  // Hold off "scheduler_task" while the table is reordered.
+  xSemaphoreTakeRecursive(g_atomic, portMAX_DELAY);
+  m_procs.add(k, freq_div, priority);
+  xSemaphoreGiveRecursive(g_atomic);
 }
 
 void SMACCMScheduler::register_timer_failsafe(AP_HAL::TimedProc k, uint32_t)
@@ -212,6 +213,29 @@ void SMACCMScheduler::register_timer_failsafe(AP_HAL::TimedProc k, uint32_t)
   m_failsafe_cb = k;
 }
 
+void SMACCMScheduler::get_timer_stats(AP_HAL::Scheduler::TimerStats &stats)
+{
+  xSemaphoreTakeRecursive(g_atomic, portMAX_DELAY);
+  m_procs.get_stats(stats);
+  xSemaphoreGiveRecursive(g_atomic);
+}
+
+bool SMACCMScheduler::get_timer_proc_stats(uint8_t i,
+                                           AP_HAL::Scheduler::TimerProcStats &stats)
+{
+  xSemaphoreTakeRecursive(g_atomic, portMAX_DELAY);
+  bool ret = m_procs.get_proc_stats(i, stats);
+  xSemaphoreGiveRecursive(g_atomic);
+  return ret;
+}
+
+void SMACCMScheduler::clear_timer_stats()
+{
+  xSemaphoreTakeRecursive(g_atomic, portMAX_DELAY);
+  m_procs.clear_stats();
+  xSemaphoreGiveRecursive(g_atomic);
+}
+
 void SMACCMScheduler::suspend_timer_procs()
 {
   xSemaphoreTakeRecursive(g_atomic, portMAX_DELAY);
@@ -252,20 +276,17 @@ void SMACCMScheduler::run_callbacks()
 {
   uint32_t now = micros();
 
-  // Run timer processes if not suspended.
-  portENTER_CRITICAL();
-  uint8_t num_procs = m_num_procs;
-  portEXIT_CRITICAL();
-
-  for (int i = 0; i < num_procs; ++i) {
-    if (m_procs[i] != NULL) {
-      m_procs[i](now);
-    }
-  }
+  // Run the timer processes that are due.
+  m_procs.run(now, timer_micros);
 }
 
 void SMACCMScheduler::run_failsafe_cb()
 {
+  // The deadline was missed, count it with the timer statistics.
+  xSemaphoreTakeRecursive(g_atomic, portMAX_DELAY);
+  m_procs.note_overrun_tick();
+  xSemaphoreGiveRecursive(g_atomic);
+
   if (m_failsafe_cb)
     m_failsafe_cb(micros());
 }
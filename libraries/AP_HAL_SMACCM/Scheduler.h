@@ -16,7 +16,7 @@
 
 #include <AP_HAL_SMACCM.h>
 
-#define SMACCM_SCHEDULER_MAX_TIMER_PROCS 4
+#define SMACCM_SCHEDULER_MAX_TIMER_PROCS 8
 
 class SMACCM::SMACCMScheduler : public AP_HAL::Scheduler
 {
@@ -51,8 +51,12 @@ public:
    */
   void register_delay_callback(AP_HAL::Proc, uint16_t min_time_ms);
 
-  /** Register a callback to run every 1ms (1kHz). */
-  void register_timer_process(AP_HAL::TimedProc);
+  /**
+   * Register a callback to run every "freq_div" ms.  Callbacks due on
+   * the same tick run highest "priority" first.
+   */
+  void register_timer_process(AP_HAL::TimedProc, uint8_t freq_div,
+                              uint8_t priority);
 
   /**
    * Register a callback to run if a timer process takes too long to
@@ -60,6 +64,19 @@ public:
    */
   void register_timer_failsafe(AP_HAL::TimedProc, uint32_t);
 
+  /** Copy the statistics of the timer ticks. */
+  void get_timer_stats(AP_HAL::Scheduler::TimerStats &stats);
+
+  /**
+   * Copy the statistics of the i'th timed procedure in the order they
+   * are called.  Returns false if there is no such procedure.
+   */
+  bool get_timer_proc_stats(uint8_t i,
+                            AP_HAL::Scheduler::TimerProcStats &stats);
+
+  /** Clear the statistics of the timer ticks and timed procedures. */
+  void clear_timer_stats();
+
   /**
    * Suspend execution of timed procedures.  Calls to this function do
    * not nest.
@@ -112,9 +129,8 @@ private:
   AP_HAL::Proc m_delay_cb;      /* delay callback */
   void *m_task;                 /* opaque scheduler task handle */
   void *m_delay_cb_task;        /* opaque delay cb task handle */
-  AP_HAL::TimedProc m_procs[SMACCM_SCHEDULER_MAX_TIMER_PROCS];
+  AP_HAL::TimerProcTable<SMACCM_SCHEDULER_MAX_TIMER_PROCS> m_procs;
   AP_HAL::TimedProc m_failsafe_cb;
-  uint8_t m_num_procs;          /* number of entries in "m_procs" */
 };
 
 #endif // __AP_HAL_SMACCM_SCHEDULER_H__
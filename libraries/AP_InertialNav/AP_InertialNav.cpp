@@ -103,15 +103,12 @@ void AP_InertialNav::update(float dt)
     // calculate new velocity
     _velocity += velocity_increase;
 
-    // store 3rd order estimate (i.e. estimated vertical position) for future use
-    _hist_position_estimate_z.add(_position_base.z);
-
-    // store 3rd order estimate (i.e. horizontal position) for future use at 10hz
-    _historic_xy_counter++;
-    if( _historic_xy_counter >= AP_INTERTIALNAV_SAVE_POS_AFTER_ITERATIONS ) {
-        _historic_xy_counter = 0;
-        _hist_position_estimate_x.add(_position_base.x);
-        _hist_position_estimate_y.add(_position_base.y);
+    // store 3rd order estimate (i.e. estimated position) for future use at 10hz
+    uint32_t now = hal.scheduler->millis();
+    if( _hist_position_estimate.num_items() == 0 ||
+        now - _hist_position_estimate.newest_time_ms() >= AP_INERTIALNAV_HISTORY_INTERVAL_MS ) {
+        float position[3] = { _position_base.x, _position_base.y, _position_base.z };
+        _hist_position_estimate.add(now, position);
     }
 }
 
@@ -150,9 +147,13 @@ void AP_InertialNav::check_gps()
     // compare gps time to previous reading
     if( gps_time != _gps_last_time ) {
 
-        // calculate time since last gps reading
+        // calculate time since last gps reading. The fix times come from
+        // the gps timestamps so they are spaced by the gps rate however
+        // late each reading is picked up
         now = hal.scheduler->millis();
-        float dt = (float)(now - _gps_last_update) / 1000.0;
+        uint32_t fix_time = (*_gps_ptr)->last_fix_time;
+        float dt = (float)(fix_time - _gps_last_fix_time) / 1000.0;
+        _gps_last_fix_time = fix_time;
 
         // call position correction method
         correct_with_gps((*_gps_ptr)->longitude, (*_gps_ptr)->latitude, dt);
@@ -167,7 +168,7 @@ void AP_InertialNav::check_gps()
 void AP_InertialNav::correct_with_gps(int32_t lon, int32_t lat, float dt)
 {
     float x,y;
-    float hist_position_base_x, hist_position_base_y;
+    float hist_position_base[3];
 
     // discard samples where dt is too large
     if( dt > 1.0 || dt == 0 || !_xy_enabled) {
@@ -183,20 +184,22 @@ void AP_InertialNav::correct_with_gps(int32_t lon, int32_t lat, float dt)
 
     // correct accelerometer offsets using gps
 
-    // ublox gps positions are delayed by 400ms
-    // we store historical position at 10hz so 4 iterations ago
-    if( _hist_position_estimate_x.num_items() >= AP_INTERTIALNAV_GPS_LAG_IN_10HZ_INCREMENTS ) {
-        hist_position_base_x = _hist_position_estimate_x.peek(AP_INTERTIALNAV_GPS_LAG_IN_10HZ_INCREMENTS-1);
-        hist_position_base_y = _hist_position_estimate_y.peek(AP_INTERTIALNAV_GPS_LAG_IN_10HZ_INCREMENTS-1);
-    }else{
-        hist_position_base_x = _position_base.x;
-        hist_position_base_y = _position_base.y;
+    // gps positions are delayed (by 500ms for ublox, 1s for others) from
+    // the time of the fix so compare them to our historical estimate
+    // from when they were taken
+    uint32_t gps_lag_ms = 1000;
+    if( _gps_ptr != NULL && *_gps_ptr != NULL ) {
+        gps_lag_ms = (*_gps_ptr)->get_lag() * 1000;
+    }
+    if( !_hist_position_estimate.get(_gps_last_fix_time - gps_lag_ms, hist_position_base) ) {
+        hist_position_base[0] = _position_base.x;
+        hist_position_base[1] = _position_base.y;
     }
 
     // calculate error in position from gps with our historical estimate
     // To-Do: check why x and y are reversed
-    float err_x = -x - (hist_position_base_x + _position_correction.x);
-    float err_y = -y - (hist_position_base_y + _position_correction.y);
+    float err_x = -x - (hist_position_base[0] + _position_correction.x);
+    float err_y = -y - (hist_position_base[1] + _position_correction.y);
 
     // calculate correction to accelerometers and apply in the body frame
     Vector3f accel_corr = accel_correction.get();
@@ -251,9 +254,8 @@ void AP_InertialNav::set_current_position(int32_t lon, int32_t lat)
     _position_correction.x = 0;
     _position_correction.y = 0;
 
-    // clear historic estimates
-    _hist_position_estimate_x.clear();
-    _hist_position_estimate_y.clear();
+    // clear historic estimates, they are relative to the old base location
+    _hist_position_estimate.clear();
 
     // set xy as enabled
     _xy_enabled = true;
@@ -347,7 +349,7 @@ void AP_InertialNav::check_baro()
 void AP_InertialNav::correct_with_baro(float baro_alt, float dt)
 {
     static uint8_t first_reads = 0;
-    float hist_position_base_z;
+    float hist_position_base[3];
     float accel_ef_z_correction;
 
     // discard samples where dt is too large
@@ -364,16 +366,14 @@ void AP_InertialNav::correct_with_baro(float baro_alt, float dt)
     // get dcm matrix
     Matrix3f dcm = _ahrs->get_dcm_matrix();
 
-    // 3rd order samples (i.e. position from baro) are delayed by 150ms (15 iterations at 100hz)
+    // 3rd order samples (i.e. position from baro) are delayed by 150ms
     // so we should calculate error using historical estimates
-    if( _hist_position_estimate_z.num_items() >= 15 ) {
-        hist_position_base_z = _hist_position_estimate_z.peek(14);
-    }else{
-        hist_position_base_z = _position_base.z;
+    if( !_hist_position_estimate.get(hal.scheduler->millis() - AP_INERTIALNAV_BARO_LAG_MS, hist_position_base) ) {
+        hist_position_base[2] = _position_base.z;
     }
 
     // calculate error in position from baro with our estimate
-    float err = baro_alt - (hist_position_base_z + _position_correction.z);
+    float err = baro_alt - (hist_position_base[2] + _position_correction.z);
 
     // retrieve the existing accelerometer corrections
     Vector3f accel_corr = accel_correction.get();
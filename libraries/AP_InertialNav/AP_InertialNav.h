@@ -13,9 +13,10 @@
 #define AP_INTERTIALNAV_TC_Z    7.0 // default time constant for complementary filter's Z axis
 
 // #defines to control how often historical accel based positions are saved
-// so they can later be compared to laggy gps readings
-#define AP_INTERTIALNAV_SAVE_POS_AFTER_ITERATIONS   10
-#define AP_INTERTIALNAV_GPS_LAG_IN_10HZ_INCREMENTS  4       // must not be larger than size of _hist_position_estimate_x and _hist_position_estimate_y
+// so they can later be compared to laggy gps and baro readings
+#define AP_INERTIALNAV_HISTORY_INTERVAL_MS          50      // historical positions are saved at 20hz, faster than the gps rate
+#define AP_INERTIALNAV_HISTORY_SIZE                 24      // enough history to cover the largest gps lag (1 second)
+#define AP_INERTIALNAV_BARO_LAG_MS                  150     // baro altitudes are delayed by 150ms
 
 #define AP_INERTIALNAV_LATLON_TO_CM 1.1113175
 
@@ -34,6 +35,7 @@ public:
         _gps_ptr(gps_ptr),
         _xy_enabled(false),
         _gps_last_update(0),
+        _gps_last_fix_time(0),
         _baro_last_update(0)
         {
             AP_Param::setup_object_defaults(this, var_info);
@@ -130,9 +132,7 @@ protected:
     float                   _k3_xy;                     // gain for horizontal accelerometer offset correction
     uint32_t                _gps_last_update;           // system time of last gps update
     uint32_t                _gps_last_time;             // time of last gps update according to the gps itself
-    uint8_t                 _historic_xy_counter;       // counter used to slow saving of position estimates for later comparison to gps
-    AP_BufferFloat_Size5    _hist_position_estimate_x;  // buffer of historic accel based position to account for lag
-    AP_BufferFloat_Size5    _hist_position_estimate_y;  // buffer of historic accel based position to account for lag
+    uint32_t                _gps_last_fix_time;         // system time the last gps fix was taken, from the gps timestamps
     int32_t                 _base_lat;                  // base latitude
     int32_t                 _base_lon;                  // base longitude
     float                   _lon_to_m_scaling;          // conversion of longitude to meters
@@ -143,12 +143,12 @@ protected:
     float                   _k2_z;                      // gain for vertical velocity correction
     float                   _k3_z;                      // gain for vertical accelerometer offset correction
     uint32_t                _baro_last_update;           // time of last barometer update
-    AP_BufferFloat_Size15   _hist_position_estimate_z;  // buffer of historic accel based altitudes to account for lag
 
     // general variables
     Vector3f                _position_base;             // position estimate
     Vector3f                _position_correction;       // sum of correction to _comp_h from delayed 1st order samples    
     Vector3f                _velocity;                  // latest velocity estimate (integrated from accelerometer values)
+    AP_DelayLine<float,3,AP_INERTIALNAV_HISTORY_SIZE> _hist_position_estimate;  // time stamped historic accel based positions to account for gps and baro lag
 };
 
 #endif // __AP_INERTIALNAV_H__
@@ -89,10 +89,53 @@ const AP_Param::GroupInfo AP_InertialSensor::var_info[] PROGMEM = {
     // @User: Advanced
     AP_GROUPINFO("MPU6K_FILTER", 4, AP_InertialSensor, _mpu6000_filter,  0),
 
+    // @Param: MPU6K_DECIM
+    // @DisplayName: MPU6000 decimation filter order
+    // @Description: When non-zero the MPU6000 is sampled at 1kHz and the samples are reduced to the main loop rate by a decimation filter of this order inside the driver. This gives lower delay than the MPU6000's own low pass filter for the same noise level. 1 is a plain average, 2 and 3 give progressively better rejection of high frequency vibration at the cost of a little delay. MPU6K_FILTER then sets the anti-aliasing filter ahead of the 1kHz sampling and defaults to 188Hz. This option takes effect on the next reboot
+    // @Values: 0:Disabled,1:Average,2:Second order,3:Third order
+    // @User: Advanced
+    AP_GROUPINFO("MPU6K_DECIM", 5, AP_InertialSensor, _mpu6000_decimation,  0),
+
+    // @Param: GYRO_LPF
+    // @DisplayName: Gyro low pass filter frequency
+    // @Description: Cutoff frequency of a second order low pass filter applied to the gyros at the main loop rate, after the sensor's own filtering. This lets the rate controllers be tuned without fighting vibration. 0 disables the filter. Frequencies at or above half the main loop rate also disable it
+    // @Units: Hz
+    // @Range: 0 100
+    // @User: Advanced
+    AP_GROUPINFO("GYRO_LPF",    6, AP_InertialSensor, _gyro_filter_hz,  0),
+
+    // @Param: ACCEL_LPF
+    // @DisplayName: Accelerometer low pass filter frequency
+    // @Description: Cutoff frequency of a second order low pass filter applied to the accelerometers at the main loop rate. 0 disables the filter
+    // @Units: Hz
+    // @Range: 0 100
+    // @User: Advanced
+    AP_GROUPINFO("ACCEL_LPF",   7, AP_InertialSensor, _accel_filter_hz,  0),
+
+    // @Param: NOTCH_FREQ
+    // @DisplayName: Notch filter frequency
+    // @Description: Centre frequency of a notch filter applied to both gyros and accelerometers, normally set to the frequency of the worst motor or propeller vibration as seen at the main loop rate. 0 disables the notch
+    // @Units: Hz
+    // @Range: 0 100
+    // @User: Advanced
+    AP_GROUPINFO("NOTCH_FREQ",  8, AP_InertialSensor, _notch_hz,  0),
+
+    // @Param: NOTCH_BW
+    // @DisplayName: Notch filter bandwidth
+    // @Description: Width of the band rejected by the notch filter. Wider notches cope with vibration that moves with throttle but add more phase lag below the notch
+    // @Units: Hz
+    // @Range: 1 100
+    // @User: Advanced
+    AP_GROUPINFO("NOTCH_BW",    9, AP_InertialSensor, _notch_bandwidth_hz,  10),
+
     AP_GROUPEND
 };
 
-AP_InertialSensor::AP_InertialSensor() {
+AP_InertialSensor::AP_InertialSensor() :
+    _update_freq_hz(100),
+    _filter_freq_hz(100),
+    _filters_designed(false)
+{
     AP_Param::setup_object_defaults(this, var_info);        
 }
 
@@ -103,6 +146,20 @@ AP_InertialSensor::init( Start_style style,
 {
     _product_id = _init_sensor(sample_rate);
 
+    // a first guess at the update rate, until it has been measured
+    switch (sample_rate) {
+    case RATE_50HZ:
+        _update_freq_hz = 50;
+        break;
+    case RATE_100HZ:
+        _update_freq_hz = 100;
+        break;
+    case RATE_200HZ:
+        _update_freq_hz = 200;
+        break;
+    }
+    _restart_filters();
+
     // check scaling
     Vector3f accel_scale = _accel_scale.get();
     if( accel_scale.x == 0 && accel_scale.y == 0 && accel_scale.z == 0 ) {
@@ -113,6 +170,7 @@ AP_InertialSensor::init( Start_style style,
     if (WARM_START != style) {
         // do cold-start calibration for gyro only
         _init_gyro(flash_leds_cb);
+        _restart_filters();
     }
 }
 
@@ -125,10 +183,69 @@ void AP_InertialSensor::_save_parameters()
     _gyro_offset.save();
 }
 
+// _filter_samples - run the latest readings through the enabled filters
+void AP_InertialSensor::_filter_samples()
+{
+    // the filters step once per update(), which need not be the rate
+    // the sensor is sampled or decimated at, so track the rate of the
+    // updates themselves. Gaps from startup and calibration are ignored
+    uint32_t dt_usec = get_delta_time_micros();
+    if (dt_usec >= 1000 && dt_usec <= 100000) {
+        _update_freq_hz += (1.0e6f / dt_usec - _update_freq_hz) * 0.1f;
+    }
+
+    if (!_filters_designed ||
+        _filter_gyro_hz != _gyro_filter_hz ||
+        _filter_accel_hz != _accel_filter_hz ||
+        _filter_notch_hz != _notch_hz ||
+        _filter_notch_bandwidth_hz != _notch_bandwidth_hz ||
+        fabsf(_update_freq_hz - _filter_freq_hz) > 0.1f * _filter_freq_hz) {
+        // first sample, the parameters have changed or the update
+        // rate has moved more than 10% from the one designed for
+        _design_filters();
+    }
+
+    if (_filter_notch_hz > 0) {
+        _gyro = _gyro_notch.apply(_gyro);
+        _accel = _accel_notch.apply(_accel);
+    }
+    if (_filter_gyro_hz > 0) {
+        _gyro = _gyro_lpf.apply(_gyro);
+    }
+    if (_filter_accel_hz > 0) {
+        _accel = _accel_lpf.apply(_accel);
+    }
+}
+
+// _design_filters - recalculate the filters and settle them on the
+// current readings so there is no step in the output
+void AP_InertialSensor::_design_filters()
+{
+    _filters_designed = true;
+    _filter_gyro_hz = _gyro_filter_hz;
+    _filter_accel_hz = _accel_filter_hz;
+    _filter_notch_hz = _notch_hz;
+    _filter_notch_bandwidth_hz = _notch_bandwidth_hz;
+    _filter_freq_hz = _update_freq_hz;
+
+    float sample_freq = _filter_freq_hz;
+
+    _gyro_lpf.set_low_pass(sample_freq, _filter_gyro_hz);
+    _gyro_lpf.reset(_gyro);
+    _accel_lpf.set_low_pass(sample_freq, _filter_accel_hz);
+    _accel_lpf.reset(_accel);
+
+    _gyro_notch.set_notch(sample_freq, _filter_notch_hz, _filter_notch_bandwidth_hz);
+    _gyro_notch.reset(_gyro);
+    _accel_notch.set_notch(sample_freq, _filter_notch_hz, _filter_notch_bandwidth_hz);
+    _accel_notch.reset(_accel);
+}
+
 void
 AP_InertialSensor::init_gyro(void (*flash_leds_cb)(bool on))
 {
     _init_gyro(flash_leds_cb);
+    _restart_filters();
 
     // save calibration
     _save_parameters();
@@ -222,6 +339,7 @@ void
 AP_InertialSensor::init_accel(void (*flash_leds_cb)(bool on))
 {
     _init_accel(flash_leds_cb);
+    _restart_filters();
 
     // save calibration
     _save_parameters();
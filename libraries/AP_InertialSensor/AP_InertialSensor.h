@@ -11,6 +11,8 @@
 #include <stdint.h>
 #include <AP_HAL.h>
 #include <AP_Math.h>
+#include <Filter.h>
+#include <BiquadFilter.h>
 #include "AP_InertialSensor_UserInteract.h"
 /* AP_InertialSensor is an abstraction for gyro and accel measurements
  * which are correctly aligned to the body axes and scaled to SI units.
@@ -151,6 +153,13 @@ protected:
     // save parameters to eeprom
     void  _save_parameters();
 
+    // filter the latest _gyro and _accel readings through the low pass
+    // and notch filters. Called by each driver at the end of update()
+    void  _filter_samples();
+
+    // force the filters to be redesigned and settled on the next sample
+    void  _restart_filters() { _filters_designed = false; }
+
     // Most recent accelerometer reading obtained by ::update
     Vector3f _accel;
 
@@ -167,6 +176,37 @@ protected:
 
     // filtering frequency (0 means default)
     AP_Int8                 _mpu6000_filter;
+
+    // order of the in-driver decimation filter used when sampling
+    // at 1kHz (0 means use the sensor's own sample rate and filter)
+    AP_Int8                 _mpu6000_decimation;
+
+    // biquad filters applied to the scaled samples (0 means disabled)
+    AP_Int8                 _gyro_filter_hz;
+    AP_Int8                 _accel_filter_hz;
+    AP_Int8                 _notch_hz;
+    AP_Int8                 _notch_bandwidth_hz;
+
+private:
+    // _design_filters - recalculate the filters from the parameters
+    void  _design_filters();
+
+    // the rate update() is called at, which is the rate the filters
+    // step at, and the rate they were designed for
+    float                   _update_freq_hz;
+    float                   _filter_freq_hz;
+    bool                    _filters_designed;
+
+    // parameter values the filters were designed with
+    int8_t                  _filter_gyro_hz;
+    int8_t                  _filter_accel_hz;
+    int8_t                  _filter_notch_hz;
+    int8_t                  _filter_notch_bandwidth_hz;
+
+    BiquadFilterVector3f    _gyro_lpf;
+    BiquadFilterVector3f    _accel_lpf;
+    BiquadFilterVector3f    _gyro_notch;
+    BiquadFilterVector3f    _accel_notch;
 };
 
 #include "AP_InertialSensor_Oilpan.h"
@@ -209,6 +209,10 @@ uint8_t AP_InertialSensor_MPU6000::_fifoCountL;
 // holds the 4 quaternions representing attitude taken directly from the DMP
 Quaternion AP_InertialSensor_MPU6000::quaternion;
 
+// decimation filter for 1kHz sampling
+DecimationFilter<7,MPU6000_DECIMATION_MAX_ORDER> AP_InertialSensor_MPU6000::_decimator;
+bool AP_InertialSensor_MPU6000::_decimating = false;
+
 /* Static SPI device driver */
 AP_HAL::SPIDeviceDriver* AP_InertialSensor_MPU6000::_spi = NULL;
 AP_HAL::Semaphore* AP_InertialSensor_MPU6000::_spi_sem = NULL;
@@ -239,8 +243,10 @@ uint16_t AP_InertialSensor_MPU6000::_init_sensor( Sample_rate sample_rate )
 }
 
 // accumulation in ISR - must be read with interrupts disabled
-// the sum of the values since last read
-static volatile int32_t _sum[7];
+// the sum of the values since last read. The decimated samples carry
+// the gain of the filter, up to 65536, so the sum is kept in 64 bits
+// to give the same margin as plain samples if update() is held off
+static volatile int64_t _sum[7];
 
 // how many values we've accumulated since last read
 static volatile uint16_t _count;
@@ -263,7 +269,7 @@ void AP_InertialSensor_MPU6000::wait_for_sample()
 
 bool AP_InertialSensor_MPU6000::update( void )
 {
-    int32_t sum[7];
+    int64_t sum[7];
     uint16_t count;
     float count_scale;
     Vector3f accel_scale = _accel_scale.get();
@@ -287,6 +293,10 @@ bool AP_InertialSensor_MPU6000::update( void )
     hal.scheduler->resume_timer_procs();
 
     count_scale = 1.0 / count;
+    if (_decimating) {
+        // the decimated samples carry the gain of the filter
+        count_scale /= _decimator.get_gain();
+    }
 
     _gyro.x = _gyro_scale * _gyro_data_sign[0] * sum[_gyro_data_index[0]] * count_scale;
     _gyro.y = _gyro_scale * _gyro_data_sign[1] * sum[_gyro_data_index[1]] * count_scale;
@@ -300,6 +310,8 @@ bool AP_InertialSensor_MPU6000::update( void )
 
     _temp    = _temp_to_celsius(sum[_temp_data_index] * count_scale);
 
+    _filter_samples();
+
     return true;
 }
 
@@ -364,7 +376,6 @@ void AP_InertialSensor_MPU6000::_read_data_from_timerprocess()
         semfail_ctr = 0;
     }   
 
-    _last_sample_time_micros = hal.scheduler->micros();
     _read_data_transaction();
 
     _spi_sem->give();
@@ -374,18 +385,38 @@ void AP_InertialSensor_MPU6000::_read_data_transaction() {
     /* one resister address followed by seven 2-byte registers */
     uint8_t tx[15];
     uint8_t rx[15];
+    int16_t raw[7];
+    uint32_t sample_time = hal.scheduler->micros();
     memset(tx,0,15);
     tx[0] = MPUREG_ACCEL_XOUT_H | 0x80;
     _spi->transaction(tx, rx, 15);
 
     for (uint8_t i = 0; i < 7; i++) {
-        _sum[i] += (int16_t)(((uint16_t)rx[2*i+1] << 8) | rx[2*i+2]);
+        raw[i] = (int16_t)(((uint16_t)rx[2*i+1] << 8) | rx[2*i+2]);
     }   
-    
-    _count++;
-    if (_count == 0) {
-        // rollover - v unlikely
-        memset((void*)_sum, 0, sizeof(_sum));
+
+    bool new_sample = true;
+    if (!_decimating) {
+        for (uint8_t i = 0; i < 7; i++) {
+            _sum[i] += raw[i];
+        }
+    } else if (_decimator.apply(raw)) {
+        // a new decimated sample is ready
+        for (uint8_t i = 0; i < 7; i++) {
+            _sum[i] += _decimator.output(i);
+        }
+    } else {
+        // sample absorbed by the decimation filter
+        new_sample = false;
+    }
+
+    if (new_sample) {
+        _last_sample_time_micros = sample_time;
+        _count++;
+        if (_count == 0) {
+            // rollover - v unlikely
+            memset((void*)_sum, 0, sizeof(_sum));
+        }
     }
 
     // should also read FIFO data if enabled
@@ -495,6 +526,19 @@ reset_chip:
         msec_per_sample = 5;
         break;
     }
+
+    if (_mpu6000_decimation > 0) {
+        // sample at 1kHz and let the decimation filter bring the
+        // rate down to the one asked for. The sensor's own filter
+        // then only has to stop aliasing at 1kHz
+        _decimator.set_ratio_and_order(msec_per_sample, _mpu6000_decimation);
+        _decimating = true;
+        rate = MPUREG_SMPLRT_1000HZ;
+        default_filter = BITS_DLPF_CFG_188HZ;
+        msec_per_sample = 1;
+    } else {
+        _decimating = false;
+    }
     
     // choose filtering frequency
     switch (_mpu6000_filter) {
@@ -574,12 +618,13 @@ reset_chip:
                     "first MPU6000 sample"));
         return; /* never reached */
     }
-    _last_sample_time_micros = hal.scheduler->micros();
     _read_data_transaction();
     _spi_sem->give();
 
     // start the timer process to read samples
-    hal.scheduler->register_timer_process(_poll_data);
+    // poll for new data every tick, ahead of the slower sensors
+    hal.scheduler->register_timer_process(_poll_data, 1,
+                                          AP_HAL::Scheduler::TIMER_PRIORITY_HIGH);
 
 #if MPU6000_DEBUG
     _dump_registers();
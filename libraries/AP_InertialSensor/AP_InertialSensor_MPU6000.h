@@ -7,10 +7,13 @@
 #include <AP_HAL.h>
 #include <AP_Math.h>
 #include <AP_Progmem.h>
+#include <Filter.h>
+#include <DecimationFilter.h>
 #include "AP_InertialSensor.h"
 
 #define MPU6000_CS_PIN       53        // APM pin connected to mpu6000's chip select pin
 #define DMP_FIFO_BUFFER_SIZE 72        // DMP FIFO buffer size
+#define MPU6000_DECIMATION_MAX_ORDER 3 // highest order of the 1kHz decimation filter
 
 // enable debug to see a register dump on startup
 #define MPU6000_DEBUG 0
@@ -80,6 +83,11 @@ private:
 
     static const uint8_t        _temp_data_index;
 
+    // decimation filter applied to the raw 1kHz samples when
+    // _mpu6000_decimation is set
+    static DecimationFilter<7,MPU6000_DECIMATION_MAX_ORDER> _decimator;
+    static bool                 _decimating;
+
     // ensure we can't initialise twice
     bool                        _initialised;
     static int16_t              _mpu6000_product_id;
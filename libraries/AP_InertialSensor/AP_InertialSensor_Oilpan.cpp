@@ -57,7 +57,7 @@ uint16_t AP_InertialSensor_Oilpan::_init_sensor( Sample_rate sample_rate)
         break;
     }
 
-#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
     return AP_PRODUCT_ID_SITL;
 #elif defined(__AVR_ATmega1280__)
     return AP_PRODUCT_ID_APM1_1280;
@@ -87,6 +87,8 @@ bool AP_InertialSensor_Oilpan::update()
     _accel.z = accel_scale.z * _sensor_signs[5] * (adc_values[5] - OILPAN_RAW_ACCEL_OFFSET) * OILPAN_ACCEL_SCALE_1G;
     _accel -= accel_offset;
 
+    _filter_samples();
+
 /*
  *  X  = 1619.30 to 2445.69
  *  Y =  1609.45 to 2435.42
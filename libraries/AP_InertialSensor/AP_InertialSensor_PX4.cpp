@@ -91,6 +91,8 @@ bool AP_InertialSensor_PX4::update(void)
 
     memset(&_raw_sensors, 0, sizeof(_raw_sensors));
 
+    _filter_samples();
+
     return true;
 }
 
@@ -4,6 +4,25 @@
 #include <AP_HAL.h>
 const extern AP_HAL::HAL& hal;
 
+// the simulated samples are quantised to the MPU6000 scaling before
+// decimation: +/- 2000 deg/s and +/- 8g
+#define STUB_GYRO_SCALE     (0.0174532 / 16.4)
+#define STUB_ACCEL_SCALE    (GRAVITY / 4096.0)
+
+Vector3f AP_InertialSensor_Stub::_hil_gyro;
+Vector3f AP_InertialSensor_Stub::_hil_accel;
+
+// decimation filter for 1kHz sampling
+DecimationFilter<6,STUB_DECIMATION_MAX_ORDER> AP_InertialSensor_Stub::_decimator;
+bool AP_InertialSensor_Stub::_decimating = false;
+
+// the sum of the decimated samples since the last update, kept in 64
+// bits as the samples carry the gain of the filter
+static volatile int64_t _sum[6];
+
+// how many decimated samples are in _sum
+static volatile uint16_t _count;
+
 uint16_t AP_InertialSensor_Stub::_init_sensor( Sample_rate sample_rate ) {
     switch (sample_rate) {
     case RATE_50HZ:
@@ -16,15 +35,77 @@ uint16_t AP_InertialSensor_Stub::_init_sensor( Sample_rate sample_rate ) {
         _sample_period_ms = 5;
         break;
     }
+
+    hal.scheduler->suspend_timer_procs();
+    if (_mpu6000_decimation > 0) {
+        _decimator.set_ratio_and_order(_sample_period_ms, _mpu6000_decimation);
+        _decimating = true;
+    } else {
+        _decimating = false;
+    }
+    _count = 0;
+    memset((void*)_sum, 0, sizeof(_sum));
+    hal.scheduler->resume_timer_procs();
+
+    hal.scheduler->register_timer_process(_poll_data, 1,
+                                          AP_HAL::Scheduler::TIMER_PRIORITY_HIGH);
     return AP_PRODUCT_ID_NONE;
 }
 
+/*
+ *  sample the held values as the MPU6000 would at 1kHz, and feed them
+ *  through the decimation filter. Called in the timer process context
+ */
+void AP_InertialSensor_Stub::_poll_data(uint32_t)
+{
+    if (!_decimating) {
+        return;
+    }
+
+    Vector3f gyro = _hil_gyro / STUB_GYRO_SCALE;
+    Vector3f accel = _hil_accel / STUB_ACCEL_SCALE;
+    int16_t raw[6];
+    raw[0] = constrain(gyro.x, -32768, 32767);
+    raw[1] = constrain(gyro.y, -32768, 32767);
+    raw[2] = constrain(gyro.z, -32768, 32767);
+    raw[3] = constrain(accel.x, -32768, 32767);
+    raw[4] = constrain(accel.y, -32768, 32767);
+    raw[5] = constrain(accel.z, -32768, 32767);
+
+    if (_decimator.apply(raw)) {
+        for (uint8_t i = 0; i < 6; i++) {
+            _sum[i] += _decimator.output(i);
+        }
+        _count++;
+        if (_count == 0) {
+            // rollover - v unlikely
+            memset((void*)_sum, 0, sizeof(_sum));
+        }
+    }
+}
+
 /*================ AP_INERTIALSENSOR PUBLIC INTERFACE ==================== */
 
 bool AP_InertialSensor_Stub::update( void ) {
     uint32_t now = hal.scheduler->millis();
     _delta_time_usec = (now - _last_update_ms) * 1000;
     _last_update_ms = now;
+
+    hal.scheduler->suspend_timer_procs();
+    if (_decimating && _count != 0) {
+        float count_scale = 1.0 / (_count * _decimator.get_gain());
+        _gyro  = Vector3f(_sum[0], _sum[1], _sum[2]) * (count_scale * STUB_GYRO_SCALE);
+        _accel = Vector3f(_sum[3], _sum[4], _sum[5]) * (count_scale * STUB_ACCEL_SCALE);
+        memset((void*)_sum, 0, sizeof(_sum));
+        _count = 0;
+    } else if (!_decimating) {
+        _gyro = _hil_gyro;
+        _accel = _hil_accel;
+    }
+    hal.scheduler->resume_timer_procs();
+
+    _filter_samples();
+
     return true;
 }
 bool AP_InertialSensor_Stub::new_data_available( void ) {
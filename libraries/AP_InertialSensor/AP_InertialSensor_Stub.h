@@ -4,8 +4,11 @@
 #define __AP_INERTIAL_SENSOR_STUB_H__
 
 #include <AP_Progmem.h>
+#include <DecimationFilter.h>
 #include "AP_InertialSensor.h"
 
+#define STUB_DECIMATION_MAX_ORDER 3 // highest order of the 1kHz decimation filter
+
 class AP_InertialSensor_Stub : public AP_InertialSensor
 {
 public:
@@ -22,11 +25,26 @@ public:
     float           get_gyro_drift_rate();
     uint16_t        num_samples_available();
 
+    /* the simulated sensors are set from the timer in SITL, so they are
+     * held here until the next ::update */
+    void            set_gyro(Vector3f gyro) { _hil_gyro = gyro; }
+    void            set_accel(Vector3f accel) { _hil_accel = accel; }
+
 protected:
     uint16_t        _init_sensor( Sample_rate sample_rate );
     uint32_t        _sample_period_ms;
     uint32_t        _last_update_ms;
     uint32_t        _delta_time_usec;
+    static Vector3f _hil_gyro;
+    static Vector3f _hil_accel;
+
+private:
+    /* with MPU6K_DECIM set the held values are sampled at 1kHz and
+     * decimated as the MPU6000 driver does, so simulation sees the
+     * same delay and rejection as the real sensor */
+    static void     _poll_data(uint32_t now);
+    static DecimationFilter<6,STUB_DECIMATION_MAX_ORDER> _decimator;
+    static bool     _decimating;
 };
 
 #endif // __AP_INERTIAL_SENSOR_STUB_H__
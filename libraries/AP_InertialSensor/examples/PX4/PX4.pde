@@ -15,6 +15,7 @@
 #include <AP_Math.h>
 #include <AP_Param.h>
 #include <AP_ADC.h>
+#include <Filter.h>
 #include <AP_InertialSensor.h>
 
 const AP_HAL::HAL& hal = AP_HAL_BOARD_DRIVER;
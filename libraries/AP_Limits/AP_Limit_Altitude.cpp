@@ -9,6 +9,7 @@
 ///         Andreas Antonopoulos
 
 #include "AP_Limit_Altitude.h"
+#include <AP_Terrain.h>
 
 const AP_Param::GroupInfo AP_Limit_Altitude::var_info[] PROGMEM = {
     // @Param: ALT_ON
@@ -42,6 +43,15 @@ const AP_Param::GroupInfo AP_Limit_Altitude::var_info[] PROGMEM = {
     // @Increment: 1
     // @User: Standard
     AP_GROUPINFO("ALT_MAX", 3,      AP_Limit_Altitude,      _max_alt, 0),
+
+    // @Param: ALT_TMIN
+    // @DisplayName: Minimum Altitude above terrain
+    // @Description: Minimum Altitude above the terrain under the vehicle. Zero to disable. Only checked where the terrain height is known, see the TERRAIN_ parameters
+    // @Units: Meters
+    // @Range: 0 250000
+    // @Increment: 1
+    // @User: Standard
+    AP_GROUPINFO("ALT_TMIN", 4,     AP_Limit_Altitude,      _min_terrain_alt, 0),
     AP_GROUPEND
 };
 
@@ -50,6 +60,7 @@ AP_Limit_Altitude::AP_Limit_Altitude(struct Location *current_loc) :
 {
     AP_Param::setup_object_defaults(this, var_info);
     _current_loc = current_loc;
+    _terrain = NULL;
 }
 
 bool AP_Limit_Altitude::triggered()
@@ -67,6 +78,15 @@ bool AP_Limit_Altitude::triggered()
     if (_min_alt > 0 && _current_loc->alt < _min_alt*100 ) {
         _triggered = true;
     }
+
+    // _min_terrain_alt is zero if disabled. Where there is no terrain
+    // data the check is skipped
+    float terrain_alt;
+    if (_min_terrain_alt > 0 && _terrain != NULL &&
+        _terrain->height_relative_home(*_current_loc, terrain_alt) &&
+        _current_loc->alt < (terrain_alt + _min_terrain_alt) * 100) {
+        _triggered = true;
+    }
     return _triggered;
 }
 
@@ -13,6 +13,8 @@
 #include "AP_Limit_Module.h"
 #include <AP_Param.h>
 
+class AP_Terrain;
+
 class AP_Limit_Altitude : public AP_Limit_Module {
 
 public:
@@ -21,6 +23,10 @@ public:
     AP_Int32        min_alt();
     AP_Int32        max_alt();
 
+    // set_terrain - check the height above the terrain as well, against
+    // ALT_TMIN. The current location altitude must be relative to home
+    void            set_terrain(AP_Terrain *terrain) { _terrain = terrain; }
+
     bool            init();
     bool            triggered();
 
@@ -30,6 +36,8 @@ protected:
     struct Location *                               _current_loc;
     AP_Int32        _min_alt;
     AP_Int32        _max_alt;
+    AP_Int32        _min_terrain_alt;
+    AP_Terrain *    _terrain;
 
 
 };
@@ -116,7 +116,7 @@ bool AP_Limit_Geofence::triggered() {
             location.x = _current_loc->lat;
             location.y = _current_loc->lng;
             // trigger if outside
-            if (Polygon_outside(location, &_boundary[1], _fence_total-1)) {
+            if (!_fence.inside(location)) {
                 // TRIGGER
                 _triggered = true;
             }
@@ -183,6 +183,9 @@ void AP_Limit_Geofence::update_boundary() {
             _boundary[i] = get_fence_point_with_index(i);
         }
 
+        _fence.clear();
+        _fence.add_polygon(&_boundary[1], _fence_total - 1, false);
+
         _boundary_uptodate = true;
 
     }
@@ -190,8 +193,9 @@ void AP_Limit_Geofence::update_boundary() {
 
 bool AP_Limit_Geofence::boundary_correct() {
 
-    if (Polygon_complete(&_boundary[1], _fence_total - 1) &&
-        !Polygon_outside(_boundary[0], &_boundary[1], _fence_total - 1)) {
+    // the fence only has a zone if the polygon was complete
+    if (_fence.num_zones() != 0 &&
+        _fence.inside(_boundary[0])) {
         return true;
     } else return false;
 }
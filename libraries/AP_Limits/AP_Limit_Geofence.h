@@ -12,6 +12,7 @@
 #include "AP_Limits.h"
 #include "AP_Limit_Module.h"
 #include <AP_Math.h>
+#include <AP_Fence.h>
 #include <AP_Param.h>
 #include <GPS.h>
 
@@ -56,6 +57,7 @@ private:
     const unsigned          _max_fence_points;
     bool                    _boundary_uptodate;
     Vector2l                _boundary[MAX_FENCEPOINTS];      // complex mode fence
+    AP_Fence                _fence;                          // zones of _boundary[1] onwards
 
 };
 
@@ -15,6 +15,7 @@
 #include "matrix3.h"
 #include "quaternion.h"
 #include "polygon.h"
+#include "nav_leg.h"
 
 #ifndef PI
 #define PI 3.141592653589793
@@ -0,0 +1,95 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ * nav_leg.cpp
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include "AP_Math.h"
+
+NavLeg::NavLeg() :
+    _dest_lat(0),
+    _dest_lng(0),
+    _scale_lat(0),
+    _lng_scale(NAV_LEG_SCALE),
+    _length(0),
+    _bearing_cd(0)
+{
+}
+
+// the cos() is only redone if the latitude moves by more than 0.01
+// degrees, as in longitude_scale()
+void NavLeg::_set_scale(int32_t lat)
+{
+    if (_lng_scale != NAV_LEG_SCALE && labs(_scale_lat - lat) < 100000) {
+        return;
+    }
+    _lng_scale = cos((fabs((float)lat)/1.0e7) * 0.0174532925) * NAV_LEG_SCALE;
+    _scale_lat = lat;
+}
+
+void NavLeg::set(const struct Location &origin, const struct Location &destination)
+{
+    _dest_lat = destination.lat;
+    _dest_lng = destination.lng;
+    _set_scale(destination.lat);
+
+    // the leg runs from the origin to the destination, which is -offset
+    Vector2f p = offset(origin);
+    Vector2f leg(-p.x, -p.y);
+    _length = leg.length();
+    if (_length > 0) {
+        _unit = leg / _length;
+    } else {
+        _unit = Vector2f(0, 0);
+    }
+    _bearing_cd = atan2(leg.y, leg.x) * 5729.57795;
+    if (_bearing_cd < 0) _bearing_cd += 36000;
+}
+
+void NavLeg::set_destination(const struct Location &destination)
+{
+    _dest_lat = destination.lat;
+    _dest_lng = destination.lng;
+    _set_scale(destination.lat);
+}
+
+float NavLeg::distance(const struct Location &loc) const
+{
+    if (loc.lat == 0 || loc.lng == 0 || _dest_lat == 0 || _dest_lng == 0) {
+        return -1;
+    }
+    return offset(loc).length();
+}
+
+int32_t NavLeg::bearing_cd(const struct Location &loc) const
+{
+    Vector2f p = offset(loc);
+    int32_t bearing = atan2(-p.y, -p.x) * 5729.57795;
+    if (bearing < 0) bearing += 36000;
+    return bearing;
+}
+
+bool NavLeg::passed(const struct Location &loc) const
+{
+    if (_length == 0) {
+        // no direction to be past the destination in, so only being
+        // on it counts
+        return ends_at(loc);
+    }
+    // past the destination when the offset from it is along the leg
+    Vector2f p = offset(loc);
+    return p * _unit > 0;
+}
@@ -0,0 +1,94 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ * nav_leg.h
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAV_LEG_H
+#define NAV_LEG_H
+
+/*
+  A leg of a route, from one waypoint to the next, worked in a flat
+  north/east frame in meters around the destination. The longitude
+  scale, the unit vector along the leg, its length and its bearing are
+  worked out once by set(), so distance, crosstrack and the passed
+  waypoint test are a few multiply-adds per update, and only the
+  bearing needs an atan2().
+
+  Positions are scaled with the same factors as get_distance(), so the
+  results match it to within float rounding.
+ */
+// meters per unit of latitude
+#define NAV_LEG_SCALE 0.01113195f
+
+class NavLeg
+{
+public:
+    NavLeg();
+
+    // set - start a leg from origin to destination
+    void        set(const struct Location &origin, const struct Location &destination);
+
+    // set_destination - move the leg so it ends at destination, keeping
+    // its direction and length. For when the target is moved without a
+    // new leg being started
+    void        set_destination(const struct Location &destination);
+
+    // ends_at - true if the leg ends at loc
+    bool        ends_at(const struct Location &loc) const {
+        return loc.lat == _dest_lat && loc.lng == _dest_lng;
+    }
+
+    // offset - meters north and east of the destination to loc
+    Vector2f    offset(const struct Location &loc) const {
+        return Vector2f((loc.lat - _dest_lat) * NAV_LEG_SCALE,
+                        (loc.lng - _dest_lng) * _lng_scale);
+    }
+
+    // length of the leg in meters, and its bearing in centi-degrees
+    float       length() const { return _length; }
+    int32_t     bearing_cd() const { return _bearing_cd; }
+
+    // distance - meters from loc to the destination, or -1 if loc or
+    // the destination is invalid, as get_distance()
+    float       distance(const struct Location &loc) const;
+
+    // bearing_cd - bearing in centi-degrees from loc to the destination
+    int32_t     bearing_cd(const struct Location &loc) const;
+
+    // crosstrack - meters that loc is off the line of the leg, positive
+    // to the left of it
+    float       crosstrack(const struct Location &loc) const {
+        Vector2f p = offset(loc);
+        return _unit.y * p.x - _unit.x * p.y;
+    }
+
+    // passed - true if loc is past the line through the destination at
+    // right angles to the leg, as location_passed_point()
+    bool        passed(const struct Location &loc) const;
+
+private:
+    void        _set_scale(int32_t lat);
+
+    int32_t     _dest_lat;
+    int32_t     _dest_lng;
+    int32_t     _scale_lat;     // latitude _lng_scale was worked out for
+    float       _lng_scale;     // meters per unit of longitude
+    Vector2f    _unit;          // along the leg, north and east
+    float       _length;
+    int32_t     _bearing_cd;
+};
+
+#endif // NAV_LEG_H
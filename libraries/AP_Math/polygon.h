@@ -17,6 +17,36 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/*
+ *  Polygon_edge_crossed(): the test Polygon_outside() makes for each
+ *  edge. Returns true if a ray from P towards increasing x crosses the
+ *  edge from V1 to V2, counting an edge that starts or ends at P.y on
+ *  one side only
+ */
+static inline bool Polygon_edge_crossed(const Vector2l &P, const Vector2l &V1, const Vector2l &V2)
+{
+    if ((V1.y > P.y) == (V2.y > P.y)) {
+        return false;
+    }
+    int32_t dx1 = P.x - V1.x;
+    int32_t dx2 = V2.x - V1.x;
+    int32_t dy1 = P.y - V1.y;
+    int32_t dy2 = V2.y - V1.y;
+    int8_t m1 = (dx1 < 0 ? -1 : 1) * (dy2 < 0 ? -1 : 1);
+    int8_t m2 = (dx2 < 0 ? -1 : 1) * (dy1 < 0 ? -1 : 1);
+    // we avoid the 64 bit multiplies if we can based on sign checks.
+    if (dy2 < 0) {
+        if (m1 != m2) {
+            return m1 > m2;
+        }
+        return dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1;
+    }
+    if (m1 != m2) {
+        return m1 < m2;
+    }
+    return dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1;
+}
+
 bool        Polygon_outside(const Vector2l &P, const Vector2l *V, unsigned n);
 bool        Polygon_complete(const Vector2l *V, unsigned n);
 
@@ -0,0 +1,189 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ *       AP_Mission.cpp - mission command storage with a RAM cache
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <string.h>
+#include "AP_Mission.h"
+
+extern const AP_HAL::HAL& hal;
+
+AP_Mission::AP_Mission(uint16_t storage_start, uint16_t max_commands) :
+    _storage_start(storage_start),
+    _max_commands(max_commands),
+    _cache_count(0),
+    _batch_start(0),
+    _batch_count(0),
+    _hits(0),
+    _misses(0)
+{
+}
+
+// the fields are copied one at a time, as struct Location has padding
+// on some boards
+void AP_Mission::_decode(const uint8_t *buf, struct Location &cmd)
+{
+    cmd.id      = buf[0];
+    cmd.options = buf[1];
+    cmd.p1      = buf[2];
+    memcpy(&cmd.alt, &buf[3],  4);
+    memcpy(&cmd.lat, &buf[7],  4);
+    memcpy(&cmd.lng, &buf[11], 4);
+}
+
+void AP_Mission::_encode(const struct Location &cmd, uint8_t *buf)
+{
+    buf[0] = cmd.id;
+    buf[1] = cmd.options;
+    buf[2] = cmd.p1;
+    memcpy(&buf[3],  &cmd.alt, 4);
+    memcpy(&buf[7],  &cmd.lat, 4);
+    memcpy(&buf[11], &cmd.lng, 4);
+}
+
+// _cache_find - look for command i, moving it to the front if found
+bool AP_Mission::_cache_find(uint16_t i, struct Location &cmd)
+{
+    for (uint8_t k=0; k<_cache_count; k++) {
+        if (_cache[k].index == i) {
+            struct CacheEntry e = _cache[k];
+            memmove(&_cache[1], &_cache[0], k * sizeof(_cache[0]));
+            _cache[0] = e;
+            cmd = e.cmd;
+            return true;
+        }
+    }
+    return false;
+}
+
+// _cache_insert - add or replace command i at the front, dropping the
+// least recently used entry if the cache is full
+void AP_Mission::_cache_insert(uint16_t i, const struct Location &cmd)
+{
+    uint8_t k;
+    for (k=0; k<_cache_count; k++) {
+        if (_cache[k].index == i) {
+            break;
+        }
+    }
+    if (k == _cache_count) {
+        if (_cache_count < AP_MISSION_CACHE_SIZE) {
+            _cache_count++;
+        } else {
+            k = AP_MISSION_CACHE_SIZE - 1;
+        }
+    }
+    memmove(&_cache[1], &_cache[0], k * sizeof(_cache[0]));
+    _cache[0].index = i;
+    _cache[0].cmd = cmd;
+}
+
+bool AP_Mission::read_cmd(uint16_t i, struct Location &cmd)
+{
+    if (i >= _max_commands) {
+        return false;
+    }
+    if (_cache_find(i, cmd)) {
+        _hits++;
+        return true;
+    }
+    _misses++;
+
+    if (_batch_count != 0 && i >= _batch_start && i < _batch_start + _batch_count) {
+        _decode(&_batch[(i - _batch_start) * AP_MISSION_CMD_SIZE], cmd);
+        _cache_insert(i, cmd);
+        return true;
+    }
+
+    // read the next command too, unless it is past the end or waiting
+    // in the batch
+    uint8_t buf[2 * AP_MISSION_CMD_SIZE];
+    uint8_t count = 2;
+    if (i + 1 >= _max_commands ||
+        (_batch_count != 0 && i + 1 == _batch_start)) {
+        count = 1;
+    }
+    hal.storage->read_block(buf, _storage_start + i * AP_MISSION_CMD_SIZE,
+                            count * AP_MISSION_CMD_SIZE);
+    if (count == 2) {
+        struct Location next;
+        _decode(&buf[AP_MISSION_CMD_SIZE], next);
+        _cache_insert(i + 1, next);
+    }
+    _decode(buf, cmd);
+    _cache_insert(i, cmd);
+    return true;
+}
+
+bool AP_Mission::write_cmd(uint16_t i, const struct Location &cmd)
+{
+    if (i >= _max_commands) {
+        return false;
+    }
+
+    if (_batch_count != 0) {
+        if (i >= _batch_start && i < _batch_start + _batch_count) {
+            // overwrite a command already in the batch
+            _encode(cmd, &_batch[(i - _batch_start) * AP_MISSION_CMD_SIZE]);
+            _cache_insert(i, cmd);
+            return true;
+        }
+        if (i != _batch_start + _batch_count ||
+            _batch_count == AP_MISSION_BATCH_SIZE) {
+            flush();
+        }
+    }
+    if (_batch_count == 0) {
+        _batch_start = i;
+    }
+    _encode(cmd, &_batch[_batch_count * AP_MISSION_CMD_SIZE]);
+    _batch_count++;
+    _cache_insert(i, cmd);
+    return true;
+}
+
+// _write_changed - write count encoded commands from command i,
+// skipping the runs of bytes that storage already holds
+void AP_Mission::_write_changed(uint16_t i, const uint8_t *buf, uint8_t count)
+{
+    uint16_t base = _storage_start + i * AP_MISSION_CMD_SIZE;
+    for (uint8_t c=0; c<count; c++) {
+        uint8_t old[AP_MISSION_CMD_SIZE];
+        const uint8_t *b = &buf[c * AP_MISSION_CMD_SIZE];
+        hal.storage->read_block(old, base, AP_MISSION_CMD_SIZE);
+        uint8_t ofs = 0;
+        while (ofs < AP_MISSION_CMD_SIZE) {
+            if (old[ofs] == b[ofs]) {
+                ofs++;
+                continue;
+            }
+            uint8_t len = 1;
+            while (ofs + len < AP_MISSION_CMD_SIZE && old[ofs+len] != b[ofs+len]) {
+                len++;
+            }
+            hal.storage->write_block(base + ofs, (void *)&b[ofs], len);
+            ofs += len;
+        }
+        base += AP_MISSION_CMD_SIZE;
+    }
+}
+
+void AP_Mission::flush()
+{
+    if (_batch_count == 0) {
+        return;
+    }
+    _write_changed(_batch_start, _batch, _batch_count);
+    _batch_count = 0;
+}
+
+void AP_Mission::clear_cache()
+{
+    _cache_count = 0;
+    _batch_count = 0;
+}
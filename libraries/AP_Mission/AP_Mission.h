@@ -0,0 +1,102 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ *       AP_Mission.h - mission command storage with a RAM cache
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ */
+
+#ifndef __AP_MISSION_H__
+#define __AP_MISSION_H__
+
+#include <AP_Common.h>
+#include <AP_HAL.h>
+
+/*
+  The mission commands are kept in storage as AP_MISSION_CMD_SIZE byte
+  records: id, options and p1 as bytes, then alt, lat and lng as 32 bit
+  little endian values. This is the layout the vehicles have always
+  used, so existing missions are read unchanged.
+
+  Commands are read with one read_block() and kept decoded in a small
+  cache, most recently used first. A miss also reads the following
+  command, as navigation usually asks for that next. Writes go into a
+  batch of consecutive commands which is written out when a command
+  that does not follow it is written, when it is full, or by flush().
+  Only the bytes that differ from storage are written, so uploading an
+  unchanged mission does not wear the EEPROM.
+
+  Reads see writes that are still in the batch. The vehicle should call
+  flush() from a slow loop, so single writes such as home reach storage
+  within a second.
+ */
+
+// bytes in a stored command
+#define AP_MISSION_CMD_SIZE 15
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_APM1 || CONFIG_HAL_BOARD == HAL_BOARD_APM2
+ # define AP_MISSION_CACHE_SIZE 4
+ # define AP_MISSION_BATCH_SIZE 4
+#else
+ # define AP_MISSION_CACHE_SIZE 8
+ # define AP_MISSION_BATCH_SIZE 16
+#endif
+
+class AP_Mission
+{
+public:
+    AP_Mission(uint16_t storage_start, uint16_t max_commands);
+
+    // read_cmd - get command i. Returns false if i is past the end of
+    // the storage
+    bool read_cmd(uint16_t i, struct Location &cmd);
+
+    // write_cmd - set command i. Returns false if i is past the end of
+    // the storage
+    bool write_cmd(uint16_t i, const struct Location &cmd);
+
+    // flush - write any batched commands to storage
+    void flush();
+
+    // clear_cache - forget the cached commands, for when the storage
+    // has been changed other than through this object
+    void clear_cache();
+
+    uint16_t max_commands() const { return _max_commands; }
+
+    // cache statistics, for tuning the cache size
+    uint16_t cache_hits() const { return _hits; }
+    uint16_t cache_misses() const { return _misses; }
+
+private:
+    struct CacheEntry {
+        uint16_t index;
+        struct Location cmd;
+    };
+
+    static void _decode(const uint8_t *buf, struct Location &cmd);
+    static void _encode(const struct Location &cmd, uint8_t *buf);
+
+    bool _cache_find(uint16_t i, struct Location &cmd);
+    void _cache_insert(uint16_t i, const struct Location &cmd);
+    void _write_changed(uint16_t i, const uint8_t *buf, uint8_t count);
+
+    const uint16_t  _storage_start;
+    const uint16_t  _max_commands;
+
+    // most recently used first
+    struct CacheEntry _cache[AP_MISSION_CACHE_SIZE];
+    uint8_t         _cache_count;
+
+    // encoded commands waiting to be written, from _batch_start
+    uint8_t         _batch[AP_MISSION_BATCH_SIZE * AP_MISSION_CMD_SIZE];
+    uint16_t        _batch_start;
+    uint8_t         _batch_count;
+
+    uint16_t        _hits;
+    uint16_t        _misses;
+};
+
+#endif // __AP_MISSION_H__
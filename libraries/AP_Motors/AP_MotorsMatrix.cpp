@@ -8,6 +8,7 @@
  *   version 2.1 of the License, or (at your option) any later version.
  */
 #include <AP_HAL.h>
+#include <AP_HAL_Static.h>
 #include "AP_MotorsMatrix.h"
 
 extern const AP_HAL::HAL& hal;
@@ -81,7 +82,7 @@ void AP_MotorsMatrix::output_min()
     for( i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++ ) {
         if( motor_enabled[i] ) {
             motor_out[i] = _rc_throttle->radio_min;
-            hal.rcout->write(_motor_to_channel_map[i], motor_out[i]);
+            hal_static::rcout_write(_motor_to_channel_map[i], motor_out[i]);
         }
     }
 }
@@ -262,7 +263,7 @@ void AP_MotorsMatrix::output_armed()
     // send output to each motor
     for( i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++ ) {
         if( motor_enabled[i] ) {
-            hal.rcout->write(_motor_to_channel_map[i], motor_out[i]);
+            hal_static::rcout_write(_motor_to_channel_map[i], motor_out[i]);
         }
     }
 }
@@ -15,9 +15,6 @@
 // pointer to the last instantiated optical flow sensor.  Will be turned into
 // a table if we ever add support for more than one sensor
 AP_OpticalFlow* AP_OpticalFlow::_sensor = NULL;
-// number of times we have been called by 1khz timer process.
-// We use this to throttle read down to 20hz
-uint8_t AP_OpticalFlow::_num_calls;
 
 bool AP_OpticalFlow::init()
 {
@@ -33,19 +30,14 @@ void AP_OpticalFlow::set_orientation(enum Rotation rotation)
     _orientation = rotation;
 }
 
-// parent method called at 1khz by periodic process
-// this is slowed down to 20hz and each instance's update function is called
+// parent method called at 20hz by periodic process
+// each instance's update function is called
 // (only one instance is supported at the moment)
 void AP_OpticalFlow::read(uint32_t now)
 {
-    _num_calls++;
-
-    if( _num_calls >= AP_OPTICALFLOW_NUM_CALLS_FOR_20HZ ) {
-        _num_calls = 0;
-        // call to update all attached sensors
-        if( _sensor != NULL ) {
-            _sensor->update(now);
-        }
+    // call to update all attached sensors
+    if( _sensor != NULL ) {
+        _sensor->update(now);
     }
 };
 
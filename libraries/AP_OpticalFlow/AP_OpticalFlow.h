@@ -96,11 +96,6 @@ protected:
     // rotate raw values to arrive at final x,y,dx and dy values
     virtual void apply_orientation_matrix();
     virtual void update_conversion_factors();
-
-private:
-    // number of times we have been called by 1khz timer process.
-    // We use this to throttle read down to 20hz
-    static uint8_t _num_calls;
 };
 
 #include "AP_OpticalFlow_ADNS3080.h"
@@ -83,9 +83,11 @@ AP_OpticalFlow_ADNS3080::init()
 
 finish:
     // if device is working register the global static read function to
-    // be called at 1khz
+    // be called at 20hz
     if( retvalue ) {
-        hal.scheduler->register_timer_process( AP_OpticalFlow_ADNS3080::read );
+        hal.scheduler->register_timer_process( AP_OpticalFlow_ADNS3080::read,
+                                               AP_OPTICALFLOW_NUM_CALLS_FOR_20HZ,
+                                               AP_HAL::Scheduler::TIMER_PRIORITY_LOW );
         _spi_sem = _spi->get_semaphore();
         if (_spi_sem == NULL) {
             hal.scheduler->panic(PSTR("PANIC: Got SPI Driver, but did not "
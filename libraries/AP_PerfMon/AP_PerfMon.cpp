@@ -1,219 +1,195 @@
-
-#include <math.h>
-#include <FastSerial.h>
-#include "Arduino.h"
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ *       AP_PerfMon.cpp - hierarchical profiler for timing zones of code
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <AP_HAL.h>
+#include <AP_HAL_Static.h>
+#include <AP_Progmem.h>
 #include "AP_PerfMon.h"
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include <stdio.h>
+#endif
+
+extern const AP_HAL::HAL& hal;
+
 // static class variable definitions
-uint8_t AP_PerfMon::nextFuncNum;
-char AP_PerfMon::functionNames[PERFMON_MAX_FUNCTIONS][PERFMON_FUNCTION_NAME_LENGTH];
-uint32_t AP_PerfMon::time[PERFMON_MAX_FUNCTIONS];
-uint32_t AP_PerfMon::maxTime[PERFMON_MAX_FUNCTIONS];
-uint32_t AP_PerfMon::numCalls[PERFMON_MAX_FUNCTIONS];
-uint32_t AP_PerfMon::allStartTime;
-uint32_t AP_PerfMon::allEndTime;
-AP_PerfMon* AP_PerfMon::lastCreated = NULL;
-bool AP_PerfMon::_enabled = true;
-
-// constructor
-AP_PerfMon::AP_PerfMon(uint8_t funcNum) : _funcNum(funcNum), _time_this_iteration(0)
+AP_PerfMon *AP_PerfMon::_current;
+AP_PerfMon::ZoneStats AP_PerfMon::_stats[AP_PERFMON_MAX_ZONES];
+uint8_t AP_PerfMon::_num_zones;
+uint32_t AP_PerfMon::_clear_time_us;
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+static FILE *trace_file;
+static uint32_t trace_events_left;
+static bool trace_first_event;
+#endif
+
+// enter the zone, becoming a child of the running zone
+void AP_PerfMon::_enter()
 {
-    // exit immediately if we are disabled
-    if( !_enabled ) {
-        return;
-    }
+    _child_time_us = 0;
+    _parent = _current;
+    _current = this;
 
-    // check global start time
-    if( allStartTime == 0 ) {
-        allStartTime = micros();
+    ZoneStats &stats = _stats[_zone];
+    if (stats.num_calls == 0 && stats.parent == AP_PERFMON_NO_ZONE && _parent != NULL) {
+        stats.parent = _parent->_zone;
     }
 
-    // stop recording time from parent
-    _parent = lastCreated;  // add pointer to parent
-	if( _parent != NULL ) {
-        _parent->stop();
-    }
-
-    // record myself as the last created instance
-    lastCreated = this;
-
-    numCalls[_funcNum]++;   // record that this function has been called
-    start();  				// start recording time spent in this function
+    // take the time last, so the bookkeeping above is not counted
+    _start_time_us = hal_static::micros();
 }
 
-// destructor
-AP_PerfMon::~AP_PerfMon()
+// leave the zone, adding its time to its statistics and its parent's
+void AP_PerfMon::_leave()
 {
-    // exit immediately if we are disabled
-    if( !_enabled ) {
-        return;
-    }
+    uint32_t time_taken = hal_static::micros() - _start_time_us;
 
-    stop();   // stop recording time spent in this function
-    lastCreated = _parent;  // make my parent the last created instance
+    ZoneStats &stats = _stats[_zone];
+    stats.num_calls++;
+    stats.total_time_us += time_taken;
+    if (time_taken > _child_time_us) {
+        stats.self_time_us += time_taken - _child_time_us;
+    }
+    if (time_taken > stats.max_time_us) {
+        stats.max_time_us = time_taken > 0xFFFF ? 0xFFFF : time_taken;
+    }
 
-    // calculate max time spent in this function
-    if( _time_this_iteration > maxTime[_funcNum] ) {
-        maxTime[_funcNum] = _time_this_iteration;
+    _current = _parent;
+    if (_parent != NULL) {
+        _parent->_child_time_us += time_taken;
     }
 
-    // restart recording time for parent
-    if( _parent != NULL )
-        _parent->start();
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    if (trace_file != NULL) {
+        char name[AP_PERFMON_NAME_LENGTH+1];
+        zone_name(_zone, name);
+        fprintf(trace_file,
+                "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu,\"pid\":1,\"tid\":1}",
+                trace_first_event ? "" : ",\n",
+                name, (unsigned long)_start_time_us, (unsigned long)time_taken);
+        trace_first_event = false;
+        if (--trace_events_left == 0) {
+            trace_stop();
+        }
+    }
+#endif
 }
 
-// record function name in static list
-uint8_t AP_PerfMon::recordFunctionName(const char funcName[])
+// register a zone
+uint8_t AP_PerfMon::register_zone(const prog_char_t *name)
 {
-    uint8_t nextNum = nextFuncNum++;
-    uint8_t i;
-
-    // clear existing function name (if any)
-    functionNames[nextNum][0] = 0;
-
-    // store function name
-    for( i=0; i<PERFMON_FUNCTION_NAME_LENGTH-1 && funcName[i] != 0; i++ ) {
-        functionNames[nextNum][i] = funcName[i];
+    if (_num_zones >= AP_PERFMON_MAX_ZONES) {
+        return AP_PERFMON_NO_ZONE;
     }
-    functionNames[nextNum][i] = 0;
-
-    return nextNum;
+    if (_num_zones == 0) {
+        _clear_time_us = hal_static::micros();
+    }
+    ZoneStats &stats = _stats[_num_zones];
+    memset(&stats, 0, sizeof(stats));
+    stats.name = name;
+    stats.parent = AP_PERFMON_NO_ZONE;
+    return _num_zones++;
 }
 
-// stop recording time
-void AP_PerfMon::start()
+// copy out a zone's name
+void AP_PerfMon::zone_name(uint8_t zone, char *name)
 {
-    _startTime = micros();  // start recording time spent in this function
+    strncpy_P(name, _stats[zone].name, AP_PERFMON_NAME_LENGTH);
+    name[AP_PERFMON_NAME_LENGTH] = 0;
 }
 
-// stop recording time
-void AP_PerfMon::stop()
+// time since the statistics were cleared
+uint32_t AP_PerfMon::elapsed_us()
 {
-    uint32_t temp_time = micros()-_startTime;
-    _time_this_iteration += temp_time;
-    time[_funcNum] += temp_time;
+    return hal_static::micros() - _clear_time_us;
 }
 
-// ClearAll - clears all data from static members
-void AP_PerfMon::ClearAll()
+// clear the statistics of all zones. The tree of zones is kept
+void AP_PerfMon::clear()
 {
-    uint8_t i;
-    AP_PerfMon *p = lastCreated;
-
-    for(i=0; i<PERFMON_MAX_FUNCTIONS; i++) {
-        time[i] = 0;        // reset times
-        numCalls[i] = 0;    // reset num times called
-        maxTime[i] = 0;     // reset maximum time
-    }
-
-    // reset start time to now
-    allStartTime = micros();
-    allEndTime = 0;
-
-    // reset start times of any active counters
-    while( p != NULL ) {
-        p->_startTime = allStartTime;
-        p = p->_parent;
+    for (uint8_t i=0; i<_num_zones; i++) {
+        ZoneStats &stats = _stats[i];
+        stats.max_time_us = 0;
+        stats.num_calls = 0;
+        stats.total_time_us = 0;
+        stats.self_time_us = 0;
     }
+    _clear_time_us = hal_static::micros();
 }
 
-// DisplayResults - displays table of timing results
-void AP_PerfMon::DisplayResults()
+// print a table of results, children indented under their parents
+void AP_PerfMon::print(AP_HAL::BetterStream *port)
 {
-    uint8_t i,j,changed;
-    float hz;
-    float pct;
-    uint32_t totalTime;
-    uint32_t avgTime;
-    uint32_t sumOfTime = 0;
-    uint32_t unExplainedTime;
-    uint8_t order[PERFMON_MAX_FUNCTIONS];
-    bool blocking_writes;
-
-    // record end time
-    if( allEndTime == 0 ) {
-        allEndTime = micros();
+    uint32_t elapsed = elapsed_us();
+    if (elapsed == 0) {
+        elapsed = 1;
     }
 
-    // turn off any time recording
-    if( lastCreated != NULL ) {
-        lastCreated->stop();
-    }
-    _enabled = false;
-
-    // reorder results
-    for(i=0; i<nextFuncNum; i++) {
-        order[i] = i;
-    }
-    changed=0;
-    do{
-        changed = 0;
-        for(i=0; i<nextFuncNum-1; i++)
-            if(time[order[i]]<time[order[i+1]]) {
-                j = order[i];
-                order[i] = order[i+1];
-                order[i+1] = j;
-                changed = 1;
-            }
-	}while(changed != 0);
-
-    // calculate time elapsed
-    totalTime = allEndTime - allStartTime;
-
-    // ensure serial is blocking
-    blocking_writes = Serial.get_blocking_writes();
-    Serial.set_blocking_writes(true);
-    Serial.printf_P(PSTR("blocking was:%d\n"),(int)blocking_writes);
-
-    // print table of results
-    Serial.printf_P(PSTR("\nPerfMon elapsed:%lu(ms)\n"),(unsigned long)totalTime/1000);
-    Serial.printf_P(PSTR("Fn:\t\tcpu\ttot(ms)\tavg(ms)\tmax(ms)\t#calls\tHz\n"));
-    for( i=0; i<nextFuncNum; i++ ) {
-        j=order[i];
-        sumOfTime += time[j];
-
-        // calculate average execution time
-        if( numCalls[j] > 0 ) {
-            avgTime = time[j] / numCalls[j];
-        }else{
-            avgTime = 0;
+    port->printf_P(PSTR("PerfMon elapsed %lums\n"), (unsigned long)(elapsed/1000));
+    port->printf_P(PSTR("zone          self%%  total(ms)  self(ms)  mean(us)  max(us)  calls\n"));
+    for (uint8_t i=0; i<_num_zones; i++) {
+        const ZoneStats &stats = _stats[i];
+        char name[AP_PERFMON_NAME_LENGTH+1];
+        zone_name(i, name);
+
+        // indent children under their parents
+        uint8_t depth = 0;
+        for (uint8_t p = stats.parent; p != AP_PERFMON_NO_ZONE && depth < _num_zones; p = _stats[p].parent) {
+            depth++;
         }
-
-        hz = numCalls[j]/(totalTime/1000000);
-        pct = ((float)time[j] / (float)totalTime) * 100.0;
-        Serial.printf_P(PSTR("%-10s\t%4.2f\t%lu\t%4.3f\t%4.3f\t%lu\t%4.1f\n"),
-            functionNames[j],
-            pct,
-            (unsigned long)time[j]/1000,
-            (float)avgTime/1000.0,
-            (float)maxTime[j]/1000.0,
-            numCalls[j],
-            hz);
-    }
-    // display unexplained time
-    if( sumOfTime >= totalTime ) {
-        unExplainedTime = 0;
-    } else {
-        unExplainedTime = totalTime - sumOfTime;
+        uint8_t width = strlen(name) + depth;
+        for (uint8_t d=0; d<depth; d++) {
+            port->printf_P(PSTR(" "));
+        }
+        port->printf_P(PSTR("%s"), name);
+        while (width++ < AP_PERFMON_NAME_LENGTH + 3) {
+            port->printf_P(PSTR(" "));
+        }
+        port->printf_P(PSTR(" %5.1f %10lu %9lu %9lu %8u %6lu\n"),
+                       100.0f * stats.self_time_us / elapsed,
+                       (unsigned long)(stats.total_time_us/1000),
+                       (unsigned long)(stats.self_time_us/1000),
+                       (unsigned long)(stats.num_calls ? stats.total_time_us / stats.num_calls : 0),
+                       (unsigned)stats.max_time_us,
+                       (unsigned long)stats.num_calls);
     }
-    pct = ((float)unExplainedTime / (float)totalTime) * 100.0;
-    Serial.printf_P(PSTR("unexpl:\t\t%4.2f\t%lu\n"),pct,(unsigned long)unExplainedTime/1000);
-
-    // restore to blocking writes if necessary
-    Serial.set_blocking_writes(blocking_writes);
+}
 
-    // turn back on any time recording
-    if( lastCreated != NULL ) {
-        lastCreated->start();
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+// start writing a Chrome trace. The closing bracket of the event array
+// is optional in the format, so a trace that is never stopped can still
+// be loaded
+bool AP_PerfMon::trace_start(const char *filename, uint32_t max_events)
+{
+    trace_stop();
+    if (max_events == 0) {
+        return false;
     }
-    _enabled = true;
+    trace_file = fopen(filename, "w");
+    if (trace_file == NULL) {
+        return false;
+    }
+    fprintf(trace_file, "[\n");
+    trace_events_left = max_events;
+    trace_first_event = true;
+    return true;
 }
 
-// DisplayAndClear - will display results after this many milliseconds.  should be called regularly
-void AP_PerfMon::DisplayAndClear(uint32_t display_after_seconds)
+// finish the trace
+void AP_PerfMon::trace_stop()
 {
-    if( (micros() - allStartTime) > (uint32_t)(display_after_seconds * 1000000) ) {
-        DisplayResults();
-        ClearAll();
+    if (trace_file != NULL) {
+        fprintf(trace_file, "\n]\n");
+        fclose(trace_file);
+        trace_file = NULL;
     }
-}
\ No newline at end of file
+}
+#endif
@@ -1,48 +1,132 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ *       AP_PerfMon.h - hierarchical profiler for timing zones of code
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ */
+
 #ifndef AP_PERFMON_H
 #define AP_PERFMON_H
 
-// macros to make integrating into code easier
-#define AP_PERFMON_REGISTER static uint8_t myFunc = AP_PerfMon::recordFunctionName(__func__); AP_PerfMon perfMon(myFunc);
-#define AP_PERFMON_REGISTER_NAME(functionName) static uint8_t myFunc = AP_PerfMon::recordFunctionName(functionName); AP_PerfMon perfMon(myFunc);
+#include <AP_Common.h>
+#include <AP_Progmem.h>
+#include <AP_HAL.h>
+
+/*
+  A zone is a block of code that is timed each time it runs. A zone is
+  declared at the top of the block with
 
-#define PERFMON_MAX_FUNCTIONS 11
-#define PERFMON_FUNCTION_NAME_LENGTH 10
+      AP_PERFMON_REGISTER_NAME("fast_loop")
 
-#include <AP_Common.h>
-#include "HardwareSerial.h"
+  which registers the zone the first time the block runs and times the
+  block from there until the end of the enclosing scope. Zone names are
+  kept in flash, and are cut to AP_PERFMON_NAME_LENGTH characters when
+  sent over MAVLink or logged.
+
+  Zones nest: a zone entered while another is running is its child. For
+  every zone the profiler keeps the total time spent in it including its
+  children, the time spent in it less its children ("self" time), the
+  number of calls, the longest call and the zone it was first entered
+  from, so the zones form a tree of where the time goes.
+
+  There are no locks and nothing is done with interrupts disabled.
+  Entering and leaving zones is strictly last in first out and each
+  zone's statistics are only written when that zone is left, so a
+  reader in the main loop always sees whole calls. Zones are meant for
+  main loop code; timer processes should not use them.
+
+  On SITL each call can also be written to a file in the Chrome trace
+  event format, which chrome://tracing shows as a timeline.
+ */
+
+// the most zones that can be registered. Further zones are not timed
+#define AP_PERFMON_MAX_ZONES 16
+
+// zone names are cut to this length when sent or logged
+#define AP_PERFMON_NAME_LENGTH 10
+
+// zone id of a zone that could not be registered, and the parent of
+// zones entered from outside any other zone
+#define AP_PERFMON_NO_ZONE 0xFF
+
+#define AP_PERFMON_REGISTER_NAME(zoneName) \
+    static uint8_t perfmon_zone_id = AP_PerfMon::register_zone(PSTR(zoneName)); \
+    AP_PerfMon perfmon_zone(perfmon_zone_id);
 
 class AP_PerfMon
 {
-    public:
-		// static methods
-        static uint8_t recordFunctionName(const char funcName[]);
-        static void DisplayResults();
-		static void ClearAll();
-        static void DisplayAndClear(uint32_t display_after_seconds);  // will display results after this many milliseconds.  should be called regularly
-
-		// public methods
-		AP_PerfMon(uint8_t funcNum);    // Constructor - records function start time
-		~AP_PerfMon();                  // Destructor - records function end time
-		void stop();                    // stops recording time spent in this function - meant to be called by a child.
-		void start();                   // restarts recording time spent in this function
-
-    private:
-        // static variables
-        static uint8_t nextFuncNum;
-		static char functionNames[PERFMON_MAX_FUNCTIONS][PERFMON_FUNCTION_NAME_LENGTH];
-        static uint32_t time[PERFMON_MAX_FUNCTIONS];
-		static uint32_t numCalls[PERFMON_MAX_FUNCTIONS];
-        static uint32_t maxTime[PERFMON_MAX_FUNCTIONS];
-		static uint32_t allStartTime;
-		static uint32_t allEndTime;
-		static AP_PerfMon* lastCreated;
-        static bool _enabled;
-
-        // instance variables
-        uint8_t _funcNum;
-        unsigned long _startTime;
-        unsigned long _time_this_iteration;
-		AP_PerfMon* _parent;
+public:
+    struct ZoneStats {
+        const prog_char_t *name;
+        uint8_t  parent;            // zone this one was first entered from
+        uint16_t max_time_us;       // longest call, including children
+        uint32_t num_calls;
+        uint32_t total_time_us;     // time in the zone, including children
+        uint32_t self_time_us;      // time in the zone, less its children
+    };
+
+    // constructor - enters the zone
+    AP_PerfMon(uint8_t zone) : _zone(zone) {
+        if (zone != AP_PERFMON_NO_ZONE) {
+            _enter();
+        }
+    }
+
+    // destructor - leaves the zone
+    ~AP_PerfMon() {
+        if (_zone != AP_PERFMON_NO_ZONE) {
+            _leave();
+        }
+    }
+
+    // register_zone - add a zone, returning its id. Returns
+    // AP_PERFMON_NO_ZONE if the table is full
+    static uint8_t register_zone(const prog_char_t *name);
+
+    // num_zones - number of zones registered so far
+    static uint8_t num_zones() { return _num_zones; }
+
+    // zone_stats - statistics of a zone since the last clear()
+    static const ZoneStats &zone_stats(uint8_t zone) { return _stats[zone]; }
+
+    // zone_name - copy a zone's name into name, which must hold
+    // AP_PERFMON_NAME_LENGTH+1 characters
+    static void zone_name(uint8_t zone, char *name);
+
+    // elapsed_us - time since the last clear()
+    static uint32_t elapsed_us();
+
+    // clear - restart the statistics of all zones
+    static void clear();
+
+    // print - show a table of the statistics of all zones
+    static void print(AP_HAL::BetterStream *port);
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    // trace_start - write every call of every zone to filename as Chrome
+    // trace events, stopping after max_events calls
+    static bool trace_start(const char *filename, uint32_t max_events);
+
+    // trace_stop - finish the trace file
+    static void trace_stop();
+#endif
+
+private:
+    void _enter();
+    void _leave();
+
+    uint8_t _zone;
+    AP_PerfMon *_parent;            // zone running when this one was entered
+    uint32_t _start_time_us;
+    uint32_t _child_time_us;        // time spent in children so far
+
+    static AP_PerfMon *_current;    // innermost running zone
+    static ZoneStats _stats[AP_PERFMON_MAX_ZONES];
+    static uint8_t _num_zones;
+    static uint32_t _clear_time_us;
 };
 
-#endif  // AP_PERFMON_H
\ No newline at end of file
+#endif  // AP_PERFMON_H
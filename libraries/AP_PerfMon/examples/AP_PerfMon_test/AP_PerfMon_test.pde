@@ -0,0 +1,60 @@
+/*
+  AP_PerfMon
+  Code by Randy Mackay
+*/
+
+#include <AP_Common.h>
+#include <AP_Progmem.h>
+#include <AP_Param.h>
+#include <AP_Math.h>
+#include <AP_HAL.h>
+#include <AP_HAL_AVR.h>
+#include <AP_HAL_AVR_SITL.h>
+#include <AP_HAL_Empty.h>
+#include <AP_PerfMon.h>        // PerfMonitor library
+
+const AP_HAL::HAL& hal = AP_HAL_BOARD_DRIVER;
+
+void setup()
+{
+    AP_PERFMON_REGISTER_NAME("setupA")
+
+    hal.console->println_P(PSTR("Performance Monitor test v2.0"));
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+    // open perfmon_trace.json in chrome://tracing to see the calls
+    AP_PerfMon::trace_start("perfmon_trace.json", 1000);
+#endif
+}
+
+void testFn2()
+{
+    AP_PERFMON_REGISTER_NAME("testFn2")
+    hal.scheduler->delay_microseconds(500);
+}
+
+void testFn()
+{
+    AP_PERFMON_REGISTER_NAME("testFn")
+    hal.scheduler->delay_microseconds(1000);
+    testFn2();
+}
+
+void loop()
+{
+    {
+        AP_PERFMON_REGISTER_NAME("loop")
+
+        for (uint8_t i=0; i<10; i++) {
+            testFn();
+        }
+        testFn2();
+    }
+
+    AP_PerfMon::print(hal.console);
+    AP_PerfMon::clear();
+
+    hal.scheduler->delay(1000);
+}
+
+AP_HAL_MAIN();
@@ -1,3 +1,30 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 3; indent-tabs-mode: t -*-
+/*
+ *       AP_RangeFinder_SharpGP2Y.h - Arduino Library for Sharpe GP2Y0A02YK0F
+ *       infrared proximity sensor
+ *       Code by Jose Julio and Randy Mackay. DIYDrones.com
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *       Sensor should be conected to one of the analog ports
+ *
+ *       Sparkfun URL: http://www.sparkfun.com/products/8958
+ *       datasheet: http://www.sparkfun.com/datasheets/Sensors/Infrared/gp2y0a02yk_e.pdf
+ *
+ *       Variables:
+ *               int raw_value : raw value from the sensor
+ *               int distance : distance in cm
+ *               int max_distance : maximum measurable distance (in cm)
+ *               int min_distance : minimum measurable distance (in cm)
+ *
+ *       Methods:
+ *               read() : read value from analog port
+ *
+ */
+
 #ifndef __AP_RangeFinder_SharpGP2Y_H__
 #define __AP_RangeFinder_SharpGP2Y_H__
 
@@ -6,17 +33,25 @@
 #define AP_RANGEFINDER_SHARPEGP2Y_MIN_DISTANCE 20
 #define AP_RANGEFINDER_SHARPEGP2Y_MAX_DISTANCE 150
 
-class AP_RangeFinder_SharpGP2Y : public RangeFinder
+template <class F>
+class AP_RangeFinder_SharpGP2Y_Filtered : public RangeFinder<F>
 {
 public:
-    AP_RangeFinder_SharpGP2Y(AP_HAL::AnalogSource *source, FilterInt16 *filter);
+    AP_RangeFinder_SharpGP2Y_Filtered(AP_HAL::AnalogSource *source, F *filter) :
+        RangeFinder<F>(source, filter)
+    {
+        this->max_distance = AP_RANGEFINDER_SHARPEGP2Y_MAX_DISTANCE;
+        this->min_distance = AP_RANGEFINDER_SHARPEGP2Y_MIN_DISTANCE;
+    }
     int  convert_raw_to_distance(int _raw_value) {
         if( _raw_value == 0 ) {
-            return max_distance;
+            return this->max_distance;
         } else {
             return 14500/_raw_value;
         }
     }       // read value from analog port and return distance in cm
 
 };
+
+typedef AP_RangeFinder_SharpGP2Y_Filtered<ModeFilterInt16_Size5> AP_RangeFinder_SharpGP2Y;
 #endif
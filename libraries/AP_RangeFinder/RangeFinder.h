@@ -1,3 +1,17 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 3; indent-tabs-mode: t -*-
+/*
+ *       RangeFinder.h - Arduino Library for Sharpe GP2Y0A02YK0F
+ *       infrared proximity sensor
+ *       Code by Jose Julio and Randy Mackay. DIYDrones.com
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *       This has the basic functions that all RangeFinders need implemented
+ */
+
 #ifndef __RANGEFINDER_H__
 #define __RANGEFINDER_H__
 
@@ -18,10 +32,16 @@
  * #define AP_RANGEFINDER_ORIENTATION_FRONT_LEFT      5,  5,  0
  */
 
+// RangeFinder is a template on the type of the filter the distances are
+// passed through, so read() calls the filter directly. Any filter with an
+// int16_t apply(int16_t) method can be used, such as a ModeFilter of any
+// size. The drivers are templates too, with typedefs for the usual 5
+// sample mode filter
+template <class F>
 class RangeFinder
 {
 protected:
-    RangeFinder(AP_HAL::AnalogSource * source, FilterInt16 *filter) :
+    RangeFinder(AP_HAL::AnalogSource * source, F *filter) :
         _analog_source(source),
         _mode_filter(filter) {
     }
@@ -36,7 +56,11 @@ public:
     int  min_distance;
 
     int  orientation_x, orientation_y, orientation_z;
-    void set_orientation(int x, int y, int z);
+    void set_orientation(int x, int y, int z) {
+        orientation_x = x;
+        orientation_y = y;
+        orientation_z = z;
+    }
 
     /**
      * convert_raw_to_distance:
@@ -53,6 +77,23 @@ public:
     virtual int read();
 
     AP_HAL::AnalogSource*       _analog_source;
-    FilterInt16 *           _mode_filter;
+    F *                         _mode_filter;
 };
+
+// Read Sensor data - only the raw_value is filled in by this parent class
+template <class F>
+int RangeFinder<F>::read()
+{
+    int temp_dist;
+
+    raw_value = _analog_source->read_average();
+    // convert analog value to distance in cm (using child implementation most likely)
+    temp_dist = convert_raw_to_distance(raw_value);
+
+    // ensure distance is within min and max
+    temp_dist = constrain(temp_dist, min_distance, max_distance);
+
+    distance = _mode_filter->apply(temp_dist);
+    return distance;
+}
 #endif // __RANGEFINDER_H__
@@ -0,0 +1,203 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ *       AP_Scheduler.cpp - main loop task scheduler
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <AP_HAL.h>
+#include <AP_HAL_Static.h>
+#include <AP_Progmem.h>
+#include "AP_Scheduler.h"
+
+extern const AP_HAL::HAL& hal;
+
+// initialise the scheduler
+void AP_Scheduler::init(const AP_Scheduler::Task *tasks, uint8_t num_tasks, bool stagger)
+{
+    _tasks = tasks;
+    _num_tasks = num_tasks;
+    _last_run = new uint16_t[_num_tasks];
+    memset(_last_run, 0, sizeof(_last_run[0]) * _num_tasks);
+    if (stagger) {
+        for (uint8_t i=0; i<_num_tasks; i++) {
+            // the phase is the number of earlier tasks with the same
+            // interval, and the task is first due on that tick
+            uint16_t interval = pgm_read_word(&_tasks[i].interval_ticks);
+            uint16_t phase = 0;
+            for (uint8_t j=0; j<i; j++) {
+                if (pgm_read_word(&_tasks[j].interval_ticks) == interval) {
+                    phase++;
+                }
+            }
+            _last_run[i] = (phase % interval) - interval;
+        }
+    }
+    _stats = new TaskStats[_num_tasks];
+    _due = new DueTask[_num_tasks];
+    _histograms = NULL;
+    reset_stats();
+    _tick_counter = 0;
+}
+
+// one tick has passed
+void AP_Scheduler::tick(void)
+{
+    // anything still due was not run in the tick that is ending
+    for (uint8_t i=0; i<_num_tasks; i++) {
+        uint16_t ticks_since_run, interval;
+        if (_is_due(i, ticks_since_run, interval) && _stats[i].num_skipped < 0xFFFF) {
+            _stats[i].num_skipped++;
+        }
+    }
+    _tick_counter++;
+}
+
+// true if task i is due to run
+bool AP_Scheduler::_is_due(uint8_t i, uint16_t &ticks_since_run, uint16_t &interval) const
+{
+    // Make sure to use 16-bit arithmetic here for this comparison
+    // to handle the rollover case.  Due to C integer promotion
+    // rules, we have to force the type of the difference here to
+    // "uint16_t" or the compiler will do a 32-bit comparison on a
+    // 32-bit platform.
+    ticks_since_run = _tick_counter - _last_run[i];
+    interval = pgm_read_word(&_tasks[i].interval_ticks);
+    return ticks_since_run >= interval;
+}
+
+/*
+  run as many scheduler tasks as we can in the specified time (in microseconds)
+ */
+void AP_Scheduler::run(uint16_t time_available)
+{
+    uint8_t num_due = 0;
+
+    // list the tasks that are due, most overdue relative to their
+    // interval first. Lateness is compared as ticks_since_run/interval
+    // by cross multiplying, and the insertion is stable so equally late
+    // tasks stay in table order
+    for (uint8_t i=0; i<_num_tasks; i++) {
+        uint16_t ticks_since_run, interval;
+        if (!_is_due(i, ticks_since_run, interval)) {
+            continue;
+        }
+        uint8_t j = num_due++;
+        while (j > 0) {
+            const struct DueTask &other = _due[j-1];
+            if ((uint32_t)ticks_since_run * other.interval <=
+                (uint32_t)other.ticks_since_run * interval) {
+                break;
+            }
+            _due[j] = other;
+            j--;
+        }
+        _due[j].task = i;
+        _due[j].ticks_since_run = ticks_since_run;
+        _due[j].interval = interval;
+    }
+
+    for (uint8_t d=0; d<num_due; d++) {
+        uint8_t i = _due[d].task;
+        uint16_t late_ticks = _due[d].ticks_since_run - _due[d].interval;
+
+        // do we have enough time to run it? If not then skip it, a
+        // shorter task later in the list may still fit. A task that has
+        // been skipped for a whole interval is run anyway
+        _task_time_allowed = pgm_read_word(&_tasks[i].max_time_micros);
+        if (_task_time_allowed > time_available &&
+            late_ticks < _due[d].interval) {
+            continue;
+        }
+
+        TaskStats &stats = _stats[i];
+        if (late_ticks > stats.max_late_ticks) {
+            stats.max_late_ticks = late_ticks;
+        }
+
+        // run it
+        _task_time_started = hal_static::micros();
+        task_fn_t func = (task_fn_t)pgm_read_pointer(&_tasks[i].function);
+        func();
+
+        // record the tick counter when we ran. This drives
+        // when we next run the task
+        _last_run[i] = _tick_counter;
+
+        // work out how long the task actually took
+        uint32_t time_taken = hal_static::micros() - _task_time_started;
+
+        // the counts stop when they are full, which keeps the
+        // mean correct if the stats are not reset often
+        if (stats.num_calls < 0xFFFF) {
+            stats.num_calls++;
+            stats.total_time_micros += time_taken;
+        }
+        if (time_taken > stats.max_time_micros) {
+            stats.max_time_micros = time_taken > 0xFFFF ? 0xFFFF : time_taken;
+        }
+        if (_histograms != NULL) {
+            _histograms[i].add(time_taken);
+        }
+        if (time_taken > _task_time_allowed && stats.num_overruns < 0xFFFF) {
+            // the task overran!
+            stats.num_overruns++;
+        }
+
+        if (time_taken >= time_available) {
+            // no time left, only overdue tasks will be run
+            time_available = 0;
+        } else {
+            time_available -= time_taken;
+        }
+    }
+}
+
+/*
+  return number of micros until the current task reaches its deadline
+ */
+uint16_t AP_Scheduler::time_available_usec(void)
+{
+    uint32_t dt = hal_static::micros() - _task_time_started;
+    if (dt > _task_time_allowed) {
+        return 0;
+    }
+    return _task_time_allowed - dt;
+}
+
+// average time taken by a task
+uint16_t AP_Scheduler::task_mean_time_micros(uint8_t i) const
+{
+    if (_stats[i].num_calls == 0) {
+        return 0;
+    }
+    return _stats[i].total_time_micros / _stats[i].num_calls;
+}
+
+// the time budget of a task
+uint16_t AP_Scheduler::task_max_time_allowed(uint8_t i) const
+{
+    return pgm_read_word(&_tasks[i].max_time_micros);
+}
+
+// start keeping a histogram of the time each task takes
+void AP_Scheduler::enable_histograms(void)
+{
+    if (_histograms == NULL) {
+        _histograms = new TaskHistogram[_num_tasks];
+    }
+}
+
+// clear the timing of all tasks
+void AP_Scheduler::reset_stats(void)
+{
+    memset(_stats, 0, sizeof(_stats[0]) * _num_tasks);
+    if (_histograms != NULL) {
+        for (uint8_t i=0; i<_num_tasks; i++) {
+            _histograms[i].clear();
+        }
+    }
+}
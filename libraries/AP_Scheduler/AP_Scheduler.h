@@ -0,0 +1,151 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ *       AP_Scheduler.h - main loop task scheduler
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ */
+
+#ifndef __AP_SCHEDULER_H__
+#define __AP_SCHEDULER_H__
+
+#include <AP_Common.h>
+#include <AP_HAL.h>
+#include "LogHistogram.h"
+
+/*
+  A task scheduler for the main loop of a vehicle.
+
+  The sketch provides a table of tasks in PROGMEM, each with how often it
+  should run (in main loop ticks) and the longest it is expected to take
+  (in microseconds). Once per main loop the sketch calls tick() and then
+  run() with the time left before the next loop is due.
+
+  Tasks that are due are run in order of how late they are relative to
+  their interval, with ties going to the one earlier in the table. A task
+  whose expected time does not fit in the time that is left is skipped
+  and the later ones are still tried, so one long task can not starve
+  all the tasks after it. Once a task has been skipped for a whole
+  interval, so it is due twice over, it is run whether or not it fits.
+  No task goes more than twice its interval without running, at the
+  cost of that loop running long.
+
+  The time each task takes, and how often it was due but not run, is
+  recorded so the sketch can report how every task is coping. The
+  sketch can also ask for a histogram of the time each task takes, which
+  costs 16 bytes of memory per task.
+ */
+class AP_Scheduler
+{
+public:
+    typedef void (*task_fn_t)(void);
+
+    struct Task {
+        task_fn_t function;
+        uint16_t interval_ticks;        // must be at least 1
+        uint16_t max_time_micros;
+    };
+
+    // timing of one task since the last reset_stats()
+    struct TaskStats {
+        uint16_t num_calls;
+        uint16_t num_overruns;          // calls that took longer than max_time_micros
+        uint16_t num_skipped;           // ticks when the task was due but was not run
+        uint16_t max_late_ticks;        // most ticks the task has been run after it was due
+        uint16_t max_time_micros;
+        uint32_t total_time_micros;
+    };
+
+    // histogram of the time a task takes, with buckets below 64
+    // microseconds, then from 64, 128, 256 and so on up to 4096 and over
+    typedef LogHistogram<8,6,0> TaskHistogram;
+
+    // initialise the scheduler with a table of tasks in PROGMEM. With
+    // stagger set, tasks that share an interval are first due on
+    // successive ticks in table order, so they don't all fall due on
+    // the same tick
+    void        init(const Task *tasks, uint8_t num_tasks, bool stagger = false);
+
+    // tick - call once per main loop
+    void        tick(void);
+
+    // run - run the tasks that are due and fit in time_available
+    // microseconds, most overdue first. Tasks a whole interval overdue
+    // are run even if they do not fit. A task that was already run since
+    // it last became due is not run again, so this can be called more
+    // than once per tick
+    void        run(uint16_t time_available);
+
+    // time_available_usec - microseconds left before the running task
+    // reaches its max_time_micros
+    uint16_t    time_available_usec(void);
+
+    // ticks - number of ticks since the scheduler was initialised
+    uint16_t    ticks(void) const { return _tick_counter; }
+
+    // num_tasks - number of tasks in the table
+    uint8_t     num_tasks(void) const { return _num_tasks; }
+
+    // task_stats - timing of a task since the last reset_stats()
+    const TaskStats &task_stats(uint8_t i) const { return _stats[i]; }
+
+    // task_mean_time_micros - average time taken by a task
+    uint16_t    task_mean_time_micros(uint8_t i) const;
+
+    // task_max_time_allowed - the max_time_micros of a task from the table
+    uint16_t    task_max_time_allowed(uint8_t i) const;
+
+    // enable_histograms - keep a histogram of the time each task takes.
+    // Call after init()
+    void        enable_histograms(void);
+
+    // task_histogram - histogram of the time taken by a task since the
+    // last reset_stats(), or NULL if histograms are not enabled
+    const TaskHistogram *task_histogram(uint8_t i) const {
+        return _histograms != NULL ? &_histograms[i] : NULL;
+    }
+
+    // reset_stats - clear the timing of all tasks
+    void        reset_stats(void);
+
+private:
+    // _is_due - true if task i is due to run, setting how many ticks it
+    // has been since it last ran and its interval
+    bool        _is_due(uint8_t i, uint16_t &ticks_since_run, uint16_t &interval) const;
+
+    // the task table, in PROGMEM
+    const struct Task *_tasks;
+    uint8_t     _num_tasks;
+
+    // number of ticks that have passed
+    uint16_t    _tick_counter;
+
+    // tick counter at the time we last ran each task
+    uint16_t    *_last_run;
+
+    // timing of each task
+    TaskStats   *_stats;
+
+    // time histogram of each task, if enabled
+    TaskHistogram *_histograms;
+
+    // a task that is due, with its timing as run() found it
+    struct DueTask {
+        uint8_t  task;
+        uint16_t ticks_since_run;
+        uint16_t interval;
+    };
+
+    // tasks that are due in the order they will be tried, used by run()
+    struct DueTask *_due;
+
+    // number of microseconds allowed for the current task
+    uint16_t    _task_time_allowed;
+
+    // the time in microseconds when the task started
+    uint32_t    _task_time_started;
+};
+
+#endif // __AP_SCHEDULER_H__
@@ -0,0 +1,122 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ *       LogHistogram.h - fixed bucket log scale histogram of times
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ */
+
+#ifndef __LOG_HISTOGRAM_H__
+#define __LOG_HISTOGRAM_H__
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+  A histogram with buckets on a log scale, cheap enough to add a sample
+  to on every main loop.
+
+  Bucket 0 holds values below 2^MIN_BITS. Above that every power of two
+  is split into 2^SUB_BITS buckets of equal width, so the resolution is
+  always a fixed fraction of the value. The last bucket also holds
+  everything larger than it. For example LogHistogram<24,10,2> has
+  bucket 0 below 1024, then buckets starting at 1024, 1280, 1536, 1792,
+  2048, 2560 and so on up to a last bucket from 49152 upwards.
+
+  Counts stop at 65535 rather than wrapping.
+ */
+
+// the type of MAVLink DATA packets holding a packed histogram
+#define DATAMSG_TYPE_HISTOGRAM 0xFD
+
+// bytes before the counts in a packed histogram
+#define LOG_HISTOGRAM_HEADER_LENGTH 4
+
+// log_histogram_lower_bound - the smallest value counted in bucket i of
+// a histogram with the given MIN_BITS and SUB_BITS, for reading packed
+// histograms
+static inline uint32_t log_histogram_lower_bound(uint8_t i, uint8_t min_bits, uint8_t sub_bits)
+{
+    if (i == 0) {
+        return 0;
+    }
+    uint8_t e = min_bits + ((i-1) >> sub_bits);
+    uint32_t sub = (i-1) & ((1U << sub_bits) - 1);
+    return (1UL << e) + (sub << (e - sub_bits));
+}
+
+template <uint8_t NUM_BUCKETS, uint8_t MIN_BITS, uint8_t SUB_BITS>
+class LogHistogram
+{
+public:
+    LogHistogram() { clear(); }
+
+    // add - count one sample
+    void add(uint32_t value) {
+        uint8_t i = bucket(value);
+        if (_count[i] < 0xFFFF) {
+            _count[i]++;
+        }
+    }
+
+    // bucket - the bucket a value falls in
+    static uint8_t bucket(uint32_t value) {
+        if (value < (1UL << MIN_BITS)) {
+            return 0;
+        }
+        uint8_t e = MIN_BITS;
+        while (e < 31 && (value >> (e+1)) != 0) {
+            e++;
+        }
+        uint32_t i = 1 + ((uint32_t)(e - MIN_BITS) << SUB_BITS) +
+            ((value >> (e - SUB_BITS)) & ((1U << SUB_BITS) - 1));
+        return i < NUM_BUCKETS ? i : NUM_BUCKETS - 1;
+    }
+
+    // bucket_lower_bound - the smallest value counted in bucket i
+    static uint32_t bucket_lower_bound(uint8_t i) {
+        return log_histogram_lower_bound(i, MIN_BITS, SUB_BITS);
+    }
+
+    static uint8_t num_buckets() { return NUM_BUCKETS; }
+
+    uint16_t count(uint8_t i) const { return _count[i]; }
+
+    // total - number of samples, up to 65535
+    uint16_t total() const {
+        uint32_t sum = 0;
+        for (uint8_t i=0; i<NUM_BUCKETS; i++) {
+            sum += _count[i];
+        }
+        return sum > 0xFFFF ? 0xFFFF : sum;
+    }
+
+    void clear() { memset(_count, 0, sizeof(_count)); }
+
+    // pack - write the histogram into buf as an id byte, the number of
+    // buckets, MIN_BITS and SUB_BITS, followed by the counts as 16 bit
+    // little endian values. Returns the number of bytes written, or 0
+    // if buf is too short
+    uint8_t pack(uint8_t id, uint8_t *buf, uint8_t buflen) const {
+        uint8_t len = LOG_HISTOGRAM_HEADER_LENGTH + NUM_BUCKETS*2;
+        if (buflen < len) {
+            return 0;
+        }
+        buf[0] = id;
+        buf[1] = NUM_BUCKETS;
+        buf[2] = MIN_BITS;
+        buf[3] = SUB_BITS;
+        for (uint8_t i=0; i<NUM_BUCKETS; i++) {
+            buf[LOG_HISTOGRAM_HEADER_LENGTH+i*2]   = _count[i] & 0xFF;
+            buf[LOG_HISTOGRAM_HEADER_LENGTH+i*2+1] = _count[i] >> 8;
+        }
+        return len;
+    }
+
+private:
+    uint16_t _count[NUM_BUCKETS];
+};
+
+#endif // __LOG_HISTOGRAM_H__
@@ -0,0 +1,97 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+/*
+ *       Example of AP_Scheduler library: runs a few tasks of different
+ *       lengths at different rates from a 100Hz main loop and prints how
+ *       long each one takes.
+ */
+
+#include <AP_Common.h>
+#include <AP_Progmem.h>
+#include <AP_Param.h>
+#include <AP_Math.h>
+#include <AP_HAL.h>
+#include <AP_HAL_AVR.h>
+#include <AP_Scheduler.h>
+
+const AP_HAL::HAL& hal = AP_HAL_BOARD_DRIVER;
+
+#define MAIN_LOOP_MICROS 10000
+
+static AP_Scheduler scheduler;
+static uint32_t loop_start_micros;
+
+static void ten_hz_task(void)
+{
+    hal.scheduler->delay_microseconds(1000);
+}
+
+static void busy_task(void)
+{
+    hal.scheduler->delay_microseconds(3000);
+}
+
+static void one_hz_task(void)
+{
+    hal.console->printf_P(PSTR("ticks=%u\n"), (unsigned)scheduler.ticks());
+}
+
+static void report_task(void)
+{
+    for (uint8_t i=0; i<scheduler.num_tasks(); i++) {
+        const AP_Scheduler::TaskStats &stats = scheduler.task_stats(i);
+        hal.console->printf_P(PSTR("task %u calls=%u mean=%u max=%u/%u overruns=%u skipped=%u late=%u\n"),
+                              (unsigned)i,
+                              (unsigned)stats.num_calls,
+                              (unsigned)scheduler.task_mean_time_micros(i),
+                              (unsigned)stats.max_time_micros,
+                              (unsigned)scheduler.task_max_time_allowed(i),
+                              (unsigned)stats.num_overruns,
+                              (unsigned)stats.num_skipped,
+                              (unsigned)stats.max_late_ticks);
+        const AP_Scheduler::TaskHistogram *hist = scheduler.task_histogram(i);
+        for (uint8_t b=0; b<hist->num_buckets(); b++) {
+            hal.console->printf_P(PSTR(" %lu:%u"),
+                                  (unsigned long)hist->bucket_lower_bound(b),
+                                  (unsigned)hist->count(b));
+        }
+        hal.console->println();
+    }
+    scheduler.reset_stats();
+}
+
+/*
+  scheduler table - how often each task should run (in 10ms ticks) and
+  the maximum time it is expected to take in microseconds
+ */
+static const AP_Scheduler::Task scheduler_tasks[] PROGMEM = {
+    { ten_hz_task,     10,  1100 },
+    { busy_task,        2,  2500 },
+    { one_hz_task,    100,  2000 },
+    { report_task,    500,  5000 }
+};
+
+void setup(void)
+{
+    hal.console->println_P(PSTR("AP_Scheduler test"));
+    scheduler.init(&scheduler_tasks[0], sizeof(scheduler_tasks)/sizeof(scheduler_tasks[0]));
+    scheduler.enable_histograms();
+    loop_start_micros = hal.scheduler->micros();
+}
+
+void loop(void)
+{
+    // wait for the start of the next 100Hz loop
+    while (hal.scheduler->micros() - loop_start_micros < MAIN_LOOP_MICROS) {
+        hal.scheduler->delay_microseconds(100);
+    }
+    loop_start_micros += MAIN_LOOP_MICROS;
+
+    scheduler.tick();
+
+    // give the tasks whatever is left of this loop
+    uint32_t elapsed = hal.scheduler->micros() - loop_start_micros;
+    scheduler.run(elapsed < MAIN_LOOP_MICROS ? MAIN_LOOP_MICROS - elapsed : 0);
+}
+
+AP_HAL_MAIN();
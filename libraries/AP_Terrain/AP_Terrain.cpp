@@ -0,0 +1,446 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ *       AP_Terrain.cpp - terrain height database with a cache of decoded tiles
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <string.h>
+#include "AP_Terrain.h"
+
+#ifdef TERRAIN_DIRECTORY
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+extern const AP_HAL::HAL& hal;
+
+// the start of a tile file, followed by the length and the CRC of the
+// compressed tile
+#define TERRAIN_FILE_MAGIC  0x5254
+#define TERRAIN_FILE_HEADER 6
+
+const AP_Param::GroupInfo AP_Terrain::var_info[] PROGMEM = {
+    // @Param: ENABLE
+    // @DisplayName: Enable terrain
+    // @Description: Setting this to Enabled(1) makes the terrain heights available to navigation and the limits, and asks the ground station for the terrain tiles that are not in storage
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("ENABLE", 0, AP_Terrain, _enable, 1),
+
+    AP_GROUPEND
+};
+
+AP_Terrain::AP_Terrain() :
+    _use_count(0),
+    _wanted(false),
+    _missing(false),
+    _have_home(false),
+    _home_valid(false),
+    _home_height(0),
+    _upload_len(0),
+    _upload_received(0),
+    _upload_unsaved(false)
+{
+    AP_Param::setup_object_defaults(this, var_info);
+    for (uint8_t i=0; i<TERRAIN_CACHE_SIZE; i++) {
+        _cache[i].valid = false;
+    }
+}
+
+uint16_t AP_Terrain::encode(const int16_t height[TERRAIN_GRID_SIZE][TERRAIN_GRID_SIZE],
+                            uint8_t *buf)
+{
+    uint16_t n = 0;
+    buf[n++] = height[0][0] & 0xFF;
+    buf[n++] = (uint16_t)height[0][0] >> 8;
+    for (uint8_t i=0; i<TERRAIN_GRID_SIZE; i++) {
+        for (uint8_t j=0; j<TERRAIN_GRID_SIZE; j++) {
+            if (i == 0 && j == 0) {
+                continue;
+            }
+            int16_t prev = (j == 0) ? height[i-1][0] : height[i][j-1];
+            int32_t diff = (int32_t)height[i][j] - prev;
+            if (diff >= -127 && diff <= 127) {
+                buf[n++] = (uint8_t)(int8_t)diff;
+            } else {
+                buf[n++] = 0x80;
+                buf[n++] = height[i][j] & 0xFF;
+                buf[n++] = (uint16_t)height[i][j] >> 8;
+            }
+        }
+    }
+    return n;
+}
+
+bool AP_Terrain::decode(const uint8_t *buf, uint16_t len,
+                        int16_t height[TERRAIN_GRID_SIZE][TERRAIN_GRID_SIZE])
+{
+    if (len < 2) {
+        return false;
+    }
+    height[0][0] = (int16_t)(buf[0] | (buf[1] << 8));
+    uint16_t n = 2;
+    for (uint8_t i=0; i<TERRAIN_GRID_SIZE; i++) {
+        for (uint8_t j=0; j<TERRAIN_GRID_SIZE; j++) {
+            if (i == 0 && j == 0) {
+                continue;
+            }
+            if (n >= len) {
+                return false;
+            }
+            uint8_t b = buf[n++];
+            if (b == 0x80) {
+                if (n + 2 > len) {
+                    return false;
+                }
+                height[i][j] = (int16_t)(buf[n] | (buf[n+1] << 8));
+                n += 2;
+            } else {
+                int16_t prev = (j == 0) ? height[i-1][0] : height[i][j-1];
+                height[i][j] = prev + (int8_t)b;
+            }
+        }
+    }
+    return n == len;
+}
+
+// _check - whether buf holds exactly one tile, so that decode() will
+// succeed. Any heights are valid, so this is only the length
+bool AP_Terrain::_check(const uint8_t *buf, uint16_t len)
+{
+    uint16_t n = 2;
+    for (uint16_t i=1; i<TERRAIN_GRID_SIZE*TERRAIN_GRID_SIZE; i++) {
+        if (n >= len) {
+            return false;
+        }
+        n += (buf[n] == 0x80) ? 3 : 1;
+    }
+    return n == len;
+}
+
+// CRC-16-CCITT
+uint16_t AP_Terrain::_crc16(const uint8_t *buf, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc ^= (uint16_t)(*buf++) << 8;
+        for (uint8_t i=0; i<8; i++) {
+            if (crc & 0x8000) {
+                crc = (crc << 1) ^ 0x1021;
+            } else {
+                crc <<= 1;
+            }
+        }
+    }
+    return crc;
+}
+
+// _tile_index - the tile holding loc, and the position of loc in it in
+// 1e-7 degrees from its south west corner
+bool AP_Terrain::_tile_index(const struct Location &loc,
+                             uint16_t &lat_index, uint16_t &lng_index,
+                             uint32_t &lat_offset, uint32_t &lng_offset)
+{
+    if (loc.lat < -900000000L || loc.lat > 900000000L ||
+        loc.lng < -1800000000L || loc.lng > 1800000000L) {
+        return false;
+    }
+    // unsigned, as the longitude does not fit in an int32_t once it is
+    // made positive
+    uint32_t lat = (uint32_t)loc.lat + 900000000UL;
+    uint32_t lng = (uint32_t)loc.lng + 1800000000UL;
+    lat_index  = lat / TERRAIN_TILE_SPAN;
+    lng_index  = lng / TERRAIN_TILE_SPAN;
+    lat_offset = lat - lat_index * TERRAIN_TILE_SPAN;
+    lng_offset = lng - lng_index * TERRAIN_TILE_SPAN;
+    return true;
+}
+
+struct AP_Terrain::Tile *AP_Terrain::_find(uint16_t lat_index, uint16_t lng_index)
+{
+    for (uint8_t i=0; i<TERRAIN_CACHE_SIZE; i++) {
+        if (_cache[i].valid &&
+            _cache[i].lat_index == lat_index &&
+            _cache[i].lng_index == lng_index) {
+            return &_cache[i];
+        }
+    }
+    return NULL;
+}
+
+// _replace - the cache entry to decode a tile into: the entry already
+// holding it, an empty one or the least recently used. The entry is
+// left invalid
+struct AP_Terrain::Tile *AP_Terrain::_replace(uint16_t lat_index, uint16_t lng_index)
+{
+    struct Tile *tile = _find(lat_index, lng_index);
+    if (tile == NULL) {
+        tile = &_cache[0];
+        for (uint8_t i=0; i<TERRAIN_CACHE_SIZE; i++) {
+            if (!_cache[i].valid) {
+                tile = &_cache[i];
+                break;
+            }
+            if (_cache[i].last_used < tile->last_used) {
+                tile = &_cache[i];
+            }
+        }
+    }
+    tile->valid = false;
+    tile->lat_index = lat_index;
+    tile->lng_index = lng_index;
+    return tile;
+}
+
+bool AP_Terrain::_load(uint16_t lat_index, uint16_t lng_index)
+{
+#ifdef TERRAIN_DIRECTORY
+    char name[48];
+    snprintf(name, sizeof(name), TERRAIN_DIRECTORY "/T%05u_%05u.DAT",
+             (unsigned)lat_index, (unsigned)lng_index);
+    FILE *f = fopen(name, "rb");
+    if (f != NULL) {
+        uint8_t header[TERRAIN_FILE_HEADER];
+        bool ok = false;
+        if (fread(header, 1, sizeof(header), f) == sizeof(header)) {
+            uint16_t magic = header[0] | (header[1] << 8);
+            uint16_t len   = header[2] | (header[3] << 8);
+            uint16_t crc   = header[4] | (header[5] << 8);
+            ok = (magic == TERRAIN_FILE_MAGIC &&
+                  len <= TERRAIN_TILE_MAX_BYTES &&
+                  fread(_read_buf, 1, len, f) == len &&
+                  crc == _crc16(_read_buf, len) &&
+                  _check(_read_buf, len));
+            if (ok) {
+                struct Tile *tile = _replace(lat_index, lng_index);
+                tile->valid = decode(_read_buf, len, tile->height);
+                tile->last_used = ++_use_count;
+            }
+        }
+        fclose(f);
+        if (ok) {
+            if (_missing && _missing_lat == lat_index && _missing_lng == lng_index) {
+                _missing = false;
+            }
+            return true;
+        }
+    }
+#endif
+    // not in storage, or damaged. Ask the ground station for it
+    _missing = true;
+    _missing_lat = lat_index;
+    _missing_lng = lng_index;
+    return false;
+}
+
+void AP_Terrain::_save(uint16_t lat_index, uint16_t lng_index,
+                       const uint8_t *buf, uint16_t len)
+{
+#ifdef TERRAIN_DIRECTORY
+    char name[48];
+    mkdir(TERRAIN_DIRECTORY, 0755);
+    snprintf(name, sizeof(name), TERRAIN_DIRECTORY "/T%05u_%05u.DAT",
+             (unsigned)lat_index, (unsigned)lng_index);
+    FILE *f = fopen(name, "wb");
+    if (f == NULL) {
+        return;
+    }
+    uint16_t crc = _crc16(buf, len);
+    uint8_t header[TERRAIN_FILE_HEADER] = {
+        TERRAIN_FILE_MAGIC & 0xFF, TERRAIN_FILE_MAGIC >> 8,
+        (uint8_t)(len & 0xFF), (uint8_t)(len >> 8),
+        (uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8)
+    };
+    fwrite(header, 1, sizeof(header), f);
+    fwrite(buf, 1, len, f);
+    fclose(f);
+#endif
+}
+
+bool AP_Terrain::height_amsl(const struct Location &loc, float &height)
+{
+    if (!_enable) {
+        return false;
+    }
+
+    uint16_t lat_index, lng_index;
+    uint32_t lat_offset, lng_offset;
+    if (!_tile_index(loc, lat_index, lng_index, lat_offset, lng_offset)) {
+        return false;
+    }
+
+    struct Tile *tile = _find(lat_index, lng_index);
+    if (tile == NULL) {
+        _wanted = true;
+        _wanted_lat = lat_index;
+        _wanted_lng = lng_index;
+        return false;
+    }
+    tile->last_used = ++_use_count;
+
+    // the grid square holding loc. x runs north and y east
+    uint8_t x = lat_offset / TERRAIN_GRID_SPACING;
+    uint8_t y = lng_offset / TERRAIN_GRID_SPACING;
+    float fx = (lat_offset - x * (uint32_t)TERRAIN_GRID_SPACING) * (1.0f / TERRAIN_GRID_SPACING);
+    float fy = (lng_offset - y * (uint32_t)TERRAIN_GRID_SPACING) * (1.0f / TERRAIN_GRID_SPACING);
+
+    float h0 = tile->height[x][y]   + (tile->height[x][y+1]   - tile->height[x][y])   * fy;
+    float h1 = tile->height[x+1][y] + (tile->height[x+1][y+1] - tile->height[x+1][y]) * fy;
+    height = h0 + (h1 - h0) * fx;
+    return true;
+}
+
+void AP_Terrain::set_home(const struct Location &home)
+{
+    if (_have_home && home.lat == _home.lat && home.lng == _home.lng) {
+        return;
+    }
+    _home = home;
+    _have_home = true;
+    _home_valid = height_amsl(_home, _home_height);
+}
+
+bool AP_Terrain::height_relative_home(const struct Location &loc, float &height)
+{
+    if (!_home_valid || !height_amsl(loc, height)) {
+        return false;
+    }
+    height -= _home_height;
+    return true;
+}
+
+void AP_Terrain::update(const struct Location &loc)
+{
+    if (!_enable) {
+        return;
+    }
+
+    if (_upload_unsaved) {
+        _save(_upload_lat, _upload_lng, _upload, _upload_len);
+        _upload_unsaved = false;
+        _upload_len = 0;
+        return;
+    }
+
+    // the tiles to have cached, most important first: home's, the one a
+    // lookup missed, the one under the vehicle and the three next to
+    // the corner of it the vehicle is nearest
+    uint16_t lat[TERRAIN_CACHE_SIZE+1], lng[TERRAIN_CACHE_SIZE+1];
+    uint8_t count = 0;
+    uint16_t lat_index, lng_index;
+    uint32_t lat_offset, lng_offset;
+    if (_have_home && !_home_valid &&
+        _tile_index(_home, lat_index, lng_index, lat_offset, lng_offset)) {
+        lat[count] = lat_index;
+        lng[count] = lng_index;
+        count++;
+    }
+    if (_wanted) {
+        lat[count] = _wanted_lat;
+        lng[count] = _wanted_lng;
+        count++;
+        _wanted = false;
+    }
+    if (_tile_index(loc, lat_index, lng_index, lat_offset, lng_offset)) {
+        uint16_t lat_next = (lat_offset < TERRAIN_TILE_SPAN/2 && lat_index > 0) ? lat_index - 1 : lat_index + 1;
+        uint16_t lng_next = (lng_offset < TERRAIN_TILE_SPAN/2 && lng_index > 0) ? lng_index - 1 : lng_index + 1;
+        const uint16_t around[4][2] = {
+            { lat_index, lng_index },
+            { lat_next,  lng_index },
+            { lat_index, lng_next },
+            { lat_next,  lng_next }
+        };
+        for (uint8_t i=0; i<4 && count<TERRAIN_CACHE_SIZE; i++) {
+            bool listed = false;
+            for (uint8_t j=0; j<count; j++) {
+                if (lat[j] == around[i][0] && lng[j] == around[i][1]) {
+                    listed = true;
+                }
+            }
+            if (listed) {
+                continue;
+            }
+            lat[count] = around[i][0];
+            lng[count] = around[i][1];
+            count++;
+        }
+    }
+
+    for (uint8_t i=0; i<count; i++) {
+        struct Tile *tile = _find(lat[i], lng[i]);
+        if (tile != NULL) {
+            // keep it from being the one replaced
+            tile->last_used = ++_use_count;
+            continue;
+        }
+        // one file read on each call, whether or not the tile is there
+        _load(lat[i], lng[i]);
+        break;
+    }
+
+    if (_have_home && !_home_valid) {
+        _home_valid = height_amsl(_home, _home_height);
+    }
+}
+
+bool AP_Terrain::missing_tile(uint16_t &lat_index, uint16_t &lng_index)
+{
+    if (!_enable || !_missing) {
+        return false;
+    }
+    lat_index = _missing_lat;
+    lng_index = _missing_lng;
+    return true;
+}
+
+void AP_Terrain::handle_tile_data(const uint8_t *data, uint8_t len)
+{
+    if (!_enable || len < TERRAIN_CHUNK_HEADER) {
+        return;
+    }
+    uint16_t lat_index = data[0] | (data[1] << 8);
+    uint16_t lng_index = data[2] | (data[3] << 8);
+    uint16_t offset    = data[4] | (data[5] << 8);
+    uint16_t total     = data[6] | (data[7] << 8);
+    uint8_t  n         = len - TERRAIN_CHUNK_HEADER;
+    if (total > TERRAIN_TILE_MAX_BYTES || offset + n > total ||
+        _upload_unsaved) {
+        return;
+    }
+
+    if (offset == 0) {
+        _upload_lat = lat_index;
+        _upload_lng = lng_index;
+        _upload_len = total;
+        _upload_received = 0;
+    } else if (_upload_len == 0 ||
+               lat_index != _upload_lat || lng_index != _upload_lng ||
+               total != _upload_len || offset != _upload_received) {
+        // a chunk was lost. Wait for the tile to be sent again
+        _upload_len = 0;
+        return;
+    }
+    memcpy(&_upload[offset], &data[TERRAIN_CHUNK_HEADER], n);
+    _upload_received += n;
+    if (_upload_received < _upload_len) {
+        return;
+    }
+
+    // a damaged tile must not push a good one out of the cache
+    if (!_check(_upload, total)) {
+        _upload_len = 0;
+        return;
+    }
+    struct Tile *tile = _replace(lat_index, lng_index);
+    tile->valid = decode(_upload, total, tile->height);
+    tile->last_used = ++_use_count;
+    _upload_unsaved = true;
+    if (_missing && _missing_lat == lat_index && _missing_lng == lng_index) {
+        _missing = false;
+    }
+}
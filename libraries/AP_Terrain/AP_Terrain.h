@@ -0,0 +1,187 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+ *       AP_Terrain.h - terrain height database with a cache of decoded tiles
+ *
+ *       This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ */
+
+#ifndef __AP_TERRAIN_H__
+#define __AP_TERRAIN_H__
+
+#include <AP_Common.h>
+#include <AP_Param.h>
+#include <AP_HAL.h>
+
+/*
+  The terrain heights are held on a grid of points TERRAIN_GRID_SPACING
+  apart in latitude and longitude, in whole meters above sea level. The
+  grid is cut into tiles of TERRAIN_GRID_SIZE by TERRAIN_GRID_SIZE
+  points. Neighbouring tiles share their edge row and column, so the
+  four grid points around any location are always in one tile and a
+  lookup needs only that tile.
+
+  A tile is stored compressed, like the AP_Declination tables: the
+  height of the first point as a 16 bit value, then each other point as
+  a one byte difference from the point before it in its row, or from the
+  first point of the row before for the first point of a row. A
+  difference that does not fit in a byte is sent as the escape byte
+  0x80 followed by the 16 bit height.
+
+  Tiles are kept one per file in TERRAIN_DIRECTORY, on the boards that
+  have a filesystem. Decoded tiles are held in a cache of
+  TERRAIN_CACHE_SIZE, so a lookup in a cached tile is a search of the
+  few cache entries and a bilinear interpolation. A lookup in a tile
+  that is not cached fails and the tile is read by the next update(),
+  which also reads the tiles around the vehicle ahead of time. Only
+  update() touches storage, as a file access can take tens of
+  milliseconds, so a vehicle looks up the places it is going to need,
+  such as the next waypoint, from its update task ahead of time.
+
+  Tiles not in storage are asked for from the ground station, with a
+  DATA16 message of type TERRAIN_DATA_REQUEST holding the 16 bit
+  latitude and longitude tile indexes. The ground station answers with
+  the compressed tile in DATA96 messages of type TERRAIN_DATA_TILE, each
+  holding the tile indexes, the offset of the chunk in the tile, the
+  tile length, all 16 bit, and up to 88 bytes of the tile. A complete
+  tile that decodes is put in the cache and written to storage by the
+  next update(). Chunks that come before then are ignored, and the
+  ground station sends them again when they are next asked for.
+  Tools/autotest/terrain_server.py is a stand in for a tile server.
+
+  All 16 bit values are little endian.
+ */
+
+// grid points on each side of a tile
+#define TERRAIN_GRID_SIZE       16
+
+// distance between the grid points, in 1e-7 degrees. 9000 is about
+// 100m of latitude
+#define TERRAIN_GRID_SPACING    9000
+
+// the latitude and longitude covered by a tile. The edges are shared
+#define TERRAIN_TILE_SPAN       ((TERRAIN_GRID_SIZE-1) * (uint32_t)TERRAIN_GRID_SPACING)
+
+// the largest compressed tile, where every difference is escaped
+#define TERRAIN_TILE_MAX_BYTES  (2 + 3*(TERRAIN_GRID_SIZE*TERRAIN_GRID_SIZE-1))
+
+// bytes in front of the chunk in a DATA96 tile message
+#define TERRAIN_CHUNK_HEADER    8
+
+// the DATA16 and DATA96 message types
+#define TERRAIN_DATA_REQUEST    0x54
+#define TERRAIN_DATA_TILE       0x55
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_APM1 || CONFIG_HAL_BOARD == HAL_BOARD_APM2
+ # define TERRAIN_CACHE_SIZE    2
+#else
+ # define TERRAIN_CACHE_SIZE    4
+#endif
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+ # define TERRAIN_DIRECTORY     "terrain"
+#elif CONFIG_HAL_BOARD == HAL_BOARD_PX4
+ # define TERRAIN_DIRECTORY     "/fs/microsd/terrain"
+#endif
+
+class AP_Terrain
+{
+public:
+    AP_Terrain();
+
+    // height_amsl - the terrain height at loc in meters above sea
+    // level, interpolated between the grid points. Returns false if the
+    // tile is not cached, and the next update() reads it
+    bool height_amsl(const struct Location &loc, float &height);
+
+    // height_relative_home - the terrain height at loc in meters above
+    // the terrain at home, for vehicles that fly relative to home
+    bool height_relative_home(const struct Location &loc, float &height);
+
+    // set_home - the location height_relative_home() is measured from
+    void set_home(const struct Location &home);
+
+    // update - write an uploaded tile to storage, or else read the
+    // tile of home, a tile that a lookup missed or the tiles around the
+    // vehicle. At most one file is written or read on each call. Call
+    // at 1Hz
+    void update(const struct Location &loc);
+
+    // missing_tile - the last tile that was not in storage, to be asked
+    // for from the ground station
+    bool missing_tile(uint16_t &lat_index, uint16_t &lng_index);
+
+    // handle_tile_data - the data of a DATA96 message of type
+    // TERRAIN_DATA_TILE
+    void handle_tile_data(const uint8_t *data, uint8_t len);
+
+    bool enabled() { return _enable != 0; }
+
+    // encode - compress a tile into buf, which must hold
+    // TERRAIN_TILE_MAX_BYTES. Returns the length
+    static uint16_t encode(const int16_t height[TERRAIN_GRID_SIZE][TERRAIN_GRID_SIZE],
+                           uint8_t *buf);
+
+    // decode - uncompress a tile. Returns false unless buf holds exactly
+    // one tile
+    static bool decode(const uint8_t *buf, uint16_t len,
+                       int16_t height[TERRAIN_GRID_SIZE][TERRAIN_GRID_SIZE]);
+
+    static const struct AP_Param::GroupInfo var_info[];
+
+private:
+    struct Tile {
+        bool     valid;
+        uint16_t lat_index;
+        uint16_t lng_index;
+        uint32_t last_used;
+        int16_t  height[TERRAIN_GRID_SIZE][TERRAIN_GRID_SIZE];
+    };
+
+    static bool         _tile_index(const struct Location &loc,
+                                    uint16_t &lat_index, uint16_t &lng_index,
+                                    uint32_t &lat_offset, uint32_t &lng_offset);
+    struct Tile *       _find(uint16_t lat_index, uint16_t lng_index);
+    struct Tile *       _replace(uint16_t lat_index, uint16_t lng_index);
+    bool                _load(uint16_t lat_index, uint16_t lng_index);
+    void                _save(uint16_t lat_index, uint16_t lng_index,
+                              const uint8_t *buf, uint16_t len);
+    static bool         _check(const uint8_t *buf, uint16_t len);
+    static uint16_t     _crc16(const uint8_t *buf, uint16_t len);
+
+    AP_Int8             _enable;
+
+    struct Tile         _cache[TERRAIN_CACHE_SIZE];
+    uint32_t            _use_count;
+
+    // the tile of the last lookup that missed the cache
+    bool                _wanted;
+    uint16_t            _wanted_lat;
+    uint16_t            _wanted_lng;
+
+    // the last tile that was not in storage
+    bool                _missing;
+    uint16_t            _missing_lat;
+    uint16_t            _missing_lng;
+
+    // the home location and the terrain height there
+    struct Location     _home;
+    bool                _have_home;
+    bool                _home_valid;
+    float               _home_height;
+
+    // the tile being uploaded
+    uint8_t             _upload[TERRAIN_TILE_MAX_BYTES];
+    uint16_t            _upload_lat;
+    uint16_t            _upload_lng;
+    uint16_t            _upload_len;
+    uint16_t            _upload_received;
+    bool                _upload_unsaved;
+
+    // a compressed tile read from storage
+    uint8_t             _read_buf[TERRAIN_TILE_MAX_BYTES];
+};
+
+#endif // __AP_TERRAIN_H__
@@ -0,0 +1,201 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+//
+// Tests for the AP_Terrain library: tile compression, upload, lookups
+// and the cache
+//
+
+#include <AP_Common.h>
+#include <AP_Progmem.h>
+#include <AP_Param.h>
+#include <AP_Math.h>
+#include <AP_Terrain.h>
+#include <AP_HAL.h>
+#include <AP_HAL_AVR.h>
+#include <AP_HAL_AVR_SITL.h>
+#include <AP_HAL_Empty.h>
+
+const AP_HAL::HAL& hal = AP_HAL_BOARD_DRIVER;
+
+static AP_Terrain terrain;
+
+// a made up terrain, with a cliff every fifth row to need the escaped
+// heights
+static int16_t grid_height(uint32_t row, uint32_t col)
+{
+    int16_t h = 500 + (row * 7 + col * 3) % 300;
+    if (row % 5 == 0) {
+        h += 400;
+    }
+    return h;
+}
+
+static void make_tile(uint16_t lat_index, uint16_t lng_index,
+                      int16_t height[TERRAIN_GRID_SIZE][TERRAIN_GRID_SIZE])
+{
+    for (uint8_t i=0; i<TERRAIN_GRID_SIZE; i++) {
+        for (uint8_t j=0; j<TERRAIN_GRID_SIZE; j++) {
+            height[i][j] = grid_height(lat_index * (uint32_t)(TERRAIN_GRID_SIZE-1) + i,
+                                       lng_index * (uint32_t)(TERRAIN_GRID_SIZE-1) + j);
+        }
+    }
+}
+
+// upload - send a tile to the library the way the ground station does
+static void upload(uint16_t lat_index, uint16_t lng_index)
+{
+    int16_t height[TERRAIN_GRID_SIZE][TERRAIN_GRID_SIZE];
+    uint8_t tile[TERRAIN_TILE_MAX_BYTES];
+    make_tile(lat_index, lng_index, height);
+    uint16_t len = AP_Terrain::encode(height, tile);
+
+    for (uint16_t offset=0; offset<len; offset += 96 - TERRAIN_CHUNK_HEADER) {
+        uint8_t data[96];
+        uint8_t n = min(len - offset, 96 - TERRAIN_CHUNK_HEADER);
+        data[0] = lat_index & 0xFF;
+        data[1] = lat_index >> 8;
+        data[2] = lng_index & 0xFF;
+        data[3] = lng_index >> 8;
+        data[4] = offset & 0xFF;
+        data[5] = offset >> 8;
+        data[6] = len & 0xFF;
+        data[7] = len >> 8;
+        memcpy(&data[TERRAIN_CHUNK_HEADER], &tile[offset], n);
+        terrain.handle_tile_data(data, n + TERRAIN_CHUNK_HEADER);
+    }
+
+    // the tile is written to storage by the next update
+    struct Location loc;
+    memset(&loc, 0, sizeof(loc));
+    terrain.update(loc);
+}
+
+// location - a point in the grid, in grid spacings from the south west
+// corner of tile 0,0
+static struct Location location(float row, float col)
+{
+    struct Location loc;
+    memset(&loc, 0, sizeof(loc));
+    loc.lat = -900000000L + (int32_t)(row * (double)TERRAIN_GRID_SPACING);
+    loc.lng = (int32_t)((uint32_t)(col * (double)TERRAIN_GRID_SPACING) - 1800000000UL);
+    return loc;
+}
+
+static float expected_height(float row, float col)
+{
+    uint32_t r = row, c = col;
+    float fr = row - r, fc = col - c;
+    float h0 = grid_height(r, c)   + (grid_height(r, c+1)   - grid_height(r, c))   * fc;
+    float h1 = grid_height(r+1, c) + (grid_height(r+1, c+1) - grid_height(r+1, c)) * fc;
+    return h0 + (h1 - h0) * fr;
+}
+
+void setup(void)
+{
+    uint16_t fail = 0;
+    hal.console->print("AP_Terrain test\n");
+
+    // compression round trip
+    int16_t height[TERRAIN_GRID_SIZE][TERRAIN_GRID_SIZE];
+    int16_t decoded[TERRAIN_GRID_SIZE][TERRAIN_GRID_SIZE];
+    uint8_t tile[TERRAIN_TILE_MAX_BYTES];
+    make_tile(6000, 12000, height);
+    height[3][4] = -32768;
+    height[3][5] = 32767;
+    uint16_t len = AP_Terrain::encode(height, tile);
+    if (!AP_Terrain::decode(tile, len, decoded) ||
+        memcmp(height, decoded, sizeof(height)) != 0) {
+        hal.console->print("FAIL: round trip\n");
+        fail++;
+    }
+    if (AP_Terrain::decode(tile, len - 1, decoded)) {
+        hal.console->print("FAIL: short tile decoded\n");
+        fail++;
+    }
+    hal.console->printf("Tile: %u bytes compressed, %u decoded\n",
+                        (unsigned)len, (unsigned)sizeof(height));
+
+    // lookups over the middle of tile 6000,12000 and its neighbours
+    float row0 = 6000 * (TERRAIN_GRID_SIZE-1);
+    float col0 = 12000 * (TERRAIN_GRID_SIZE-1);
+    for (uint16_t lat_index=6000; lat_index<6002; lat_index++) {
+        for (uint16_t lng_index=12000; lng_index<12002; lng_index++) {
+            upload(lat_index, lng_index);
+        }
+    }
+    uint16_t checked = 0;
+    for (float row=row0+0.3f; row<row0+2*(TERRAIN_GRID_SIZE-1); row += 0.77f) {
+        for (float col=col0+0.1f; col<col0+2*(TERRAIN_GRID_SIZE-1); col += 0.53f) {
+            float h;
+            if (!terrain.height_amsl(location(row, col), h)) {
+                hal.console->printf("FAIL: no height at %f %f\n", row, col);
+                fail++;
+            } else if (fabs(h - expected_height(row, col)) > 0.1f) {
+                hal.console->printf("FAIL: %f %f : %f, %f\n",
+                                    row, col, h, expected_height(row, col));
+                fail++;
+            }
+            checked++;
+        }
+    }
+    hal.console->printf("Checked %u lookups\n", (unsigned)checked);
+
+    // a tile that does not decode is dropped without taking the place
+    // of a cached one
+    uint8_t bad[TERRAIN_CHUNK_HEADER + 10];
+    memset(bad, 0x80, sizeof(bad));
+    bad[0] = 6002 & 0xFF; bad[1] = 6002 >> 8;
+    bad[2] = 12000 & 0xFF; bad[3] = 12000 >> 8;
+    bad[4] = 0; bad[5] = 0;
+    bad[6] = 10; bad[7] = 0;
+    terrain.handle_tile_data(bad, sizeof(bad));
+    for (uint16_t lat_index=6000; lat_index<6002; lat_index++) {
+        for (uint16_t lng_index=12000; lng_index<12002; lng_index++) {
+            float h;
+            if (!terrain.height_amsl(location(lat_index * (TERRAIN_GRID_SIZE-1) + 1.5f,
+                                              lng_index * (TERRAIN_GRID_SIZE-1) + 1.5f), h)) {
+                hal.console->print("FAIL: damaged tile evicted a good one\n");
+                fail++;
+            }
+        }
+    }
+
+    // a fifth tile pushes the least recently used one out of the
+    // cache. It is read back from storage by update()
+    upload(6002, 12000);
+    struct Location loc = location(row0 + 1.5f, col0 + 1.5f);
+    float h;
+    if (terrain.height_amsl(loc, h)) {
+        hal.console->print("FAIL: evicted tile found\n");
+        fail++;
+    }
+    terrain.update(loc);
+#ifdef TERRAIN_DIRECTORY
+    if (!terrain.height_amsl(loc, h)) {
+        hal.console->print("FAIL: tile not read from storage\n");
+        fail++;
+    }
+#else
+    uint16_t lat_index, lng_index;
+    if (!terrain.missing_tile(lat_index, lng_index) ||
+        lat_index != 6000 || lng_index != 12000) {
+        hal.console->print("FAIL: missing tile not reported\n");
+        fail++;
+    }
+#endif
+
+    // time the lookups in a cached tile
+    uint32_t t1 = hal.scheduler->micros();
+    for (uint16_t i=0; i<1000; i++) {
+        terrain.height_amsl(location(row0 + i*0.01f, col0 + i*0.01f), h);
+    }
+    uint32_t lookup_time = hal.scheduler->micros() - t1;
+    hal.console->printf("Lookup: %.2f usec per call\n", lookup_time/1000.0f);
+
+    hal.console->printf("%u failures\n", (unsigned)fail);
+}
+
+void loop(void)
+{
+}
+
+AP_HAL_MAIN();
@@ -4,7 +4,7 @@
 #ifndef __DATAFLASH_SITL_H__
 #define __DATAFLASH_SITL_H__
 
-#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 
 #include <AP_HAL.h>
 #include "DataFlash.h"
@@ -35,5 +35,5 @@ public:
     bool        CardInserted();
 };
 
-#endif // CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_AVR_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 #endif // __DATAFLASH_SITL_H__
@@ -19,18 +19,21 @@
 // 2nd parameter <U> is a larger data type used during summation to prevent overflows
 // 3rd parameter <FILTER_SIZE> is the number of elements in the filter
 template <class T, class U, uint8_t FILTER_SIZE>
-class AverageFilter : public FilterWithBuffer<T,FILTER_SIZE>
+class AverageFilter : public FilterWithBuffer<T,FILTER_SIZE,AverageFilter<T,U,FILTER_SIZE> >
 {
+    typedef FilterWithBuffer<T,FILTER_SIZE,AverageFilter<T,U,FILTER_SIZE> > Buffer;
+
 public:
     // constructor
-    AverageFilter() : FilterWithBuffer<T,FILTER_SIZE>(), _num_samples(0) {
+    AverageFilter() : Buffer(), _num_samples(0) {
     };
 
     // apply - Add a new raw value to the filter, retrieve the filtered result
-    virtual T        apply(T sample);
+    using Buffer::apply;
+    T            apply(T sample);
 
     // reset - clear the filter
-    virtual void        reset();
+    void         reset();
 
 private:
     uint8_t        _num_samples; // the number of samples in the filter, maxes out at size of the filter
@@ -74,7 +77,7 @@ T AverageFilter<T,U,FILTER_SIZE>::        apply(T sample)
     U        result = 0;
 
     // call parent's apply function to get the sample into the array
-    FilterWithBuffer<T,FILTER_SIZE>::apply(sample);
+    Buffer::apply(sample);
 
     // increment the number of samples so far
     _num_samples++;
@@ -83,7 +86,7 @@ T AverageFilter<T,U,FILTER_SIZE>::        apply(T sample)
 
     // get sum of all values - there is a risk of overflow here that we ignore
     for(uint8_t i=0; i<FILTER_SIZE; i++)
-        result += FilterWithBuffer<T,FILTER_SIZE>::samples[i];
+        result += Buffer::samples[i];
 
     return (T)(result / _num_samples);
 }
@@ -92,8 +95,8 @@ T AverageFilter<T,U,FILTER_SIZE>::        apply(T sample)
 template <class T, class U, uint8_t FILTER_SIZE>
 void AverageFilter<T,U,FILTER_SIZE>::        reset()
 {
-    // call parent's apply function to get the sample into the array
-    FilterWithBuffer<T,FILTER_SIZE>::reset();
+    // call parent's reset function to clear the array
+    Buffer::reset();
 
     // clear our variable
     _num_samples = 0;
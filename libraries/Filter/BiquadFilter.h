@@ -0,0 +1,154 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+//
+// This is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+
+/// @file	BiquadFilter.h
+/// @brief	A second order IIR (biquad) filter with low pass and notch
+///         designs computed from the cutoff and sample frequencies.
+///
+///         The coefficients follow the RBJ audio EQ cookbook and the filter
+///         runs in transposed direct form II, which needs only two state
+///         values per channel. T can be a scalar or a vector type (such as
+///         Vector3f) with element wise +, - and * float operators, in which
+///         case all channels share one set of coefficients. The arithmetic
+///         is straight line and element wise so host compilers can
+///         vectorise it across the channels.
+
+#ifndef __BIQUAD_FILTER_H__
+#define __BIQUAD_FILTER_H__
+
+#include <AP_Math.h>
+#include "FilterClass.h"
+
+// 1st parameter <T> is the type of data being filtered.
+template <class T>
+class BiquadFilter : public Filter<T, BiquadFilter<T> >
+{
+public:
+    // constructor - the filter passes samples through until a design is set
+    BiquadFilter();
+
+    // set_low_pass - second order Butterworth low pass
+    void        set_low_pass(float sample_freq, float cutoff_freq);
+
+    // set_notch - reject a band of bandwidth Hz centred on center_freq
+    void        set_notch(float sample_freq, float center_freq, float bandwidth);
+
+    // set_band_stop - reject the band between low_freq and high_freq
+    void        set_band_stop(float sample_freq, float low_freq, float high_freq);
+
+    // set_pass_through - let samples through unchanged
+    void        set_pass_through();
+
+    // apply - Add a new raw value to the filter, retrieve the filtered result
+    using Filter<T, BiquadFilter<T> >::apply;
+    T           apply(T sample) {
+        T out = sample * _b0 + _z1;
+        _z1 = sample * _b1 - out * _a1 + _z2;
+        _z2 = sample * _b2 - out * _a2;
+        return out;
+    }
+
+    // reset - clear the filter history
+    void        reset() {
+        _z1 = T();
+        _z2 = T();
+    }
+
+    // reset - settle the filter as if value had been applied forever. All
+    // the designs above have unity gain at DC
+    void        reset(T value) {
+        _z1 = value * (1.0f - _b0);
+        _z2 = value * (_b2 - _a2);
+    }
+
+private:
+    // set_coefficients - normalise by a0 and store
+    void        set_coefficients(float b0, float b1, float b2, float a0, float a1, float a2);
+
+    float       _b0, _b1, _b2;          // feed forward coefficients
+    float       _a1, _a2;               // feedback coefficients (a0 normalised to 1)
+    T           _z1, _z2;               // filter state
+};
+
+// Typedef for convenience
+typedef BiquadFilter<float> BiquadFilterFloat;
+typedef BiquadFilter<Vector3f> BiquadFilterVector3f;
+
+// Constructor    //////////////////////////////////////////////////////////////
+
+template <class T>
+BiquadFilter<T>::BiquadFilter() :
+    Filter<T, BiquadFilter<T> >()
+{
+    set_pass_through();
+    reset();
+}
+
+// Public Methods //////////////////////////////////////////////////////////////
+
+template <class T>
+void BiquadFilter<T>::set_low_pass(float sample_freq, float cutoff_freq)
+{
+    if (cutoff_freq <= 0 || cutoff_freq >= sample_freq * 0.5f) {
+        set_pass_through();
+        return;
+    }
+    float w0 = 2.0f * M_PI * cutoff_freq / sample_freq;
+    float cos_w0 = cosf(w0);
+    float alpha = sinf(w0) * 0.70710678f;   // sin(w0) / (2Q), Q = 1/sqrt(2)
+    set_coefficients((1.0f - cos_w0) * 0.5f, 1.0f - cos_w0, (1.0f - cos_w0) * 0.5f,
+                     1.0f + alpha, -2.0f * cos_w0, 1.0f - alpha);
+}
+
+template <class T>
+void BiquadFilter<T>::set_notch(float sample_freq, float center_freq, float bandwidth)
+{
+    if (center_freq <= 0 || center_freq >= sample_freq * 0.5f || bandwidth <= 0) {
+        set_pass_through();
+        return;
+    }
+    float w0 = 2.0f * M_PI * center_freq / sample_freq;
+    float cos_w0 = cosf(w0);
+    float alpha = sinf(w0) * bandwidth / (2.0f * center_freq);  // sin(w0) / (2Q), Q = f0/bw
+    set_coefficients(1.0f, -2.0f * cos_w0, 1.0f,
+                     1.0f + alpha, -2.0f * cos_w0, 1.0f - alpha);
+}
+
+template <class T>
+void BiquadFilter<T>::set_band_stop(float sample_freq, float low_freq, float high_freq)
+{
+    if (low_freq <= 0 || high_freq <= low_freq) {
+        set_pass_through();
+        return;
+    }
+    // centre on the geometric mean of the band edges
+    set_notch(sample_freq, sqrtf(low_freq * high_freq), high_freq - low_freq);
+}
+
+template <class T>
+void BiquadFilter<T>::set_pass_through()
+{
+    _b0 = 1.0f;
+    _b1 = _b2 = 0;
+    _a1 = _a2 = 0;
+}
+
+// Private Methods //////////////////////////////////////////////////////////////
+
+template <class T>
+void BiquadFilter<T>::set_coefficients(float b0, float b1, float b2, float a0, float a1, float a2)
+{
+    float inv_a0 = 1.0f / a0;
+    _b0 = b0 * inv_a0;
+    _b1 = b1 * inv_a0;
+    _b2 = b2 * inv_a0;
+    _a1 = a1 * inv_a0;
+    _a2 = a2 * inv_a0;
+}
+
+#endif // __BIQUAD_FILTER_H__
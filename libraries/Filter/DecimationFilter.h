@@ -0,0 +1,178 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+//
+// This is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+
+/// @file	DecimationFilter.h
+/// @brief	A multi-channel cascaded integrator-comb (CIC) decimation filter.
+///         Raw samples are added at a high rate and a low pass filtered
+///         output is produced once every "ratio" samples.
+///
+///         A CIC filter of order N is exactly a FIR filter with N*(ratio-1)+1
+///         taps, but it needs no multiplies and no sample buffer, so it is
+///         cheap enough to run on every sample inside a 1kHz timer process.
+///         Order 1 is the plain boxcar average, higher orders trade a little
+///         group delay (N*(ratio-1)/2 input samples) for much better
+///         rejection of noise that would otherwise alias into the output.
+
+#ifndef __DECIMATION_FILTER_H__
+#define __DECIMATION_FILTER_H__
+
+#include <inttypes.h>
+#include <string.h>
+
+// the largest gain that keeps a full scale int16_t input within the
+// int32_t output
+#define DECIMATION_FILTER_MAX_GAIN 65536UL
+
+// 1st parameter <CHANNELS> is the number of channels filtered in lock step
+// 2nd parameter <MAX_ORDER> is the highest order the filter can be configured for
+template <uint8_t CHANNELS, uint8_t MAX_ORDER>
+class DecimationFilter
+{
+public:
+    // constructor
+    DecimationFilter();
+
+    // set_ratio_and_order - configure the filter. This also resets it.
+    // The order is lowered if needed to keep the gain within
+    // DECIMATION_FILTER_MAX_GAIN
+    void        set_ratio_and_order(uint8_t ratio, uint8_t order);
+
+    // reset - clear the filter
+    void        reset();
+
+    // apply - add a new raw sample for each channel. Returns true when
+    // a new decimated output is available through output()
+    bool        apply(const int16_t sample[CHANNELS]);
+
+    // output - the latest decimated value of a channel, scaled by get_gain()
+    int32_t     output(uint8_t channel) const {
+        return _output[channel];
+    }
+
+    // get_gain - DC gain of the filter, ratio^order
+    uint32_t    get_gain() const {
+        return _gain;
+    }
+
+    // get_ratio - number of input samples per output
+    uint8_t     get_ratio() const {
+        return _ratio;
+    }
+
+    // get_order - number of integrator/comb stages in use
+    uint8_t     get_order() const {
+        return _order;
+    }
+
+    // get_delay_samples - group delay of the filter in input samples
+    float       get_delay_samples() const {
+        return _order * (_ratio - 1) * 0.5f;
+    }
+
+private:
+    static uint32_t _power(uint8_t ratio, uint8_t order) {
+        uint32_t gain = 1;
+        for (uint8_t i=0; i<order; i++) {
+            gain *= ratio;
+        }
+        return gain;
+    }
+
+    // the integrators and combs rely on modular arithmetic, so they are
+    // kept unsigned to make the wrap around well defined. Only the final
+    // output needs to fit in an int32_t
+    uint32_t    _integrator[MAX_ORDER][CHANNELS];
+    uint32_t    _comb[MAX_ORDER][CHANNELS];
+    int32_t     _output[CHANNELS];
+    uint32_t    _gain;
+    uint8_t     _ratio;
+    uint8_t     _order;
+    uint8_t     _phase;             // input samples since the last output
+    uint8_t     _warmup;            // outputs still to discard after a reset
+};
+
+// Constructor    //////////////////////////////////////////////////////////////
+
+template <uint8_t CHANNELS, uint8_t MAX_ORDER>
+DecimationFilter<CHANNELS,MAX_ORDER>::DecimationFilter()
+{
+    set_ratio_and_order(1, 1);
+}
+
+// Public Methods //////////////////////////////////////////////////////////////
+
+template <uint8_t CHANNELS, uint8_t MAX_ORDER>
+void DecimationFilter<CHANNELS,MAX_ORDER>::set_ratio_and_order(uint8_t ratio, uint8_t order)
+{
+    if (ratio == 0) {
+        ratio = 1;
+    }
+    if (order == 0) {
+        order = 1;
+    }
+    if (order > MAX_ORDER) {
+        order = MAX_ORDER;
+    }
+    while (order > 1 && _power(ratio, order) > DECIMATION_FILTER_MAX_GAIN) {
+        order--;
+    }
+    _ratio = ratio;
+    _order = order;
+    _gain = _power(ratio, order);
+    reset();
+}
+
+template <uint8_t CHANNELS, uint8_t MAX_ORDER>
+void DecimationFilter<CHANNELS,MAX_ORDER>::reset()
+{
+    memset(_integrator, 0, sizeof(_integrator));
+    memset(_comb, 0, sizeof(_comb));
+    memset(_output, 0, sizeof(_output));
+    _phase = 0;
+
+    // the integrators start from zero rather than from the signal, so
+    // the first order-1 outputs only see part of the impulse response
+    _warmup = _order - 1;
+}
+
+template <uint8_t CHANNELS, uint8_t MAX_ORDER>
+bool DecimationFilter<CHANNELS,MAX_ORDER>::apply(const int16_t sample[CHANNELS])
+{
+    // integrator section, run on every input sample
+    for (uint8_t c=0; c<CHANNELS; c++) {
+        uint32_t v = (uint32_t)(int32_t)sample[c];
+        for (uint8_t s=0; s<_order; s++) {
+            _integrator[s][c] += v;
+            v = _integrator[s][c];
+        }
+    }
+
+    if (++_phase < _ratio) {
+        return false;
+    }
+    _phase = 0;
+
+    // comb section, run at the output rate
+    for (uint8_t c=0; c<CHANNELS; c++) {
+        uint32_t v = _integrator[_order-1][c];
+        for (uint8_t s=0; s<_order; s++) {
+            uint32_t prev = _comb[s][c];
+            _comb[s][c] = v;
+            v -= prev;
+        }
+        _output[c] = (int32_t)v;
+    }
+
+    if (_warmup > 0) {
+        _warmup--;
+        return false;
+    }
+    return true;
+}
+
+#endif // __DECIMATION_FILTER_H__
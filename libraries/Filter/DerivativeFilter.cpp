@@ -19,13 +19,8 @@
 template <class T,  uint8_t FILTER_SIZE>
 void DerivativeFilter<T,FILTER_SIZE>::update(T sample, uint32_t timestamp)
 {
-    uint8_t i = FilterWithBuffer<T,FILTER_SIZE>::sample_index;
-    uint8_t i1;
-    if (i == 0) {
-        i1 = FILTER_SIZE-1;
-    } else {
-        i1 = i-1;
-    }
+    uint8_t i = Buffer::sample_index;
+    uint8_t i1 = filter_ring_index<FILTER_SIZE>(i + FILTER_SIZE - 1);
     if (_timestamps[i1] == timestamp) {
         // this is not a new timestamp - ignore
         return;
@@ -35,7 +30,7 @@ void DerivativeFilter<T,FILTER_SIZE>::update(T sample, uint32_t timestamp)
     _timestamps[i] = timestamp;
 
     // call parent's apply function to get the sample into the array
-    FilterWithBuffer<T,FILTER_SIZE>::apply(sample);
+    Buffer::apply(sample);
 
     _new_data = true;
 }
@@ -52,8 +47,8 @@ float DerivativeFilter<T,FILTER_SIZE>::slope(void)
 
     // use f() to make the code match the maths a bit better. Note
     // that unlike an average filter, we care about the order of the elements
-#define f(i) FilterWithBuffer<T,FILTER_SIZE>::samples[(((FilterWithBuffer<T,FILTER_SIZE>::sample_index-1)+i+1)+3*FILTER_SIZE/2) % FILTER_SIZE]
-#define x(i) _timestamps[(((FilterWithBuffer<T,FILTER_SIZE>::sample_index-1)+i+1)+3*FILTER_SIZE/2) % FILTER_SIZE]
+#define f(i) Buffer::samples[_index(i)]
+#define x(i) _timestamps[_index(i)]
 
     if (_timestamps[FILTER_SIZE-1] == _timestamps[FILTER_SIZE-2]) {
         // we haven't filled the buffer yet - assume zero derivative
@@ -108,8 +103,8 @@ float DerivativeFilter<T,FILTER_SIZE>::slope(void)
 template <class T, uint8_t FILTER_SIZE>
 void DerivativeFilter<T,FILTER_SIZE>::reset(void)
 {
-    // call parent's apply function to get the sample into the array
-    FilterWithBuffer<T,FILTER_SIZE>::reset();
+    // call parent's reset function to clear the array
+    Buffer::reset();
 }
 
 // add new instances as needed here
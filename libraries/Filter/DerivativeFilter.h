@@ -19,23 +19,31 @@
 // 1st parameter <T> is the type of data being filtered.
 // 2nd parameter <FILTER_SIZE> is the number of elements in the filter
 template <class T, uint8_t FILTER_SIZE>
-class DerivativeFilter : public FilterWithBuffer<T,FILTER_SIZE>
+class DerivativeFilter : public FilterWithBuffer<T,FILTER_SIZE,DerivativeFilter<T,FILTER_SIZE> >
 {
+    typedef FilterWithBuffer<T,FILTER_SIZE,DerivativeFilter<T,FILTER_SIZE> > Buffer;
+
 public:
     // constructor
-    DerivativeFilter() : FilterWithBuffer<T,FILTER_SIZE>() {
+    DerivativeFilter() : Buffer() {
     };
 
     // update - Add a new raw value to the filter, but don't recalculate
-    virtual void        update(T sample, uint32_t timestamp);
+    void                update(T sample, uint32_t timestamp);
 
     // return the derivative value
-    virtual float        slope(void);
+    float                slope(void);
 
     // reset - clear the filter
-    virtual void        reset();
+    void                reset();
 
 private:
+    // _index - position in the buffer of the i'th sample from the
+    // middle of the window (i from -FILTER_SIZE/2 to FILTER_SIZE/2)
+    uint8_t             _index(int8_t i) const {
+        return filter_ring_index<FILTER_SIZE>(Buffer::sample_index + FILTER_SIZE/2 + i);
+    }
+
     bool            _new_data;
     float           _last_slope;
 
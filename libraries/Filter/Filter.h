@@ -6,6 +6,8 @@
 
 #include "FilterClass.h"
 #include "AverageFilter.h"
+#include "BiquadFilter.h"
+#include "DecimationFilter.h"
 #include "DerivativeFilter.h"
 #include "FilterWithBuffer.h"
 #include "LowPassFilter.h"
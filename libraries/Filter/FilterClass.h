@@ -7,33 +7,62 @@
 //
 
 /// @file	FilterClass.h
-/// @brief	A pure virtual interface class
+/// @brief	Common base class for the filters in this library
 ///
+///         The base class is resolved at compile time (the "curiously
+///         recurring template pattern"): each filter passes its own type
+///         as the Derived parameter and provides
+///
+///             T    apply(T sample);
+///             void reset();
+///
+///         There are no virtual functions, so calls to a filter can be
+///         inlined and no filter carries a vtable, which on AVR would
+///         otherwise be copied into RAM. Code that takes a filter is a
+///         template on its type (see RangeFinder).
 
 #ifndef __FILTER_CLASS_H__
 #define __FILTER_CLASS_H__
 
 #include <inttypes.h>
 
-template <class T>
+template <class T, class Derived>
 class Filter
 {
 public:
-    // apply - Add a new raw value to the filter, retrieve the filtered result
-    virtual T apply(T sample) = 0;
+    // apply - run a block of n raw values through the filter, writing the
+    // filtered result for each one to out. in and out may be the same array
+    void apply(const T *in, T *out, uint16_t n) {
+        Derived *filter = static_cast<Derived *>(this);
+        for (uint16_t i=0; i<n; i++) {
+            out[i] = filter->apply(in[i]);
+        }
+    }
+};
 
-    // reset - clear the filter
-    virtual void reset()  = 0;
+// FilterDerived - picks the class a filter should dispatch to. Classes
+// that can be used both on their own and as the base of another filter
+// (like FilterWithBuffer) take a Derived parameter that defaults to void
+template <class Self, class Derived>
+struct FilterDerived {
+    typedef Derived type;
+};
 
+template <class Self>
+struct FilterDerived<Self, void> {
+    typedef Self type;
 };
 
-// Typedef for convenience
-typedef Filter<int8_t> FilterInt8;
-typedef Filter<uint8_t> FilterUInt8;
-typedef Filter<int16_t> FilterInt16;
-typedef Filter<uint16_t> FilterUInt16;
-typedef Filter<int32_t> FilterInt32;
-typedef Filter<uint32_t> FilterUInt32;
+// filter_ring_index - wrap an index into a buffer of SIZE elements. index must
+// be less than 2*SIZE. For power of two sizes this is a single mask,
+// the comparison is removed at compile time
+template <uint8_t SIZE>
+inline uint8_t filter_ring_index(uint8_t index)
+{
+    if ((SIZE & (SIZE-1)) == 0) {
+        return index & (SIZE-1);
+    }
+    return index >= SIZE ? index - SIZE : index;
+}
 
 #endif // __FILTER_CLASS_H__
-
@@ -17,14 +17,20 @@
 
 #include "FilterClass.h"
 
-template <class T, uint8_t FILTER_SIZE>
-class FilterWithBuffer : public Filter<T>
+// 1st parameter <T> is the type of data being filtered.
+// 2nd parameter <FILTER_SIZE> is the number of elements in the buffer
+// 3rd parameter <Derived> is the filter built on top of the buffer, if any
+template <class T, uint8_t FILTER_SIZE, class Derived = void>
+class FilterWithBuffer : public Filter<T, typename FilterDerived<FilterWithBuffer<T,FILTER_SIZE,Derived>, Derived>::type>
 {
+    typedef Filter<T, typename FilterDerived<FilterWithBuffer<T,FILTER_SIZE,Derived>, Derived>::type> FilterBase;
+
 public:
     // constructor
     FilterWithBuffer();
 
     // apply - Add a new raw value to the filter, retrieve the filtered result
+    using FilterBase::apply;
     T apply(T sample);
 
     // reset - clear the filter
@@ -35,7 +41,7 @@ public:
         return FILTER_SIZE;
     };
 
-    virtual T get_sample(uint8_t i) {
+    T get_sample(uint8_t i) {
         return samples[i];
     }
 
@@ -72,8 +78,8 @@ typedef FilterWithBuffer<uint32_t,6> FilterWithBufferUInt32_Size6;
 typedef FilterWithBuffer<uint32_t,7> FilterWithBufferUInt32_Size7;
 
 // Constructor
-template <class T, uint8_t FILTER_SIZE>
-FilterWithBuffer<T,FILTER_SIZE>::FilterWithBuffer() :
+template <class T, uint8_t FILTER_SIZE, class Derived>
+FilterWithBuffer<T,FILTER_SIZE,Derived>::FilterWithBuffer() :
     sample_index(0)
 {
     // clear sample buffer
@@ -81,8 +87,8 @@ FilterWithBuffer<T,FILTER_SIZE>::FilterWithBuffer() :
 }
 
 // reset - clear all samples from the buffer
-template <class T, uint8_t FILTER_SIZE>
-void FilterWithBuffer<T,FILTER_SIZE>::reset()
+template <class T, uint8_t FILTER_SIZE, class Derived>
+void FilterWithBuffer<T,FILTER_SIZE,Derived>::reset()
 {
     // clear samples buffer
     for( int8_t i=0; i<FILTER_SIZE; i++ ) {
@@ -94,15 +100,14 @@ void FilterWithBuffer<T,FILTER_SIZE>::reset()
 }
 
 // apply - take in a new raw sample, and return the filtered results
-template <class T, uint8_t FILTER_SIZE>
-T FilterWithBuffer<T,FILTER_SIZE>::        apply(T sample)
+template <class T, uint8_t FILTER_SIZE, class Derived>
+T FilterWithBuffer<T,FILTER_SIZE,Derived>::        apply(T sample)
 {
     // add sample to array
-    samples[sample_index++] = sample;
+    samples[sample_index] = sample;
 
-    // wrap index if necessary
-    if( sample_index >= FILTER_SIZE )
-        sample_index = 0;
+    // move to the next slot, wrapping if necessary
+    sample_index = filter_ring_index<FILTER_SIZE>(sample_index+1);
 
     // base class doesn't know what filtering to do so we just return the raw sample
     return sample;
@@ -19,25 +19,26 @@
 
 // 1st parameter <T> is the type of data being filtered.
 template <class T>
-class LowPassFilter : public Filter<T>
+class LowPassFilter : public Filter<T, LowPassFilter<T> >
 {
 public:
     // constructor
     LowPassFilter();
 
-    virtual void    set_cutoff_frequency(float time_step, float cutoff_freq);
-    virtual void    set_time_constant(float time_step, float time_constant);
+    void            set_cutoff_frequency(float time_step, float cutoff_freq);
+    void            set_time_constant(float time_step, float time_constant);
 
     // apply - Add a new raw value to the filter, retrieve the filtered result
-    virtual T        apply(T sample);
+    using Filter<T, LowPassFilter<T> >::apply;
+    T                apply(T sample);
 
     // reset - clear the filter - next sample added will become the new base value
-    virtual void        reset() {
+    void                reset() {
         _base_value_set = false;
     };
 
     // reset - clear the filter and provide the new base value
-    virtual void        reset( T new_base_value ) {
+    void                reset( T new_base_value ) {
         _base_value = new_base_value; _base_value_set = true;
     };
 
@@ -63,7 +64,7 @@ typedef LowPassFilter<float> LowPassFilterFloat;
 
 template <class T>
 LowPassFilter<T>::LowPassFilter() :
-    Filter<T>(),
+    Filter<T, LowPassFilter<T> >(),
     _alpha(1),
     _base_value_set(false)
 {};
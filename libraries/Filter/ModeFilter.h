@@ -9,6 +9,15 @@
 /// @file	ModeFilter.h
 /// @brief	A class to apply a mode filter which is basically picking the median value from the last x samples
 ///         the filter size (i.e buffer size) should always be an odd number
+///
+///         The samples are kept in time order in the buffer and also in
+///         sorted order in a second array. Each new sample replaces the
+///         oldest one: the oldest is found in the sorted array by binary
+///         search and the entries between it and the new sample's place
+///         are moved along by one. Unlike dropping the highest or lowest
+///         sample this gives the true median of the last FILTER_SIZE
+///         samples, and the cost only grows with how far the sorted
+///         position moves, so wide windows stay cheap.
 
 #ifndef __MODE_FILTER_H__
 #define __MODE_FILTER_H__
@@ -18,19 +27,27 @@
 #include "FilterWithBuffer.h"
 
 template <class T, uint8_t FILTER_SIZE>
-class ModeFilter : public FilterWithBuffer<T,FILTER_SIZE>
+class ModeFilter : public FilterWithBuffer<T,FILTER_SIZE,ModeFilter<T,FILTER_SIZE> >
 {
+    typedef FilterWithBuffer<T,FILTER_SIZE,ModeFilter<T,FILTER_SIZE> > Buffer;
+
 public:
     ModeFilter(uint8_t return_element);
 
     // apply - Add a new raw value to the filter, retrieve the filtered result
-    virtual T        apply(T sample);
+    using Buffer::apply;
+    T                apply(T sample);
+
+    // reset - clear the filter
+    void             reset();
 
 private:
-    // private methods
+    // _find - position of value in the sorted array (which must hold it)
+    uint8_t         _find(T value);
+
     uint8_t         _return_element;
-    void            isort(T sample, bool drop_high_sample);
-    bool            drop_high_sample; // switch to determine whether to drop the highest or lowest sample when new value arrives
+    uint8_t         _num_samples;               // number of samples in the filter
+    T               _sorted[FILTER_SIZE];       // the samples in ascending order
 };
 
 // Typedef for convenience
@@ -54,85 +71,96 @@ typedef ModeFilter<uint16_t,4> ModeFilterUInt16_Size4;
 typedef ModeFilter<uint16_t,5> ModeFilterUInt16_Size5;
 typedef ModeFilter<uint16_t,6> ModeFilterUInt16_Size6;
 typedef ModeFilter<uint16_t,7> ModeFilterUInt16_Size7;
+typedef ModeFilter<int16_t,15> ModeFilterInt16_Size15;
+typedef ModeFilter<int16_t,31> ModeFilterInt16_Size31;
+typedef ModeFilter<uint16_t,15> ModeFilterUInt16_Size15;
+typedef ModeFilter<uint16_t,31> ModeFilterUInt16_Size31;
 
 // Constructor    //////////////////////////////////////////////////////////////
 
 template <class T, uint8_t FILTER_SIZE>
 ModeFilter<T,FILTER_SIZE>::ModeFilter(uint8_t return_element) :
-    FilterWithBuffer<T,FILTER_SIZE>(),
-    _return_element(return_element),
-    drop_high_sample(true)
+    Buffer(),
+    _return_element(return_element)
 {
     // ensure we have a valid return_nth_element value.  if not, revert to median
     if( _return_element >= FILTER_SIZE )
         _return_element = FILTER_SIZE / 2;
+
+    reset();
 };
 
 // Public Methods //////////////////////////////////////////////////////////////
 
+template <class T, uint8_t FILTER_SIZE>
+void ModeFilter<T,FILTER_SIZE>::        reset()
+{
+    Buffer::reset();
+    _num_samples = 0;
+}
+
 template <class T, uint8_t FILTER_SIZE>
 T ModeFilter<T,FILTER_SIZE>::        apply(T sample)
 {
-    // insert the new items into the samples buffer
-    isort(sample, drop_high_sample);
+    uint8_t i;
 
-    // next time drop from the other end of the sample buffer
-    drop_high_sample = !drop_high_sample;
+    if( _num_samples < FILTER_SIZE ) {
+        // buffer is not yet full, insert the sample from the top
+        i = _num_samples++;
+        while( i > 0 && _sorted[i-1] > sample ) {
+            _sorted[i] = _sorted[i-1];
+            i--;
+        }
+        _sorted[i] = sample;
+    }else{
+        // replace the oldest sample, moving the entries between its
+        // position and the new sample's position along by one
+        i = _find(Buffer::samples[Buffer::sample_index]);
+        if( sample > _sorted[i] ) {
+            while( i < FILTER_SIZE-1 && _sorted[i+1] < sample ) {
+                _sorted[i] = _sorted[i+1];
+                i++;
+            }
+        }else{
+            while( i > 0 && _sorted[i-1] > sample ) {
+                _sorted[i] = _sorted[i-1];
+                i--;
+            }
+        }
+        _sorted[i] = sample;
+    }
+
+    // add to the time ordered buffer
+    Buffer::apply(sample);
 
     // return results
-    if( FilterWithBuffer<T,FILTER_SIZE>::sample_index < FILTER_SIZE ) {
+    if( _num_samples < FILTER_SIZE ) {
         // middle sample if buffer is not yet full
-        return FilterWithBuffer<T,FILTER_SIZE>::samples[(FilterWithBuffer<T,FILTER_SIZE>::sample_index / 2)];
+        return _sorted[_num_samples / 2];
     }else{
         // return element specified by user in constructor
-        return FilterWithBuffer<T,FILTER_SIZE>::samples[_return_element];
+        return _sorted[_return_element];
     }
 }
 
-//
-// insertion sort - takes a new sample and pushes it into the sample array
-//                  drops either the highest or lowest sample depending on the 'drop_high_sample' parameter
-//
+// Private Methods //////////////////////////////////////////////////////////////
+
+// _find - binary search for value in the full sorted array
 template <class T, uint8_t FILTER_SIZE>
-void ModeFilter<T,FILTER_SIZE>::        isort(T new_sample, bool drop_high)
+uint8_t ModeFilter<T,FILTER_SIZE>::        _find(T value)
 {
-    int8_t        i;
-
-    // if the buffer isn't full simply increase the #items in the buffer (i.e. sample_index)
-    // the rest is the same as dropping the high sample
-    if( FilterWithBuffer<T,FILTER_SIZE>::sample_index < FILTER_SIZE ) {
-        FilterWithBuffer<T,FILTER_SIZE>::sample_index++;
-        drop_high = true;
-    }
-
-    if( drop_high ) {      // drop highest sample from the buffer to make room for our new sample
-
-        // start from top. Note: sample_index always points to the next open space so we start from sample_index-1
-        i = FilterWithBuffer<T,FILTER_SIZE>::sample_index-1;
-
-        // if the next element is higher than our new sample, push it up one position
-        while( FilterWithBuffer<T,FILTER_SIZE>::samples[i-1] > new_sample && i > 0 ) {
-            FilterWithBuffer<T,FILTER_SIZE>::samples[i] = FilterWithBuffer<T,FILTER_SIZE>::samples[i-1];
-            i--;
+    uint8_t low = 0;
+    uint8_t high = FILTER_SIZE-1;
+
+    while( low < high ) {
+        uint8_t mid = (low + high) / 2;
+        if( _sorted[mid] < value ) {
+            low = mid + 1;
+        }else{
+            high = mid;
         }
-
-        // add our new sample to the buffer
-        FilterWithBuffer<T,FILTER_SIZE>::samples[i] = new_sample;
-
-    }else{     // drop lowest sample from the buffer to make room for our new sample
-
-        // start from the bottom
-        i = 0;
-
-        // if the element is lower than our new sample, push it down one position
-        while( FilterWithBuffer<T,FILTER_SIZE>::samples[i+1] < new_sample && i < FilterWithBuffer<T,FILTER_SIZE>::sample_index-1 ) {
-            FilterWithBuffer<T,FILTER_SIZE>::samples[i] = FilterWithBuffer<T,FILTER_SIZE>::samples[i+1];
-            i++;
-        }
-
-        // add our new sample to the buffer
-        FilterWithBuffer<T,FILTER_SIZE>::samples[i] = new_sample;
     }
+    return low;
 }
 
 #endif // __MODE_FILTER_H__
@@ -0,0 +1,60 @@
+/*
+ *       Example sketch to demonstrate use of BiquadFilter library.
+ *       Prints the gain of a low pass and a notch filter at a range of
+ *       frequencies for a 200Hz sample rate.
+ */
+
+#include <AP_Common.h>
+#include <AP_Progmem.h>
+#include <AP_HAL.h>
+#include <AP_HAL_AVR.h>
+#include <AP_Param.h>
+#include <AP_Math.h>            // ArduPilot Mega Vector/Matrix math Library
+#include <Filter.h>                     // Filter library
+#include <BiquadFilter.h>       // BiquadFilter class (inherits from Filter class)
+
+const AP_HAL::HAL& hal = AP_HAL_BOARD_DRIVER;
+
+#define SAMPLE_FREQ 200.0f
+
+BiquadFilterFloat low_pass_filter;
+BiquadFilterFloat notch_filter;
+
+// gain - peak output of the filter for a unit sine wave at freq, once the
+// filter has settled
+static float gain(BiquadFilterFloat &filter, float freq)
+{
+    float peak = 0;
+    filter.reset();
+    for (uint16_t i=0; i<400; i++) {
+        float out = filter.apply(sin(i * 2 * M_PI * freq / SAMPLE_FREQ));
+        if (i >= 200 && fabs(out) > peak) {
+            peak = fabs(out);
+        }
+    }
+    return peak;
+}
+
+void setup()
+{
+    hal.console->printf("ArduPilot BiquadFilter test ver 1.0\n\n");
+
+    low_pass_filter.set_low_pass(SAMPLE_FREQ, 20);
+    notch_filter.set_notch(SAMPLE_FREQ, 60, 10);
+
+    hal.scheduler->delay(500);
+}
+
+void loop()
+{
+    hal.console->printf("freq\tlow pass 20Hz\tnotch 60Hz\n");
+    for (uint8_t freq=5; freq<100; freq+=5) {
+        hal.console->printf("%u\t%6.4f\t\t%6.4f\n",
+                            (unsigned)freq,
+                            gain(low_pass_filter, freq),
+                            gain(notch_filter, freq));
+    }
+    hal.scheduler->delay(10000);
+}
+
+AP_HAL_MAIN();
@@ -0,0 +1,72 @@
+/*
+ *       Example sketch to demonstrate use of DecimationFilter library.
+ *       Simulates a 1kHz gyro sample stream with a slow manoeuvre plus
+ *       motor vibration and shows how much of the vibration is left at
+ *       200Hz for each filter order.
+ */
+
+#include <AP_Common.h>
+#include <AP_Progmem.h>
+#include <AP_HAL.h>
+#include <AP_HAL_AVR.h>
+#include <AP_Param.h>
+#include <AP_Math.h>
+#include <Filter.h>
+#include <DecimationFilter.h>
+
+const AP_HAL::HAL& hal = AP_HAL_BOARD_DRIVER;
+
+// one channel, up to third order
+DecimationFilter<1,3> decimator;
+
+// setup routine
+void setup()
+{
+    hal.console->printf("ArduPilot DecimationFilter test ver 1.0\n\n");
+
+    // Wait for the serial connection
+    hal.scheduler->delay(500);
+}
+
+// run one second of 1kHz samples through the filter, and return the
+// worst error against the manoeuvre delayed by the filter's group delay
+static float test_order(uint8_t order)
+{
+    decimator.set_ratio_and_order(5, order);
+    float delay = decimator.get_delay_samples();
+    float max_error = 0;
+
+    for (uint16_t i=0; i<1000; i++) {
+        float manoeuvre = 2000 * sin(i*2*M_PI*2/1000.0);        // 2Hz
+        float vibration = 3000 * sin(i*2*M_PI*180/1000.0);      // 180Hz
+        int16_t sample = manoeuvre + vibration;
+
+        if (decimator.apply(&sample) && i > 20) {
+            float expected = 2000 * sin((i-delay)*2*M_PI*2/1000.0);
+            float output = decimator.output(0) / (float)decimator.get_gain();
+            float error = fabs(output - expected);
+            if (error > max_error) {
+                max_error = error;
+            }
+        }
+    }
+    return max_error;
+}
+
+//Main loop where the action takes place
+void loop()
+{
+    for (uint8_t order=1; order<=3; order++) {
+        uint32_t t1 = hal.scheduler->micros();
+        float max_error = test_order(order);
+        uint32_t t2 = hal.scheduler->micros();
+        hal.console->printf("order %u: delay %.1fms max error %.1f (%lu usec per 1000 samples)\n",
+                            (unsigned)order,
+                            decimator.get_delay_samples(),
+                            max_error,
+                            (unsigned long)(t2 - t1));
+    }
+    hal.scheduler->delay(10000);
+}
+
+AP_HAL_MAIN();
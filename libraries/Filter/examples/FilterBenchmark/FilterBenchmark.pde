@@ -0,0 +1,159 @@
+/*
+ *       Timing of the Filter library, one sample at a time and in blocks,
+ *       against a filter called through a virtual interface the way the
+ *       library used to work.
+ */
+
+#include <AP_Common.h>
+#include <AP_Progmem.h>
+#include <AP_HAL.h>
+#include <AP_HAL_AVR.h>
+#include <AP_Param.h>
+#include <AP_Math.h>
+#include <Filter.h>
+#include <ModeFilter.h>
+#include <AverageFilter.h>
+#include <LowPassFilter.h>
+#include <DerivativeFilter.h>
+
+const AP_HAL::HAL& hal = AP_HAL_BOARD_DRIVER;
+
+#define NUM_SAMPLES 64
+#define NUM_PASSES  20
+
+// baseline: an average filter reached through a vtable
+class VirtualFilterInt16 {
+public:
+    virtual int16_t apply(int16_t sample) = 0;
+};
+
+class VirtualAverageFilterInt16_Size5 : public VirtualFilterInt16 {
+public:
+    virtual int16_t apply(int16_t sample) {
+        return _filter.apply(sample);
+    }
+private:
+    AverageFilterInt16_Size5 _filter;
+};
+
+ModeFilterInt16_Size5           mode_filter(2);
+ModeFilterInt16_Size15          mode_filter15(7);
+ModeFilterInt16_Size31          mode_filter31(15);
+AverageFilterInt16_Size5        average_filter;
+VirtualAverageFilterInt16_Size5 virtual_average_filter;
+LowPassFilterFloat              low_pass_filter;
+DerivativeFilterFloat_Size7     derivative_filter;
+
+int16_t in_int16[NUM_SAMPLES];
+int16_t out_int16[NUM_SAMPLES];
+int16_t in_random[NUM_SAMPLES];
+float   in_float[NUM_SAMPLES];
+float   out_float[NUM_SAMPLES];
+
+static void report(const prog_char_t *name, uint32_t time_us)
+{
+    hal.console->printf_P(name);
+    hal.console->printf_P(PSTR(" %.2f usec/sample\n"),
+                          time_us / (float)(NUM_SAMPLES * NUM_PASSES));
+}
+
+// time_mode_filter - time a mode filter on a slowly changing signal like
+// a sonar, and on one that jumps about at random. The template is on
+// the same line so the sketch prototype scanner skips it
+template <class F> static void time_mode_filter(F &filter, const prog_char_t *name)
+{
+    uint32_t start = hal.scheduler->micros();
+    for (uint8_t p=0; p<NUM_PASSES; p++) {
+        for (uint8_t i=0; i<NUM_SAMPLES; i++) {
+            out_int16[i] = filter.apply(in_int16[i]);
+        }
+    }
+    report(name, hal.scheduler->micros() - start);
+
+    start = hal.scheduler->micros();
+    for (uint8_t p=0; p<NUM_PASSES; p++) {
+        for (uint8_t i=0; i<NUM_SAMPLES; i++) {
+            out_int16[i] = filter.apply(in_random[i]);
+        }
+    }
+    report(PSTR("    random input      "), hal.scheduler->micros() - start);
+}
+
+void setup()
+{
+    hal.console->println("ArduPilot Filter benchmark");
+
+    for (uint8_t i=0; i<NUM_SAMPLES; i++) {
+        in_int16[i] = 200 + (i * 37) % 50;
+        in_float[i] = in_int16[i];
+        in_random[i] = (i * 7919) % 1000;
+    }
+    low_pass_filter.set_cutoff_frequency(0.01, 5);
+    hal.scheduler->delay(500);
+}
+
+void loop()
+{
+    uint32_t start;
+    VirtualFilterInt16 *vf = &virtual_average_filter;
+
+    start = hal.scheduler->micros();
+    for (uint8_t p=0; p<NUM_PASSES; p++) {
+        for (uint8_t i=0; i<NUM_SAMPLES; i++) {
+            out_int16[i] = vf->apply(in_int16[i]);
+        }
+    }
+    report(PSTR("virtual average       "), hal.scheduler->micros() - start);
+
+    start = hal.scheduler->micros();
+    for (uint8_t p=0; p<NUM_PASSES; p++) {
+        for (uint8_t i=0; i<NUM_SAMPLES; i++) {
+            out_int16[i] = average_filter.apply(in_int16[i]);
+        }
+    }
+    report(PSTR("average               "), hal.scheduler->micros() - start);
+
+    start = hal.scheduler->micros();
+    for (uint8_t p=0; p<NUM_PASSES; p++) {
+        average_filter.apply(in_int16, out_int16, NUM_SAMPLES);
+    }
+    report(PSTR("average block         "), hal.scheduler->micros() - start);
+
+    time_mode_filter(mode_filter, PSTR("mode 5                "));
+    time_mode_filter(mode_filter15, PSTR("mode 15               "));
+    time_mode_filter(mode_filter31, PSTR("mode 31               "));
+
+    start = hal.scheduler->micros();
+    for (uint8_t p=0; p<NUM_PASSES; p++) {
+        mode_filter.apply(in_int16, out_int16, NUM_SAMPLES);
+    }
+    report(PSTR("mode block            "), hal.scheduler->micros() - start);
+
+    start = hal.scheduler->micros();
+    for (uint8_t p=0; p<NUM_PASSES; p++) {
+        for (uint8_t i=0; i<NUM_SAMPLES; i++) {
+            out_float[i] = low_pass_filter.apply(in_float[i]);
+        }
+    }
+    report(PSTR("low pass              "), hal.scheduler->micros() - start);
+
+    start = hal.scheduler->micros();
+    for (uint8_t p=0; p<NUM_PASSES; p++) {
+        low_pass_filter.apply(in_float, out_float, NUM_SAMPLES);
+    }
+    report(PSTR("low pass block        "), hal.scheduler->micros() - start);
+
+    start = hal.scheduler->micros();
+    for (uint8_t p=0; p<NUM_PASSES; p++) {
+        for (uint8_t i=0; i<NUM_SAMPLES; i++) {
+            derivative_filter.update(in_float[i], start + i*10000UL);
+        }
+        out_float[0] = derivative_filter.slope();
+    }
+    report(PSTR("derivative update     "), hal.scheduler->micros() - start);
+
+    hal.console->println();
+    hal.scheduler->delay(1000);
+}
+
+AP_HAL_MAIN();
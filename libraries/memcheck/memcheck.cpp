@@ -3,6 +3,11 @@
 /*
  *  note that we use a 32 bit sentinel to reduce the chance
  *  of false positives with uninitialised stack variables
+ *
+ *  the AVR scheduler paints below the timer interrupt's stack frame
+ *  to measure how much stack the timer processes use, and puts this
+ *  sentinel back where it found it. The stack high water marks it
+ *  keeps are in AP_HAL::Scheduler::TimerStats
  */
 
 #include <stdlib.h>
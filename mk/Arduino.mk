@@ -272,6 +272,7 @@ LISTOPTS        =   -adhlns=$(@:.o=.lst)
 NATIVE_CPUFLAGS     = -D_GNU_SOURCE
 NATIVE_CPULDFLAGS   = -g
 NATIVE_OPTFLAGS     = -O0 -g
+NATIVE_LIBS         = -lpthread
 
 AVR_CPUFLAGS        = -mmcu=$(MCU) -mcall-prologues 
 AVR_CPULDFLAGS      = -Wl,-m,avr6
@@ -280,6 +281,7 @@ AVR_OPTFLAGS        = -Os
 CPUFLAGS= $($(TOOLCHAIN)_CPUFLAGS)
 CPULDFLAGS= $($(TOOLCHAIN)_CPULDFLAGS)
 OPTFLAGS= $($(TOOLCHAIN)_OPTFLAGS)
+TOOLCHAINLIBS= $($(TOOLCHAIN)_LIBS)
 
 CXXFLAGS        =   -g $(CPUFLAGS) $(DEFINES) -Wa,$(LISTOPTS) $(OPTFLAGS)
 CXXFLAGS       +=   $(WARNFLAGS) $(WARNFLAGSCXX) $(DEPFLAGS) $(CXXOPTS)
@@ -302,7 +304,7 @@ ifeq ($(EXCLUDE_RELAX),)
   LDFLAGS      +=   -Wl,--relax
 endif
 
-LIBS = -lm
+LIBS = -lm $(TOOLCHAINLIBS)
 
 SRCSUFFIXES = *.cpp *.c *.S
 
@@ -448,6 +450,8 @@ endif
 
 ifeq ($(HAL_BOARD),HAL_BOARD_AVR_SITL)
   TOOLCHAIN = NATIVE
+else ifeq ($(HAL_BOARD),HAL_BOARD_LINUX)
+  TOOLCHAIN = NATIVE
 else
   TOOLCHAIN = AVR
 endif
@@ -492,6 +496,10 @@ sitl: HAL_BOARD = HAL_BOARD_AVR_SITL
 sitl: TOOLCHAIN = NATIVE
 sitl: all
 
+linux: HAL_BOARD = HAL_BOARD_LINUX
+linux: TOOLCHAIN = NATIVE
+linux: all
+
 apm1: HAL_BOARD = HAL_BOARD_APM1
 apm1: TOOLCHAIN = AVR
 apm1: all
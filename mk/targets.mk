@@ -61,6 +61,23 @@ obc: apm2
 sitl-mount: EXTRAFLAGS += "-DMOUNT=ENABLED"
 sitl-mount: sitl
 
+# bind the HAL drivers used in hot paths statically, see AP_HAL_Static.h
+sitl-static: EXTRAFLAGS += "-DHAL_STATIC_BINDING=1 "
+sitl-static: sitl
+
+linux-static: EXTRAFLAGS += "-DHAL_STATIC_BINDING=1 "
+linux-static: linux
+
+apm1-static: EXTRAFLAGS += "-DHAL_STATIC_BINDING=1 "
+apm1-static: apm1
+
+apm2-static: EXTRAFLAGS += "-DHAL_STATIC_BINDING=1 "
+apm2-static: apm2
+
+# static RAM used by each library, from the map of the last build
+ramreport:
+	python $(SKETCHBOOK)/Tools/scripts/ram_report.py $(SKETCHMAP)
+
 etags:
 	cd .. && etags -f ArduCopter/TAGS --langmap=C++:.pde.cpp.h $$(git ls-files ArduCopter libraries)
 